@@ -0,0 +1,209 @@
+#ifndef KV_BENCH_BENCH_ALLOC_WORKLOADS_H
+#define KV_BENCH_BENCH_ALLOC_WORKLOADS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "kv/Bench/BenchAllocators.h"
+#include "kv/Bench/BenchRunner.h"
+
+namespace kv {
+
+/**
+ * @brief Options of MeasureAllocThroughput.
+ */
+struct AllocThroughputOptions {
+  size_t size = 64;                     // The size of every memory chunk
+  size_t batchSize = 1024;              // The number of chunks allocated before they are released in the same order
+  MeasureOptions measure;
+}; // struct AllocThroughputOptions
+
+/**
+ * @brief Measure the single-threaded throughput of allocating and releasing memory chunks of one size.
+ *
+ * Every call of the measured function allocates a batch of chunks, writes the first byte of each, and then releases
+ * them, and finally recycles the heap.
+ *
+ * @param allocator the allocator under test.
+ * @param options the options of the benchmark.
+ *
+ * @return the samples, which are the durations of a whole batch.
+ * @throw std::bad_alloc if the allocation fails.
+ */
+[[nodiscard]]
+Measurement MeasureAllocThroughput(BenchAllocator& allocator, const AllocThroughputOptions& options);
+
+/**
+ * @brief The result of a multi-threaded allocator benchmark.
+ */
+struct AllocWorkloadResult {
+  uint64_t operations = 0;              // The number of pairs of an allocation and a release of all threads
+  double seconds = 0;                   // The time from the synchronized start until the last thread finished
+
+  /**
+   * @brief Get the throughput.
+   *
+   * @return the operations per second in millions, or 0 if no time has passed.
+   */
+  [[nodiscard]]
+  double GetMillionOperationsPerSecond() const noexcept {
+    return seconds == 0 ? 0.0 : static_cast<double>(operations) / seconds / 1e6;
+  }
+}; // struct AllocWorkloadResult
+
+/**
+ * @brief Options of RunCrossThreadFrees.
+ */
+struct CrossThreadOptions {
+  size_t pairs = 1;                     // The number of producer and consumer thread pairs
+  uint64_t operations = 1 << 19;        // The number of chunks every producer allocates
+  size_t minSize = 16;                  // The minimal size of chunks
+  size_t maxSize = 256;                 // The maximal size of chunks
+  size_t queueCapacity = 1024;          // The capacity of the queue from a producer to its consumer
+  uint64_t seed = 1;                    // The seed of the random chunk sizes
+}; // struct CrossThreadOptions
+
+/**
+ * @brief Run producer threads that allocate memory chunks of random sizes and pass them to consumer threads, which
+ * release them through their own heaps.
+ *
+ * @param allocator the allocator under test.
+ * @param options the options of the benchmark.
+ *
+ * @return the result, counting the chunks of all producers.
+ * @throw std::bad_alloc if the allocation fails.
+ * @throw std::system_error if the threads cannot be started.
+ */
+[[nodiscard]]
+AllocWorkloadResult RunCrossThreadFrees(BenchAllocator& allocator, const CrossThreadOptions& options);
+
+/**
+ * @brief Options of RunAllocChurn.
+ */
+struct ChurnOptions {
+  size_t threads = 1;                   // The number of threads
+  size_t slots = 1024;                  // The number of live chunks of every thread
+  uint64_t operations = 1 << 19;        // The number of chunk replacements of every thread
+  size_t rounds = 8;                    // The number of rounds the replacements are divided into
+  size_t minSize = 16;                  // The minimal size of chunks
+  size_t maxSize = 512;                 // The maximal size of chunks
+  uint64_t seed = 1;                    // The seed of the random slots and chunk sizes
+}; // struct ChurnOptions
+
+/**
+ * @brief Run threads that repeatedly replace random live chunks with new chunks of random sizes, in the manner of the
+ * larson and threadtest benchmarks.
+ *
+ * Every thread fills a set of slots with chunks. After each round, every thread moves on to the set of the next
+ * thread, so that chunks allocated by one thread are released by another, as in larson, where the chunks of a
+ * finishing thread are handed to its successor.
+ *
+ * @param allocator the allocator under test.
+ * @param options the options of the benchmark.
+ *
+ * @return the result, counting the replacements of all threads.
+ * @throw std::bad_alloc if the allocation fails.
+ * @throw std::system_error if the threads cannot be started.
+ */
+[[nodiscard]]
+AllocWorkloadResult RunAllocChurn(BenchAllocator& allocator, const ChurnOptions& options);
+
+/**
+ * @brief Options of RunFragmentation.
+ */
+struct FragmentationOptions {
+  size_t liveSize = static_cast<size_t>(64) << 20; // The size of the live chunks after each allocation phase
+  size_t phases = 8;                    // The number of allocation phases
+  double releaseFraction = 0.875;       // The fraction of live chunks released at random after each allocation phase
+  size_t minSize = 16;                  // The minimal size of chunks in the first phase
+  size_t maxSize = 256;                 // The maximal size of chunks in the first phase
+  uint64_t seed = 1;                    // The seed of the random chunk sizes and releases
+}; // struct FragmentationOptions
+
+/**
+ * @brief A sample of the memory use during RunFragmentation.
+ */
+struct FragmentationSample {
+  double seconds = 0;                   // The time since the start of the benchmark
+  size_t liveBytes = 0;                 // The total size of the live chunks
+  size_t residentBytes = 0;             // The growth of the resident set of the process since the start
+}; // struct FragmentationSample
+
+/**
+ * @brief The result of RunFragmentation.
+ */
+struct FragmentationResult {
+  std::vector<FragmentationSample> samples;
+
+  /**
+   * @brief Get the peak resident set relative to the peak size of the live chunks.
+   *
+   * @return the ratio, or 0 if there are no live chunks.
+   */
+  [[nodiscard]]
+  double GetPeakResidentRatio() const noexcept;
+}; // struct FragmentationResult
+
+/**
+ * @brief Run a workload that fragments the heap and sample the resident set of the process over time.
+ *
+ * Every phase allocates chunks until the live chunks reach the live size, and then releases a random fraction of the
+ * live chunks. The chunk sizes of each phase are larger than those of the phase before, so the holes left behind only
+ * fit the new chunks if the allocator coalesces or returns them. Samples are taken after every allocation and
+ * release, and after all chunks are released at the end.
+ *
+ * The resident set is that of the whole process, so other threads should be idle.
+ *
+ * @param allocator the allocator under test.
+ * @param options the options of the benchmark.
+ *
+ * @return the samples.
+ * @throw std::bad_alloc if the allocation fails.
+ */
+[[nodiscard]]
+FragmentationResult RunFragmentation(BenchAllocator& allocator, const FragmentationOptions& options);
+
+/**
+ * @brief Get the resident set size of the process.
+ *
+ * @return the resident set size in bytes, or 0 if it is unavailable.
+ */
+[[nodiscard]]
+size_t GetResidentSetSize() noexcept;
+
+/**
+ * @brief Options of MeasureJsonTree.
+ */
+struct JsonTreeOptions {
+  size_t records = 1024;                // The number of records in the array at the root of every tree
+  size_t sampleCount = 5;               // The number of trees built and torn down
+}; // struct JsonTreeOptions
+
+/**
+ * @brief The result of MeasureJsonTree.
+ */
+struct JsonTreeResult {
+  size_t nodes = 0;                     // The number of nodes of every tree allocated by the allocator under test
+  std::vector<double> buildSamples;     // The time to build a tree in seconds, one per sample
+  std::vector<double> teardownSamples;  // The time to destroy a tree in seconds, one per sample
+}; // struct JsonTreeResult
+
+/**
+ * @brief Measure building and tearing down JsonObject trees whose nodes are allocated by the allocator under test.
+ *
+ * Every record is a flat map with a number, a string, a boolean, an array of strings and a nested map. The storage of
+ * strings, arrays and maps comes from the global allocator regardless of the allocator under test.
+ *
+ * @param allocator the allocator under test.
+ * @param options the options of the benchmark.
+ *
+ * @return the samples.
+ * @throw std::bad_alloc if the allocation fails.
+ */
+[[nodiscard]]
+JsonTreeResult MeasureJsonTree(BenchAllocator& allocator, const JsonTreeOptions& options);
+
+} // namespace kv
+
+#endif // KV_BENCH_BENCH_ALLOC_WORKLOADS_H
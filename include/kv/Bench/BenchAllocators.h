@@ -0,0 +1,245 @@
+#ifndef KV_BENCH_BENCH_ALLOCATORS_H
+#define KV_BENCH_BENCH_ALLOCATORS_H
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "kv/Support/Memory.h"
+
+namespace kv {
+
+/**
+ * @brief Allocators that the allocator benchmarks compare.
+ */
+enum class BenchAllocatorKind {
+  /**
+   * @brief A private RawAllocator shared by all threads, which serializes allocations on its lock.
+   */
+  Raw,
+
+  /**
+   * @brief A ThreadCache for each thread in front of a private RawAllocator, as the global `operator new` does.
+   */
+  ThreadCache,
+
+  /**
+   * @brief A MonotonicArena for each thread, whose releases do nothing, over a private RawAllocator.
+   */
+  Arena,
+
+  /**
+   * @brief A SlabPoolSet for each thread over a private RawAllocator, which also serves the sizes it does not pool.
+   */
+  SlabPool,
+
+  /**
+   * @brief The `malloc` and `free` of the C library.
+   */
+  Malloc,
+
+  /**
+   * @brief jemalloc, loaded at runtime.
+   */
+  Jemalloc,
+
+  /**
+   * @brief mimalloc, loaded at runtime.
+   */
+  Mimalloc,
+};
+
+/**
+ * @brief The number of allocator kinds.
+ */
+constexpr static const size_t BenchAllocatorKindCount = static_cast<size_t>(BenchAllocatorKind::Mimalloc) + 1;
+
+/**
+ * @brief Get the name of the specified allocator kind, such as `thread-cache`.
+ *
+ * @param kind the allocator kind.
+ *
+ * @return the name.
+ */
+[[nodiscard]]
+const char* GetBenchAllocatorName(BenchAllocatorKind kind) noexcept;
+
+/**
+ * @brief Get the allocator kind of the specified name.
+ *
+ * @param name the name, as returned by GetBenchAllocatorName.
+ *
+ * @return the allocator kind, or empty if there is no allocator kind of the name.
+ */
+[[nodiscard]]
+std::optional<BenchAllocatorKind> ParseBenchAllocatorKind(std::string_view name) noexcept;
+
+/**
+ * @brief A handle through which a single thread allocates from the allocator under test.
+ *
+ * A memory chunk may be released through another heap of the same allocator than the one that allocated it, which is
+ * how the benchmarks free memory across threads. Heaps that keep memory of their own, such as the pools of SlabPool
+ * heaps, then take the chunk over; all heaps of an allocator are therefore destroyed together once every thread is
+ * done with them, and before the allocator itself.
+ *
+ * Objects of this class are not thread safe.
+ */
+class BenchHeap {
+public:
+  /**
+   * @brief Destroy this BenchHeap object.
+   */
+  virtual ~BenchHeap() noexcept = default;
+
+  /**
+   * @brief Allocates a new memory chunk aligned to at least 8 bytes.
+   *
+   * @param size the size of the memory chunk. The size must be positive.
+   *
+   * @return pointer to the allocated memory chunk.
+   * @throw std::bad_alloc if the allocation fails.
+   */
+  [[nodiscard]]
+  virtual void* Allocate(size_t size) = 0;
+
+  /**
+   * @brief Releases a memory chunk that was allocated through a heap of the same allocator.
+   *
+   * @param ptr pointer to the memory chunk.
+   * @param size the size passed to Allocate when the chunk was allocated.
+   */
+  virtual void Release(void* ptr, size_t size) noexcept = 0;
+
+  /**
+   * @brief Reclaim the memory of released chunks that the heap does not reuse by itself. Only the chunks allocated
+   * through this heap may be live, and none of them must be used afterwards.
+   *
+   * Arena heaps reset their arenas; the other heaps do nothing.
+   */
+  virtual void Recycle() noexcept { }
+}; // class BenchHeap
+
+/**
+ * @brief An allocator under test.
+ *
+ * Objects of this class are thread safe.
+ */
+class BenchAllocator {
+public:
+  /**
+   * @brief Create an allocator of the specified kind.
+   *
+   * @param kind the allocator kind.
+   *
+   * @return the allocator, or null if the allocator is not available on this system.
+   */
+  [[nodiscard]]
+  static std::unique_ptr<BenchAllocator> Create(BenchAllocatorKind kind);
+
+  /**
+   * @brief Determine whether allocators of the specified kind are available on this system.
+   *
+   * @param kind the allocator kind.
+   *
+   * @return whether the allocators are available. jemalloc and mimalloc are available if their shared libraries can be
+   * loaded; the other allocators are always available.
+   */
+  [[nodiscard]]
+  static bool IsAvailable(BenchAllocatorKind kind) noexcept;
+
+  /**
+   * @brief Destroy this BenchAllocator object.
+   */
+  virtual ~BenchAllocator() noexcept = default;
+
+  /**
+   * @brief Get the kind of this allocator.
+   *
+   * @return the allocator kind.
+   */
+  [[nodiscard]]
+  virtual BenchAllocatorKind GetKind() const noexcept = 0;
+
+  /**
+   * @brief Create a new heap for a thread.
+   *
+   * @return the heap.
+   */
+  [[nodiscard]]
+  virtual std::unique_ptr<BenchHeap> CreateHeap() = 0;
+}; // class BenchAllocator
+
+/**
+ * @brief Get the allocator kinds that are available on this system.
+ *
+ * @return the available allocator kinds, in the order of their declaration.
+ */
+[[nodiscard]]
+std::vector<BenchAllocatorKind> GetAvailableBenchAllocators();
+
+/**
+ * @brief A memory resource that serves fixed-size allocations from a heap, such that object allocators can use the
+ * allocator under test.
+ *
+ * Objects of this class are not thread safe. Objects of this class cannot be copy constructed, move constructed, copy
+ * assigned or move assigned.
+ */
+class BenchHeapResource final : public MemoryResource {
+public:
+  /**
+   * @brief Construct a new BenchHeapResource object.
+   *
+   * @param heap the heap from which memory chunks are allocated.
+   * @param size the size of all memory chunks, which BenchHeap::Release needs as MemoryResource::Release does not
+   * pass it.
+   */
+  explicit BenchHeapResource(BenchHeap& heap, size_t size) noexcept
+    : _heap(&heap),
+      _size(size)
+  { }
+
+  BenchHeapResource(const BenchHeapResource &) = delete;
+  BenchHeapResource(BenchHeapResource &&) noexcept = delete;
+
+  BenchHeapResource& operator=(const BenchHeapResource &) = delete;
+  BenchHeapResource& operator=(BenchHeapResource &&) noexcept = delete;
+
+  /**
+   * @brief Allocates a new memory chunk.
+   *
+   * @param size the size of the memory chunk, which must be the size given at construction time.
+   * @param alignment the alignment of the memory chunk, which must be at most 8.
+   *
+   * @return pointer to the allocated memory chunk.
+   * @throw std::bad_alloc if the allocation fails.
+   */
+  void* Allocate(size_t size, size_t alignment = DefaultAlignment) override {
+    assert(size == _size && "size should be the size of the resource");
+    assert(alignment <= DefaultAlignment && "alignment should be at most the default alignment");
+    static_cast<void>(size);
+    static_cast<void>(alignment);
+    return _heap->Allocate(_size);
+  }
+
+  /**
+   * @brief Releases a memory chunk allocated by this resource.
+   *
+   * @param ptr pointer to the memory chunk, or null.
+   */
+  void Release(void* ptr) noexcept override {
+    if (ptr) {
+      _heap->Release(ptr, _size);
+    }
+  }
+
+private:
+  BenchHeap* _heap;
+  size_t _size;
+}; // class BenchHeapResource
+
+} // namespace kv
+
+#endif // KV_BENCH_BENCH_ALLOCATORS_H
@@ -0,0 +1,155 @@
+#ifndef KV_BENCH_BENCH_BUFFER_H
+#define KV_BENCH_BENCH_BUFFER_H
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "kv/Support/BackingStore.h"
+#include "kv/Support/Memory.h"
+
+namespace kv {
+
+/**
+ * @brief Policies of the memory that backs benchmark buffers.
+ */
+enum class MemoryPolicy {
+  /**
+   * @brief Obtain memory blocks from `malloc`.
+   */
+  Malloc,
+
+  /**
+   * @brief Map memory blocks with regular pages.
+   */
+  Mmap,
+
+  /**
+   * @brief Map memory blocks backed by transparent huge pages.
+   */
+  TransparentHugePages,
+
+  /**
+   * @brief Map memory blocks backed by 2 MiB pages from the hugetlbfs pool.
+   */
+  HugePages2M,
+
+  /**
+   * @brief Map memory blocks backed by 1 GiB pages from the hugetlbfs pool.
+   */
+  HugePages1G,
+};
+
+/**
+ * @brief Get the name of the specified memory policy, as accepted by ParseMemoryPolicy.
+ *
+ * @param policy the memory policy.
+ *
+ * @return the name of the memory policy.
+ */
+[[nodiscard]]
+const char* GetMemoryPolicyName(MemoryPolicy policy) noexcept;
+
+/**
+ * @brief Parse the name of a memory policy.
+ *
+ * @param name the name, which is one of `malloc`, `mmap`, `thp`, `huge-2m` and `huge-1g`.
+ *
+ * @return the memory policy, or empty if the name is unknown.
+ */
+[[nodiscard]]
+std::optional<MemoryPolicy> ParseMemoryPolicy(std::string_view name) noexcept;
+
+/**
+ * @brief Options of a BenchBuffer.
+ */
+struct BenchBufferOptions {
+  /**
+   * @brief The policy of the memory that backs the buffer.
+   */
+  MemoryPolicy policy = MemoryPolicy::Mmap;
+
+  /**
+   * @brief The NUMA node that the buffer is bound to, or empty if it is placed by the default policy of the system.
+   */
+  std::optional<size_t> numaNode;
+}; // struct BenchBufferOptions
+
+/**
+ * @brief A memory buffer that benchmark kernels operate on.
+ *
+ * Each buffer owns a RawAllocator configured by the buffer options, so the page size and the NUMA placement of the
+ * memory are parameters of a benchmark run. Every page of the buffer is touched on construction, so page faults do not
+ * show up in measurements.
+ *
+ * Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned.
+ */
+class BenchBuffer {
+public:
+  /**
+   * @brief The alignment of buffers.
+   */
+  constexpr static const size_t Alignment = 4096;
+
+  /**
+   * @brief Construct a new BenchBuffer object.
+   *
+   * @param size the size of the buffer in bytes. The size must be positive.
+   * @param options the options of the buffer.
+   * @throw std::bad_alloc if the allocation fails.
+   */
+  explicit BenchBuffer(size_t size, const BenchBufferOptions& options = BenchBufferOptions());
+
+  BenchBuffer(const BenchBuffer &) = delete;
+  BenchBuffer(BenchBuffer &&) noexcept = delete;
+
+  /**
+   * @brief Destroy this BenchBuffer object.
+   */
+  ~BenchBuffer() noexcept;
+
+  BenchBuffer& operator=(const BenchBuffer &) = delete;
+  BenchBuffer& operator=(BenchBuffer &&) noexcept = delete;
+
+  /**
+   * @brief Get the memory of the buffer.
+   *
+   * @return pointer to the memory, which is aligned to Alignment.
+   */
+  [[nodiscard]]
+  void* GetData() const noexcept {
+    return _data;
+  }
+
+  /**
+   * @brief Get the size of the buffer.
+   *
+   * @return the size of the buffer in bytes.
+   */
+  [[nodiscard]]
+  size_t GetSize() const noexcept {
+    return _size;
+  }
+
+  /**
+   * @brief Get the options of the buffer.
+   *
+   * @return the options of the buffer.
+   */
+  [[nodiscard]]
+  const BenchBufferOptions& GetOptions() const noexcept {
+    return _options;
+  }
+
+private:
+  BenchBufferOptions _options;
+  std::unique_ptr<MmapBackingStore> _store;
+  RawAllocator _allocator;
+  void* _data;
+  size_t _size;
+}; // class BenchBuffer
+
+} // namespace kv
+
+#endif // KV_BENCH_BENCH_BUFFER_H
@@ -0,0 +1,283 @@
+#ifndef KV_BENCH_BENCH_COUNTERS_H
+#define KV_BENCH_BENCH_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace kv {
+
+/**
+ * @brief Hardware performance counters collected by PerfCounterGroup.
+ */
+enum class PerfCounter {
+  /**
+   * @brief CPU cycles.
+   */
+  Cycles,
+
+  /**
+   * @brief Retired instructions.
+   */
+  Instructions,
+
+  /**
+   * @brief Loads that miss the L1 data cache.
+   */
+  L1Misses,
+
+  /**
+   * @brief Loads that miss the last level cache.
+   */
+  LlcMisses,
+
+  /**
+   * @brief Loads that miss the data TLB.
+   */
+  DtlbMisses,
+
+  /**
+   * @brief Cycles in which the backend of the CPU is stalled, mostly on memory.
+   */
+  StallCycles,
+};
+
+/**
+ * @brief The number of counters in PerfCounter.
+ */
+constexpr static const size_t PerfCounterCount = static_cast<size_t>(PerfCounter::StallCycles) + 1;
+
+/**
+ * @brief Get the name of the specified counter.
+ *
+ * @param counter the counter.
+ *
+ * @return the name, such as `cycles` or `llc-misses`.
+ */
+[[nodiscard]]
+const char* GetPerfCounterName(PerfCounter counter) noexcept;
+
+/**
+ * @brief Values of the counters of a PerfCounterGroup, each of which may be unavailable.
+ */
+class PerfCounterValues {
+public:
+  /**
+   * @brief Construct a new PerfCounterValues object in which all counters are unavailable.
+   */
+  PerfCounterValues() noexcept
+    : _values(),
+      _available()
+  { }
+
+  /**
+   * @brief Determine whether any counter is available.
+   *
+   * @return whether any counter is available.
+   */
+  [[nodiscard]]
+  bool IsAnyAvailable() const noexcept;
+
+  /**
+   * @brief Get the value of the specified counter.
+   *
+   * @param counter the counter.
+   *
+   * @return the value, or empty if the counter is unavailable.
+   */
+  [[nodiscard]]
+  std::optional<uint64_t> Get(PerfCounter counter) const noexcept {
+    auto index = static_cast<size_t>(counter);
+    if (!_available[index]) {
+      return std::nullopt;
+    }
+    return _values[index];
+  }
+
+  /**
+   * @brief Get the value of the specified counter divided by the specified count.
+   *
+   * @param counter the counter.
+   * @param count the count, such as the number of memory accesses that the counter values were collected over.
+   *
+   * @return the value per count, or empty if the counter is unavailable or the count is 0.
+   */
+  [[nodiscard]]
+  std::optional<double> GetPer(PerfCounter counter, uint64_t count) const noexcept;
+
+  /**
+   * @brief Get the number of instructions per cycle.
+   *
+   * @return the instructions per cycle, or empty if either counter is unavailable or no cycle was counted.
+   */
+  [[nodiscard]]
+  std::optional<double> GetInstructionsPerCycle() const noexcept;
+
+  /**
+   * @brief Set the value of the specified counter and mark it available.
+   *
+   * @param counter the counter.
+   * @param value the value.
+   */
+  void Set(PerfCounter counter, uint64_t value) noexcept {
+    auto index = static_cast<size_t>(counter);
+    _values[index] = value;
+    _available[index] = true;
+  }
+
+  /**
+   * @brief Add the values of the specified object. Counters that are available in the specified object become
+   * available in this object.
+   *
+   * @param other the values to be added.
+   *
+   * @return this object.
+   */
+  PerfCounterValues& operator+=(const PerfCounterValues& other) noexcept;
+
+private:
+  std::array<uint64_t, PerfCounterCount> _values;
+  std::array<bool, PerfCounterCount> _available;
+}; // class PerfCounterValues
+
+/**
+ * @brief Hardware performance counters of the calling thread, collected through perf_event_open.
+ *
+ * Each counter is opened on its own rather than as an event group, so that counters the PMU cannot schedule at the same
+ * time are multiplexed and scaled instead of failing together. Counters count user space only, which perf_event_open
+ * permits at the default perf_event_paranoid level. Counters that cannot be opened, for example because the kernel does
+ * not expose a PMU to a virtual machine or forbids perf events altogether, are unavailable, and a group without any
+ * available counter reads as all unavailable.
+ *
+ * The counters follow the thread that opened the group, so the group must be opened by the thread to be measured.
+ *
+ * Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned.
+ */
+class PerfCounterGroup {
+public:
+  /**
+   * @brief Open the counters of the calling thread. The counters start counting immediately.
+   */
+  PerfCounterGroup() noexcept;
+
+  PerfCounterGroup(const PerfCounterGroup &) = delete;
+  PerfCounterGroup(PerfCounterGroup &&) noexcept = delete;
+
+  /**
+   * @brief Destroy this object and close the counters.
+   */
+  ~PerfCounterGroup();
+
+  PerfCounterGroup& operator=(const PerfCounterGroup &) = delete;
+  PerfCounterGroup& operator=(PerfCounterGroup &&) noexcept = delete;
+
+  /**
+   * @brief Determine whether the specified counter is available.
+   *
+   * @param counter the counter.
+   *
+   * @return whether the counter could be opened.
+   */
+  [[nodiscard]]
+  bool IsAvailable(PerfCounter counter) const noexcept {
+    return _fds[static_cast<size_t>(counter)] >= 0;
+  }
+
+  /**
+   * @brief Determine whether any counter is available.
+   *
+   * @return whether any counter could be opened.
+   */
+  [[nodiscard]]
+  bool IsAnyAvailable() const noexcept;
+
+  /**
+   * @brief A raw reading of all counters, whose differences PerfCounterGroup turns into counter values.
+   */
+  struct Reading {
+    std::array<uint64_t, PerfCounterCount> values;       // The raw counts
+    std::array<uint64_t, PerfCounterCount> enabled;      // The time during which each counter was enabled
+    std::array<uint64_t, PerfCounterCount> running;      // The time during which each counter was scheduled on the PMU
+  }; // struct Reading
+
+  /**
+   * @brief Read all counters.
+   *
+   * @return the reading.
+   */
+  [[nodiscard]]
+  Reading Read() const noexcept;
+
+  /**
+   * @brief Get the counter values between two readings, scaled up for the time each counter was not scheduled.
+   *
+   * @param start the earlier reading.
+   * @param end the later reading.
+   *
+   * @return the values. Counters that are unavailable or were never scheduled between the readings are unavailable.
+   */
+  [[nodiscard]]
+  PerfCounterValues GetValues(const Reading& start, const Reading& end) const noexcept;
+
+private:
+  std::array<int, PerfCounterCount> _fds;
+}; // class PerfCounterGroup
+
+/**
+ * @brief Wrapper objects that collect the counter values of a code region, from the construction to the destruction of
+ * the object, and add them to a PerfCounterValues object.
+ *
+ * Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned.
+ */
+class PerfCounterScope {
+public:
+  /**
+   * @brief Construct a new PerfCounterScope object and start collecting.
+   *
+   * @param group the counters, which must have been opened by the calling thread.
+   * @param values the values that the counter values of the region will be added to during the destruction of this
+   * object.
+   */
+  explicit PerfCounterScope(const PerfCounterGroup& group, PerfCounterValues& values) noexcept
+    : PerfCounterScope(&group, values)
+  { }
+
+  /**
+   * @brief Construct a new PerfCounterScope object and start collecting if there are counters.
+   *
+   * @param group the counters, which must have been opened by the calling thread, or null to collect nothing.
+   * @param values the values that the counter values of the region will be added to during the destruction of this
+   * object.
+   */
+  explicit PerfCounterScope(const PerfCounterGroup* group, PerfCounterValues& values) noexcept
+    : _group(group),
+      _values(values),
+      _start(group ? group->Read() : PerfCounterGroup::Reading { })
+  { }
+
+  PerfCounterScope(const PerfCounterScope &) = delete;
+  PerfCounterScope(PerfCounterScope &&) noexcept = delete;
+
+  /**
+   * @brief Destroy this object, adding the counter values since its construction.
+   */
+  ~PerfCounterScope() {
+    if (_group) {
+      _values += _group->GetValues(_start, _group->Read());
+    }
+  }
+
+  PerfCounterScope& operator=(const PerfCounterScope &) = delete;
+  PerfCounterScope& operator=(PerfCounterScope &&) noexcept = delete;
+
+private:
+  const PerfCounterGroup* _group = nullptr;
+  PerfCounterValues& _values;
+  PerfCounterGroup::Reading _start;
+}; // class PerfCounterScope
+
+} // namespace kv
+
+#endif // KV_BENCH_BENCH_COUNTERS_H
@@ -0,0 +1,175 @@
+#ifndef KV_BENCH_BENCH_KERNELS_H
+#define KV_BENCH_BENCH_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace kv {
+
+/**
+ * @brief Kinds of memory accesses of bandwidth kernels.
+ */
+enum class AccessKind {
+  /**
+   * @brief Load from the source buffer.
+   */
+  Read,
+
+  /**
+   * @brief Store to the destination buffer.
+   */
+  Write,
+
+  /**
+   * @brief Load from the source buffer and store to the destination buffer.
+   */
+  Copy,
+};
+
+/**
+ * @brief Get the name of the specified access kind, as accepted by ParseAccessKind.
+ *
+ * @param kind the access kind.
+ *
+ * @return the name of the access kind.
+ */
+[[nodiscard]]
+const char* GetAccessKindName(AccessKind kind) noexcept;
+
+/**
+ * @brief Parse the name of an access kind.
+ *
+ * @param name the name, which is one of `read`, `write` and `copy`.
+ *
+ * @return the access kind, or empty if the name is unknown.
+ */
+[[nodiscard]]
+std::optional<AccessKind> ParseAccessKind(std::string_view name) noexcept;
+
+/**
+ * @brief Instruction variants of bandwidth kernels.
+ */
+enum class KernelVariant {
+  /**
+   * @brief Access 8 bytes at a time with general purpose registers.
+   */
+  Scalar,
+
+  /**
+   * @brief Access a vector register at a time, using the widest SIMD instruction set the CPU supports.
+   */
+  Simd,
+};
+
+/**
+ * @brief Get the name of the specified kernel variant, as accepted by ParseKernelVariant.
+ *
+ * @param variant the kernel variant.
+ *
+ * @return the name of the kernel variant.
+ */
+[[nodiscard]]
+const char* GetKernelVariantName(KernelVariant variant) noexcept;
+
+/**
+ * @brief Parse the name of a kernel variant.
+ *
+ * @param name the name, which is either `scalar` or `simd`.
+ *
+ * @return the kernel variant, or empty if the name is unknown.
+ */
+[[nodiscard]]
+std::optional<KernelVariant> ParseKernelVariant(std::string_view name) noexcept;
+
+/**
+ * @brief Get the name of the SIMD instruction set that the Simd kernel variant uses on this CPU.
+ *
+ * @return the name of the instruction set, such as `avx512`, `avx2`, `sse2` or `neon`, or `none` if the Simd variant
+ * falls back to scalar accesses.
+ */
+[[nodiscard]]
+const char* GetSimdInstructionSet() noexcept;
+
+/**
+ * @brief Get the number of bytes that a single access of the specified kernel variant covers on this CPU.
+ *
+ * Strides of bandwidth kernels must be multiples of the access width.
+ *
+ * @param variant the kernel variant.
+ *
+ * @return the access width in bytes.
+ */
+[[nodiscard]]
+size_t GetAccessWidth(KernelVariant variant) noexcept;
+
+/**
+ * @brief Link the slots of the specified buffer into a cyclic list in random order, for chasing with ChasePointers.
+ *
+ * The buffer is divided into slots of the specified stride, and the first pointer-sized word of every slot points to
+ * the next slot of a single cycle that visits all slots. Since the order is random, hardware prefetchers cannot
+ * predict the next slot and every step of a chase pays the full latency of the memory level that the buffer fits in.
+ *
+ * @param buffer the buffer, which must be aligned to the size of a pointer.
+ * @param size the size of the buffer in bytes. The size must be at least the stride.
+ * @param stride the distance between slots. The stride must be a positive multiple of the size of a pointer.
+ * @param seed the seed of the random order.
+ *
+ * @return pointer to the first slot, which is where chasing starts.
+ * @throw std::invalid_argument if the stride is not a positive multiple of the size of a pointer, or the size is less
+ * than the stride.
+ */
+void* BuildChaseList(void* buffer, size_t size, size_t stride, uint64_t seed);
+
+/**
+ * @brief Follow the pointers of a list built by BuildChaseList for the specified number of steps.
+ *
+ * Every load depends on the previous one, so the time per step is the load-to-use latency of the memory.
+ *
+ * @param start the slot to start from.
+ * @param steps the number of steps.
+ *
+ * @return the slot reached after the last step, which is where the next chase should continue.
+ */
+[[nodiscard]]
+const void* ChasePointers(const void* start, size_t steps) noexcept;
+
+/**
+ * @brief Read one access width of the specified buffer at every stride.
+ *
+ * @param variant the kernel variant.
+ * @param buffer the buffer, which must be aligned to the access width.
+ * @param size the size of the buffer in bytes. Trailing bytes that do not fill a whole stride are not accessed.
+ * @param stride the distance between accesses, which must be a positive multiple of the access width.
+ *
+ * @return a value that depends on all loaded data, which keeps the loads from being optimized away.
+ */
+[[nodiscard]]
+uint64_t ReadMemory(KernelVariant variant, const void* buffer, size_t size, size_t stride) noexcept;
+
+/**
+ * @brief Fill one access width of the specified buffer at every stride with the specified 64-bit value.
+ *
+ * @param variant the kernel variant.
+ * @param buffer the buffer, which must be aligned to the access width.
+ * @param size the size of the buffer in bytes. Trailing bytes that do not fill a whole stride are not accessed.
+ * @param stride the distance between accesses, which must be a positive multiple of the access width.
+ * @param value the value stored in every 8 bytes written.
+ */
+void WriteMemory(KernelVariant variant, void* buffer, size_t size, size_t stride, uint64_t value) noexcept;
+
+/**
+ * @brief Copy one access width at every stride from the source buffer to the same offset in the destination buffer.
+ *
+ * @param variant the kernel variant.
+ * @param dst the destination buffer, which must be aligned to the access width.
+ * @param src the source buffer, which must be aligned to the access width and must not overlap the destination.
+ * @param size the size of both buffers in bytes. Trailing bytes that do not fill a whole stride are not accessed.
+ * @param stride the distance between accesses, which must be a positive multiple of the access width.
+ */
+void CopyMemory(KernelVariant variant, void* dst, const void* src, size_t size, size_t stride) noexcept;
+
+} // namespace kv
+
+#endif // KV_BENCH_BENCH_KERNELS_H
@@ -0,0 +1,242 @@
+#ifndef KV_BENCH_BENCH_REPORT_H
+#define KV_BENCH_BENCH_REPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "kv/Bench/BenchCounters.h"
+#include "kv/Json/JsonObject.h"
+
+namespace kv {
+
+/**
+ * @brief Summary statistics of the samples of a result.
+ */
+struct SampleStatistics {
+  size_t count = 0;                     // The number of samples
+  double min = 0;
+  double max = 0;
+  double mean = 0;
+  double median = 0;
+  double p99 = 0;                       // The 99th percentile, interpolated linearly between the closest ranks
+  double stddev = 0;                    // The sample standard deviation, or 0 for fewer than 2 samples
+}; // struct SampleStatistics
+
+/**
+ * @brief Compute the summary statistics of the specified samples.
+ *
+ * @param samples the samples.
+ *
+ * @return the statistics, which are all 0 if there is no sample.
+ */
+[[nodiscard]]
+SampleStatistics ComputeStatistics(std::vector<double> samples);
+
+/**
+ * @brief Directions in which the metric of a result improves.
+ */
+enum class MetricDirection {
+  /**
+   * @brief Lower values are better, as for latencies.
+   */
+  LowerIsBetter,
+
+  /**
+   * @brief Higher values are better, as for bandwidths.
+   */
+  HigherIsBetter,
+};
+
+/**
+ * @brief Describe the machine that runs the benchmarks: the CPU model, the caches of the first CPU, and the NUMA nodes
+ * with their CPUs and distances.
+ *
+ * Information that the system does not expose is left out.
+ *
+ * @return a map describing the machine.
+ */
+[[nodiscard]]
+JsonObject DescribeMachine();
+
+/**
+ * @brief Describe the specified counter values.
+ *
+ * @param counters the counter values.
+ * @param accesses the number of memory accesses the counters were collected over.
+ *
+ * @return a map from the names of the available counters to maps holding the total and the value per access.
+ */
+[[nodiscard]]
+JsonObject DescribeCounters(const PerfCounterValues& counters, uint64_t accesses);
+
+/**
+ * @brief A machine-readable report of a benchmark run.
+ *
+ * The report is a JSON map with the schema name and version, the mode, the machine description, the run parameters,
+ * and an array of results. Every result has a name that identifies it within the mode, a metric with its direction,
+ * the samples of the metric and their statistics, and any further fields the mode adds.
+ *
+ * Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned.
+ */
+class BenchReport {
+public:
+  /**
+   * @brief The schema name of reports.
+   */
+  constexpr static const char* Schema = "mab-results";
+
+  /**
+   * @brief The schema version of reports.
+   */
+  constexpr static const uint64_t Version = 1;
+
+  /**
+   * @brief Construct a new BenchReport object with the description of this machine and no results.
+   *
+   * @param mode the benchmark mode.
+   */
+  explicit BenchReport(std::string mode);
+
+  BenchReport(const BenchReport &) = delete;
+  BenchReport(BenchReport &&) noexcept = delete;
+
+  BenchReport& operator=(const BenchReport &) = delete;
+  BenchReport& operator=(BenchReport &&) noexcept = delete;
+
+  /**
+   * @brief Get the parameters of the run.
+   *
+   * @return the parameter map, to which the caller adds the parameters.
+   */
+  [[nodiscard]]
+  JsonFlatMap& GetParameters() noexcept {
+    return _parameters->GetFlatMap();
+  }
+
+  /**
+   * @brief Add a result.
+   *
+   * @param name the name of the result, which identifies it within the mode.
+   * @param metric the name of the metric, such as `ns/access`.
+   * @param direction the direction in which the metric improves.
+   * @param samples the samples of the metric.
+   *
+   * @return the map of the result, to which the caller can add further fields.
+   */
+  JsonFlatMap& AddResult(std::string name, std::string metric, MetricDirection direction,
+                         const std::vector<double>& samples);
+
+  /**
+   * @brief Get the root of the report.
+   *
+   * @return the root map.
+   */
+  [[nodiscard]]
+  const JsonObject& GetRoot() const noexcept {
+    return _root;
+  }
+
+  /**
+   * @brief Write the report as JSON to the specified file, which is created or truncated.
+   *
+   * @param path the path of the file.
+   * @throw std::system_error if the file cannot be written.
+   */
+  void WriteFile(const char* path) const;
+
+private:
+  JsonObject _root;
+  JsonObject* _parameters;
+  JsonObject* _results;
+}; // class BenchReport
+
+/**
+ * @brief Load a report written by BenchReport::WriteFile.
+ *
+ * @param path the path of the file.
+ *
+ * @return the root of the report.
+ * @throw std::system_error if the file cannot be read.
+ * @throw JsonParseException if the file is not valid JSON.
+ * @throw JsonException if the file is not a report of a supported version.
+ */
+[[nodiscard]]
+JsonObject LoadReport(const char* path);
+
+/**
+ * @brief Options of CompareReports.
+ */
+struct ComparisonOptions {
+  double threshold = 0.05;              // The relative change of the median below which changes are ignored
+  double alpha = 0.05;                  // The significance level of the Welch t-test on the samples
+}; // struct ComparisonOptions
+
+/**
+ * @brief Verdicts of the comparison of a result.
+ */
+enum class ComparisonVerdict {
+  /**
+   * @brief The change is not significant or below the threshold.
+   */
+  Unchanged,
+
+  /**
+   * @brief The metric got significantly better.
+   */
+  Improvement,
+
+  /**
+   * @brief The metric got significantly worse.
+   */
+  Regression,
+};
+
+/**
+ * @brief The comparison of a result present in both reports.
+ */
+struct Comparison {
+  std::string name;
+  std::string metric;
+  MetricDirection direction = MetricDirection::LowerIsBetter;
+  SampleStatistics baseline;
+  SampleStatistics current;
+  double change = 0;                    // The relative change of the median, positive if the metric increased
+  double pValue = 1;                    // The two-sided p-value of the Welch t-test, or 1 for fewer than 2 samples
+  ComparisonVerdict verdict = ComparisonVerdict::Unchanged;
+}; // struct Comparison
+
+/**
+ * @brief Compare the results of two reports of the same mode.
+ *
+ * A result is compared if both reports have a result of the same name and metric. A change is flagged if its p-value
+ * is below the significance level and the relative change of the median is at least the threshold.
+ *
+ * @param baseline the baseline report.
+ * @param current the current report.
+ * @param options the options of the comparison.
+ *
+ * @return the comparisons, in the order of the results of the current report.
+ * @throw JsonException if a report is malformed or the modes differ.
+ */
+[[nodiscard]]
+std::vector<Comparison> CompareReports(const JsonObject& baseline, const JsonObject& current,
+                                       const ComparisonOptions& options = ComparisonOptions());
+
+/**
+ * @brief Compute the two-sided p-value of the Welch t-test for a difference between the means of two samples.
+ *
+ * @param lhs the first samples.
+ * @param rhs the second samples.
+ *
+ * @return the p-value, or 1 if either of the samples has fewer than 2 elements.
+ */
+[[nodiscard]]
+double ComputeWelchPValue(const SampleStatistics& lhs, const SampleStatistics& rhs) noexcept;
+
+} // namespace kv
+
+#endif // KV_BENCH_BENCH_REPORT_H
@@ -0,0 +1,393 @@
+#ifndef KV_BENCH_BENCH_RUNNER_H
+#define KV_BENCH_BENCH_RUNNER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "kv/Bench/BenchBuffer.h"
+#include "kv/Bench/BenchCounters.h"
+#include "kv/Bench/BenchKernels.h"
+
+namespace kv {
+
+/**
+ * @brief Prevent the compiler from optimizing away the computation of the specified value.
+ *
+ * @param value the value.
+ */
+template <typename T>
+inline void DoNotOptimize(const T& value) noexcept {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Options of Measure.
+ */
+struct MeasureOptions {
+  /**
+   * @brief The minimal duration of a sample. Each sample repeats the measured function until it takes this long.
+   */
+  std::chrono::nanoseconds minSampleTime = std::chrono::milliseconds { 10 };
+
+  /**
+   * @brief The number of samples.
+   */
+  size_t sampleCount = 5;
+
+  /**
+   * @brief The largest number of calls per sample. Calibration stops here even if a sample is shorter than the minimal
+   * sample time, so that functions that take next to no time cannot make it run forever.
+   */
+  size_t maxIterations = static_cast<size_t>(1) << 32;
+
+  /**
+   * @brief Whether to collect the hardware performance counters of the calling thread over the samples.
+   */
+  bool collectCounters = false;
+}; // struct MeasureOptions
+
+/**
+ * @brief The samples taken by Measure.
+ */
+struct Measurement {
+  size_t iterations = 0;                // The number of calls of the measured function per sample
+  std::vector<double> samples;          // The duration of a single call in seconds, one per sample
+  PerfCounterValues counters;           // The counter values over all samples, if collected
+
+  /**
+   * @brief Get the number of calls of the measured function over all samples.
+   *
+   * @return the number of calls.
+   */
+  [[nodiscard]]
+  uint64_t GetSampledCalls() const noexcept {
+    return static_cast<uint64_t>(iterations) * samples.size();
+  }
+
+  /**
+   * @brief Get the median of the samples.
+   *
+   * @return the median duration of a single call in seconds, or 0 if there is no sample.
+   */
+  [[nodiscard]]
+  double GetMedian() const;
+}; // struct Measurement
+
+/**
+ * @brief Measure the duration of calls to the specified function.
+ *
+ * The number of calls per sample is first calibrated so that a sample takes at least the minimal sample time. The
+ * calibration doubles as a warm-up, which brings the working set of the function into the caches it fits in. Counters
+ * are collected over the samples only, so they do not include the warm-up. Every call is followed by a compiler
+ * barrier, so calls whose effects the compiler could otherwise merge or hoist are made one by one.
+ *
+ * @param fn the function to be measured.
+ * @param options the options of the measurement.
+ *
+ * @return the samples.
+ */
+template <typename Fn>
+Measurement Measure(Fn&& fn, const MeasureOptions& options) {
+  using Clock = std::chrono::steady_clock;
+
+  auto run = [&fn](size_t iterations) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      fn();
+      DoNotOptimize(fn);
+    }
+    return Clock::now() - start;
+  };
+
+  auto maxIterations = std::max(options.maxIterations, static_cast<size_t>(1));
+  Measurement measurement;
+  measurement.iterations = 1;
+  while (run(measurement.iterations) < options.minSampleTime && measurement.iterations < maxIterations) {
+    measurement.iterations = measurement.iterations > maxIterations / 2 ? maxIterations : measurement.iterations * 2;
+  }
+
+  std::optional<PerfCounterGroup> group;
+  if (options.collectCounters) {
+    group.emplace();
+  }
+
+  measurement.samples.reserve(options.sampleCount);
+  {
+    PerfCounterScope scope { group ? &*group : nullptr, measurement.counters };
+    for (size_t i = 0; i < options.sampleCount; ++i) {
+      std::chrono::duration<double> elapsed = run(measurement.iterations);
+      measurement.samples.push_back(elapsed.count() / static_cast<double>(measurement.iterations));
+    }
+  }
+  return measurement;
+}
+
+/**
+ * @brief The result of a benchmark on a single working set size.
+ */
+struct BenchResult {
+  size_t workingSetSize = 0;            // The total size of the buffers accessed by the kernel
+  size_t accesses = 0;                  // The number of memory accesses of a single call of the kernel
+  size_t bytes = 0;                     // The number of bytes loaded and stored by a single call of the kernel
+  Measurement measurement;
+
+  /**
+   * @brief Get the median time per memory access.
+   *
+   * @return the time per access in nanoseconds.
+   */
+  [[nodiscard]]
+  double GetNanosecondsPerAccess() const {
+    return measurement.GetMedian() * 1e9 / static_cast<double>(accesses);
+  }
+
+  /**
+   * @brief Get the median bandwidth.
+   *
+   * @return the bandwidth in GB/s, where a GB is 10^9 bytes.
+   */
+  [[nodiscard]]
+  double GetGigabytesPerSecond() const {
+    return static_cast<double>(bytes) / measurement.GetMedian() / 1e9;
+  }
+
+  /**
+   * @brief Get the mean value of the specified counter per memory access.
+   *
+   * @param counter the counter.
+   *
+   * @return the value per access, or empty if the counter was not collected or is unavailable.
+   */
+  [[nodiscard]]
+  std::optional<double> GetCounterPerAccess(PerfCounter counter) const noexcept {
+    return measurement.counters.GetPer(counter, measurement.GetSampledCalls() * accesses);
+  }
+}; // struct BenchResult
+
+/**
+ * @brief Options of RunLatencyBench.
+ */
+struct LatencyBenchOptions {
+  size_t stride = 64;                   // The distance between list slots, which defaults to a cache line
+  size_t steps = 1 << 16;               // The number of chase steps per call of the kernel
+  uint64_t seed = 1;                    // The seed of the random list order
+  BenchBufferOptions buffer;
+  MeasureOptions measure;
+}; // struct LatencyBenchOptions
+
+/**
+ * @brief A pointer chase through a list of its own, which is the kernel of latency benchmarks.
+ *
+ * Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned.
+ */
+class ChaseKernel {
+public:
+  /**
+   * @brief Construct a new ChaseKernel object.
+   *
+   * @param workingSetSize the size of the list, which must be at least the stride.
+   * @param options the options of the benchmark.
+   * @throw std::invalid_argument if the stride is not a positive multiple of the pointer size, or the working set is
+   * smaller than the stride.
+   * @throw std::bad_alloc if the buffer cannot be allocated.
+   */
+  explicit ChaseKernel(size_t workingSetSize, const LatencyBenchOptions& options);
+
+  ChaseKernel(const ChaseKernel &) = delete;
+  ChaseKernel(ChaseKernel &&) noexcept = delete;
+
+  ChaseKernel& operator=(const ChaseKernel &) = delete;
+  ChaseKernel& operator=(ChaseKernel &&) noexcept = delete;
+
+  /**
+   * @brief Chase the configured number of steps, continuing where the previous run stopped.
+   */
+  void Run() noexcept {
+    _current = ChasePointers(_current, _steps);
+    DoNotOptimize(_current);
+  }
+
+  /**
+   * @brief Get the number of memory accesses of a run.
+   *
+   * @return the number of chase steps of a run.
+   */
+  [[nodiscard]]
+  size_t GetAccesses() const noexcept {
+    return _steps;
+  }
+
+  /**
+   * @brief Get the number of bytes loaded by a run.
+   *
+   * @return the number of bytes.
+   */
+  [[nodiscard]]
+  size_t GetBytes() const noexcept {
+    return _steps * sizeof(void *);
+  }
+
+private:
+  BenchBuffer _buffer;
+  const void* _current;
+  size_t _steps;
+}; // class ChaseKernel
+
+/**
+ * @brief Measure the latency of dependent loads by chasing pointers through a working set of the specified size.
+ *
+ * @param workingSetSize the size of the working set, which must be at least the stride.
+ * @param options the options of the benchmark.
+ *
+ * @return the result, whose accesses are the chase steps of a call.
+ * @throw std::invalid_argument if the stride is not a positive multiple of the pointer size, or the working set is
+ * smaller than the stride.
+ * @throw std::bad_alloc if the buffer cannot be allocated.
+ */
+[[nodiscard]]
+BenchResult RunLatencyBench(size_t workingSetSize, const LatencyBenchOptions& options);
+
+/**
+ * @brief Options of RunBandwidthBench.
+ */
+struct BandwidthBenchOptions {
+  AccessKind kind = AccessKind::Read;
+  KernelVariant variant = KernelVariant::Simd;
+  size_t stride = 0;                    // The distance between accesses, or 0 for sequential accesses
+  BenchBufferOptions buffer;
+  MeasureOptions measure;
+}; // struct BandwidthBenchOptions
+
+/**
+ * @brief Get the smallest working set on which the specified bandwidth kernel makes at least one access.
+ *
+ * @param options the options of the kernel.
+ *
+ * @return the stride, or twice the stride for copy kernels, whose working set holds a source and a destination.
+ */
+[[nodiscard]]
+size_t GetMinBandwidthWorkingSetSize(const BandwidthBenchOptions& options) noexcept;
+
+/**
+ * @brief A bandwidth kernel bound to buffers of its own.
+ *
+ * Copy kernels split the working set into a source and a destination buffer of half the size each.
+ *
+ * Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned.
+ */
+class BandwidthKernel {
+public:
+  /**
+   * @brief Construct a new BandwidthKernel object.
+   *
+   * @param workingSetSize the size of the working set, which must be at least the stride, or twice the stride for copy
+   * kernels.
+   * @param options the options of the benchmark.
+   * @throw std::invalid_argument if the stride is not a multiple of the access width, or the working set is smaller than
+   * GetMinBandwidthWorkingSetSize.
+   * @throw std::bad_alloc if the buffers cannot be allocated.
+   */
+  explicit BandwidthKernel(size_t workingSetSize, const BandwidthBenchOptions& options);
+
+  BandwidthKernel(const BandwidthKernel &) = delete;
+  BandwidthKernel(BandwidthKernel &&) noexcept = delete;
+
+  BandwidthKernel& operator=(const BandwidthKernel &) = delete;
+  BandwidthKernel& operator=(BandwidthKernel &&) noexcept = delete;
+
+  /**
+   * @brief Access the whole working set once.
+   */
+  void Run() noexcept;
+
+  /**
+   * @brief Get the number of memory accesses of a run.
+   *
+   * @return the number of accesses, where a copy of one access width counts as one access.
+   */
+  [[nodiscard]]
+  size_t GetAccesses() const noexcept {
+    return _accesses;
+  }
+
+  /**
+   * @brief Get the number of bytes loaded and stored by a run.
+   *
+   * @return the number of bytes.
+   */
+  [[nodiscard]]
+  size_t GetBytes() const noexcept {
+    return _bytes;
+  }
+
+private:
+  AccessKind _kind;
+  KernelVariant _variant;
+  size_t _stride;
+  BenchBuffer _src;
+  std::optional<BenchBuffer> _dst;
+  uint64_t _value;
+  size_t _accesses;
+  size_t _bytes;
+}; // class BandwidthKernel
+
+/**
+ * @brief Measure the bandwidth of the specified kernel over a working set of the specified size.
+ *
+ * @param workingSetSize the size of the working set, which must be at least the stride, or twice the stride for copy
+ * kernels.
+ * @param options the options of the benchmark.
+ *
+ * @return the result.
+ * @throw std::invalid_argument if the stride is not a multiple of the access width, or the working set is smaller than
+ * GetMinBandwidthWorkingSetSize.
+ * @throw std::bad_alloc if the buffers cannot be allocated.
+ */
+[[nodiscard]]
+BenchResult RunBandwidthBench(size_t workingSetSize, const BandwidthBenchOptions& options);
+
+/**
+ * @brief Make the working set sizes of a sweep from the specified minimal size to the specified maximal size.
+ *
+ * Sizes grow geometrically, with the specified number of sizes per doubling. Sizes between the minimal and the maximal
+ * size are rounded to multiples of a 64-byte cache line.
+ *
+ * @param minSize the minimal size.
+ * @param maxSize the maximal size, which is always part of the sweep if it is at least the minimal size.
+ * @param stepsPerOctave the number of sizes per doubling, which must be positive.
+ *
+ * @return the sizes in ascending order.
+ */
+[[nodiscard]]
+std::vector<size_t> MakeSizeSweep(size_t minSize, size_t maxSize, size_t stepsPerOctave = 1);
+
+/**
+ * @brief Parse a byte size with an optional binary suffix, such as `4096`, `64K`, `2M` or `4GiB`.
+ *
+ * @param text the text.
+ *
+ * @return the size in bytes, or empty if the text is not a valid size.
+ */
+[[nodiscard]]
+std::optional<size_t> ParseByteSize(std::string_view text) noexcept;
+
+/**
+ * @brief Format a byte size with the largest binary suffix that represents it exactly, such as `64K` or `3M`.
+ *
+ * @param size the size in bytes.
+ *
+ * @return the formatted size, which ParseByteSize accepts.
+ */
+[[nodiscard]]
+std::string FormatByteSize(size_t size);
+
+} // namespace kv
+
+#endif // KV_BENCH_BENCH_RUNNER_H
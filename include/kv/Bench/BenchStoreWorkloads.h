@@ -0,0 +1,132 @@
+#ifndef KV_BENCH_BENCH_STORE_WORKLOADS_H
+#define KV_BENCH_BENCH_STORE_WORKLOADS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "kv/Store/KvStore.h"
+
+namespace kv {
+
+/**
+ * @brief Generate ranks from 0 to a number of items with a zipfian distribution, in which rank 0 is the most popular,
+ * with the method of Gray et al., "Quickly Generating Billion-Record Synthetic Databases", as in YCSB.
+ *
+ * Construction takes time linear in the number of items; generating a rank takes constant time.
+ */
+class ZipfianGenerator {
+public:
+  /**
+   * @brief The skew of the YCSB workloads.
+   */
+  constexpr static const double DefaultTheta = 0.99;
+
+  /**
+   * @brief Construct a new ZipfianGenerator object.
+   *
+   * @param items the number of items.
+   * @param theta the skew, where 0 gives the uniform distribution.
+   * @throw std::invalid_argument if there are no items or the skew is not in [0, 1).
+   */
+  explicit ZipfianGenerator(uint64_t items, double theta = DefaultTheta);
+
+  /**
+   * @brief Get the number of items.
+   *
+   * @return the number of items.
+   */
+  [[nodiscard]]
+  uint64_t GetItemCount() const noexcept {
+    return _items;
+  }
+
+  /**
+   * @brief Generate the next rank.
+   *
+   * @tparam Random type of the uniform random bit generator.
+   * @param random the random bit generator.
+   * @return the rank, which is less than the number of items.
+   */
+  template <typename Random>
+  uint64_t operator()(Random& random) const {
+    auto u = std::uniform_real_distribution<double> { 0.0, 1.0 }(random);
+    auto uz = u * _zetaN;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < _rank1Bound) {
+      return _items > 1 ? 1 : 0;
+    }
+    auto rank = static_cast<uint64_t>(static_cast<double>(_items) * std::pow(_eta * u - _eta + 1.0, _alpha));
+    return rank < _items ? rank : _items - 1;
+  }
+
+private:
+  uint64_t _items;
+  double _alpha;
+  double _zetaN;
+  double _eta;
+  double _rank1Bound;                   // 1 + 0.5^theta, below which u * zeta(n) yields rank 1
+}; // class ZipfianGenerator
+
+/**
+ * @brief Options of RunStoreWorkload.
+ */
+struct StoreWorkloadOptions {
+  size_t threads = 1;                   // The number of threads
+  size_t keys = 1 << 18;                // The number of keys loaded before the run
+  uint64_t operations = 1 << 19;        // The number of keys every thread reads or writes
+  double readFraction = 0.95;           // The fraction of requests that read, while the others write
+  double theta = ZipfianGenerator::DefaultTheta; // The skew of the key popularity, where 0 means uniform
+  size_t batchSize = 1;                 // The number of keys of every read, which uses MultiGet if more than 1
+  size_t latencyInterval = 16;          // Every so many requests of every thread, the latency is sampled
+  size_t shards = KvStoreOptions { }.shards;
+  uint64_t seed = 1;                    // The seed of the random keys and requests
+}; // struct StoreWorkloadOptions
+
+/**
+ * @brief The result of RunStoreWorkload.
+ */
+struct StoreWorkloadResult {
+  uint64_t operations = 0;              // The number of keys read or written by all threads
+  uint64_t reads = 0;                   // The number of keys read
+  uint64_t hits = 0;                    // The number of keys read that the store contained
+  double seconds = 0;                   // The time from the synchronized start until the last thread finished
+  std::vector<double> readLatencies;    // The sampled durations of read requests in nanoseconds
+  std::vector<double> writeLatencies;   // The sampled durations of write requests in nanoseconds
+
+  /**
+   * @brief Get the throughput.
+   *
+   * @return the keys read or written per second in millions, or 0 if no time has passed.
+   */
+  [[nodiscard]]
+  double GetMillionOperationsPerSecond() const noexcept {
+    return seconds == 0 ? 0.0 : static_cast<double>(operations) / seconds / 1e6;
+  }
+}; // struct StoreWorkloadResult
+
+/**
+ * @brief Run threads that read and write the records of a KvStore whose keys they pick with a zipfian distribution, in
+ * the manner of the YCSB core workloads.
+ *
+ * The store is loaded with a small record for every key before the threads start. Every request either reads a
+ * batch of keys or replaces the record of one key with a new one, whose nodes are allocated from the memory of the
+ * store. Rank 0 is the most popular key, so under high skew the threads contend on its stripe.
+ *
+ * @param options the options of the benchmark.
+ *
+ * @return the result.
+ * @throw std::bad_alloc if the allocation fails.
+ * @throw std::invalid_argument if the skew is not in [0, 1), or there are no keys.
+ * @throw std::system_error if the threads cannot be started.
+ */
+[[nodiscard]]
+StoreWorkloadResult RunStoreWorkload(const StoreWorkloadOptions& options);
+
+} // namespace kv
+
+#endif // KV_BENCH_BENCH_STORE_WORKLOADS_H
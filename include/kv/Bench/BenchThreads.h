@@ -0,0 +1,307 @@
+#ifndef KV_BENCH_BENCH_THREADS_H
+#define KV_BENCH_BENCH_THREADS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "kv/Bench/BenchRunner.h"
+#include "kv/Support/Defer.h"
+
+namespace kv {
+
+/**
+ * @brief A reusable barrier that blocks threads until the configured number of threads have arrived.
+ *
+ * Waiting threads spin on the phase and yield, rather than sleep, so that they all resume within a scheduler tick of
+ * the last arrival and start their measurements together.
+ *
+ * Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned.
+ */
+class BenchBarrier {
+public:
+  /**
+   * @brief Construct a new BenchBarrier object.
+   *
+   * @param count the number of threads that take part in each phase. The count must be positive.
+   */
+  explicit BenchBarrier(size_t count) noexcept
+    : _mutex(),
+      _count(count),
+      _waiting(0),
+      _generation(0)
+  { }
+
+  BenchBarrier(const BenchBarrier &) = delete;
+  BenchBarrier(BenchBarrier &&) noexcept = delete;
+
+  BenchBarrier& operator=(const BenchBarrier &) = delete;
+  BenchBarrier& operator=(BenchBarrier &&) noexcept = delete;
+
+  /**
+   * @brief Block until all threads of the current phase have arrived.
+   */
+  void ArriveAndWait();
+
+  /**
+   * @brief Leave the barrier without waiting, reducing the number of threads of the current and all later phases.
+   */
+  void ArriveAndDrop();
+
+private:
+  std::mutex _mutex;
+  size_t _count;
+  size_t _waiting;
+  std::atomic<uint64_t> _generation;
+}; // class BenchBarrier
+
+/**
+ * @brief Run the specified work on the specified number of threads, which start together.
+ *
+ * The work receives the index of its thread. If it throws, the abort flag is set, upon which the work of the other
+ * threads should give up as soon as possible.
+ *
+ * @param count the number of threads.
+ * @param abort the abort flag.
+ * @param work the work of every thread.
+ *
+ * @return the time in seconds from the start until the last thread finished.
+ * @throw std::system_error if the threads cannot be started.
+ */
+template <typename Work>
+double RunBenchThreads(size_t count, std::atomic<bool>& abort, Work&& work) {
+  using Clock = std::chrono::steady_clock;
+
+  std::vector<std::exception_ptr> errors(count);
+  std::vector<Clock::time_point> ends(count);
+  BenchBarrier barrier { count + 1 };
+
+  auto run = [&](size_t index) {
+    barrier.ArriveAndWait();
+    try {
+      work(index);
+    } catch (...) {
+      errors[index] = std::current_exception();
+      abort.store(true, std::memory_order_relaxed);
+    }
+    ends[index] = Clock::now();
+  };
+
+  Clock::time_point start;
+  std::vector<std::thread> threads;
+  threads.reserve(count);
+  {
+    DEFER(1, for (auto& thread : threads) thread.join());
+
+    std::exception_ptr spawnError;
+    for (size_t i = 0; i < count; ++i) {
+      try {
+        threads.emplace_back(run, i);
+      } catch (const std::system_error &) {
+        spawnError = std::current_exception();
+        abort.store(true, std::memory_order_relaxed);
+        // The threads that could not be started never arrive.
+        for (auto missing = i; missing < count; ++missing) {
+          barrier.ArriveAndDrop();
+        }
+        break;
+      }
+    }
+
+    start = Clock::now();
+    barrier.ArriveAndWait();
+    if (spawnError) {
+      errors.push_back(spawnError);
+    }
+  }
+
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  std::chrono::duration<double> elapsed = *std::max_element(ends.begin(), ends.end()) - start;
+  return elapsed.count();
+}
+
+/**
+ * @brief Roles of the threads of a multi-threaded benchmark.
+ */
+enum class ThreadRole {
+  /**
+   * @brief Run the chase kernel and measure latency.
+   */
+  Chase,
+
+  /**
+   * @brief Run the bandwidth kernel and measure bandwidth.
+   */
+  Bandwidth,
+};
+
+/**
+ * @brief Options of RunThreadBench.
+ */
+struct ThreadBenchOptions {
+  /**
+   * @brief The size of the working set of every thread.
+   */
+  size_t workingSetSize = static_cast<size_t>(64) << 20;
+
+  /**
+   * @brief The time from the synchronized start to the synchronized stop of all threads.
+   */
+  std::chrono::nanoseconds duration = std::chrono::milliseconds { 200 };
+
+  /**
+   * @brief The CPUs that threads are pinned to, in order; thread i runs on CPU i modulo the number of CPUs. If empty,
+   * the CPUs are selected by SelectBenchCpus.
+   */
+  std::vector<size_t> cpus;
+
+  /**
+   * @brief The NUMA node that the buffers of all threads are bound to. If empty, the buffers of each thread are bound
+   * to the node of the CPU it runs on.
+   */
+  std::optional<size_t> memoryNode;
+
+  /**
+   * @brief Whether every thread collects its hardware performance counters over its kernel runs.
+   */
+  bool collectCounters = false;
+
+  /**
+   * @brief The options of chase threads. The NUMA node of the buffer options is overridden per thread.
+   */
+  LatencyBenchOptions latency;
+
+  /**
+   * @brief The options of bandwidth threads. The NUMA node of the buffer options is overridden per thread.
+   */
+  BandwidthBenchOptions bandwidth;
+}; // struct ThreadBenchOptions
+
+/**
+ * @brief The result of a single thread of a multi-threaded benchmark.
+ */
+struct ThreadResult {
+  ThreadRole role = ThreadRole::Chase;
+  size_t cpu = 0;                       // The CPU the thread is pinned to
+  bool pinned = false;                  // Whether pinning the thread succeeded
+  size_t memoryNode = 0;                // The NUMA node the buffers of the thread are bound to
+  uint64_t runs = 0;                    // The number of kernel runs
+  uint64_t accesses = 0;                // The number of memory accesses of all runs
+  uint64_t bytes = 0;                   // The number of bytes loaded and stored by all runs
+  double seconds = 0;                   // The time from the start until the thread finished its last run
+  PerfCounterValues counters;           // The counter values over all runs, if collected
+
+  /**
+   * @brief Get the time per memory access.
+   *
+   * @return the time per access in nanoseconds, or 0 if the thread did not finish a run.
+   */
+  [[nodiscard]]
+  double GetNanosecondsPerAccess() const noexcept {
+    return accesses == 0 ? 0.0 : seconds * 1e9 / static_cast<double>(accesses);
+  }
+
+  /**
+   * @brief Get the bandwidth.
+   *
+   * @return the bandwidth in GB/s, where a GB is 10^9 bytes, or 0 if the thread did not finish a run.
+   */
+  [[nodiscard]]
+  double GetGigabytesPerSecond() const noexcept {
+    return seconds == 0 ? 0.0 : static_cast<double>(bytes) / seconds / 1e9;
+  }
+
+  /**
+   * @brief Get the mean value of the specified counter per memory access.
+   *
+   * @param counter the counter.
+   *
+   * @return the value per access, or empty if the counter was not collected or is unavailable.
+   */
+  [[nodiscard]]
+  std::optional<double> GetCounterPerAccess(PerfCounter counter) const noexcept {
+    return counters.GetPer(counter, accesses);
+  }
+}; // struct ThreadResult
+
+/**
+ * @brief The result of a multi-threaded benchmark.
+ */
+struct ThreadBenchResult {
+  std::vector<ThreadResult> threads;
+
+  /**
+   * @brief Get the aggregate bandwidth of the threads of the specified role.
+   *
+   * @param role the role.
+   *
+   * @return the sum of the bandwidths in GB/s.
+   */
+  [[nodiscard]]
+  double GetGigabytesPerSecond(ThreadRole role) const noexcept;
+
+  /**
+   * @brief Get the mean time per memory access of the threads of the specified role.
+   *
+   * @param role the role.
+   *
+   * @return the mean time per access in nanoseconds, or 0 if there is no such thread.
+   */
+  [[nodiscard]]
+  double GetNanosecondsPerAccess(ThreadRole role) const noexcept;
+}; // struct ThreadBenchResult
+
+/**
+ * @brief Select the CPUs that benchmark threads run on.
+ *
+ * @param node the NUMA node whose CPUs are selected, or empty to select the CPUs of all online nodes.
+ *
+ * @return the CPUs, ordered by node and then by CPU ID, so that consecutive threads fill one node before the next.
+ */
+[[nodiscard]]
+std::vector<size_t> SelectBenchCpus(std::optional<size_t> node = std::nullopt);
+
+/**
+ * @brief Run a multi-threaded benchmark with one thread for each of the specified roles.
+ *
+ * Every thread pins itself to its CPU and then allocates its buffers, so that the pages are first touched from that
+ * CPU. The threads start their kernels together once all buffers are ready, run them repeatedly until the configured
+ * duration has passed, and stop together. Each thread accounts for the kernel runs it finished before the stop.
+ *
+ * @param roles the roles of the threads.
+ * @param options the options of the benchmark.
+ *
+ * @return the results of the threads, in the order of the roles.
+ * @throw std::bad_alloc if the buffers cannot be allocated.
+ * @throw std::invalid_argument if the bandwidth options are invalid.
+ * @throw std::system_error if the threads cannot be started.
+ */
+[[nodiscard]]
+ThreadBenchResult RunThreadBench(const std::vector<ThreadRole>& roles, const ThreadBenchOptions& options);
+
+/**
+ * @brief Make the thread counts of a scaling sweep.
+ *
+ * @param maxThreads the maximal number of threads.
+ *
+ * @return the powers of two below the maximal number followed by the maximal number itself.
+ */
+[[nodiscard]]
+std::vector<size_t> MakeThreadSweep(size_t maxThreads);
+
+} // namespace kv
+
+#endif // KV_BENCH_BENCH_THREADS_H
@@ -0,0 +1,83 @@
+#ifndef KV_JSON_JSON_ALLOCATOR_STATS_H
+#define KV_JSON_JSON_ALLOCATOR_STATS_H
+
+#include <memory>
+#include <string>
+
+#include "kv/Json/JsonObject.h"
+#include "kv/Json/JsonSerializer.h"
+#include "kv/Support/Memory.h"
+#include "kv/Support/SizeClass.h"
+
+namespace kv {
+
+/**
+ * @brief Convert the specified allocator statistics into a JSON object.
+ *
+ * The hot-path counters are only included if AllocatorStatsEnabled is true. Size classes without any allocation or
+ * release are omitted from the `sizeClasses` array.
+ *
+ * @param stats the allocator statistics.
+ *
+ * @return the JSON object that represents the statistics.
+ */
+[[nodiscard]]
+inline JsonObject ToJsonObject(const RawAllocatorStats& stats) {
+  auto obj = JsonObject::CreateMap();
+  auto& map = obj.GetMap();
+
+  auto put = [&map](const char* key, JsonObject value) {
+    map.emplace(key, MakeJsonObject(std::move(value)));
+  };
+
+  put("statsEnabled", JsonObject { AllocatorStatsEnabled });
+  put("blockCount", JsonObject { stats.blockCount });
+  put("reservedBytes", JsonObject { stats.reservedBytes });
+  put("inUseBytes", JsonObject { stats.GetInUseBytes() });
+  put("freeBytes", JsonObject { stats.freeBytes });
+  put("chunkCount", JsonObject { stats.chunkCount });
+  put("freeChunkCount", JsonObject { stats.freeChunkCount });
+  put("largestFreeChunkSize", JsonObject { stats.largestFreeChunkSize });
+  put("fragmentation", JsonObject { stats.GetFragmentation() });
+
+  if constexpr (AllocatorStatsEnabled) {
+    put("splits", JsonObject { stats.splits });
+    put("merges", JsonObject { stats.merges });
+    put("lockAcquisitions", JsonObject { stats.lockAcquisitions });
+    put("lockContentions", JsonObject { stats.lockContentions });
+    put("lockWaitNanoseconds", JsonObject { stats.lockWaitNanoseconds });
+
+    auto sizeClasses = JsonObject::CreateArray();
+    for (size_t sizeClass = 0; sizeClass < SizeClassCount; ++sizeClass) {
+      if (stats.allocations[sizeClass] == 0 && stats.releases[sizeClass] == 0) {
+        continue;
+      }
+
+      auto entry = MakeJsonObject(JsonObject::CreateMap());
+      auto& entryMap = entry->GetMap();
+      entryMap.emplace("size", MakeJsonObject(ClassToSize(sizeClass)));
+      entryMap.emplace("allocations", MakeJsonObject(stats.allocations[sizeClass]));
+      entryMap.emplace("releases", MakeJsonObject(stats.releases[sizeClass]));
+      sizeClasses.GetArray().push_back(std::move(entry));
+    }
+    put("sizeClasses", std::move(sizeClasses));
+  }
+
+  return obj;
+}
+
+/**
+ * @brief Dump the specified allocator statistics as JSON text.
+ *
+ * @param stats the allocator statistics.
+ *
+ * @return the JSON text.
+ */
+[[nodiscard]]
+inline std::string DumpAllocatorStats(const RawAllocatorStats& stats) {
+  return SerializeJson(ToJsonObject(stats));
+}
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_ALLOCATOR_STATS_H
@@ -0,0 +1,372 @@
+#ifndef KV_JSON_JSON_CBOR_H
+#define KV_JSON_JSON_CBOR_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "kv/Json/JsonObject.h"
+#include "kv/Json/JsonSink.h"
+#include "kv/Support/Memory.h"
+
+namespace kv {
+
+/**
+ * @brief CBOR major types, as defined by RFC 8949.
+ */
+enum class CborMajorType : uint8_t {
+  UnsignedInteger = 0,
+  NegativeInteger = 1,
+  ByteString = 2,
+  TextString = 3,
+  Array = 4,
+  Map = 5,
+  Tag = 6,
+  Simple = 7,
+};
+
+/**
+ * @brief Encode JsonObject into CBOR, as defined by RFC 8949.
+ *
+ * Every data item uses the shortest head, and strings, arrays and maps carry their lengths up front. Integral numbers
+ * in the range of 64-bit CBOR integers are encoded as integers; other numbers are encoded as single precision floats
+ * if that is exact and as double precision floats otherwise, so decoding always yields the original double.
+ *
+ * @tparam Output type of the JSON sink or of the output iterator that receives the encoded bytes.
+ *
+ * @see JsonSerializer
+ */
+template <typename Output>
+class JsonCborEncoder {
+public:
+  /**
+   * @brief Type of the sink that receives the output.
+   */
+  using SinkType = std::conditional_t<IsJsonSink<Output>::value, Output, JsonIteratorSink<Output>>;
+
+  /**
+   * @brief Visitor used for generating CBOR output.
+   *
+   * The visitor works on any node type that provides the accessors and the `Visit` protocol of JsonObject, such as
+   * JsonObject and JsonTapeNode.
+   */
+  class Visitor {
+  public:
+    /**
+     * @brief Construct a new Visitor object.
+     *
+     * @param sink the sink.
+     */
+    explicit Visitor(SinkType& sink) noexcept
+      : _sink(sink)
+    { }
+
+    template <typename Node>
+    void VisitNull(const Node &) {
+      _sink.Append(static_cast<char>(0xF6));
+    }
+
+    template <typename Node>
+    void VisitBoolean(const Node& obj) {
+      _sink.Append(static_cast<char>(obj.GetBoolean() ? 0xF5 : 0xF4));
+    }
+
+    template <typename Node>
+    void VisitNumber(const Node& obj) {
+      constexpr double IntegerLimit = 18446744073709551616.0;
+
+      auto value = obj.GetNumber();
+      if (value == std::trunc(value) && !(value == 0 && std::signbit(value))) {
+        if (value >= 0 && value < IntegerLimit) {
+          WriteHead(CborMajorType::UnsignedInteger, static_cast<uint64_t>(value));
+          return;
+        }
+        if (value < 0 && value > -IntegerLimit) {
+          WriteHead(CborMajorType::NegativeInteger, static_cast<uint64_t>(-value) - 1);
+          return;
+        }
+      }
+
+      auto single = static_cast<float>(value);
+      if (static_cast<double>(single) == value) {
+        uint32_t bits;
+        std::memcpy(&bits, &single, sizeof(bits));
+        _sink.Append(static_cast<char>(0xFA));
+        WriteBigEndian(bits, sizeof(bits));
+        return;
+      }
+
+      uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      _sink.Append(static_cast<char>(0xFB));
+      WriteBigEndian(bits, sizeof(bits));
+    }
+
+    template <typename Node>
+    void VisitString(const Node& obj) {
+      WriteString(obj.GetString());
+    }
+
+    template <typename Node>
+    void VisitArray(const Node& obj) {
+      const auto& arr = obj.GetArray();
+      WriteHead(CborMajorType::Array, arr.size());
+      for (const auto& element : arr) {
+        element->Visit(*this);
+      }
+    }
+
+    template <typename Node>
+    void VisitMap(const Node& obj) {
+      obj.WithMap([this](const auto& map) {
+        WriteHead(CborMajorType::Map, map.size());
+        for (const auto& [key, value] : map) {
+          WriteString(key);
+          value->Visit(*this);
+        }
+      });
+    }
+
+  private:
+    SinkType& _sink;
+
+    void WriteBigEndian(uint64_t value, size_t size) {
+      char bytes[8];
+      for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<char>(value >> ((size - 1 - i) * 8));
+      }
+      _sink.Append(bytes, size);
+    }
+
+    void WriteHead(CborMajorType major, uint64_t argument) {
+      auto type = static_cast<uint8_t>(static_cast<uint8_t>(major) << 5);
+      if (argument < 24) {
+        _sink.Append(static_cast<char>(type | argument));
+      } else if (argument <= UINT8_MAX) {
+        _sink.Append(static_cast<char>(type | 24));
+        WriteBigEndian(argument, 1);
+      } else if (argument <= UINT16_MAX) {
+        _sink.Append(static_cast<char>(type | 25));
+        WriteBigEndian(argument, 2);
+      } else if (argument <= UINT32_MAX) {
+        _sink.Append(static_cast<char>(type | 26));
+        WriteBigEndian(argument, 4);
+      } else {
+        _sink.Append(static_cast<char>(type | 27));
+        WriteBigEndian(argument, 8);
+      }
+    }
+
+    void WriteString(std::string_view s) {
+      WriteHead(CborMajorType::TextString, s.size());
+      _sink.Append(s.data(), s.size());
+    }
+  }; // class Visitor
+
+  /**
+   * @brief Construct a new JsonCborEncoder object that writes to the specified output iterator.
+   *
+   * This constructor takes part in overload resolution only if Output is an output iterator.
+   *
+   * @param iter the output iterator.
+   */
+  template <typename T = Output,
+      std::enable_if_t<!IsJsonSink<T>::value, int> = 0>
+  explicit JsonCborEncoder(Output iter) noexcept
+    : _sink(std::move(iter))
+  { }
+
+  /**
+   * @brief Construct a new JsonCborEncoder object that writes to the specified sink.
+   *
+   * This constructor takes part in overload resolution only if Output is a JSON sink.
+   *
+   * @param sink the sink. The sink must outlive this encoder.
+   */
+  template <typename T = Output,
+      std::enable_if_t<IsJsonSink<T>::value, int> = 0>
+  explicit JsonCborEncoder(Output& sink) noexcept
+    : _sink(sink)
+  { }
+
+  /**
+   * @brief Encode the specified JSON object into CBOR.
+   *
+   * @tparam Node type of the node, such as JsonObject or JsonTapeNode.
+   * @param obj the node to be encoded.
+   */
+  template <typename Node>
+  void Encode(const Node& obj) {
+    obj.Visit(Visitor { _sink });
+  }
+
+private:
+  std::conditional_t<IsJsonSink<Output>::value, Output &, JsonIteratorSink<Output>> _sink;
+}; // class JsonCborEncoder
+
+/**
+ * @brief Encode the specified JSON object into CBOR and append the result to the specified string.
+ *
+ * @tparam Node type of the node, such as JsonObject or JsonTapeNode.
+ * @param obj the node to be encoded.
+ * @param output the string to append to.
+ */
+template <typename Node>
+void EncodeCbor(const Node& obj, std::string& output) {
+  JsonStringSink sink { output };
+  JsonCborEncoder<JsonStringSink> encoder { sink };
+  encoder.Encode(obj);
+}
+
+/**
+ * @brief Encode the specified JSON object into CBOR.
+ *
+ * @tparam Node type of the node, such as JsonObject or JsonTapeNode.
+ * @param obj the node to be encoded.
+ * @return the encoded bytes.
+ */
+template <typename Node>
+[[nodiscard]]
+std::string EncodeCbor(const Node& obj) {
+  std::string output;
+  EncodeCbor(obj, output);
+  return output;
+}
+
+/**
+ * @brief Decode CBOR data items into JsonObject trees.
+ *
+ * The decoder accepts the subset of CBOR that corresponds to JSON: integers, floats of all three precisions, text
+ * strings, arrays, maps with text string keys, false, true, null and undefined, which decodes as null. Both definite
+ * and indefinite lengths are accepted, and tags are ignored. Because lengths come first, arrays and maps are
+ * preallocated and subtrees are skipped by reading their heads only, without decoding strings or numbers. Text strings
+ * are not validated as UTF-8.
+ *
+ * Errors are reported with JsonParseException, whose offset is the byte offset of the offending data item.
+ */
+class JsonCborDecoder {
+public:
+  /**
+   * @brief The maximal nesting depth of arrays and maps.
+   */
+  constexpr static const size_t MaxDepth = 4096;
+
+  /**
+   * @brief Construct a new JsonCborDecoder object.
+   *
+   * @param data the CBOR data, which must outlive the decoder.
+   * @param allocator the object allocator used for allocating child nodes.
+   * @param storage the storage mode of decoded maps.
+   */
+  explicit JsonCborDecoder(std::string_view data,
+                           ObjectAllocator<JsonObject> allocator = ObjectAllocator<JsonObject>(),
+                           JsonMapStorage storage = JsonMapStorage::Hashed) noexcept
+    : _data(data),
+      _offset(0),
+      _allocator(allocator),
+      _storage(storage)
+  { }
+
+  /**
+   * @brief Decode the next data item.
+   *
+   * @return the decoded JSON object.
+   * @throw JsonParseException if the data item is malformed or has no JSON equivalent.
+   */
+  [[nodiscard]]
+  JsonObject Decode();
+
+  /**
+   * @brief Skip the next data item without decoding it.
+   *
+   * @throw JsonParseException if the data item is malformed or has no JSON equivalent.
+   */
+  void Skip();
+
+  /**
+   * @brief Determine whether all data has been consumed.
+   *
+   * @return whether all data has been consumed.
+   */
+  [[nodiscard]]
+  bool IsAtEnd() const noexcept {
+    return _offset == _data.size();
+  }
+
+  /**
+   * @brief Get the number of bytes consumed so far.
+   *
+   * @return the number of bytes consumed.
+   */
+  [[nodiscard]]
+  size_t GetOffset() const noexcept {
+    return _offset;
+  }
+
+private:
+  /**
+   * @brief The head of a data item.
+   */
+  class Head {
+  public:
+    CborMajorType Major;
+    uint8_t Info;
+    uint64_t Argument;
+    size_t Offset;
+
+    [[nodiscard]]
+    bool IsIndefinite() const noexcept {
+      return Info == 31;
+    }
+  }; // class Head
+
+  std::string_view _data;
+  size_t _offset;
+  ObjectAllocator<JsonObject> _allocator;
+  JsonMapStorage _storage;
+
+  [[nodiscard]]
+  Head ReadHead();
+
+  [[nodiscard]]
+  bool ReadBreak() noexcept;
+
+  [[nodiscard]]
+  std::string ReadString(const Head& head);
+
+  void SkipString(const Head& head);
+
+  [[nodiscard]]
+  JsonObject DecodeItem(size_t depth);
+
+  void SkipItem(size_t depth);
+
+  [[nodiscard]]
+  double DecodeFloat(const Head& head) const;
+
+  [[noreturn]]
+  static void Fail(const char* message, size_t offset);
+}; // class JsonCborDecoder
+
+/**
+ * @brief Decode the specified CBOR data, which must consist of exactly one data item.
+ *
+ * @param data the CBOR data.
+ * @param allocator the object allocator used for allocating child nodes.
+ * @param storage the storage mode of decoded maps.
+ * @return the decoded JSON object.
+ * @throw JsonParseException if the data is malformed, has no JSON equivalent or has trailing bytes.
+ */
+[[nodiscard]]
+JsonObject DecodeCbor(std::string_view data,
+                      ObjectAllocator<JsonObject> allocator = ObjectAllocator<JsonObject>(),
+                      JsonMapStorage storage = JsonMapStorage::Hashed);
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_CBOR_H
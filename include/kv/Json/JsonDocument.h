@@ -0,0 +1,507 @@
+#ifndef KV_JSON_JSON_DOCUMENT_H
+#define KV_JSON_JSON_DOCUMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "kv/Json/JsonObject.h"
+#include "kv/Support/MappedFile.h"
+#include "kv/Support/MonotonicArena.h"
+
+namespace kv {
+
+class JsonDocument;
+class JsonArrayView;
+class JsonMapView;
+
+/**
+ * @brief A lazily decoded value within a JsonDocument.
+ *
+ * A JsonValue is a small handle that refers to the position of a value in the source text. Scalars are decoded, and
+ * validated, each time they are accessed. The handle is valid as long as its document is alive.
+ */
+class JsonValue {
+public:
+  /**
+   * @brief Get the type of this value, which is determined by its first character.
+   *
+   * @return the type of this value.
+   */
+  [[nodiscard]]
+  JsonObjectType GetType() const noexcept;
+
+  [[nodiscard]]
+  bool IsNull() const noexcept {
+    return GetType() == JsonObjectType::Null;
+  }
+
+  [[nodiscard]]
+  bool IsBoolean() const noexcept {
+    return GetType() == JsonObjectType::Boolean;
+  }
+
+  [[nodiscard]]
+  bool IsNumber() const noexcept {
+    return GetType() == JsonObjectType::Number;
+  }
+
+  [[nodiscard]]
+  bool IsString() const noexcept {
+    return GetType() == JsonObjectType::String;
+  }
+
+  [[nodiscard]]
+  bool IsArray() const noexcept {
+    return GetType() == JsonObjectType::Array;
+  }
+
+  [[nodiscard]]
+  bool IsMap() const noexcept {
+    return GetType() == JsonObjectType::Map;
+  }
+
+  /**
+   * @brief Get the boolean value represented by this value.
+   *
+   * @return the boolean value.
+   * @throw JsonException if this value is not a boolean.
+   * @throw JsonParseException if the literal is malformed.
+   */
+  [[nodiscard]]
+  bool GetBoolean() const;
+
+  /**
+   * @brief Get the number value represented by this value.
+   *
+   * @tparam T the type of the number value. T should be an arithmetic type.
+   *
+   * @return the number value.
+   * @throw JsonException if this value is not a number.
+   * @throw JsonParseException if the number is malformed.
+   */
+  template <typename T = double>
+  [[nodiscard]]
+  T GetNumber() const {
+    static_assert(std::is_arithmetic_v<T>, "T should be an arithmetic type");
+    return static_cast<T>(DecodeNumber());
+  }
+
+  /**
+   * @brief Get the string value represented by this value.
+   *
+   * A string without escape sequences is returned as a view into the source text. A string with escape sequences is
+   * decoded into storage owned by the document on the first call, and later calls return the same view.
+   *
+   * @return the string value, which is valid as long as the document is alive.
+   * @throw JsonException if this value is not a string.
+   * @throw JsonParseException if the string is malformed.
+   */
+  [[nodiscard]]
+  std::string_view GetString() const;
+
+  /**
+   * @brief Get the array represented by this value.
+   *
+   * @return a view of the array.
+   * @throw JsonException if this value is not an array.
+   */
+  [[nodiscard]]
+  JsonArrayView GetArray() const;
+
+  /**
+   * @brief Get the map represented by this value.
+   *
+   * @return a view of the map.
+   * @throw JsonException if this value is not a map.
+   */
+  [[nodiscard]]
+  JsonMapView GetMap() const;
+
+  /**
+   * @brief Get the offset of this value in the source text.
+   *
+   * @return the offset of the first character of this value.
+   */
+  [[nodiscard]]
+  size_t GetOffset() const noexcept;
+
+  /**
+   * @brief Decode this value and its descendants into a JsonObject tree.
+   *
+   * @param allocator the object allocator used for allocating child nodes.
+   *
+   * @return the decoded tree.
+   * @throw JsonParseException if the value is malformed.
+   */
+  [[nodiscard]]
+  JsonObject ToJsonObject(ObjectAllocator<JsonObject> allocator = ObjectAllocator<JsonObject>()) const;
+
+private:
+  friend class JsonDocument;
+  friend class JsonArrayView;
+  friend class JsonMapView;
+
+  explicit JsonValue(const JsonDocument* document, uint32_t token) noexcept
+    : _document(document),
+      _token(token)
+  { }
+
+  const JsonDocument* _document;
+  uint32_t _token;
+
+  [[nodiscard]]
+  double DecodeNumber() const;
+}; // class JsonValue
+
+/**
+ * @brief A lazily decoded JSON array. Elements are found by walking the structural index.
+ */
+class JsonArrayView {
+public:
+  /**
+   * @brief Forward iterator over the elements of an array.
+   */
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = JsonValue;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = JsonValue;
+
+    [[nodiscard]]
+    JsonValue operator*() const noexcept {
+      return JsonValue { _document, _token };
+    }
+
+    Iterator& operator++() noexcept;
+
+    Iterator operator++(int) noexcept {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    [[nodiscard]]
+    bool operator==(const Iterator& rhs) const noexcept {
+      return _token == rhs._token;
+    }
+
+    [[nodiscard]]
+    bool operator!=(const Iterator& rhs) const noexcept {
+      return _token != rhs._token;
+    }
+
+  private:
+    friend class JsonArrayView;
+
+    explicit Iterator(const JsonDocument* document, uint32_t token) noexcept
+      : _document(document),
+        _token(token)
+    { }
+
+    const JsonDocument* _document;
+    uint32_t _token;
+  }; // class Iterator
+
+  [[nodiscard]]
+  Iterator begin() const noexcept;
+
+  [[nodiscard]]
+  Iterator end() const noexcept;
+
+  /**
+   * @brief Determine whether the array is empty.
+   */
+  [[nodiscard]]
+  bool IsEmpty() const noexcept {
+    return begin() == end();
+  }
+
+  /**
+   * @brief Count the elements of the array, which takes time linear in the number of elements.
+   */
+  [[nodiscard]]
+  size_t GetSize() const noexcept {
+    return static_cast<size_t>(std::distance(begin(), end()));
+  }
+
+  /**
+   * @brief Get the element at the specified index, which takes time linear in the index.
+   *
+   * @param index the index of the element.
+   *
+   * @return the element.
+   * @throw JsonException if the index is out of range.
+   */
+  [[nodiscard]]
+  JsonValue At(size_t index) const;
+
+private:
+  friend class JsonValue;
+
+  explicit JsonArrayView(const JsonDocument* document, uint32_t token) noexcept
+    : _document(document),
+      _token(token)
+  { }
+
+  const JsonDocument* _document;
+  uint32_t _token;
+}; // class JsonArrayView
+
+/**
+ * @brief A lazily decoded JSON map. Entries are found by walking the structural index, in document order.
+ */
+class JsonMapView {
+public:
+  /**
+   * @brief Forward iterator over the entries of a map.
+   */
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<std::string_view, JsonValue>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    /**
+     * @throw JsonParseException if the key is malformed.
+     */
+    [[nodiscard]]
+    value_type operator*() const;
+
+    /**
+     * @brief Get the value of the current entry without decoding its key.
+     */
+    [[nodiscard]]
+    JsonValue GetValue() const noexcept {
+      return JsonValue { _document, _token + 2 };
+    }
+
+    Iterator& operator++() noexcept;
+
+    Iterator operator++(int) noexcept {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    [[nodiscard]]
+    bool operator==(const Iterator& rhs) const noexcept {
+      return _token == rhs._token;
+    }
+
+    [[nodiscard]]
+    bool operator!=(const Iterator& rhs) const noexcept {
+      return _token != rhs._token;
+    }
+
+  private:
+    friend class JsonMapView;
+
+    explicit Iterator(const JsonDocument* document, uint32_t token) noexcept
+      : _document(document),
+        _token(token)
+    { }
+
+    const JsonDocument* _document;
+    uint32_t _token;
+  }; // class Iterator
+
+  [[nodiscard]]
+  Iterator begin() const noexcept;
+
+  [[nodiscard]]
+  Iterator end() const noexcept;
+
+  /**
+   * @brief Determine whether the map is empty.
+   */
+  [[nodiscard]]
+  bool IsEmpty() const noexcept {
+    return begin() == end();
+  }
+
+  /**
+   * @brief Count the entries of the map, which takes time linear in the number of entries.
+   */
+  [[nodiscard]]
+  size_t GetSize() const noexcept {
+    return static_cast<size_t>(std::distance(begin(), end()));
+  }
+
+  /**
+   * @brief Find the value of the specified key. If the key occurs more than once, the last occurrence wins, as in
+   * JsonParser.
+   *
+   * @param key the key.
+   *
+   * @return the value of the key, or empty if the map does not contain the key.
+   * @throw JsonParseException if a key is malformed.
+   */
+  [[nodiscard]]
+  std::optional<JsonValue> Find(std::string_view key) const;
+
+  /**
+   * @brief Get the value of the specified key.
+   *
+   * @param key the key.
+   *
+   * @return the value of the key.
+   * @throw JsonException if the map does not contain the key.
+   */
+  [[nodiscard]]
+  JsonValue At(std::string_view key) const;
+
+private:
+  friend class JsonValue;
+
+  explicit JsonMapView(const JsonDocument* document, uint32_t token) noexcept
+    : _document(document),
+      _token(token)
+  { }
+
+  const JsonDocument* _document;
+  uint32_t _token;
+}; // class JsonMapView
+
+/**
+ * @brief A JSON document that is decoded on demand.
+ *
+ * Construction scans the text into a structural index and checks the structure of the document: brackets, colons and
+ * commas, and the first character of every value. Scalars are decoded and fully validated only when they are
+ * accessed, so malformed scalars that are never accessed go unnoticed. Nothing is copied out of the source text
+ * except strings with escape sequences.
+ *
+ * The source text is either borrowed, in which case it must outlive the document, or a memory-mapped file owned by
+ * the document.
+ *
+ * Objects of this class are not thread safe, since decoding strings with escape sequences allocates storage within
+ * the document. Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned,
+ * since values refer to their document.
+ */
+class JsonDocument {
+public:
+  /**
+   * @brief Construct a new JsonDocument object over the specified text, which must outlive the document.
+   *
+   * @param text the JSON text, whose size is at most MaxIndexedJsonSize.
+   *
+   * @throw JsonParseException if the structure of the document is not valid JSON.
+   */
+  explicit JsonDocument(std::string_view text);
+
+  /**
+   * @brief Construct a new JsonDocument object over the content of the specified memory-mapped file.
+   *
+   * @param file the file, which is owned by the document.
+   *
+   * @throw JsonParseException if the structure of the document is not valid JSON.
+   */
+  explicit JsonDocument(MappedFile file);
+
+  JsonDocument(const JsonDocument &) = delete;
+  JsonDocument(JsonDocument &&) noexcept = delete;
+
+  JsonDocument& operator=(const JsonDocument &) = delete;
+  JsonDocument& operator=(JsonDocument &&) noexcept = delete;
+
+  /**
+   * @brief Get the root value of the document.
+   *
+   * @return the root value.
+   */
+  [[nodiscard]]
+  JsonValue GetRoot() const noexcept {
+    return JsonValue { this, 0 };
+  }
+
+  /**
+   * @brief Get the source text of the document.
+   *
+   * @return the source text.
+   */
+  [[nodiscard]]
+  std::string_view GetText() const noexcept {
+    return _text;
+  }
+
+private:
+  friend class JsonValue;
+  friend class JsonArrayView;
+  friend class JsonMapView;
+
+  std::optional<MappedFile> _file;
+  std::string_view _text;
+  // Offsets of the structural tokens in the text.
+  std::vector<uint32_t> _positions;
+  // For each opening bracket, the token index of its matching closing bracket.
+  std::vector<uint32_t> _matches;
+  mutable MonotonicArena _strings;
+  // Decoded strings with escape sequences, keyed by token index.
+  mutable std::unordered_map<uint32_t, std::string_view> _decodedStrings;
+
+  void Index();
+
+  [[nodiscard]]
+  char GetChar(uint32_t token) const noexcept {
+    return _text[_positions[token]];
+  }
+
+  /**
+   * @brief Get the token index right after the value that starts at the specified token.
+   */
+  [[nodiscard]]
+  uint32_t SkipValue(uint32_t token) const noexcept {
+    auto ch = GetChar(token);
+    return (ch == '[' || ch == '{') ? _matches[token] + 1 : token + 1;
+  }
+
+  /**
+   * @brief Get the token index of the element or entry after the one that starts at the specified token, or of the
+   * closing bracket if there is none.
+   */
+  [[nodiscard]]
+  uint32_t NextElement(uint32_t token) const noexcept {
+    return GetChar(token) == ',' ? token + 1 : token;
+  }
+
+  /**
+   * @brief Get the text from the specified token up to the next token, which covers a scalar and its trailing
+   * whitespace.
+   */
+  [[nodiscard]]
+  std::string_view GetTokenText(uint32_t token) const noexcept {
+    auto begin = static_cast<size_t>(_positions[token]);
+    auto end = token + 1 < _positions.size() ? static_cast<size_t>(_positions[token + 1]) : _text.size();
+    return _text.substr(begin, end - begin);
+  }
+
+  /**
+   * @brief Get the content of the string at the specified token if it has no escape sequences.
+   */
+  [[nodiscard]]
+  std::optional<std::string_view> GetRawString(uint32_t token) const noexcept;
+
+  /**
+   * @brief Get the content of the string at the specified token, decoding it into the document on first use if it has
+   * escape sequences.
+   */
+  [[nodiscard]]
+  std::string_view DecodeString(uint32_t token) const;
+
+  [[nodiscard]]
+  bool StringEquals(uint32_t token, std::string_view s) const;
+}; // class JsonDocument
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_DOCUMENT_H
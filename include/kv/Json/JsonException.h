@@ -1,9 +1,9 @@
 #ifndef KV_JSON_JSON_EXCEPTION_H
 #define KV_JSON_JSON_EXCEPTION_H
 
+#include <cstddef>
 #include <exception>
 #include <string>
-#include <type_traits>
 #include <utility>
 
 namespace kv {
@@ -46,27 +46,35 @@ private:
   std::string _message;
 }; // class JsonException
 
-namespace details {
-
-template <typename F, typename ...Args>
-inline decltype(auto) InterceptAsJsonException(const F& func, Args&&... args) {
-  static_assert(std::is_invocable_v<F, Args...>,
-      "F should be a function object type that can be invoked with the specified arguments");
+/**
+ * @brief The exception thrown when parsing malformed JSON text.
+ */
+class JsonParseException : public JsonException {
+public:
+  /**
+   * @brief Construct a new JsonParseException object.
+   *
+   * @param message the exception message, which does not include the offset.
+   * @param offset the byte offset into the JSON text at which the error is detected.
+   */
+  explicit JsonParseException(const std::string& message, size_t offset) noexcept
+    : JsonException(message + " at offset " + std::to_string(offset)),
+      _offset(offset)
+  { }
 
-  try {
-    if constexpr (std::is_void_v<std::invoke_result_t<F, Args...>>) {
-      func(std::forward<Args>(args)...);
-    } else {
-      return func(std::forward<Args>(args)...);
-    }
-  } catch (const JsonException &) {
-    throw;
-  } catch (...) {
-    throw JsonException();
+  /**
+   * @brief Get the byte offset into the JSON text at which the error is detected.
+   *
+   * @return the byte offset.
+   */
+  [[nodiscard]]
+  size_t GetOffset() const noexcept {
+    return _offset;
   }
-}
 
-} // namespace details
+private:
+  size_t _offset;
+}; // class JsonParseException
 
 } // namespace kv
 
@@ -1,9 +1,13 @@
 #ifndef KV_JSON_JSON_OBJECT_H
 #define KV_JSON_JSON_OBJECT_H
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
 #include <string>
 #include <type_traits>
 #include <unordered_map>
@@ -12,6 +16,7 @@
 #include <vector>
 
 #include "kv/Json/JsonException.h"
+#include "kv/Support/FlatStringMap.h"
 #include "kv/Support/Intrinsics.h"
 #include "kv/Support/Memory.h"
 
@@ -39,10 +44,47 @@ class JsonArrayTag { }; // class JsonArrayTag
  */
 class JsonMapTag { }; // class JsonMapTag
 
+/**
+ * @brief Tag type used for indicating construction of a JSON map object with flat storage.
+ */
+class JsonFlatMapTag { }; // class JsonFlatMapTag
+
+/**
+ * @brief Storage modes of JSON map objects.
+ */
+enum class JsonMapStorage {
+  /**
+   * @brief Entries are kept in a std::unordered_map, iterated in unspecified order.
+   */
+  Hashed,
+
+  /**
+   * @brief Entries are kept inline in a FlatStringMap, iterated in insertion order.
+   */
+  Flat,
+};
+
+class JsonObject;
+
+/**
+ * @brief Owning pointer to a child node of a JSON object.
+ *
+ * The deleter remembers the memory resource the node was allocated from, so nodes can be allocated from an arena as
+ * well as from the global allocator.
+ */
+using JsonObjectPtr = std::unique_ptr<JsonObject, ObjectDeleter<JsonObject>>;
+
+/**
+ * @brief Flat storage of a JSON map object.
+ */
+using JsonFlatMap = FlatStringMap<JsonObjectPtr>;
+
 /**
  * @brief A JSON object.
+ *
+ * JsonObject is not polymorphic: its size is that of its value, and it is moved by moving the value.
  */
-class JsonObject {
+class JsonObject final {
 public:
   /**
    * @brief Create a new JsonObject that represents an empty array.
@@ -57,10 +99,14 @@ public:
   /**
    * @brief Create a new JsonObject that represents an empty map.
    *
+   * @param storage the storage mode of the map.
    * @return the created JsonObject object.
    */
   [[nodiscard]]
-  static JsonObject CreateMap() noexcept {
+  static JsonObject CreateMap(JsonMapStorage storage = JsonMapStorage::Hashed) noexcept {
+    if (storage == JsonMapStorage::Flat) {
+      return JsonObject(JsonFlatMapTag{});
+    }
     return JsonObject(JsonMapTag{});
   }
 
@@ -129,17 +175,67 @@ public:
     : _data(std::in_place_type_t<MapType>())
   { }
 
-  JsonObject(const JsonObject &) = default;
+  /**
+   * @brief Construct a new JsonObject that represents a map value with flat storage.
+   */
+  explicit JsonObject(JsonFlatMapTag) noexcept
+    : _data(std::in_place_type_t<FlatMapType>())
+  { }
+
+  /**
+   * @brief Construct a new JsonObject that is a deep copy of the specified one.
+   *
+   * Every copied node is allocated from the memory resource of the node it is copied from. The tree is copied with an
+   * explicit stack, so copying deeply nested trees does not overflow the call stack.
+   *
+   * @param other the JSON object to copy.
+   * @throw std::bad_alloc if the allocation fails.
+   */
+  JsonObject(const JsonObject& other)
+    : JsonObject(CopyValue(other))
+  {
+    CopyDescendants(other, *this, nullptr);
+  }
+
   JsonObject(JsonObject &&) noexcept = default;
 
   /**
    * @brief Destroy this JsonObject object.
+   *
+   * The tree rooted at this JSON object is torn down with an explicit stack rather than through the destructors of the
+   * children, so destroying deeply nested trees does not overflow the call stack.
    */
-  virtual ~JsonObject() = default;
+  ~JsonObject() {
+    if (HasChildren()) {
+      ReleaseDescendants();
+    }
+  }
+
+  JsonObject& operator=(const JsonObject& other) {
+    if (this != &other) {
+      *this = JsonObject { other };
+    }
+    return *this;
+  }
 
-  JsonObject& operator=(const JsonObject &) = default;
   JsonObject& operator=(JsonObject &&) noexcept = default;
 
+  /**
+   * @brief Create a deep copy of the tree rooted at this JSON object, allocating every node from the specified object
+   * allocator, such as that of an arena.
+   *
+   * @param allocator the object allocator.
+   *
+   * @return the root of the copy.
+   * @throw std::bad_alloc if the allocation fails.
+   */
+  [[nodiscard]]
+  JsonObjectPtr Clone(ObjectAllocator<JsonObject> allocator = ObjectAllocator<JsonObject> { }) const {
+    auto root = MakeObject<JsonObject>(allocator, CopyValue(*this));
+    CopyDescendants(*this, *root, &allocator);
+    return root;
+  }
+
   /**
    * @brief Get the type of this JSON object.
    *
@@ -147,7 +243,11 @@ public:
    */
   [[nodiscard]]
   JsonObjectType GetType() const noexcept {
-    return static_cast<JsonObjectType>(_data.index());
+    auto index = _data.index();
+    if (UNLIKELY(index == FlatMapIndex)) {
+      return JsonObjectType::Map;
+    }
+    return static_cast<JsonObjectType>(index);
   }
 
   /**
@@ -207,19 +307,42 @@ public:
    */
   [[nodiscard]]
   bool IsMap() const noexcept {
-    return std::holds_alternative<MapType>(_data);
+    return std::holds_alternative<MapType>(_data) || std::holds_alternative<FlatMapType>(_data);
+  }
+
+  /**
+   * @brief Determine whether this JSON object is a map value with flat storage.
+   *
+   * @return whether this JSON object is a map value with flat storage.
+   */
+  [[nodiscard]]
+  bool IsFlatMap() const noexcept {
+    return std::holds_alternative<FlatMapType>(_data);
+  }
+
+  /**
+   * @brief Get the storage mode of the map value represented by this JSON object.
+   *
+   * @return the storage mode of the map value.
+   * @throw JsonException if this JSON object is not a map value.
+   */
+  [[nodiscard]]
+  JsonMapStorage GetMapStorage() const {
+    if (UNLIKELY(!IsMap())) {
+      throw JsonException { };
+    }
+    return IsFlatMap() ? JsonMapStorage::Flat : JsonMapStorage::Hashed;
   }
 
   /**
    * @brief Get the boolean value represented by this JSON object.
    *
    * @return the boolean value represented by this JSON object.
+   * @throw JsonException if this JSON object is not a boolean value.
    */
   [[nodiscard]]
   bool GetBoolean() const {
-    return details::InterceptAsJsonException([this]() {
-      return std::get<BooleanType>(_data);
-    });
+    return GetValue<BooleanType>();
   }
 
   /**
@@ -228,76 +351,206 @@ public:
    * @tparam T the type of the number value. T should be an arithmetic type.
    *
    * @return the number value represented by this JSON object.
+   * @throw JsonException if this JSON object is not a number value.
    */
   template <typename T = double>
   [[nodiscard]]
   T GetNumber() const {
     static_assert(std::is_arithmetic_v<T>, "T should be an arithmetic type");
-    return details::InterceptAsJsonException([this]() {
-      return static_cast<T>(std::get<NumberType>(_data));
-    });
+    return static_cast<T>(GetValue<NumberType>());
   }
 
   /**
    * @brief Get the string value represented by this JSON object.
    *
    * @return the string value represented by this JSON object.
+   * @throw JsonException if this JSON object is not a string value.
    */
   [[nodiscard]]
   const std::string& GetString() const {
-    return details::InterceptAsJsonException([this]() -> const std::string& {
-      return std::get<StringType>(_data);
-    });
+    return GetValue<StringType>();
   }
 
   /**
    * @brief Get the array value represented by this JSON object.
    *
    * @return the array value represented by this JSON object.
+   * @throw JsonException if this JSON object is not an array value.
    */
   [[nodiscard]]
-  std::vector<std::unique_ptr<JsonObject>>& GetArray() {
-    return details::InterceptAsJsonException([this]() -> std::vector<std::unique_ptr<JsonObject>> & {
-      return std::get<ArrayType>(_data);
-    });
+  std::vector<JsonObjectPtr>& GetArray() {
+    return GetValue<ArrayType>();
   }
 
   /**
    * @brief Get the array value represented by this JSON object.
    *
    * @return the array value represented by this JSON object.
+   * @throw JsonException if this JSON object is not an array value.
    */
   [[nodiscard]]
-  const std::vector<std::unique_ptr<JsonObject>>& GetArray() const {
-    return details::InterceptAsJsonException([this]() -> const std::vector<std::unique_ptr<JsonObject>> & {
-      return std::get<ArrayType>(_data);
-    });
+  const std::vector<JsonObjectPtr>& GetArray() const {
+    return GetValue<ArrayType>();
   }
 
   /**
-   * @brief Get the map value represented by this JSON object.
+   * @brief Get the map value represented by this JSON object, which must have hashed storage.
    *
    * @return the map value represented by this JSON object.
+   * @throw JsonException if this JSON object is not a map value with hashed storage.
    */
   [[nodiscard]]
-  std::unordered_map<std::string, std::unique_ptr<JsonObject>>& GetMap() {
-    return details::InterceptAsJsonException(
-        [this]() -> std::unordered_map<std::string, std::unique_ptr<JsonObject>> & {
-          return std::get<MapType>(_data);
-        });
+  std::unordered_map<std::string, JsonObjectPtr>& GetMap() {
+    return GetValue<MapType>();
   }
 
   /**
-   * @brief Get the map value represented by this JSON object.
+   * @brief Get the map value represented by this JSON object, which must have hashed storage.
    *
    * @return the map value represented by this JSON object.
+   * @throw JsonException if this JSON object is not a map value with hashed storage.
    */
   [[nodiscard]]
-  const std::unordered_map<std::string, std::unique_ptr<JsonObject>>& GetMap() const {
-    return details::InterceptAsJsonException(
-        [this]() -> const std::unordered_map<std::string, std::unique_ptr<JsonObject>> & {
-          return std::get<MapType>(_data);
-        });
+  const std::unordered_map<std::string, JsonObjectPtr>& GetMap() const {
+    return GetValue<MapType>();
+  }
+
+  /**
+   * @brief Get the map value represented by this JSON object, which must have flat storage.
+   *
+   * @return the map value represented by this JSON object.
+   * @throw JsonException if this JSON object is not a map value with flat storage.
+   */
+  [[nodiscard]]
+  JsonFlatMap& GetFlatMap() {
+    return GetValue<FlatMapType>();
+  }
+
+  /**
+   * @brief Get the map value represented by this JSON object, which must have flat storage.
+   *
+   * @return the map value represented by this JSON object.
+   * @throw JsonException if this JSON object is not a map value with flat storage.
+   */
+  [[nodiscard]]
+  const JsonFlatMap& GetFlatMap() const {
+    return GetValue<FlatMapType>();
+  }
+
+  /**
+   * @brief Get the boolean value represented by this JSON object, if it is one.
+   *
+   * @return the boolean value, or empty if this JSON object is not a boolean value.
+   */
+  [[nodiscard]]
+  std::optional<bool> TryGetBoolean() const noexcept {
+    if (auto value = std::get_if<BooleanType>(&_data)) {
+      return *value;
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Get the number value represented by this JSON object, if it is one.
+   *
+   * @tparam T the type of the number value. T should be an arithmetic type.
+   *
+   * @return the number value, or empty if this JSON object is not a number value.
+   */
+  template <typename T = double>
+  [[nodiscard]]
+  std::optional<T> TryGetNumber() const noexcept {
+    static_assert(std::is_arithmetic_v<T>, "T should be an arithmetic type");
+    if (auto value = std::get_if<NumberType>(&_data)) {
+      return static_cast<T>(*value);
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Get the string value represented by this JSON object, if it is one.
+   *
+   * @return pointer to the string value, or null if this JSON object is not a string value.
+   */
+  [[nodiscard]]
+  const std::string* TryGetString() const noexcept {
+    return std::get_if<StringType>(&_data);
+  }
+
+  /**
+   * @brief Get the array value represented by this JSON object, if it is one.
+   *
+   * @return pointer to the array value, or null if this JSON object is not an array value.
+   */
+  [[nodiscard]]
+  std::vector<JsonObjectPtr>* TryGetArray() noexcept {
+    return std::get_if<ArrayType>(&_data);
+  }
+
+  /**
+   * @brief Get the array value represented by this JSON object, if it is one.
+   *
+   * @return pointer to the array value, or null if this JSON object is not an array value.
+   */
+  [[nodiscard]]
+  const std::vector<JsonObjectPtr>* TryGetArray() const noexcept {
+    return std::get_if<ArrayType>(&_data);
+  }
+
+  /**
+   * @brief Get the map value represented by this JSON object, if it is a map value with hashed storage.
+   *
+   * @return pointer to the map value, or null if this JSON object is not a map value with hashed storage.
+   */
+  [[nodiscard]]
+  std::unordered_map<std::string, JsonObjectPtr>* TryGetMap() noexcept {
+    return std::get_if<MapType>(&_data);
+  }
+
+  /**
+   * @brief Get the map value represented by this JSON object, if it is a map value with hashed storage.
+   *
+   * @return pointer to the map value, or null if this JSON object is not a map value with hashed storage.
+   */
+  [[nodiscard]]
+  const std::unordered_map<std::string, JsonObjectPtr>* TryGetMap() const noexcept {
+    return std::get_if<MapType>(&_data);
+  }
+
+  /**
+   * @brief Get the map value represented by this JSON object, if it is a map value with flat storage.
+   *
+   * @return pointer to the map value, or null if this JSON object is not a map value with flat storage.
+   */
+  [[nodiscard]]
+  JsonFlatMap* TryGetFlatMap() noexcept {
+    return std::get_if<FlatMapType>(&_data);
+  }
+
+  /**
+   * @brief Get the map value represented by this JSON object, if it is a map value with flat storage.
+   *
+   * @return pointer to the map value, or null if this JSON object is not a map value with flat storage.
+   */
+  [[nodiscard]]
+  const JsonFlatMap* TryGetFlatMap() const noexcept {
+    return std::get_if<FlatMapType>(&_data);
+  }
+
+  /**
+   * @brief Call the specified function with the map value represented by this JSON object, whichever its storage.
+   *
+   * @tparam Fn type of the function, which is called with either `const std::unordered_map<std::string,
+   * JsonObjectPtr> &` or `const JsonFlatMap &`.
+   * @param fn the function.
+   * @return the return value of the function.
+   */
+  template <typename Fn>
+  decltype(auto) WithMap(Fn&& fn) const {
+    if (IsFlatMap()) {
+      return std::forward<Fn>(fn)(std::get<FlatMapType>(_data));
+    }
+    return std::forward<Fn>(fn)(GetMap());
   }
 
   /**
@@ -311,6 +564,8 @@ public:
    * * `void VisitArray(const JsonObject &)`;
    * * `void VisitMap(const JsonObject &)`.
    *
+   * Maps of both storage modes are passed to `VisitMap`; WithMap gives access to their entries.
+   *
    * @tparam Visitor type of the visitor.
    * @param visitor the visitor.
    */
@@ -342,14 +597,56 @@ public:
     }
   }
 
+  /**
+   * @brief Determine whether this JSON object is structurally equal to the specified one, comparing children by value.
+   */
   [[nodiscard]]
   bool operator==(const JsonObject& rhs) const noexcept {
-    return _data == rhs._data;
+    if (GetType() != rhs.GetType()) {
+      return false;
+    }
+
+    switch (GetType()) {
+      case JsonObjectType::Array: {
+        const auto& lhsArray = GetArray();
+        const auto& rhsArray = rhs.GetArray();
+        return std::equal(lhsArray.begin(), lhsArray.end(), rhsArray.begin(), rhsArray.end(),
+            [](const JsonObjectPtr& lhsChild, const JsonObjectPtr& rhsChild) {
+              return *lhsChild == *rhsChild;
+            });
+      }
+      case JsonObjectType::Map:
+        // Maps are equal regardless of their storage modes.
+        return WithMap([&rhs](const auto& lhsMap) {
+          return rhs.WithMap([&lhsMap](const auto& rhsMap) {
+            if (lhsMap.size() != rhsMap.size()) {
+              return false;
+            }
+            for (const auto& [key, child] : lhsMap) {
+              auto it = rhsMap.find(key);
+              if (it == rhsMap.end() || *child != *it->second) {
+                return false;
+              }
+            }
+            return true;
+          });
+        });
+      case JsonObjectType::Null:
+        return true;
+      case JsonObjectType::Boolean:
+        return std::get<BooleanType>(_data) == std::get<BooleanType>(rhs._data);
+      case JsonObjectType::Number:
+        return std::get<NumberType>(_data) == std::get<NumberType>(rhs._data);
+      case JsonObjectType::String:
+        return std::get<StringType>(_data) == std::get<StringType>(rhs._data);
+      default:
+        UNREACHABLE();
+    }
   }
 
   [[nodiscard]]
   bool operator!=(const JsonObject& rhs) const noexcept {
-    return _data != rhs._data;
+    return !(*this == rhs);
   }
 
 private:
@@ -357,8 +654,12 @@ private:
   using BooleanType = bool;
   using NumberType = double;
   using StringType = std::string;
-  using ArrayType = std::vector<std::unique_ptr<JsonObject>>;
-  using MapType = std::unordered_map<std::string, std::unique_ptr<JsonObject>>;
+  using ArrayType = std::vector<JsonObjectPtr>;
+  using MapType = std::unordered_map<std::string, JsonObjectPtr>;
+  using FlatMapType = JsonFlatMap;
+
+  // Flat maps come after the alternatives that correspond to JsonObjectType in order.
+  constexpr static const size_t FlatMapIndex = static_cast<size_t>(JsonObjectType::Map) + 1;
 
   std::variant<
       NullType,
@@ -366,9 +667,207 @@ private:
       NumberType,
       StringType,
       ArrayType,
-      MapType> _data;
+      MapType,
+      FlatMapType> _data;
+
+  template <typename Alternative>
+  Alternative& GetValue() {
+    auto value = std::get_if<Alternative>(&_data);
+    if (UNLIKELY(!value)) {
+      throw JsonException { };
+    }
+    return *value;
+  }
+
+  template <typename Alternative>
+  const Alternative& GetValue() const {
+    auto value = std::get_if<Alternative>(&_data);
+    if (UNLIKELY(!value)) {
+      throw JsonException { };
+    }
+    return *value;
+  }
+
+  /**
+   * @brief Copy the specified JSON object without its children.
+   *
+   * @param other the JSON object to copy.
+   *
+   * @return the copy, which is an empty array or map of the same storage mode if the JSON object is an array or a map.
+   */
+  [[nodiscard]]
+  static JsonObject CopyValue(const JsonObject& other) {
+    switch (other._data.index()) {
+      case static_cast<size_t>(JsonObjectType::Null):
+        return JsonObject { nullptr };
+      case static_cast<size_t>(JsonObjectType::Boolean):
+        return JsonObject { std::get<BooleanType>(other._data) };
+      case static_cast<size_t>(JsonObjectType::Number):
+        return JsonObject { std::get<NumberType>(other._data) };
+      case static_cast<size_t>(JsonObjectType::String):
+        return JsonObject { std::get<StringType>(other._data) };
+      case static_cast<size_t>(JsonObjectType::Array):
+        return CreateArray();
+      case static_cast<size_t>(JsonObjectType::Map):
+        return CreateMap(JsonMapStorage::Hashed);
+      case FlatMapIndex:
+        return CreateMap(JsonMapStorage::Flat);
+      default:
+        UNREACHABLE();
+    }
+  }
+
+  /**
+   * @brief Copy the descendants of the specified JSON object into the specified copy of it, made by CopyValue, without
+   * recursion.
+   *
+   * @param source the JSON object to copy.
+   * @param target the copy.
+   * @param allocator the object allocator of the copied nodes, or null to allocate every copied node from the memory
+   * resource of the node it is copied from.
+   * @throw std::bad_alloc if the allocation fails, in which case the target holds part of the descendants.
+   */
+  static void CopyDescendants(const JsonObject& source, JsonObject& target,
+                              const ObjectAllocator<JsonObject>* allocator) {
+    std::vector<std::pair<const JsonObject *, JsonObject *>> pending;
+    pending.emplace_back(&source, &target);
+    auto copy = [allocator, &pending](const JsonObjectPtr& child) {
+      if (UNLIKELY(!child)) {
+        return JsonObjectPtr { };
+      }
+      auto clone = MakeObject<JsonObject>(allocator ? *allocator : child.get_deleter().GetAllocator(),
+                                          CopyValue(*child));
+      if (child->HasChildren()) {
+        pending.emplace_back(child.get(), clone.get());
+      }
+      return clone;
+    };
+
+    while (!pending.empty()) {
+      auto [from, to] = pending.back();
+      pending.pop_back();
+      switch (from->_data.index()) {
+        case static_cast<size_t>(JsonObjectType::Array): {
+          const auto& children = std::get<ArrayType>(from->_data);
+          auto& copies = std::get<ArrayType>(to->_data);
+          copies.reserve(children.size());
+          for (const auto& child : children) {
+            copies.push_back(copy(child));
+          }
+          break;
+        }
+        case static_cast<size_t>(JsonObjectType::Map): {
+          const auto& children = std::get<MapType>(from->_data);
+          auto& copies = std::get<MapType>(to->_data);
+          copies.reserve(children.size());
+          for (const auto& [key, child] : children) {
+            copies.emplace(key, copy(child));
+          }
+          break;
+        }
+        case FlatMapIndex: {
+          const auto& children = std::get<FlatMapType>(from->_data);
+          auto& copies = std::get<FlatMapType>(to->_data);
+          copies.reserve(children.size());
+          for (const auto& [key, child] : children) {
+            copies.emplace(key, copy(child));
+          }
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  }
+
+  /**
+   * @brief Determine whether this JSON object is a non-empty array or map.
+   */
+  [[nodiscard]]
+  bool HasChildren() const noexcept {
+    switch (_data.index()) {
+      case static_cast<size_t>(JsonObjectType::Array):
+        return !std::get<ArrayType>(_data).empty();
+      case static_cast<size_t>(JsonObjectType::Map):
+        return !std::get<MapType>(_data).empty();
+      case FlatMapIndex:
+        return !std::get<FlatMapType>(_data).empty();
+      default:
+        return false;
+    }
+  }
+
+  /**
+   * @brief Move the children of this JSON object that have children of their own to the end of the specified vector,
+   * leaving null pointers behind.
+   *
+   * @param pending the vector.
+   * @throw std::bad_alloc if the vector cannot grow, in which case the child that failed to move stays in place.
+   */
+  void DetachNestedChildren(std::vector<JsonObjectPtr>& pending) {
+    auto detach = [&pending](JsonObjectPtr& child) {
+      if (child && child->HasChildren()) {
+        pending.push_back(std::move(child));
+      }
+    };
+
+    switch (_data.index()) {
+      case static_cast<size_t>(JsonObjectType::Array):
+        for (auto& child : std::get<ArrayType>(_data)) {
+          detach(child);
+        }
+        break;
+      case static_cast<size_t>(JsonObjectType::Map):
+        for (auto& entry : std::get<MapType>(_data)) {
+          detach(entry.second);
+        }
+        break;
+      case FlatMapIndex:
+        for (auto& entry : std::get<FlatMapType>(_data)) {
+          detach(entry.second);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  /**
+   * @brief Destroy the descendants of this JSON object without recursion.
+   *
+   * Every node is destroyed only after its nested children have been detached, so the destructor of each node only
+   * releases children without children of their own. Should the explicit stack fail to grow, the remaining nodes are
+   * destroyed recursively.
+   */
+  void ReleaseDescendants() noexcept {
+    std::vector<JsonObjectPtr> pending;
+    try {
+      DetachNestedChildren(pending);
+      while (!pending.empty()) {
+        auto node = std::move(pending.back());
+        pending.pop_back();
+        node->DetachNestedChildren(pending);
+      }
+    } catch (const std::bad_alloc &) {
+      // The nodes that are still attached or pending are destroyed through their destructors.
+    }
+  }
 }; // class JsonObject
 
+/**
+ * @brief Create a new child node allocated from the global allocator.
+ *
+ * @tparam Args types of the constructor arguments of JsonObject.
+ * @param args the constructor arguments.
+ *
+ * @return the created node.
+ */
+template <typename ...Args>
+[[nodiscard]]
+JsonObjectPtr MakeJsonObject(Args&&... args) {
+  return MakeObject<JsonObject>(ObjectAllocator<JsonObject> { }, std::forward<Args>(args)...);
+}
+
 } // namespace kv
 
 #endif // KV_JSON_JSON_OBJECT_H
@@ -0,0 +1,271 @@
+#ifndef KV_JSON_JSON_PARALLEL_SERIALIZER_H
+#define KV_JSON_JSON_PARALLEL_SERIALIZER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "kv/Json/JsonObject.h"
+#include "kv/Json/JsonSerializer.h"
+#include "kv/Json/JsonSink.h"
+
+namespace kv {
+
+/**
+ * @brief Serialize large JSON documents on several threads.
+ *
+ * Arrays and maps with at least the threshold number of elements are partitioned into chunks of consecutive elements,
+ * and every chunk is serialized into a buffer of its own by a pool of threads. The text around the chunks, including
+ * all smaller containers and scalars that are not inside a chunk, is generated sequentially while partitioning. The
+ * buffers are finally concatenated into a string or written to a file descriptor with scatter I/O, so the output is
+ * byte-identical to that of JsonSerializer.
+ *
+ * Elements of a chunk are serialized sequentially, including large containers nested in them. Documents without a
+ * container above the threshold, and serializers with a single thread, serialize sequentially.
+ */
+class JsonParallelSerializer {
+public:
+  /**
+   * @brief The default minimal number of elements of a container that is serialized in parallel.
+   */
+  constexpr static const size_t DefaultParallelThreshold = 4096;
+
+  /**
+   * @brief The number of chunks per thread that a large container is partitioned into.
+   */
+  constexpr static const size_t ChunksPerThread = 4;
+
+  /**
+   * @brief Construct a new JsonParallelSerializer object.
+   *
+   * @param threadCount the number of threads, including the calling thread. Zero selects the number of CPUs.
+   * @param threshold the minimal number of elements of a container that is serialized in parallel.
+   */
+  explicit JsonParallelSerializer(size_t threadCount = 0, size_t threshold = DefaultParallelThreshold) noexcept;
+
+  /**
+   * @brief Get the number of threads, including the calling thread.
+   *
+   * @return the number of threads.
+   */
+  [[nodiscard]]
+  size_t GetThreadCount() const noexcept {
+    return _threadCount;
+  }
+
+  /**
+   * @brief Get the minimal number of elements of a container that is serialized in parallel.
+   *
+   * @return the threshold.
+   */
+  [[nodiscard]]
+  size_t GetThreshold() const noexcept {
+    return _threshold;
+  }
+
+  /**
+   * @brief Serialize the specified JSON object and append the result to the specified string.
+   *
+   * @tparam Node type of the node, such as JsonObject or JsonTapeNode.
+   * @param obj the node to be serialized. The node must not be modified during serialization.
+   * @param output the string to append to.
+   */
+  template <typename Node>
+  void Serialize(const Node& obj, std::string& output) {
+    if (_threadCount <= 1) {
+      SerializeJson(obj, output);
+      return;
+    }
+
+    Plan plan { _threshold, _threadCount * ChunksPerThread };
+    plan.Add(obj);
+    plan.Run(_threadCount);
+    plan.Concatenate(output);
+  }
+
+  /**
+   * @brief Serialize the specified JSON object and write the result to the specified file descriptor.
+   *
+   * @tparam Node type of the node, such as JsonObject or JsonTapeNode.
+   * @param obj the node to be serialized. The node must not be modified during serialization.
+   * @param fd the file descriptor.
+   * @throw std::system_error if writing fails.
+   */
+  template <typename Node>
+  void Serialize(const Node& obj, int fd) {
+    if (_threadCount <= 1) {
+      JsonFileSink sink { fd };
+      JsonSerializer<JsonFileSink> serializer { sink };
+      serializer.Serialize(obj);
+      sink.Flush();
+      return;
+    }
+
+    Plan plan { _threshold, _threadCount * ChunksPerThread };
+    plan.Add(obj);
+    plan.Run(_threadCount);
+    plan.Write(fd);
+  }
+
+private:
+  using Visitor = JsonSerializer<JsonStringSink>::Visitor;
+
+  /**
+   * @brief The output of a document as a sequence of buffers, some of which are filled by tasks.
+   */
+  class Plan {
+  public:
+    /**
+     * @brief The minimal number of elements in a chunk.
+     */
+    constexpr static const size_t MinChunkSize = 64;
+
+    explicit Plan(size_t threshold, size_t chunkCount) noexcept
+      : _buffers(),
+        _tasks(),
+        _threshold(std::max(threshold, static_cast<size_t>(1))),
+        _chunkCount(chunkCount),
+        _literal(false)
+    { }
+
+    /**
+     * @brief Append the specified node to the output.
+     */
+    template <typename Node>
+    void Add(const Node& node) {
+      switch (node.GetType()) {
+        case JsonObjectType::Array: {
+          const auto& arr = node.GetArray();
+          AddContainer('[', ']', arr, arr.size(), [](Visitor& visitor, const auto& element) {
+            element->Visit(visitor);
+          }, [this](const auto& element) {
+            Add(*element);
+          });
+          break;
+        }
+        case JsonObjectType::Map:
+          node.WithMap([this](const auto& map) {
+            AddContainer('{', '}', map, map.size(), [](Visitor& visitor, const auto& entry) {
+              const auto& [key, value] = entry;
+              visitor.WriteKey(key);
+              value->Visit(visitor);
+            }, [this](const auto& entry) {
+              const auto& [key, value] = entry;
+              {
+                JsonStringSink sink { GetLiteral() };
+                Visitor visitor { sink };
+                visitor.WriteKey(key);
+              }
+              Add(*value);
+            });
+          });
+          break;
+        default: {
+          JsonStringSink sink { GetLiteral() };
+          node.Visit(Visitor { sink });
+          break;
+        }
+      }
+    }
+
+    /**
+     * @brief Run all tasks on the specified number of threads, including the calling thread.
+     *
+     * @throw any exception thrown by a task, after all threads have finished.
+     */
+    void Run(size_t threadCount);
+
+    /**
+     * @brief Append all buffers to the specified string.
+     */
+    void Concatenate(std::string& output) const;
+
+    /**
+     * @brief Write all buffers to the specified file descriptor.
+     *
+     * @throw std::system_error if writing fails.
+     */
+    void Write(int fd) const;
+
+  private:
+    using Task = std::function<void(std::string &)>;
+
+    std::vector<std::string> _buffers;
+    // Tasks with the index of the buffer they fill.
+    std::vector<std::pair<size_t, Task>> _tasks;
+    size_t _threshold;
+    size_t _chunkCount;
+    // Whether the last buffer holds text generated while planning, to which more text can be appended.
+    bool _literal;
+
+    std::string& GetLiteral() {
+      if (!_literal) {
+        _buffers.emplace_back();
+        _literal = true;
+      }
+      return _buffers.back();
+    }
+
+    /**
+     * @brief Append a container to the output, partitioning its elements into chunk tasks if there are at least the
+     * threshold number of them and descending into them otherwise.
+     */
+    template <typename Range, typename WriteElement, typename AddElement>
+    void AddContainer(char open, char close, const Range& range, size_t size, WriteElement write, AddElement add) {
+      GetLiteral().push_back(open);
+
+      if (size < _threshold) {
+        auto first = true;
+        for (const auto& element : range) {
+          if (UNLIKELY(first)) {
+            first = false;
+          } else {
+            GetLiteral().push_back(',');
+          }
+          add(element);
+        }
+        GetLiteral().push_back(close);
+        return;
+      }
+
+      auto chunkSize = std::max((size + _chunkCount - 1) / _chunkCount, MinChunkSize);
+      auto it = range.begin();
+      for (size_t index = 0; index < size; index += chunkSize) {
+        if (index > 0) {
+          GetLiteral().push_back(',');
+        }
+
+        auto count = std::min(chunkSize, size - index);
+        _buffers.emplace_back();
+        _literal = false;
+        _tasks.emplace_back(_buffers.size() - 1, [it, count, write](std::string& buffer) {
+          JsonStringSink sink { buffer };
+          Visitor visitor { sink };
+          auto current = it;
+          for (size_t i = 0; i < count; ++i, ++current) {
+            if (i > 0) {
+              sink.Append(',');
+            }
+            write(visitor, *current);
+          }
+        });
+
+        for (size_t i = 0; i < count; ++i) {
+          ++it;
+        }
+      }
+
+      GetLiteral().push_back(close);
+    }
+  }; // class Plan
+
+  size_t _threadCount;
+  size_t _threshold;
+}; // class JsonParallelSerializer
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_PARALLEL_SERIALIZER_H
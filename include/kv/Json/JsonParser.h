@@ -0,0 +1,248 @@
+#ifndef KV_JSON_JSON_PARSER_H
+#define KV_JSON_JSON_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "kv/Json/JsonException.h"
+#include "kv/Json/JsonObject.h"
+#include "kv/Json/JsonReader.h"
+#include "kv/Json/JsonScanner.h"
+#include "kv/Support/Memory.h"
+
+namespace kv {
+
+/**
+ * @brief Parse JSON text into a JsonObject tree in a single pass.
+ *
+ * The parser builds the tree from the events of a JsonReader, so it accepts the same input and reports the same errors
+ * at the same offsets. Strings are decoded directly into the strings owned by the tree and nodes are moved into place,
+ * so no intermediate copy of the document is made.
+ *
+ * Child nodes are allocated with the object allocator given at construction time, which may be backed by a
+ * MonotonicArena; the arena must then outlive the parsed tree. Maps are created with the storage mode set by
+ * SetMapStorage, which defaults to JsonMapStorage::Hashed.
+ *
+ * @tparam InputIter type of the input iterator, whose value type is char.
+ */
+template <typename InputIter>
+class JsonParser {
+public:
+  /**
+   * @brief The maximal nesting depth of arrays and maps.
+   */
+  constexpr static const size_t MaxDepth = JsonReader<InputIter>::MaxDepth;
+
+  /**
+   * @brief Construct a new JsonParser object.
+   *
+   * @param first the beginning of the JSON text.
+   * @param last the end of the JSON text.
+   * @param allocator the object allocator used for allocating child nodes.
+   * @param offset the offset of the JSON text within an enclosing text, from which reported offsets count.
+   */
+  explicit JsonParser(InputIter first, InputIter last,
+                      ObjectAllocator<JsonObject> allocator = ObjectAllocator<JsonObject>(),
+                      size_t offset = 0) noexcept
+    : _reader(std::move(first), std::move(last), offset),
+      _allocator(allocator),
+      _storage(JsonMapStorage::Hashed)
+  { }
+
+  /**
+   * @brief Feed the parser from the specified structural index of its input.
+   *
+   * @param first the beginning of the structural positions.
+   * @param last the end of the structural positions.
+   *
+   * @see JsonReader::SetStructuralIndex
+   */
+  void SetStructuralIndex(const uint32_t* first, const uint32_t* last) noexcept {
+    _reader.SetStructuralIndex(first, last);
+  }
+
+  /**
+   * @brief Set the storage mode of the maps created by the parser.
+   *
+   * With JsonMapStorage::Flat, maps keep their keys in document order, so serializing the tree reproduces the key order
+   * of the input. A duplicate key keeps the position of its first occurrence and the value of its last.
+   *
+   * @param storage the storage mode.
+   */
+  void SetMapStorage(JsonMapStorage storage) noexcept {
+    _storage = storage;
+  }
+
+  /**
+   * @brief Parse the JSON text into a JsonObject tree.
+   *
+   * The text must consist of exactly one JSON value, optionally surrounded by whitespace.
+   *
+   * @return the root of the parsed tree.
+   * @throw JsonParseException if the text is not valid JSON.
+   */
+  [[nodiscard]]
+  JsonObject Parse() {
+    TreeBuilder builder { _allocator, _storage };
+    _reader.Read(builder);
+    return builder.GetRoot();
+  }
+
+  /**
+   * @brief Get the number of bytes consumed so far.
+   *
+   * @return the number of bytes consumed.
+   */
+  [[nodiscard]]
+  size_t GetOffset() const noexcept {
+    return _reader.GetOffset();
+  }
+
+private:
+  /**
+   * @brief JsonReader handler that places every value into the tree.
+   */
+  class TreeBuilder {
+  public:
+    explicit TreeBuilder(ObjectAllocator<JsonObject> allocator, JsonMapStorage storage) noexcept
+      : _root(nullptr),
+        _allocator(allocator),
+        _storage(storage)
+    { }
+
+    [[nodiscard]]
+    JsonObject GetRoot() noexcept {
+      return std::move(_root);
+    }
+
+    void VisitNull() {
+      Place(JsonObject { nullptr });
+    }
+
+    void VisitBoolean(bool value) {
+      Place(JsonObject { value });
+    }
+
+    void VisitNumber(double value) {
+      Place(JsonObject { value });
+    }
+
+    void VisitString(std::string&& value) {
+      Place(JsonObject { std::move(value) });
+    }
+
+    void VisitArray() {
+      _stack.push_back(Place(JsonObject::CreateArray()));
+    }
+
+    void VisitArrayEnd() noexcept {
+      _stack.pop_back();
+    }
+
+    void VisitMap() {
+      _stack.push_back(Place(JsonObject::CreateMap(_storage)));
+    }
+
+    void VisitKey(std::string&& key) {
+      _key = std::move(key);
+    }
+
+    void VisitMapEnd() noexcept {
+      _stack.pop_back();
+    }
+
+  private:
+    JsonObject _root;
+    std::vector<JsonObject *> _stack;
+    std::string _key;
+    ObjectAllocator<JsonObject> _allocator;
+    JsonMapStorage _storage;
+
+    /**
+     * @brief Place the specified value at the current position of the tree, and return the placed value.
+     */
+    JsonObject* Place(JsonObject value) {
+      if (_stack.empty()) {
+        _root = std::move(value);
+        return &_root;
+      }
+
+      auto parent = _stack.back();
+      auto node = MakeObject<JsonObject>(_allocator, std::move(value));
+      auto ptr = node.get();
+      if (parent->IsFlatMap()) {
+        parent->GetFlatMap().insert_or_assign(std::move(_key), std::move(node));
+      } else if (parent->IsMap()) {
+        parent->GetMap().insert_or_assign(std::move(_key), std::move(node));
+      } else {
+        parent->GetArray().push_back(std::move(node));
+      }
+      return ptr;
+    }
+  }; // class TreeBuilder
+
+  JsonReader<InputIter> _reader;
+  ObjectAllocator<JsonObject> _allocator;
+  JsonMapStorage _storage;
+}; // class JsonParser
+
+/**
+ * @brief Parse the specified JSON text into a JsonObject tree.
+ *
+ * Text of at least MinIndexedJsonSize bytes is first scanned into a structural index with the best instruction set of
+ * this machine.
+ *
+ * @param text the JSON text.
+ * @param allocator the object allocator used for allocating child nodes.
+ * @param storage the storage mode of maps.
+ *
+ * @return the root of the parsed tree.
+ * @throw JsonParseException if the text is not valid JSON.
+ */
+[[nodiscard]]
+inline JsonObject ParseJson(std::string_view text,
+                            ObjectAllocator<JsonObject> allocator = ObjectAllocator<JsonObject>(),
+                            JsonMapStorage storage = JsonMapStorage::Hashed) {
+  JsonParser<const char *> parser { text.data(), text.data() + text.size(), allocator };
+  parser.SetMapStorage(storage);
+  if (text.size() < MinIndexedJsonSize || text.size() > MaxIndexedJsonSize) {
+    return parser.Parse();
+  }
+
+  std::vector<uint32_t> structurals;
+  ScanJsonStructurals(text, structurals);
+  parser.SetStructuralIndex(structurals.data(), structurals.data() + structurals.size());
+  return parser.Parse();
+}
+
+/**
+ * @brief Parse the JSON text read from the specified stream into a JsonObject tree.
+ *
+ * The stream is read up to its end.
+ *
+ * @param input the input stream.
+ * @param allocator the object allocator used for allocating child nodes.
+ * @param storage the storage mode of maps.
+ *
+ * @return the root of the parsed tree.
+ * @throw JsonParseException if the text is not valid JSON.
+ */
+[[nodiscard]]
+inline JsonObject ParseJson(std::istream& input,
+                            ObjectAllocator<JsonObject> allocator = ObjectAllocator<JsonObject>(),
+                            JsonMapStorage storage = JsonMapStorage::Hashed) {
+  JsonParser<std::istreambuf_iterator<char>> parser {
+      std::istreambuf_iterator<char> { input }, std::istreambuf_iterator<char> { }, allocator };
+  parser.SetMapStorage(storage);
+  return parser.Parse();
+}
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_PARSER_H
@@ -0,0 +1,341 @@
+#ifndef KV_JSON_JSON_PATH_H
+#define KV_JSON_JSON_PATH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "kv/Json/JsonDocument.h"
+#include "kv/Json/JsonObject.h"
+#include "kv/Json/JsonTape.h"
+
+namespace kv {
+
+/**
+ * @brief A JSON Pointer (RFC 6901), optionally with wildcards, compiled into a plan that can be evaluated against many
+ * documents.
+ *
+ * A pointer is either empty, which refers to the root, or a sequence of reference tokens each preceded by `/`. Within
+ * a token, `~0` stands for `~` and `~1` for `/`. A token that consists of `*` alone is a wildcard, which matches every
+ * element of an array and every entry of a map; as an extension to RFC 6901, `~2` stands for a literal `*`, so a key
+ * that is a single asterisk can still be referred to. Any other token matches the entry of a map with the token as its
+ * key, or the element of an array at the index the token denotes, if the token is `0` or a decimal number without
+ * leading zeros. For example, the path of the tokens `spans`, `*`, `attrs` and `latency` refers to the latency
+ * attribute of every span.
+ *
+ * Compiling decodes the tokens, parses the array indices and hashes the keys once, so evaluating the path does not
+ * re-parse it. Paths evaluate against JsonObject trees, JsonTape nodes and JsonDocument values alike. Matches are
+ * produced in document order, except under wildcards over maps with hashed storage, whose entries come in unspecified
+ * order. Wildcards over the maps of tapes and documents also visit entries whose keys occur more than once.
+ *
+ * Objects of this class are immutable and therefore thread safe.
+ */
+class JsonPath {
+public:
+  /**
+   * @brief Construct a new JsonPath object that refers to the root.
+   */
+  explicit JsonPath() noexcept = default;
+
+  /**
+   * @brief Construct a new JsonPath object by compiling the specified pointer.
+   *
+   * @param pointer the pointer.
+   * @throw JsonParseException if the pointer is malformed, that is, is not empty and does not start with `/`, or
+   * contains `~` not followed by `0`, `1` or `2`.
+   */
+  explicit JsonPath(std::string_view pointer);
+
+  /**
+   * @brief Get the number of reference tokens of this path.
+   *
+   * @return the number of tokens, which is 0 for the root.
+   */
+  [[nodiscard]]
+  size_t GetTokenCount() const noexcept {
+    return _steps.size();
+  }
+
+  /**
+   * @brief Determine whether this path contains wildcards, and may therefore match more than one value.
+   *
+   * @return whether this path contains wildcards.
+   */
+  [[nodiscard]]
+  bool HasWildcards() const noexcept {
+    return _wildcards;
+  }
+
+  /**
+   * @brief Get the pointer that this path was compiled from, in canonical form.
+   *
+   * @return the pointer, in which `~`, `/` and literal `*` tokens are escaped.
+   */
+  [[nodiscard]]
+  std::string ToString() const;
+
+  /**
+   * @brief Find the first value that this path matches in the specified tree.
+   *
+   * @param root the root of the tree.
+   * @return pointer to the value, or null if the path matches nothing.
+   */
+  [[nodiscard]]
+  const JsonObject* Find(const JsonObject& root) const noexcept {
+    return FindFirst(root);
+  }
+
+  /**
+   * @brief Find the first value that this path matches in the specified tape subtree.
+   *
+   * @param root the root of the subtree.
+   * @return pointer to the value, or null if the path matches nothing.
+   */
+  [[nodiscard]]
+  const JsonTapeNode* Find(const JsonTapeNode& root) const noexcept {
+    return FindFirst(root);
+  }
+
+  /**
+   * @brief Find the first value that this path matches in the specified lazily decoded value.
+   *
+   * @param root the value.
+   * @return the matched value, or empty if the path matches nothing.
+   * @throw JsonParseException if a key that is compared is malformed.
+   */
+  [[nodiscard]]
+  std::optional<JsonValue> Find(const JsonValue& root) const {
+    std::optional<JsonValue> found;
+    Match(root, 0, [&found](const JsonValue& value) {
+      found = value;
+      return true;
+    });
+    return found;
+  }
+
+  /**
+   * @brief Call the specified function with every value that this path matches in the specified tree.
+   *
+   * @tparam Node type of the node, which is JsonObject, JsonTapeNode or JsonValue.
+   * @tparam Fn type of the function, which is called with `const Node &`.
+   * @param root the root of the tree.
+   * @param fn the function.
+   * @throw JsonParseException if Node is JsonValue and a key that is compared is malformed.
+   */
+  template <typename Node, typename Fn>
+  void ForEach(const Node& root, Fn&& fn) const {
+    Match(root, 0, [&fn](const Node& value) {
+      fn(value);
+      return false;
+    });
+  }
+
+  /**
+   * @brief Find the first value that this path matches in each of the specified trees.
+   *
+   * @tparam Node type of the node, which is JsonObject or JsonTapeNode.
+   * @param roots the roots of the trees.
+   * @return pointers to the first match in each tree, or null for the trees where the path matches nothing, in the
+   * order of the trees.
+   */
+  template <typename Node>
+  [[nodiscard]]
+  std::vector<const Node *> FindEach(const std::vector<const Node *>& roots) const {
+    std::vector<const Node *> matches;
+    matches.reserve(roots.size());
+    for (auto root : roots) {
+      matches.push_back(root ? FindFirst(*root) : nullptr);
+    }
+    return matches;
+  }
+
+private:
+  constexpr static const size_t NoIndex = SIZE_MAX;
+
+  /**
+   * @brief A compiled reference token.
+   */
+  struct Step {
+    std::string key;                    // The decoded token, which is the key of map entries
+    size_t hash;                        // The hash of the key as computed by JsonFlatMap::HashKey
+    size_t index;                       // The array index the token denotes, or NoIndex
+    bool wildcard;                      // Whether the token is a wildcard
+  }; // struct Step
+
+  std::vector<Step> _steps;
+  bool _wildcards = false;
+
+  template <typename Node>
+  const Node* FindFirst(const Node& root) const noexcept {
+    const Node* found = nullptr;
+    Match(root, 0, [&found](const Node& value) {
+      found = &value;
+      return true;
+    });
+    return found;
+  }
+
+  /**
+   * @brief Match the steps from the specified position on against the specified node.
+   *
+   * The recursion is bounded by the number of steps rather than by the depth of the tree.
+   *
+   * @param fn the function called with every match, which returns whether to stop.
+   * @return whether fn asked to stop.
+   */
+  template <typename Node, typename Fn>
+  bool Match(const Node& node, size_t position, const Fn& fn) const {
+    if (position == _steps.size()) {
+      return fn(node);
+    }
+
+    const auto& step = _steps[position];
+    if (UNLIKELY(step.wildcard)) {
+      return ForEachChild(node, [this, position, &fn](const Node& child) {
+        return Match(child, position + 1, fn);
+      });
+    }
+
+    auto child = FindChild(node, step);
+    return child && Match(*child, position + 1, fn);
+  }
+
+  static const JsonObject* FindChild(const JsonObject& node, const Step& step) noexcept {
+    switch (node.GetType()) {
+      case JsonObjectType::Array: {
+        const auto& array = node.GetArray();
+        return step.index < array.size() ? array[step.index].get() : nullptr;
+      }
+      case JsonObjectType::Map:
+        if (auto flat = node.TryGetFlatMap()) {
+          auto it = flat->find(step.key, step.hash);
+          return it == flat->end() ? nullptr : it->second.get();
+        } else {
+          const auto& map = node.GetMap();
+          auto it = map.find(step.key);
+          return it == map.end() ? nullptr : it->second.get();
+        }
+      default:
+        return nullptr;
+    }
+  }
+
+  static const JsonTapeNode* FindChild(const JsonTapeNode& node, const Step& step) noexcept {
+    switch (node.GetType()) {
+      case JsonObjectType::Array: {
+        auto array = node.GetArray();
+        if (step.index >= array.size()) {
+          return nullptr;
+        }
+        auto it = array.begin();
+        for (auto i = step.index; i > 0; --i) {
+          ++it;
+        }
+        return *it;
+      }
+      case JsonObjectType::Map:
+        return node.GetMap().Find(step.key);
+      default:
+        return nullptr;
+    }
+  }
+
+  static std::optional<JsonValue> FindChild(const JsonValue& node, const Step& step) {
+    switch (node.GetType()) {
+      case JsonObjectType::Array: {
+        if (step.index == NoIndex) {
+          return std::nullopt;
+        }
+        auto index = step.index;
+        for (auto element : node.GetArray()) {
+          if (index-- == 0) {
+            return element;
+          }
+        }
+        return std::nullopt;
+      }
+      case JsonObjectType::Map:
+        return node.GetMap().Find(step.key);
+      default:
+        return std::nullopt;
+    }
+  }
+
+  template <typename Fn>
+  static bool ForEachChild(const JsonObject& node, const Fn& fn) {
+    switch (node.GetType()) {
+      case JsonObjectType::Array:
+        for (const auto& child : node.GetArray()) {
+          if (child && fn(*child)) {
+            return true;
+          }
+        }
+        return false;
+      case JsonObjectType::Map:
+        return node.WithMap([&fn](const auto& map) {
+          for (const auto& entry : map) {
+            if (entry.second && fn(*entry.second)) {
+              return true;
+            }
+          }
+          return false;
+        });
+      default:
+        return false;
+    }
+  }
+
+  template <typename Fn>
+  static bool ForEachChild(const JsonTapeNode& node, const Fn& fn) {
+    switch (node.GetType()) {
+      case JsonObjectType::Array:
+        for (auto child : node.GetArray()) {
+          if (fn(*child)) {
+            return true;
+          }
+        }
+        return false;
+      case JsonObjectType::Map:
+        for (auto entry : node.GetMap()) {
+          if (fn(*entry.second)) {
+            return true;
+          }
+        }
+        return false;
+      default:
+        return false;
+    }
+  }
+
+  template <typename Fn>
+  static bool ForEachChild(const JsonValue& node, const Fn& fn) {
+    switch (node.GetType()) {
+      case JsonObjectType::Array:
+        for (auto child : node.GetArray()) {
+          if (fn(child)) {
+            return true;
+          }
+        }
+        return false;
+      case JsonObjectType::Map: {
+        auto map = node.GetMap();
+        for (auto it = map.begin(); it != map.end(); ++it) {
+          if (fn(it.GetValue())) {
+            return true;
+          }
+        }
+        return false;
+      }
+      default:
+        return false;
+    }
+  }
+}; // class JsonPath
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_PATH_H
@@ -0,0 +1,627 @@
+#ifndef KV_JSON_JSON_READER_H
+#define KV_JSON_JSON_READER_H
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "kv/Json/JsonException.h"
+#include "kv/Json/JsonScanner.h"
+#include "kv/Support/Intrinsics.h"
+
+namespace kv {
+
+/**
+ * @brief What JsonReader should do after an event has been delivered to the handler.
+ */
+enum class JsonReadAction {
+  /**
+   * @brief Continue reading.
+   */
+  Continue,
+
+  /**
+   * @brief Skip the value that the event announces without delivering its events.
+   *
+   * Returned from `VisitArray` or `VisitMap`, the content and the end of the container are skipped; returned from
+   * `VisitKey`, the value of the key is skipped. After any other event it has the same effect as Continue. Skipped
+   * values are still validated.
+   */
+  Skip,
+
+  /**
+   * @brief Stop reading immediately. The rest of the text is not examined.
+   */
+  Stop,
+};
+
+/**
+ * @brief The size from which JSON text is scanned into a structural index before being read.
+ */
+constexpr static const size_t MinIndexedJsonSize = 4096;
+
+/**
+ * @brief Read JSON text as a sequence of events without building a tree.
+ *
+ * The handler receives the events through methods named after the `Visit` methods of JsonObject:
+ * * `VisitNull()`;
+ * * `VisitBoolean(bool)`;
+ * * `VisitNumber(double)`;
+ * * `VisitString(std::string&&)`;
+ * * `VisitArray()` and `VisitArrayEnd()`;
+ * * `VisitMap()`, `VisitKey(std::string&&)` and `VisitMapEnd()`.
+ *
+ * Each method returns either void or a JsonReadAction; void counts as JsonReadAction::Continue. String methods may
+ * take a `std::string_view`, which is valid until the method returns, or take ownership of the decoded string. Strings
+ * are decoded into a buffer that is reused between events, so a handler that only looks at a few fields allocates
+ * almost nothing and the memory used by the reader is proportional to the nesting depth rather than to the size of
+ * the text.
+ *
+ * The reader reads every character exactly once, so it works with single-pass iterators such as
+ * `std::istreambuf_iterator<char>` as well as with contiguous buffers. Nesting is handled with an explicit stack
+ * instead of recursion. Contiguous input may come with a structural index built by ScanJsonStructurals, in which case
+ * the reader jumps from token to token instead of stepping over whitespace byte by byte.
+ *
+ * @tparam InputIter type of the input iterator, whose value type is char.
+ */
+template <typename InputIter>
+class JsonReader {
+public:
+  static_assert(std::is_convertible_v<decltype(*std::declval<InputIter &>()), char>,
+      "InputIter should be an iterator over chars");
+
+  /**
+   * @brief The maximal nesting depth of arrays and maps.
+   */
+  constexpr static const size_t MaxDepth = 4096;
+
+  /**
+   * @brief Construct a new JsonReader object.
+   *
+   * @param first the beginning of the JSON text.
+   * @param last the end of the JSON text.
+   * @param offset the offset of the JSON text within an enclosing text, from which reported offsets count.
+   */
+  explicit JsonReader(InputIter first, InputIter last, size_t offset = 0) noexcept
+    : _current(std::move(first)),
+      _end(std::move(last)),
+      _offset(offset),
+      _structural(nullptr),
+      _structuralEnd(nullptr)
+  { }
+
+  /**
+   * @brief Feed the reader from the specified structural index of its input.
+   *
+   * The index must have been built by ScanJsonStructurals over exactly the text between the iterators given at
+   * construction time, and must outlive the reader. Errors are reported at the same offsets with or without the index.
+   *
+   * @param first the beginning of the structural positions.
+   * @param last the end of the structural positions.
+   */
+  void SetStructuralIndex(const uint32_t* first, const uint32_t* last) noexcept {
+    static_assert(IsContiguous, "The structural index can only be used with contiguous input");
+    _structural = first;
+    _structuralEnd = last;
+  }
+
+  /**
+   * @brief Read the JSON text and deliver its events to the specified handler.
+   *
+   * The text must consist of exactly one JSON value, optionally surrounded by whitespace.
+   *
+   * @tparam Handler type of the handler.
+   * @param handler the handler.
+   *
+   * @return true if the whole text has been read, or false if the handler stopped reading.
+   * @throw JsonParseException if the text is not valid JSON.
+   */
+  template <typename Handler>
+  bool Read(Handler& handler) {
+    // Whether each open container is a map.
+    std::vector<bool> stack;
+    // Events are not delivered while the stack is at least this deep.
+    auto muteDepth = NotMuted;
+
+    auto state = State::Value;
+    while (true) {
+      auto muted = muteDepth != NotMuted;
+      switch (state) {
+        case State::Value: {
+          SkipWhitespace();
+          state = State::AfterValue;
+
+          switch (Peek()) {
+            case '{':
+            case '[': {
+              auto isMap = Peek() == '{';
+              Advance();
+              if (UNLIKELY(stack.size() == MaxDepth)) {
+                Fail("nesting too deep", _offset - 1);
+              }
+
+              auto action = JsonReadAction::Continue;
+              if (!muted) {
+                action = isMap ? Notify([&handler]() { return handler.VisitMap(); })
+                               : Notify([&handler]() { return handler.VisitArray(); });
+                if (action == JsonReadAction::Stop) {
+                  return false;
+                }
+              }
+
+              SkipWhitespace();
+              if (Peek() == (isMap ? '}' : ']')) {
+                Advance();
+                if (!muted && action != JsonReadAction::Skip && NotifyEnd(handler, isMap) == JsonReadAction::Stop) {
+                  return false;
+                }
+                break;
+              }
+
+              stack.push_back(isMap);
+              if (action == JsonReadAction::Skip) {
+                muteDepth = stack.size();
+              }
+              state = isMap ? State::Key : State::Value;
+              break;
+            }
+            case '"':
+              Advance();
+              ParseString();
+              if (!muted && Notify([&]() { return handler.VisitString(std::move(_string)); }) == JsonReadAction::Stop) {
+                return false;
+              }
+              break;
+            case 't':
+              ParseLiteral("true");
+              if (!muted && Notify([&handler]() { return handler.VisitBoolean(true); }) == JsonReadAction::Stop) {
+                return false;
+              }
+              break;
+            case 'f':
+              ParseLiteral("false");
+              if (!muted && Notify([&handler]() { return handler.VisitBoolean(false); }) == JsonReadAction::Stop) {
+                return false;
+              }
+              break;
+            case 'n':
+              ParseLiteral("null");
+              if (!muted && Notify([&handler]() { return handler.VisitNull(); }) == JsonReadAction::Stop) {
+                return false;
+              }
+              break;
+            case '-':
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9': {
+              auto value = ParseNumber();
+              if (!muted && Notify([&handler, value]() { return handler.VisitNumber(value); }) == JsonReadAction::Stop) {
+                return false;
+              }
+              break;
+            }
+            case EndOfInput:
+              Fail("unexpected end of input", _offset);
+            default:
+              Fail("unexpected character", _offset);
+          }
+          break;
+        }
+
+        case State::Key: {
+          SkipWhitespace();
+          if (UNLIKELY(Peek() != '"')) {
+            Fail("expected a string as map key", _offset);
+          }
+          Advance();
+          ParseString();
+
+          if (!muted) {
+            auto action = Notify([&]() { return handler.VisitKey(std::move(_string)); });
+            if (action == JsonReadAction::Stop) {
+              return false;
+            }
+            if (action == JsonReadAction::Skip) {
+              // The value lives at the depth of its map, so muting one level deeper covers exactly the value.
+              muteDepth = stack.size() + 1;
+            }
+          }
+
+          SkipWhitespace();
+          if (UNLIKELY(Peek() != ':')) {
+            Fail("expected ':' after map key", _offset);
+          }
+          Advance();
+          state = State::Value;
+          break;
+        }
+
+        case State::AfterValue: {
+          // A skipped value is complete once reading is back above the depth it was muted at.
+          if (muted && stack.size() < muteDepth) {
+            muteDepth = NotMuted;
+            muted = false;
+          }
+
+          if (stack.empty()) {
+            SkipWhitespace();
+            if (UNLIKELY(Peek() != EndOfInput)) {
+              Fail("unexpected trailing content", _offset);
+            }
+            return true;
+          }
+
+          SkipWhitespace();
+          auto isMap = stack.back();
+          auto ch = Peek();
+          if (ch == ',') {
+            Advance();
+            state = isMap ? State::Key : State::Value;
+          } else if (ch == (isMap ? '}' : ']')) {
+            Advance();
+            if (!muted && NotifyEnd(handler, isMap) == JsonReadAction::Stop) {
+              return false;
+            }
+            stack.pop_back();
+          } else {
+            Fail(isMap ? "expected ',' or '}'" : "expected ',' or ']'", _offset);
+          }
+          break;
+        }
+
+        default:
+          UNREACHABLE();
+      }
+    }
+  }
+
+  /**
+   * @brief Get the number of bytes consumed so far.
+   *
+   * @return the number of bytes consumed.
+   */
+  [[nodiscard]]
+  size_t GetOffset() const noexcept {
+    return _offset;
+  }
+
+private:
+  constexpr static const int EndOfInput = -1;
+
+  constexpr static const size_t NotMuted = std::numeric_limits<size_t>::max();
+
+  constexpr static const bool IsContiguous =
+      std::is_same_v<InputIter, const char *> || std::is_same_v<InputIter, char *>;
+
+  enum class State {
+    Value,
+    Key,
+    AfterValue,
+  };
+
+  InputIter _current;
+  InputIter _end;
+  size_t _offset;
+  std::string _string;
+  std::string _scratch;
+  const uint32_t* _structural;
+  const uint32_t* _structuralEnd;
+
+  [[noreturn]]
+  static void Fail(const char* message, size_t offset) {
+    throw JsonParseException { message, offset };
+  }
+
+  template <typename Callback>
+  static JsonReadAction Notify(Callback&& callback) {
+    if constexpr (std::is_void_v<decltype(callback())>) {
+      callback();
+      return JsonReadAction::Continue;
+    } else {
+      return callback();
+    }
+  }
+
+  template <typename Handler>
+  static JsonReadAction NotifyEnd(Handler& handler, bool isMap) {
+    return isMap ? Notify([&handler]() { return handler.VisitMapEnd(); })
+                 : Notify([&handler]() { return handler.VisitArrayEnd(); });
+  }
+
+  [[nodiscard]]
+  int Peek() {
+    return _current == _end ? EndOfInput : static_cast<unsigned char>(*_current);
+  }
+
+  void Advance() {
+    ++_current;
+    ++_offset;
+  }
+
+  [[nodiscard]]
+  int Next() {
+    auto ch = Peek();
+    if (LIKELY(ch != EndOfInput)) {
+      Advance();
+    }
+    return ch;
+  }
+
+  void SkipWhitespace() {
+    if constexpr (IsContiguous) {
+      if (_structural && _current != _end && IsWhitespace(*_current)) {
+        // Outside strings, everything up to the next structural position is whitespace.
+        while (_structural != _structuralEnd && *_structural < _offset) {
+          ++_structural;
+        }
+        auto skipped = _structural == _structuralEnd
+            ? static_cast<size_t>(_end - _current)
+            : static_cast<size_t>(*_structural) - _offset;
+        _current += skipped;
+        _offset += skipped;
+        return;
+      }
+    }
+
+    while (true) {
+      switch (Peek()) {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+          Advance();
+          break;
+        default:
+          return;
+      }
+    }
+  }
+
+  [[nodiscard]]
+  static bool IsWhitespace(char ch) noexcept {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+  }
+
+  void ParseLiteral(const char* literal) {
+    auto start = _offset;
+    for (auto p = literal; *p; ++p) {
+      if (UNLIKELY(Next() != static_cast<unsigned char>(*p))) {
+        Fail("invalid literal", start);
+      }
+    }
+  }
+
+  /**
+   * @brief Parse the rest of a string whose opening quote has been consumed into the string buffer.
+   */
+  void ParseString() {
+    auto start = _offset - 1;
+    _string.clear();
+
+    while (true) {
+      if constexpr (IsContiguous) {
+        // Copy runs of plain characters in bulk.
+        auto run = _current;
+        while (run != _end && *run != '"' && *run != '\\' && static_cast<unsigned char>(*run) >= 0x20) {
+          ++run;
+        }
+        _string.append(_current, run);
+        _offset += static_cast<size_t>(run - _current);
+        _current = run;
+      }
+
+      auto ch = Next();
+      switch (ch) {
+        case '"':
+          return;
+        case '\\':
+          ParseEscape(_string);
+          break;
+        case EndOfInput:
+          Fail("unterminated string", start);
+        default:
+          if (UNLIKELY(ch < 0x20)) {
+            Fail("control character in string", _offset - 1);
+          }
+          _string.push_back(static_cast<char>(ch));
+          break;
+      }
+    }
+  }
+
+  /**
+   * @brief Parse the rest of an escape sequence whose backslash has been consumed, and append the escaped character
+   * to the specified string.
+   */
+  void ParseEscape(std::string& s) {
+    auto start = _offset - 1;
+    switch (Next()) {
+      case '"': s.push_back('"'); break;
+      case '\\': s.push_back('\\'); break;
+      case '/': s.push_back('/'); break;
+      case 'b': s.push_back('\b'); break;
+      case 'f': s.push_back('\f'); break;
+      case 'n': s.push_back('\n'); break;
+      case 'r': s.push_back('\r'); break;
+      case 't': s.push_back('\t'); break;
+      case 'u': {
+        auto codePoint = ParseHex4(start);
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+          // A high surrogate must be followed by an escaped low surrogate.
+          if (UNLIKELY(Next() != '\\' || Next() != 'u')) {
+            Fail("unpaired surrogate in string", start);
+          }
+          auto low = ParseHex4(start);
+          if (UNLIKELY(low < 0xDC00 || low > 0xDFFF)) {
+            Fail("unpaired surrogate in string", start);
+          }
+          codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        } else if (UNLIKELY(codePoint >= 0xDC00 && codePoint <= 0xDFFF)) {
+          Fail("unpaired surrogate in string", start);
+        }
+        AppendUtf8(s, codePoint);
+        break;
+      }
+      default:
+        Fail("invalid escape sequence", start);
+    }
+  }
+
+  [[nodiscard]]
+  uint32_t ParseHex4(size_t start) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      auto ch = Next();
+      uint32_t digit;
+      if (ch >= '0' && ch <= '9') {
+        digit = static_cast<uint32_t>(ch - '0');
+      } else if (ch >= 'a' && ch <= 'f') {
+        digit = static_cast<uint32_t>(ch - 'a' + 10);
+      } else if (ch >= 'A' && ch <= 'F') {
+        digit = static_cast<uint32_t>(ch - 'A' + 10);
+      } else {
+        Fail("invalid unicode escape", start);
+      }
+      value = (value << 4) | digit;
+    }
+    return value;
+  }
+
+  static void AppendUtf8(std::string& s, uint32_t codePoint) {
+    if (codePoint < 0x80) {
+      s.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+      s.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+      s.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+      s.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+      s.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+      s.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+      s.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+      s.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+      s.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+      s.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+  }
+
+  /**
+   * @brief Parse a number according to the JSON grammar `-?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?`.
+   */
+  [[nodiscard]]
+  double ParseNumber() {
+    auto start = _offset;
+    _scratch.clear();
+
+    auto takeDigits = [this]() {
+      auto count = 0;
+      while (Peek() >= '0' && Peek() <= '9') {
+        _scratch.push_back(static_cast<char>(Next()));
+        ++count;
+      }
+      return count;
+    };
+
+    if (Peek() == '-') {
+      _scratch.push_back(static_cast<char>(Next()));
+    }
+
+    if (Peek() == '0') {
+      _scratch.push_back(static_cast<char>(Next()));
+    } else if (UNLIKELY(takeDigits() == 0)) {
+      Fail("invalid number", start);
+    }
+
+    if (Peek() == '.') {
+      _scratch.push_back(static_cast<char>(Next()));
+      if (UNLIKELY(takeDigits() == 0)) {
+        Fail("invalid number", start);
+      }
+    }
+
+    if (Peek() == 'e' || Peek() == 'E') {
+      _scratch.push_back(static_cast<char>(Next()));
+      if (Peek() == '+' || Peek() == '-') {
+        _scratch.push_back(static_cast<char>(Next()));
+      }
+      if (UNLIKELY(takeDigits() == 0)) {
+        Fail("invalid number", start);
+      }
+    }
+
+    double value;
+    auto [end, ec] = std::from_chars(_scratch.data(), _scratch.data() + _scratch.size(), value);
+    if (UNLIKELY(ec == std::errc::result_out_of_range)) {
+      // Some standard libraries also report subnormal and underflowing values as out of range; only overflow is an
+      // error in JSON.
+      value = std::strtod(_scratch.c_str(), nullptr);
+      if (UNLIKELY(!std::isfinite(value))) {
+        Fail("number out of range", start);
+      }
+      return value;
+    }
+    if (UNLIKELY(ec != std::errc { } || end != _scratch.data() + _scratch.size())) {
+      Fail("number out of range", start);
+    }
+    return value;
+  }
+}; // class JsonReader
+
+/**
+ * @brief Read the specified JSON text and deliver its events to the specified handler.
+ *
+ * Text of at least MinIndexedJsonSize bytes is first scanned into a structural index with the best instruction set of
+ * this machine.
+ *
+ * @tparam Handler type of the handler.
+ * @param text the JSON text.
+ * @param handler the handler.
+ *
+ * @return true if the whole text has been read, or false if the handler stopped reading.
+ * @throw JsonParseException if the text is not valid JSON.
+ */
+template <typename Handler>
+bool ReadJson(std::string_view text, Handler& handler) {
+  JsonReader<const char *> reader { text.data(), text.data() + text.size() };
+  if (text.size() < MinIndexedJsonSize || text.size() > MaxIndexedJsonSize) {
+    return reader.Read(handler);
+  }
+
+  std::vector<uint32_t> structurals;
+  ScanJsonStructurals(text, structurals);
+  reader.SetStructuralIndex(structurals.data(), structurals.data() + structurals.size());
+  return reader.Read(handler);
+}
+
+/**
+ * @brief Read the JSON text from the specified stream and deliver its events to the specified handler.
+ *
+ * The stream is read up to its end, or up to the point at which the handler stops reading.
+ *
+ * @tparam Handler type of the handler.
+ * @param input the input stream.
+ * @param handler the handler.
+ *
+ * @return true if the whole text has been read, or false if the handler stopped reading.
+ * @throw JsonParseException if the text is not valid JSON.
+ */
+template <typename Handler>
+bool ReadJson(std::istream& input, Handler& handler) {
+  JsonReader<std::istreambuf_iterator<char>> reader {
+      std::istreambuf_iterator<char> { input }, std::istreambuf_iterator<char> { } };
+  return reader.Read(handler);
+}
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_READER_H
@@ -0,0 +1,101 @@
+#ifndef KV_JSON_JSON_SCANNER_H
+#define KV_JSON_JSON_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace kv {
+
+/**
+ * @brief Instruction sets that the structural scanner can be implemented with.
+ */
+enum class JsonScannerIsa {
+  /**
+   * @brief Portable 64-bit integer code.
+   */
+  Scalar,
+
+  /**
+   * @brief SSE4.2 with carry-less multiplication.
+   */
+  Sse42,
+
+  /**
+   * @brief AVX2 with carry-less multiplication.
+   */
+  Avx2,
+
+  /**
+   * @brief AVX-512BW with carry-less multiplication.
+   */
+  Avx512,
+
+  /**
+   * @brief ARM NEON.
+   */
+  Neon,
+};
+
+/**
+ * @brief The largest JSON text that can be indexed, since positions are stored as 32-bit offsets.
+ */
+constexpr static const size_t MaxIndexedJsonSize = static_cast<size_t>(UINT32_MAX);
+
+/**
+ * @brief Get the name of the specified instruction set.
+ *
+ * @param isa the instruction set.
+ *
+ * @return the name of the instruction set.
+ */
+[[nodiscard]]
+const char* GetJsonScannerIsaName(JsonScannerIsa isa) noexcept;
+
+/**
+ * @brief Determine whether the structural scanner can run with the specified instruction set on this machine.
+ *
+ * @param isa the instruction set.
+ *
+ * @return whether the instruction set is supported.
+ */
+[[nodiscard]]
+bool IsJsonScannerIsaSupported(JsonScannerIsa isa) noexcept;
+
+/**
+ * @brief Get the best instruction set for the structural scanner on this machine, which is detected once at runtime.
+ *
+ * @return the best supported instruction set.
+ */
+[[nodiscard]]
+JsonScannerIsa GetJsonScannerIsa() noexcept;
+
+/**
+ * @brief Build the structural index of the specified JSON text with the best instruction set of this machine.
+ *
+ * The text is scanned in 64-byte blocks that are classified into bitmasks of quotes, backslashes, whitespace and the
+ * structural characters `{}[]:,`. The index lists, in order, the positions of every structural character outside
+ * strings, the opening quote of every string, and the first character of every other token outside strings, such as
+ * numbers, literals and stray characters. Everything between two consecutive positions that is not part of the token
+ * at the first position is whitespace, so a parser can jump from token to token.
+ *
+ * The scanner does not validate the text; malformed text yields an index on which the parser reports the error.
+ *
+ * @param text the JSON text, whose size is at most MaxIndexedJsonSize.
+ * @param positions the vector that receives the positions. Its previous content is discarded.
+ */
+void ScanJsonStructurals(std::string_view text, std::vector<uint32_t>& positions);
+
+/**
+ * @brief Build the structural index of the specified JSON text with the specified instruction set.
+ *
+ * @param text the JSON text, whose size is at most MaxIndexedJsonSize.
+ * @param positions the vector that receives the positions. Its previous content is discarded.
+ * @param isa the instruction set, which must be supported on this machine.
+ */
+void ScanJsonStructurals(std::string_view text, std::vector<uint32_t>& positions, JsonScannerIsa isa);
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_SCANNER_H
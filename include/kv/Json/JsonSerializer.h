@@ -1,26 +1,111 @@
 #ifndef KV_JSON_JSON_SYNTHESISER_H
 #define KV_JSON_JSON_SYNTHESISER_H
 
-#include <iterator>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include "kv/Json/JsonObject.h"
+#include "kv/Json/JsonSink.h"
+#include "kv/Json/JsonTraversal.h"
 
 namespace kv {
 
 namespace details {
 
-template <typename OutputIter>
-inline void WriteString(OutputIter& output, const char* s) {
-  while (*s) {
-    *output++ = *s++;
+/**
+ * @brief Determine whether the specified byte must be escaped in a JSON string.
+ */
+constexpr bool NeedsJsonEscape(char ch) noexcept {
+  return ch == '\"' || ch == '\\' || static_cast<unsigned char>(ch) < 0x20;
+}
+
+/**
+ * @brief Find the first byte in the specified range that must be escaped in a JSON string.
+ *
+ * The range is scanned 16 bytes at a time with SSE2 or NEON where available.
+ *
+ * @return pointer to the first such byte, or last if there is none.
+ */
+inline const char* FindJsonEscape(const char* first, const char* last) noexcept {
+#if defined(__SSE2__)
+  const auto quote = _mm_set1_epi8('\"');
+  const auto backslash = _mm_set1_epi8('\\');
+  const auto control = _mm_set1_epi8(0x1F);
+  for (; last - first >= 16; first += 16) {
+    auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+    auto matches = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)),
+        _mm_cmpeq_epi8(_mm_min_epu8(block, control), block));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+    if (mask) {
+      return first + __builtin_ctz(mask);
+    }
+  }
+#elif defined(__aarch64__)
+  const auto quote = vdupq_n_u8('\"');
+  const auto backslash = vdupq_n_u8('\\');
+  const auto control = vdupq_n_u8(0x20);
+  for (; last - first >= 16; first += 16) {
+    auto block = vld1q_u8(reinterpret_cast<const uint8_t *>(first));
+    auto matches = vorrq_u8(vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, backslash)), vcltq_u8(block, control));
+    // Narrow every byte of the comparison result to 4 bits, which gives a 64-bit mask with 4 bits per byte.
+    auto mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(matches), 4)), 0);
+    if (mask) {
+      return first + (__builtin_ctzll(mask) >> 2);
+    }
+  }
+#endif
+
+  for (; first != last; ++first) {
+    if (NeedsJsonEscape(*first)) {
+      return first;
+    }
   }
+  return last;
 }
 
-template <typename OutputIter>
-inline void WriteString(OutputIter& output, const std::string& s) {
-  WriteString(output, s.c_str());
+/**
+ * @brief The maximal length of a number formatted by FormatJsonNumber.
+ */
+constexpr static const size_t MaxJsonNumberLength = 32;
+
+/**
+ * @brief Format the specified number as the shortest JSON number that parses back to the same value.
+ *
+ * Integral values of magnitude below 2^53 are formatted as integers. NaN and infinities cannot be represented in JSON
+ * and are formatted as null.
+ *
+ * @param buffer the output buffer of at least MaxJsonNumberLength chars.
+ * @param value the number.
+ * @return the length of the formatted number.
+ */
+inline size_t FormatJsonNumber(char* buffer, double value) noexcept {
+  constexpr double MaxExactInteger = 9007199254740992.0;
+
+  if (UNLIKELY(!std::isfinite(value))) {
+    std::memcpy(buffer, "null", 4);
+    return 4;
+  }
+
+  std::to_chars_result result;
+  if (std::abs(value) < MaxExactInteger && value == std::trunc(value) && !(value == 0 && std::signbit(value))) {
+    result = std::to_chars(buffer, buffer + MaxJsonNumberLength, static_cast<int64_t>(value));
+  } else {
+    result = std::to_chars(buffer, buffer + MaxJsonNumberLength, value);
+  }
+  return static_cast<size_t>(result.ptr - buffer);
 }
 
 } // namespace details
@@ -28,77 +113,67 @@ inline void WriteString(OutputIter& output, const std::string& s) {
 /**
  * @brief Serialize JsonObject into JSON representation.
  *
- * @tparam OutputIter type of the output iterator.
+ * Output is written to a JSON sink in bulk: runs of characters that need no escaping are appended at once. Output
+ * may be either a type that satisfies IsJsonSink, such as JsonStringSink or JsonFileSink, which the serializer refers
+ * to, or an output iterator, which the serializer wraps into a JsonIteratorSink of its own.
+ *
+ * @tparam Output type of the JSON sink or of the output iterator.
  */
-template <typename OutputIter>
+template <typename Output>
 class JsonSerializer {
 public:
-  static_assert(
-      std::is_same_v<typename std::iterator_traits<OutputIter>::iterator_category, std::output_iterator_tag>,
-      "OutputIter should be an output iterator");
-  static_assert(
-      std::is_same_v<typename std::iterator_traits<OutputIter>::value_type, char>,
-      "value_type of OutputIter should be char");
+  /**
+   * @brief Type of the JSON sink that receives the output.
+   */
+  using SinkType = std::conditional_t<IsJsonSink<Output>::value, Output, JsonIteratorSink<Output>>;
 
   /**
-   * @brief JsonObject visitor used for generating JSON output.
+   * @brief Visitor used for generating JSON output.
+   *
+   * The visitor works on any node type that provides the accessors and the `Visit` protocol of JsonObject, such as
+   * JsonObject and JsonTapeNode.
    */
   class Visitor {
   public:
     /**
      * @brief Construct a new Visitor object.
      *
-     * @param output the output iterator.
+     * @param sink the JSON sink.
      */
-    explicit Visitor(OutputIter& output) noexcept
-      : _output(output)
+    explicit Visitor(SinkType& sink) noexcept
+      : _sink(sink)
     { }
 
-    void VisitNull(const JsonObject &) {
-      details::WriteString(_output, "null");
+    template <typename Node>
+    void VisitNull(const Node &) {
+      Append("null");
     }
 
-    void VisitBoolean(const JsonObject& obj) {
+    template <typename Node>
+    void VisitBoolean(const Node& obj) {
       auto value = obj.GetBoolean();
       if (value) {
-        details::WriteString(_output, "true");
+        Append("true");
       } else {
-        details::WriteString(_output, "false");
+        Append("false");
       }
     }
 
-    void VisitNumber(const JsonObject& obj) {
-      auto value = obj.template GetNumber();
-      details::WriteString(_output, std::to_string(value));
+    template <typename Node>
+    void VisitNumber(const Node& obj) {
+      char buffer[details::MaxJsonNumberLength];
+      auto size = details::FormatJsonNumber(buffer, obj.GetNumber());
+      _sink.Append(buffer, size);
     }
 
-    void VisitString(const JsonObject& obj) {
-      const auto& s = obj.GetString();
-
-      *_output++ = '\"';
-
-      for (auto ch : s) {
-        switch (ch) {
-          case '\"':
-            details::WriteString(_output, "\\\"");
-            break;
-          case '\n':
-            details::WriteString(_output, "\\n");
-            break;
-          case '\t':
-            details::WriteString(_output, "\\t");
-            break;
-          default:
-            *_output++ = ch;
-            break;
-        }
-      }
-
-      *_output++ = '\"';
+    template <typename Node>
+    void VisitString(const Node& obj) {
+      WriteString(obj.GetString());
     }
 
-    void VisitArray(const JsonObject& obj) {
-      *_output++ = '[';
+    template <typename Node>
+    void VisitArray(const Node& obj) {
+      _sink.Append('[');
 
       auto first = true;
       const auto& arr = obj.GetArray();
@@ -106,67 +181,234 @@ public:
         if (UNLIKELY(first)) {
           first = false;
         } else {
-          *_output++ = ',';
+          _sink.Append(',');
         }
 
-        element->template Visit(*this);
+        element->Visit(*this);
+      }
+
+      _sink.Append(']');
+    }
+
+    template <typename Node>
+    void VisitMap(const Node& obj) {
+      obj.WithMap([this](const auto& map) {
+        WriteMap(map);
+      });
+    }
+
+    /**
+     * @brief Write the specified map key followed by a colon.
+     *
+     * @param key the map key.
+     */
+    void WriteKey(std::string_view key) {
+      WriteString(key);
+      _sink.Append(':');
+    }
+
+  private:
+    SinkType& _sink;
+
+    template <size_t N>
+    void Append(const char (&s)[N]) {
+      _sink.Append(s, N - 1);
+    }
+
+    /**
+     * @brief Write the specified string as a quoted JSON string.
+     *
+     * Runs of bytes that need no escaping, including all non-ASCII bytes, are appended in bulk. Quotes, backslashes
+     * and control characters are escaped, using the short forms where JSON defines them.
+     */
+    void WriteString(std::string_view s) {
+      _sink.Append('\"');
+
+      auto first = s.data();
+      auto last = first + s.size();
+      while (true) {
+        auto escape = details::FindJsonEscape(first, last);
+        _sink.Append(first, static_cast<size_t>(escape - first));
+        if (escape == last) {
+          break;
+        }
+        WriteEscape(*escape);
+        first = escape + 1;
       }
 
-      *_output++ = ']';
+      _sink.Append('\"');
+    }
+
+    void WriteEscape(char ch) {
+      switch (ch) {
+        case '\"':
+          Append("\\\"");
+          break;
+        case '\\':
+          Append("\\\\");
+          break;
+        case '\b':
+          Append("\\b");
+          break;
+        case '\f':
+          Append("\\f");
+          break;
+        case '\n':
+          Append("\\n");
+          break;
+        case '\r':
+          Append("\\r");
+          break;
+        case '\t':
+          Append("\\t");
+          break;
+        default: {
+          constexpr const char* Digits = "0123456789abcdef";
+          auto code = static_cast<unsigned char>(ch);
+          const char escape[] = { '\\', 'u', '0', '0', Digits[code >> 4], Digits[code & 0xF] };
+          _sink.Append(escape, sizeof(escape));
+          break;
+        }
+      }
     }
 
-    void VisitMap(const JsonObject& obj) {
-      *output++ = '{';
+    template <typename Map>
+    void WriteMap(const Map& map) {
+      _sink.Append('{');
 
       auto first = true;
-      const auto& map = obj.GetMap();
       for (const auto& [key, value] : map) {
         if (UNLIKELY(first)) {
           first = false;
         } else {
-          *output++ = ',';
+          _sink.Append(',');
         }
 
-        *output++ = '\"';
-        details::WriteString(_output, key);
-        *output++ = '\"';
-
-        *output++ = ':';
-
-        value->template Visit(*this);
+        WriteKey(key);
+        value->Visit(*this);
       }
 
-      *output++ = '}';
+      _sink.Append('}');
     }
-
-  private:
-    OutputIter& _output;
   }; // class Visitor
 
   /**
-   * @brief Construct a new JsonSerializer object.
+   * @brief Construct a new JsonSerializer object that writes to the specified output iterator.
+   *
+   * This constructor takes part in overload resolution only if Output is an output iterator.
    *
    * @param iter the output iterator.
    */
-  explicit JsonSerializer(OutputIter iter) noexcept
-    : _output(std::move(iter))
+  template <typename T = Output,
+      std::enable_if_t<!IsJsonSink<T>::value, int> = 0>
+  explicit JsonSerializer(Output iter) noexcept
+    : _sink(std::move(iter))
+  { }
+
+  /**
+   * @brief Construct a new JsonSerializer object that writes to the specified JSON sink.
+   *
+   * This constructor takes part in overload resolution only if Output is a JSON sink.
+   *
+   * @param sink the JSON sink. The sink must outlive this serializer.
+   */
+  template <typename T = Output,
+      std::enable_if_t<IsJsonSink<T>::value, int> = 0>
+  explicit JsonSerializer(Output& sink) noexcept
+    : _sink(sink)
   { }
 
   /**
    * @brief Serialize the specified JSON object into JSON representation.
    *
-   * The generated JSON representation is written to the output iterator.
+   * The generated JSON representation is written to the JSON sink.
+   *
+   * @tparam Node type of the node, such as JsonObject or JsonTapeNode.
+   * @param obj the node to be serialized.
+   */
+  template <typename Node>
+  void Serialize(const Node& obj) {
+    obj.Visit(Visitor { _sink });
+  }
+
+  /**
+   * @brief Serialize the specified JSON object tree into JSON representation without recursion.
+   *
+   * The tree is walked with an explicit stack instead of recursing through the visitor, so trees of any depth can be
+   * serialized. Serialize is somewhat faster on trees of moderate depth, such as those produced by the parsers, whose
+   * depth is bounded. The generated JSON representation is written to the JSON sink.
+   *
+   * @param obj the root of the tree to be serialized.
+   */
+  void SerializeIterative(const JsonObject& obj) {
+    Visitor visitor { _sink };
+    for (JsonTreeWalker walker { obj }; !walker.IsDone(); walker.Next()) {
+      const auto& node = walker.GetNode();
+      auto event = walker.GetEvent();
+      if (event == JsonWalkEvent::Leave) {
+        _sink.Append(node.IsArray() ? ']' : '}');
+        continue;
+      }
+
+      if (walker.GetIndex() > 0) {
+        _sink.Append(',');
+      }
+      if (auto key = walker.GetKey()) {
+        visitor.WriteKey(*key);
+      }
+
+      if (event == JsonWalkEvent::Enter) {
+        _sink.Append(node.IsArray() ? '[' : '{');
+      } else {
+        node.Visit(visitor);
+      }
+    }
+  }
+
+  /**
+   * @brief Get the JSON sink that receives the output.
    *
-   * @param obj the JsonObject to be serialized.
+   * @return the JSON sink.
    */
-  void Serialize(const JsonObject& obj) noexcept {
-    obj.template Visit(Visitor { _output });
+  [[nodiscard]]
+  SinkType& GetSink() noexcept {
+    return _sink;
   }
 
 private:
-  OutputIter _output;
+  // Sinks are referred to, and output iterators are wrapped into a sink owned by the serializer.
+  std::conditional_t<IsJsonSink<Output>::value, Output &, JsonIteratorSink<Output>> _sink;
 }; // class JsonSynthesiser
 
+/**
+ * @brief Serialize the specified JSON object and append the result to the specified string.
+ *
+ * @tparam Node type of the node, such as JsonObject or JsonTapeNode.
+ * @param obj the node to be serialized.
+ * @param output the string to append to.
+ */
+template <typename Node>
+void SerializeJson(const Node& obj, std::string& output) {
+  JsonStringSink sink { output };
+  JsonSerializer<JsonStringSink> serializer { sink };
+  serializer.Serialize(obj);
+}
+
+/**
+ * @brief Serialize the specified JSON object into a string.
+ *
+ * @tparam Node type of the node, such as JsonObject or JsonTapeNode.
+ * @param obj the node to be serialized.
+ * @return the JSON representation.
+ */
+template <typename Node>
+[[nodiscard]]
+std::string SerializeJson(const Node& obj) {
+  std::string output;
+  SerializeJson(obj, output);
+  return output;
+}
+
 } // namespace kv
 
 #endif // KV_JSON_JSON_SYNTHESISER_H
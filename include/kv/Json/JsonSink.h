@@ -0,0 +1,193 @@
+#ifndef KV_JSON_JSON_SINK_H
+#define KV_JSON_JSON_SINK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "kv/Support/Intrinsics.h"
+
+namespace kv {
+
+/**
+ * @brief Determine whether the specified type is a JSON sink.
+ *
+ * A JSON sink receives the output of JsonSerializer in bulk. It should define the following methods in corresponding
+ * signature:
+ * * `void Append(char)`;
+ * * `void Append(const char *, size_t)`.
+ *
+ * @tparam T the type.
+ */
+template <typename T, typename = void>
+struct IsJsonSink : std::false_type { }; // struct IsJsonSink
+
+template <typename T>
+struct IsJsonSink<T, std::void_t<
+    decltype(std::declval<T &>().Append(std::declval<char>())),
+    decltype(std::declval<T &>().Append(std::declval<const char *>(), std::declval<size_t>()))>>
+  : std::true_type { }; // struct IsJsonSink
+
+/**
+ * @brief JSON sink that writes to an output iterator.
+ *
+ * Bulk appends are forwarded to std::copy, which writes a whole run at once to iterators that support it, such as
+ * std::ostreambuf_iterator.
+ *
+ * @tparam OutputIter type of the output iterator, which chars can be written to.
+ */
+template <typename OutputIter>
+class JsonIteratorSink {
+public:
+  static_assert(
+      std::is_assignable_v<decltype(*std::declval<OutputIter &>()), char>,
+      "OutputIter should be an iterator that chars can be written to");
+
+  /**
+   * @brief Construct a new JsonIteratorSink object.
+   *
+   * @param output the output iterator.
+   */
+  explicit JsonIteratorSink(OutputIter output) noexcept
+    : _output(std::move(output))
+  { }
+
+  void Append(char ch) {
+    *_output++ = ch;
+  }
+
+  void Append(const char* data, size_t size) {
+    _output = std::copy(data, data + size, std::move(_output));
+  }
+
+  /**
+   * @brief Get the output iterator, which points past the last written char.
+   *
+   * @return the output iterator.
+   */
+  [[nodiscard]]
+  const OutputIter& GetIterator() const noexcept {
+    return _output;
+  }
+
+private:
+  OutputIter _output;
+}; // class JsonIteratorSink
+
+/**
+ * @brief JSON sink that appends to a std::string.
+ *
+ * The string is only appended to, so a string that is cleared and reused keeps its capacity across documents.
+ */
+class JsonStringSink {
+public:
+  /**
+   * @brief Construct a new JsonStringSink object.
+   *
+   * @param output the string to append to. The string must outlive this sink.
+   */
+  explicit JsonStringSink(std::string& output) noexcept
+    : _output(output)
+  { }
+
+  void Append(char ch) {
+    _output.push_back(ch);
+  }
+
+  void Append(const char* data, size_t size) {
+    _output.append(data, size);
+  }
+
+private:
+  std::string& _output;
+}; // class JsonStringSink
+
+/**
+ * @brief JSON sink that writes to a file descriptor through a fixed-size buffer.
+ *
+ * Output is collected in the buffer and written with a single writev when the buffer fills up; appends larger than
+ * the remaining room are written together with the buffer without being copied. The buffer is flushed when the sink
+ * is destroyed, but errors can only be observed by calling Flush explicitly.
+ *
+ * Objects of this class are not thread safe. Objects of this class cannot be copy constructed, move constructed, copy
+ * assigned or move assigned.
+ */
+class JsonFileSink {
+public:
+  /**
+   * @brief The default size of the buffer.
+   */
+  constexpr static const size_t DefaultBufferSize = static_cast<size_t>(64) << 10;
+
+  /**
+   * @brief Construct a new JsonFileSink object.
+   *
+   * @param fd the file descriptor to write to. The sink does not take ownership of the file descriptor.
+   * @param bufferSize the size of the buffer. The size must be positive.
+   */
+  explicit JsonFileSink(int fd, size_t bufferSize = DefaultBufferSize);
+
+  JsonFileSink(const JsonFileSink &) = delete;
+  JsonFileSink(JsonFileSink &&) noexcept = delete;
+
+  /**
+   * @brief Destroy this JsonFileSink object, flushing the buffer and ignoring errors.
+   */
+  ~JsonFileSink() noexcept;
+
+  JsonFileSink& operator=(const JsonFileSink &) = delete;
+  JsonFileSink& operator=(JsonFileSink &&) noexcept = delete;
+
+  void Append(char ch) {
+    if (UNLIKELY(_size == _capacity)) {
+      Flush();
+    }
+    _buffer[_size++] = ch;
+  }
+
+  void Append(const char* data, size_t size) {
+    if (LIKELY(size <= _capacity - _size)) {
+      std::memcpy(_buffer.get() + _size, data, size);
+      _size += size;
+      return;
+    }
+    Write(data, size);
+  }
+
+  /**
+   * @brief Write the buffered output to the file descriptor.
+   *
+   * @throw std::system_error if writing fails. The buffered output is discarded.
+   */
+  void Flush();
+
+  /**
+   * @brief Get the number of bytes written to the file descriptor so far, not counting buffered output.
+   *
+   * @return the number of bytes written.
+   */
+  [[nodiscard]]
+  size_t GetBytesWritten() const noexcept {
+    return _written;
+  }
+
+private:
+  int _fd;
+  std::unique_ptr<char[]> _buffer;
+  size_t _size;
+  size_t _capacity;
+  size_t _written;
+
+  /**
+   * @brief Write the buffered output followed by the specified data to the file descriptor.
+   */
+  void Write(const char* data, size_t size);
+}; // class JsonFileSink
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_SINK_H
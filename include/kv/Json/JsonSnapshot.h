@@ -0,0 +1,738 @@
+#ifndef KV_JSON_JSON_SNAPSHOT_H
+#define KV_JSON_JSON_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "kv/Json/JsonException.h"
+#include "kv/Json/JsonObject.h"
+#include "kv/Json/JsonSink.h"
+#include "kv/Json/JsonTape.h"
+#include "kv/Json/JsonTraversal.h"
+#include "kv/Support/Crc32c.h"
+#include "kv/Support/Intrinsics.h"
+#include "kv/Support/MappedFile.h"
+
+namespace kv {
+
+/**
+ * @brief Kinds of the sections of a snapshot.
+ */
+enum class JsonSnapshotSectionKind : uint32_t {
+  /**
+   * @brief A single JSON value stored as the nodes of a JsonTape.
+   */
+  Document = 1,
+
+  /**
+   * @brief JSON values stored as JsonTape nodes under string keys, with a hash index of the keys.
+   */
+  Index = 2,
+};
+
+namespace details {
+
+/**
+ * @brief The first bytes of a snapshot file.
+ */
+struct JsonSnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byteOrder;                   // ByteOrderMark in the byte order of the writer
+  uint64_t reserved[2];
+}; // struct JsonSnapshotHeader
+
+/**
+ * @brief An entry of the section table, which follows the last section.
+ */
+struct JsonSnapshotSectionEntry {
+  uint64_t offset;                      // The offset of the section from the start of the file
+  uint64_t size;                        // The size of the section in bytes
+  uint32_t kind;
+  uint32_t crc;                         // The CRC-32C of the bytes of the section
+  uint32_t nameSize;
+  uint32_t reserved;
+  char name[32];
+}; // struct JsonSnapshotSectionEntry
+
+/**
+ * @brief The last bytes of a snapshot file.
+ */
+struct JsonSnapshotFooter {
+  uint64_t tableOffset;                 // The offset of the section table from the start of the file
+  uint32_t sectionCount;
+  uint32_t tableCrc;                    // The CRC-32C of the section table
+  uint64_t reserved;
+  char magic[8];
+}; // struct JsonSnapshotFooter
+
+/**
+ * @brief A slot of the hash index of an index section.
+ */
+struct JsonSnapshotSlot {
+  uint64_t hash;
+  uint64_t keyNode;                     // The position of the key node among the nodes of the section, or EmptySlot
+}; // struct JsonSnapshotSlot
+
+/**
+ * @brief The last bytes of an index section, after its nodes and slots.
+ */
+struct JsonSnapshotIndexFooter {
+  uint64_t entryCount;
+  uint64_t nodeCount;
+  uint64_t slotCount;                   // A power of 2
+  uint64_t reserved;
+}; // struct JsonSnapshotIndexFooter
+
+constexpr static const char JsonSnapshotMagic[8] = { 'K', 'V', 'S', 'N', 'A', 'P', '1', '\n' };
+constexpr static const char JsonSnapshotFooterMagic[8] = { 'K', 'V', 'S', 'N', 'E', 'N', 'D', '\n' };
+constexpr static const uint32_t JsonSnapshotVersion = 1;
+constexpr static const uint32_t JsonSnapshotByteOrderMark = 0x01020304;
+constexpr static const uint64_t JsonSnapshotEmptySlot = std::numeric_limits<uint64_t>::max();
+
+static_assert(sizeof(JsonSnapshotHeader) == 32, "JsonSnapshotHeader should be 32 bytes");
+static_assert(sizeof(JsonSnapshotSectionEntry) == 64, "JsonSnapshotSectionEntry should be 64 bytes");
+static_assert(sizeof(JsonSnapshotFooter) == 32, "JsonSnapshotFooter should be 32 bytes");
+static_assert(sizeof(JsonSnapshotSlot) == 16, "JsonSnapshotSlot should be 16 bytes");
+static_assert(sizeof(JsonSnapshotIndexFooter) == 32, "JsonSnapshotIndexFooter should be 32 bytes");
+
+/**
+ * @brief Hash the specified key of an index section with 64-bit FNV-1a, which, unlike std::hash, is the same in every
+ * process that reads the snapshot.
+ */
+inline uint64_t HashJsonSnapshotKey(std::string_view key) noexcept {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (auto ch : key) {
+    hash = (hash ^ static_cast<unsigned char>(ch)) * 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+} // namespace details
+
+/**
+ * @brief Write snapshots, which store JSON values in a form that can be read in place after mapping the file.
+ *
+ * A snapshot consists of named sections. A document section holds one value as the nodes of a JsonTape, which refer
+ * to each other only by relative positions and are therefore valid at any address. An index section holds values
+ * under string keys: a key node followed by the nodes of its value for every entry, and then a hash index of the keys
+ * by their positions. The section table and a footer follow the last section, so sections are written one after
+ * another as they are produced, each with its CRC-32C.
+ *
+ * The writer buffers neither the snapshot nor a section: JsonObject trees are encoded in two passes over the tree, the
+ * first of which computes the spans of arrays and maps, and the nodes are appended to the output as they are encoded.
+ * While an index section is open, the writer keeps 16 bytes per entry for its hash index. All integers are written in
+ * the byte order of this machine, and snapshots written on a machine of the other byte order are rejected by
+ * JsonSnapshot.
+ *
+ * Output may be either a type that satisfies IsJsonSink, such as JsonFileSink or JsonStringSink, which the writer
+ * refers to, or an output iterator, which the writer wraps into a JsonIteratorSink of its own.
+ *
+ * Objects of this class are not thread safe.
+ *
+ * @tparam Output type of the JSON sink or of the output iterator.
+ */
+template <typename Output>
+class JsonSnapshotWriter {
+public:
+  /**
+   * @brief Type of the JSON sink that receives the output.
+   */
+  using SinkType = std::conditional_t<IsJsonSink<Output>::value, Output, JsonIteratorSink<Output>>;
+
+  /**
+   * @brief The longest name of a section.
+   */
+  constexpr static const size_t MaxSectionNameSize = sizeof(details::JsonSnapshotSectionEntry::name);
+
+  /**
+   * @brief Construct a new JsonSnapshotWriter object that writes to the specified output iterator.
+   *
+   * This constructor takes part in overload resolution only if Output is an output iterator.
+   *
+   * @param iter the output iterator.
+   */
+  template <typename T = Output,
+      std::enable_if_t<!IsJsonSink<T>::value, int> = 0>
+  explicit JsonSnapshotWriter(Output iter) noexcept
+    : _sink(std::move(iter))
+  { }
+
+  /**
+   * @brief Construct a new JsonSnapshotWriter object that writes to the specified JSON sink.
+   *
+   * This constructor takes part in overload resolution only if Output is a JSON sink.
+   *
+   * @param sink the JSON sink. The sink must outlive this writer.
+   */
+  template <typename T = Output,
+      std::enable_if_t<IsJsonSink<T>::value, int> = 0>
+  explicit JsonSnapshotWriter(Output& sink) noexcept
+    : _sink(sink)
+  { }
+
+  /**
+   * @brief Write a document section with the specified tree.
+   *
+   * @param name the name of the section.
+   * @param root the root of the tree.
+   * @throw std::invalid_argument if the name is longer than MaxSectionNameSize.
+   * @throw std::logic_error if an index section is open or the snapshot is finished.
+   * @throw JsonException if a string, array or map is too large for a tape.
+   */
+  void WriteDocument(std::string_view name, const JsonObject& root) {
+    BeginSection(name, JsonSnapshotSectionKind::Document);
+    WriteTree(root);
+    EndSection();
+  }
+
+  /**
+   * @brief Write a document section with the specified tape subtree.
+   *
+   * @param name the name of the section.
+   * @param root the root of the subtree.
+   * @throw std::invalid_argument if the name is longer than MaxSectionNameSize.
+   * @throw std::logic_error if an index section is open or the snapshot is finished.
+   */
+  void WriteDocument(std::string_view name, const JsonTapeNode& root) {
+    BeginSection(name, JsonSnapshotSectionKind::Document);
+    WriteNodes(&root, root.GetSpan());
+    EndSection();
+  }
+
+  /**
+   * @brief Open an index section, to which entries are then added until EndIndex.
+   *
+   * @param name the name of the section.
+   * @throw std::invalid_argument if the name is longer than MaxSectionNameSize.
+   * @throw std::logic_error if an index section is open or the snapshot is finished.
+   */
+  void BeginIndex(std::string_view name) {
+    BeginSection(name, JsonSnapshotSectionKind::Index);
+    _entries.clear();
+  }
+
+  /**
+   * @brief Add an entry to the open index section.
+   *
+   * Keys should be unique within a section; if a key is added more than once, lookups find its first entry.
+   *
+   * @param key the key.
+   * @param value the value.
+   * @throw std::logic_error if no index section is open.
+   * @throw JsonException if the key, or a string, array or map of the value is too large for a tape.
+   */
+  void AddEntry(std::string_view key, const JsonObject& value) {
+    BeginEntry(key);
+    WriteTree(value);
+  }
+
+  /**
+   * @brief Add an entry with a tape subtree as its value to the open index section.
+   *
+   * @param key the key.
+   * @param value the root of the subtree.
+   * @throw std::logic_error if no index section is open.
+   * @throw JsonException if the key is too large for a tape.
+   */
+  void AddEntry(std::string_view key, const JsonTapeNode& value) {
+    BeginEntry(key);
+    WriteNodes(&value, value.GetSpan());
+  }
+
+  /**
+   * @brief Close the open index section by writing its hash index.
+   *
+   * @throw std::logic_error if no index section is open.
+   */
+  void EndIndex() {
+    if (UNLIKELY(!_open || _open->kind != static_cast<uint32_t>(JsonSnapshotSectionKind::Index))) {
+      throw std::logic_error { "no index section is open" };
+    }
+
+    // The index is kept at most half full, so that lookups of missing keys stop early.
+    uint64_t slotCount = 1;
+    while (slotCount < _entries.size() * 2) {
+      slotCount *= 2;
+    }
+    std::vector<details::JsonSnapshotSlot> slots(slotCount,
+                                                 details::JsonSnapshotSlot { 0, details::JsonSnapshotEmptySlot });
+    auto mask = slotCount - 1;
+    for (const auto& entry : _entries) {
+      auto slot = entry.hash & mask;
+      while (slots[slot].keyNode != details::JsonSnapshotEmptySlot) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot] = entry;
+    }
+    Write(slots.data(), slots.size() * sizeof(details::JsonSnapshotSlot));
+
+    details::JsonSnapshotIndexFooter footer { _entries.size(), _nodeCount, slotCount, 0 };
+    Write(&footer, sizeof(footer));
+    _entries.clear();
+    _entries.shrink_to_fit();
+    EndSection();
+  }
+
+  /**
+   * @brief Finish the snapshot by writing the section table and the footer.
+   *
+   * The snapshot cannot be written to afterwards. A JsonFileSink still needs to be flushed.
+   *
+   * @throw std::logic_error if an index section is open or the snapshot is finished.
+   */
+  void Finish() {
+    CheckIdle();
+    WriteHeader();
+
+    details::JsonSnapshotFooter footer { };
+    footer.tableOffset = _offset;
+    footer.sectionCount = static_cast<uint32_t>(_sections.size());
+    _crc = 0;
+    Write(_sections.data(), _sections.size() * sizeof(details::JsonSnapshotSectionEntry));
+    footer.tableCrc = _crc;
+    std::memcpy(footer.magic, details::JsonSnapshotFooterMagic, sizeof(footer.magic));
+    Write(&footer, sizeof(footer));
+    _finished = true;
+  }
+
+  /**
+   * @brief Get the number of bytes written so far.
+   *
+   * @return the number of bytes.
+   */
+  [[nodiscard]]
+  uint64_t GetBytesWritten() const noexcept {
+    return _offset;
+  }
+
+  /**
+   * @brief Get the JSON sink that receives the output.
+   *
+   * @return the JSON sink.
+   */
+  [[nodiscard]]
+  SinkType& GetSink() noexcept {
+    return _sink;
+  }
+
+private:
+  // Sinks are referred to, and output iterators are wrapped into a sink owned by the writer.
+  std::conditional_t<IsJsonSink<Output>::value, Output &, JsonIteratorSink<Output>> _sink;
+  uint64_t _offset = 0;
+  uint32_t _crc = 0;                    // The CRC-32C of the open section so far
+  uint64_t _nodeCount = 0;              // The number of nodes of the open section so far
+  bool _finished = false;
+  std::optional<details::JsonSnapshotSectionEntry> _open;
+  std::vector<details::JsonSnapshotSectionEntry> _sections;
+  std::vector<details::JsonSnapshotSlot> _entries; // The keys of the open index section
+  std::vector<uint64_t> _spans;         // The spans of the arrays and maps of the tree being written, in pre-order
+  std::vector<size_t> _pending;         // The positions in _spans of the arrays and maps being counted
+
+  void Write(const void* data, size_t size) {
+    _sink.Append(static_cast<const char *>(data), size);
+    _crc = ComputeCrc32c(data, size, _crc);
+    _offset += size;
+  }
+
+  void WriteHeader() {
+    if (_offset > 0) {
+      return;
+    }
+    details::JsonSnapshotHeader header { };
+    std::memcpy(header.magic, details::JsonSnapshotMagic, sizeof(header.magic));
+    header.version = details::JsonSnapshotVersion;
+    header.byteOrder = details::JsonSnapshotByteOrderMark;
+    Write(&header, sizeof(header));
+  }
+
+  void CheckIdle() const {
+    if (UNLIKELY(_open)) {
+      throw std::logic_error { "an index section is open" };
+    }
+    if (UNLIKELY(_finished)) {
+      throw std::logic_error { "the snapshot is finished" };
+    }
+  }
+
+  void BeginSection(std::string_view name, JsonSnapshotSectionKind kind) {
+    CheckIdle();
+    if (UNLIKELY(name.size() > MaxSectionNameSize)) {
+      throw std::invalid_argument { "snapshot section name too long" };
+    }
+    WriteHeader();
+
+    details::JsonSnapshotSectionEntry entry { };
+    entry.offset = _offset;
+    entry.kind = static_cast<uint32_t>(kind);
+    entry.nameSize = static_cast<uint32_t>(name.size());
+    std::memcpy(entry.name, name.data(), name.size());
+    _open = entry;
+    _crc = 0;
+    _nodeCount = 0;
+  }
+
+  void EndSection() {
+    auto entry = *_open;
+    entry.size = _offset - entry.offset;
+    entry.crc = _crc;
+    _sections.push_back(entry);
+    _open.reset();
+  }
+
+  void BeginEntry(std::string_view key) {
+    if (UNLIKELY(!_open || _open->kind != static_cast<uint32_t>(JsonSnapshotSectionKind::Index))) {
+      throw std::logic_error { "no index section is open" };
+    }
+    auto position = _nodeCount;
+    WriteString(key);
+    _entries.push_back(details::JsonSnapshotSlot { details::HashJsonSnapshotKey(key), position });
+  }
+
+  void WriteNodes(const JsonTapeNode* nodes, size_t count) {
+    Write(nodes, count * sizeof(JsonTapeNode));
+    _nodeCount += count;
+  }
+
+  [[nodiscard]]
+  static uint32_t CheckCount(size_t count) {
+    if (UNLIKELY(count > std::numeric_limits<uint32_t>::max())) {
+      throw JsonException { "array or map too large for a tape" };
+    }
+    return static_cast<uint32_t>(count);
+  }
+
+  [[nodiscard]]
+  static uint64_t GetStringSpan(size_t size) noexcept {
+    return size <= JsonTapeNode::InlineStringCapacity ? 1 : 1 + (size + sizeof(JsonTapeNode) - 1) / sizeof(JsonTapeNode);
+  }
+
+  void WriteString(std::string_view s) {
+    if (UNLIKELY(s.size() > std::numeric_limits<uint32_t>::max())) {
+      throw JsonException { "string too long for a tape" };
+    }
+
+    JsonTapeNode node { JsonObjectType::String, static_cast<uint32_t>(s.size()) };
+    if (s.size() <= JsonTapeNode::InlineStringCapacity) {
+      node._header |= JsonTapeNode::InlineStringFlag |
+          (static_cast<uint32_t>(s.size()) << JsonTapeNode::StringSizeShift);
+      std::memcpy(reinterpret_cast<char *>(&node) + JsonTapeNode::InlineStringOffset, s.data(), s.size());
+      WriteNodes(&node, 1);
+      return;
+    }
+
+    WriteNodes(&node, 1);
+    Write(s.data(), s.size());
+    auto span = GetStringSpan(s.size());
+    auto padding = (span - 1) * sizeof(JsonTapeNode) - s.size();
+    if (padding > 0) {
+      const char zeros[sizeof(JsonTapeNode)] = { };
+      Write(zeros, padding);
+    }
+    _nodeCount += span - 1;
+  }
+
+  /**
+   * @brief Count the nodes of every array and map of the specified tree, in the order in which WriteTree meets them.
+   */
+  void CountSpans(const JsonObject& root) {
+    _spans.clear();
+    _pending.clear();
+    uint64_t count = 0;
+    for (JsonTreeWalker walker { root }; !walker.IsDone(); walker.Next()) {
+      const auto& node = walker.GetNode();
+      auto event = walker.GetEvent();
+      if (event == JsonWalkEvent::Leave) {
+        auto position = _pending.back();
+        _pending.pop_back();
+        _spans[position] = count - _spans[position];
+        continue;
+      }
+
+      if (auto key = walker.GetKey()) {
+        count += GetStringSpan(key->size());
+      }
+      if (event == JsonWalkEvent::Enter) {
+        _pending.push_back(_spans.size());
+        _spans.push_back(count);
+        ++count;
+      } else {
+        count += node.IsString() ? GetStringSpan(node.GetString().size()) : 1;
+      }
+    }
+  }
+
+  void WriteTree(const JsonObject& root) {
+    CountSpans(root);
+
+    size_t next = 0;
+    for (JsonTreeWalker walker { root }; !walker.IsDone(); walker.Next()) {
+      const auto& node = walker.GetNode();
+      auto event = walker.GetEvent();
+      if (event == JsonWalkEvent::Leave) {
+        continue;
+      }
+
+      if (auto key = walker.GetKey()) {
+        WriteString(*key);
+      }
+      switch (node.GetType()) {
+        case JsonObjectType::Null:
+          WriteNode(JsonTapeNode { JsonObjectType::Null });
+          break;
+        case JsonObjectType::Boolean:
+          WriteNode(JsonTapeNode { JsonObjectType::Boolean, 0, node.GetBoolean() ? 1U : 0U });
+          break;
+        case JsonObjectType::Number: {
+          auto value = node.GetNumber();
+          uint64_t bits;
+          std::memcpy(&bits, &value, sizeof(bits));
+          WriteNode(JsonTapeNode { JsonObjectType::Number, 0, bits });
+          break;
+        }
+        case JsonObjectType::String:
+          WriteString(node.GetString());
+          break;
+        case JsonObjectType::Array:
+          WriteNode(JsonTapeNode { JsonObjectType::Array, CheckCount(node.GetArray().size()), _spans[next++] });
+          break;
+        case JsonObjectType::Map: {
+          auto size = node.WithMap([](const auto& map) {
+            return map.size();
+          });
+          WriteNode(JsonTapeNode { JsonObjectType::Map, CheckCount(size), _spans[next++] });
+          break;
+        }
+        default:
+          UNREACHABLE();
+      }
+    }
+  }
+
+  void WriteNode(const JsonTapeNode& node) {
+    WriteNodes(&node, 1);
+  }
+}; // class JsonSnapshotWriter
+
+/**
+ * @brief Describe a section of a snapshot.
+ */
+struct JsonSnapshotSection {
+  std::string_view name;
+  JsonSnapshotSectionKind kind;
+  uint64_t offset;                      // The offset of the section from the start of the snapshot
+  uint64_t size;                        // The size of the section in bytes
+}; // struct JsonSnapshotSection
+
+/**
+ * @brief The entries of an index section of a snapshot, which are read in place.
+ *
+ * Objects of this class are valid as long as their snapshot is alive.
+ */
+class JsonSnapshotIndex {
+public:
+  /**
+   * @brief Get the number of entries.
+   */
+  [[nodiscard]]
+  size_t size() const noexcept {
+    return static_cast<size_t>(_size);
+  }
+
+  [[nodiscard]]
+  bool empty() const noexcept {
+    return _size == 0;
+  }
+
+  /**
+   * @brief Find the value of the specified key.
+   *
+   * @param key the key.
+   * @return pointer to the root node of the value, or null if the index does not contain the key.
+   */
+  [[nodiscard]]
+  const JsonTapeNode* Find(std::string_view key) const noexcept {
+    auto hash = details::HashJsonSnapshotKey(key);
+    for (auto slot = hash & _mask, probes = _mask + 1; probes > 0; slot = (slot + 1) & _mask, --probes) {
+      const auto& candidate = _slots[slot];
+      if (candidate.keyNode == details::JsonSnapshotEmptySlot) {
+        return nullptr;
+      }
+      if (candidate.hash == hash && LIKELY(candidate.keyNode < _nodeCount)) {
+        const auto& keyNode = _nodes[candidate.keyNode];
+        if (keyNode.IsString() && keyNode.GetString() == key) {
+          return keyNode.GetNext();
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Call the specified function with every entry, in the order in which the entries were added.
+   *
+   * @tparam Fn type of the function, which is called with `std::string_view` and `const JsonTapeNode &`.
+   * @param fn the function.
+   * @throw JsonException if the section is corrupt. Call JsonSnapshot::Verify first to rule this out.
+   */
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    auto node = _nodes;
+    for (uint64_t i = 0; i < _size; ++i) {
+      auto value = node->GetNext();
+      fn(node->GetString(), *value);
+      node = value->GetNext();
+    }
+  }
+
+private:
+  friend class JsonSnapshot;
+
+  explicit JsonSnapshotIndex(const JsonTapeNode* nodes, uint64_t nodeCount, const details::JsonSnapshotSlot* slots,
+                             uint64_t slotCount, uint64_t size) noexcept
+    : _nodes(nodes),
+      _nodeCount(nodeCount),
+      _slots(slots),
+      _mask(slotCount - 1),
+      _size(size)
+  { }
+
+  const JsonTapeNode* _nodes;
+  uint64_t _nodeCount;
+  const details::JsonSnapshotSlot* _slots;
+  uint64_t _mask;
+  uint64_t _size;
+}; // class JsonSnapshotIndex
+
+/**
+ * @brief A snapshot written by JsonSnapshotWriter, whose values are read in place.
+ *
+ * Opening a snapshot checks its header, footer and section table, and the bounds of every section, but reads none of
+ * the values, so it takes time proportional to the number of sections only. When the snapshot is mapped from a file,
+ * the pages of a value are faulted in when the value is first read. The checksums of the sections are only checked by
+ * Verify, which reads the whole snapshot; values of a snapshot that is corrupt but has not been verified may be read
+ * out of bounds.
+ *
+ * Objects of this class are immutable and therefore thread safe. Objects of this class cannot be copy constructed or
+ * copy assigned.
+ */
+class JsonSnapshot {
+public:
+  /**
+   * @brief Open the snapshot in the file at the specified path by mapping the file.
+   *
+   * @param path the path of the file.
+   * @throw std::system_error if the file cannot be opened or mapped.
+   * @throw JsonParseException if the file is not a snapshot, or its layout is inconsistent.
+   */
+  explicit JsonSnapshot(const char* path);
+
+  /**
+   * @brief Open the snapshot in the specified memory.
+   *
+   * @param image the bytes of the snapshot, which must be aligned to 16 bytes and outlive this object.
+   * @throw std::invalid_argument if the bytes are not aligned to 16 bytes.
+   * @throw JsonParseException if the bytes are not a snapshot, or their layout is inconsistent.
+   */
+  explicit JsonSnapshot(std::string_view image);
+
+  JsonSnapshot(const JsonSnapshot &) = delete;
+  JsonSnapshot(JsonSnapshot &&) noexcept = default;
+
+  ~JsonSnapshot() = default;
+
+  JsonSnapshot& operator=(const JsonSnapshot &) = delete;
+  JsonSnapshot& operator=(JsonSnapshot &&) noexcept = default;
+
+  /**
+   * @brief Get the number of sections.
+   *
+   * @return the number of sections.
+   */
+  [[nodiscard]]
+  size_t GetSectionCount() const noexcept {
+    return _sectionCount;
+  }
+
+  /**
+   * @brief Describe the section at the specified position.
+   *
+   * @param index the position of the section, which must be less than GetSectionCount.
+   * @return the description of the section.
+   */
+  [[nodiscard]]
+  JsonSnapshotSection GetSection(size_t index) const noexcept;
+
+  /**
+   * @brief Find the first section with the specified name.
+   *
+   * @param name the name.
+   * @return the position of the section, or empty if there is none.
+   */
+  [[nodiscard]]
+  std::optional<size_t> FindSection(std::string_view name) const noexcept;
+
+  /**
+   * @brief Find the document section with the specified name.
+   *
+   * @param name the name.
+   * @return pointer to the root node of the document, or null if there is no document section with the name.
+   */
+  [[nodiscard]]
+  const JsonTapeNode* FindDocument(std::string_view name) const noexcept;
+
+  /**
+   * @brief Find the index section with the specified name.
+   *
+   * @param name the name.
+   * @return the entries of the index, or empty if there is no index section with the name.
+   */
+  [[nodiscard]]
+  std::optional<JsonSnapshotIndex> FindIndex(std::string_view name) const noexcept;
+
+  /**
+   * @brief Check the checksum of the section at the specified position.
+   *
+   * @param index the position of the section, which must be less than GetSectionCount.
+   * @return whether the checksum matches.
+   */
+  [[nodiscard]]
+  bool VerifySection(size_t index) const noexcept;
+
+  /**
+   * @brief Check the checksums of all sections.
+   *
+   * @return whether all checksums match.
+   */
+  [[nodiscard]]
+  bool Verify() const noexcept;
+
+private:
+  std::optional<MappedFile> _file;
+  std::string_view _image;
+  const details::JsonSnapshotSectionEntry* _table;
+  size_t _sectionCount;
+
+  void Open();
+
+  [[nodiscard]]
+  const details::JsonSnapshotSectionEntry* FindEntry(std::string_view name, JsonSnapshotSectionKind kind) const
+      noexcept;
+
+  [[nodiscard]]
+  const char* GetSectionData(const details::JsonSnapshotSectionEntry& entry) const noexcept {
+    return _image.data() + entry.offset;
+  }
+}; // class JsonSnapshot
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_SNAPSHOT_H
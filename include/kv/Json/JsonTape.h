@@ -0,0 +1,759 @@
+#ifndef KV_JSON_JSON_TAPE_H
+#define KV_JSON_JSON_TAPE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "kv/Json/JsonException.h"
+#include "kv/Json/JsonObject.h"
+#include "kv/Json/JsonReader.h"
+#include "kv/Json/JsonScanner.h"
+#include "kv/Support/Intrinsics.h"
+
+namespace kv {
+
+class JsonTapeArray;
+class JsonTapeMap;
+
+template <typename Output>
+class JsonSnapshotWriter;
+
+/**
+ * @brief A 16-byte node of a JsonTape.
+ *
+ * The nodes of a tape are stored contiguously in document order. A node is self-contained: the children of an array
+ * or map follow the node directly, and so do the bytes of a string longer than InlineStringCapacity, so a subtree
+ * occupies a contiguous range of nodes and no pointers need to be chased. Map entries are stored as a string node for
+ * the key followed by the value.
+ *
+ * Nodes provide the same read-only accessors and the same `Visit` protocol as JsonObject, so JsonSerializer can
+ * serialize a tape as well. Nodes can only be obtained from a JsonTape.
+ */
+class JsonTapeNode {
+public:
+  /**
+   * @brief The longest string that is stored within its node.
+   */
+  constexpr static const size_t InlineStringCapacity = 12;
+
+  /**
+   * @brief Get the type of this node.
+   *
+   * @return the type of this node.
+   */
+  [[nodiscard]]
+  JsonObjectType GetType() const noexcept {
+    return static_cast<JsonObjectType>(_header & TypeMask);
+  }
+
+  [[nodiscard]]
+  bool IsNull() const noexcept {
+    return GetType() == JsonObjectType::Null;
+  }
+
+  [[nodiscard]]
+  bool IsBoolean() const noexcept {
+    return GetType() == JsonObjectType::Boolean;
+  }
+
+  [[nodiscard]]
+  bool IsNumber() const noexcept {
+    return GetType() == JsonObjectType::Number;
+  }
+
+  [[nodiscard]]
+  bool IsString() const noexcept {
+    return GetType() == JsonObjectType::String;
+  }
+
+  [[nodiscard]]
+  bool IsArray() const noexcept {
+    return GetType() == JsonObjectType::Array;
+  }
+
+  [[nodiscard]]
+  bool IsMap() const noexcept {
+    return GetType() == JsonObjectType::Map;
+  }
+
+  /**
+   * @brief Get the boolean value represented by this node.
+   *
+   * @return the boolean value.
+   * @throw JsonException if this node is not a boolean.
+   */
+  [[nodiscard]]
+  bool GetBoolean() const {
+    Expect(JsonObjectType::Boolean);
+    return _value != 0;
+  }
+
+  /**
+   * @brief Get the number value represented by this node.
+   *
+   * @tparam T the type of the number value. T should be an arithmetic type.
+   *
+   * @return the number value.
+   * @throw JsonException if this node is not a number.
+   */
+  template <typename T = double>
+  [[nodiscard]]
+  T GetNumber() const {
+    static_assert(std::is_arithmetic_v<T>, "T should be an arithmetic type");
+    Expect(JsonObjectType::Number);
+
+    double value;
+    std::memcpy(&value, &_value, sizeof(value));
+    return static_cast<T>(value);
+  }
+
+  /**
+   * @brief Get the string value represented by this node.
+   *
+   * @return the string value, which is valid as long as the tape is alive.
+   * @throw JsonException if this node is not a string.
+   */
+  [[nodiscard]]
+  std::string_view GetString() const {
+    Expect(JsonObjectType::String);
+    if (_header & InlineStringFlag) {
+      return std::string_view { reinterpret_cast<const char *>(this) + InlineStringOffset,
+                                static_cast<size_t>(_header >> StringSizeShift) };
+    }
+    return std::string_view { reinterpret_cast<const char *>(this + 1), static_cast<size_t>(_count) };
+  }
+
+  /**
+   * @brief Get the array represented by this node.
+   *
+   * @return a view of the array.
+   * @throw JsonException if this node is not an array.
+   */
+  [[nodiscard]]
+  JsonTapeArray GetArray() const;
+
+  /**
+   * @brief Get the map represented by this node.
+   *
+   * @return a view of the map.
+   * @throw JsonException if this node is not a map.
+   */
+  [[nodiscard]]
+  JsonTapeMap GetMap() const;
+
+  /**
+   * @brief Call the specified function with the map represented by this node.
+   *
+   * This mirrors JsonObject::WithMap, so generic visitors can reach the entries of either representation.
+   *
+   * @tparam Fn type of the function, which is called with a JsonTapeMap.
+   * @param fn the function.
+   * @return the return value of the function.
+   * @throw JsonException if this node is not a map.
+   */
+  template <typename Fn>
+  decltype(auto) WithMap(Fn&& fn) const {
+    return std::forward<Fn>(fn)(GetMap());
+  }
+
+  /**
+   * @brief Get the number of nodes that this node and its descendants occupy.
+   *
+   * @return the number of nodes, which is at least 1.
+   */
+  [[nodiscard]]
+  size_t GetSpan() const noexcept {
+    switch (GetType()) {
+      case JsonObjectType::String:
+        return (_header & InlineStringFlag) ? 1 : 1 + (static_cast<size_t>(_count) + sizeof(JsonTapeNode) - 1) /
+            sizeof(JsonTapeNode);
+      case JsonObjectType::Array:
+      case JsonObjectType::Map:
+        return static_cast<size_t>(_value);
+      default:
+        return 1;
+    }
+  }
+
+  /**
+   * @brief Get the node right after the subtree rooted at this node.
+   *
+   * @return pointer to the node after this subtree.
+   */
+  [[nodiscard]]
+  const JsonTapeNode* GetNext() const noexcept {
+    return this + GetSpan();
+  }
+
+  /**
+   * @brief Visit the subtree rooted at this node with the specified visitor.
+   *
+   * The visitor should define the `Visit` methods described in JsonObject::Visit, taking `const JsonTapeNode &`.
+   *
+   * @tparam Visitor type of the visitor.
+   * @param visitor the visitor.
+   */
+  template <typename Visitor>
+  void Visit(Visitor&& visitor) const {
+    switch (GetType()) {
+      case JsonObjectType::Null:
+        visitor.VisitNull(*this);
+        break;
+      case JsonObjectType::Boolean:
+        visitor.VisitBoolean(*this);
+        break;
+      case JsonObjectType::Number:
+        visitor.VisitNumber(*this);
+        break;
+      case JsonObjectType::String:
+        visitor.VisitString(*this);
+        break;
+      case JsonObjectType::Array:
+        visitor.VisitArray(*this);
+        break;
+      case JsonObjectType::Map:
+        visitor.VisitMap(*this);
+        break;
+      default:
+        UNREACHABLE();
+    }
+  }
+
+private:
+  friend class JsonTape;
+  friend class JsonTapeArray;
+  friend class JsonTapeMap;
+  template <typename Output>
+  friend class JsonSnapshotWriter;
+
+  constexpr static const uint32_t TypeMask = 0x7;
+  constexpr static const uint32_t InlineStringFlag = 0x8;
+  constexpr static const uint32_t StringSizeShift = 8;
+  constexpr static const size_t InlineStringOffset = 4;
+
+  // Type, inline string flag and inline string size.
+  uint32_t _header;
+  // Number of elements, number of entries, or size of a string stored in the following nodes.
+  uint32_t _count;
+  // Boolean value, bits of a number, or span of an array or map.
+  uint64_t _value;
+
+  explicit JsonTapeNode(JsonObjectType type, uint32_t count = 0, uint64_t value = 0) noexcept
+    : _header(static_cast<uint32_t>(type)),
+      _count(count),
+      _value(value)
+  { }
+
+  void Expect(JsonObjectType type) const {
+    if (UNLIKELY(GetType() != type)) {
+      throw JsonException { };
+    }
+  }
+}; // class JsonTapeNode
+
+static_assert(sizeof(JsonTapeNode) == 16, "JsonTapeNode should be 16 bytes");
+static_assert(std::is_trivially_copyable_v<JsonTapeNode>, "JsonTapeNode should be trivially copyable");
+
+/**
+ * @brief View of the elements of an array node.
+ */
+class JsonTapeArray {
+public:
+  /**
+   * @brief Forward iterator over the elements of an array, which yields pointers to the element nodes.
+   */
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = const JsonTapeNode *;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = const JsonTapeNode *;
+
+    [[nodiscard]]
+    const JsonTapeNode* operator*() const noexcept {
+      return _node;
+    }
+
+    Iterator& operator++() noexcept {
+      _node = _node->GetNext();
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    [[nodiscard]]
+    bool operator==(const Iterator& rhs) const noexcept {
+      return _node == rhs._node;
+    }
+
+    [[nodiscard]]
+    bool operator!=(const Iterator& rhs) const noexcept {
+      return _node != rhs._node;
+    }
+
+  private:
+    friend class JsonTapeArray;
+
+    explicit Iterator(const JsonTapeNode* node) noexcept
+      : _node(node)
+    { }
+
+    const JsonTapeNode* _node;
+  }; // class Iterator
+
+  [[nodiscard]]
+  Iterator begin() const noexcept {
+    return Iterator { _node + 1 };
+  }
+
+  [[nodiscard]]
+  Iterator end() const noexcept {
+    return Iterator { _node->GetNext() };
+  }
+
+  [[nodiscard]]
+  size_t size() const noexcept {
+    return static_cast<size_t>(_node->_count);
+  }
+
+  [[nodiscard]]
+  bool empty() const noexcept {
+    return _node->_count == 0;
+  }
+
+private:
+  friend class JsonTapeNode;
+
+  explicit JsonTapeArray(const JsonTapeNode* node) noexcept
+    : _node(node)
+  { }
+
+  const JsonTapeNode* _node;
+}; // class JsonTapeArray
+
+/**
+ * @brief View of the entries of a map node, in document order.
+ */
+class JsonTapeMap {
+public:
+  /**
+   * @brief Forward iterator over the entries of a map, which yields pairs of the key and a pointer to the value node.
+   */
+  class Iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::pair<std::string_view, const JsonTapeNode *>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = value_type;
+
+    [[nodiscard]]
+    value_type operator*() const noexcept {
+      return value_type { _node->GetString(), _node->GetNext() };
+    }
+
+    Iterator& operator++() noexcept {
+      _node = _node->GetNext()->GetNext();
+      return *this;
+    }
+
+    Iterator operator++(int) noexcept {
+      auto old = *this;
+      ++*this;
+      return old;
+    }
+
+    [[nodiscard]]
+    bool operator==(const Iterator& rhs) const noexcept {
+      return _node == rhs._node;
+    }
+
+    [[nodiscard]]
+    bool operator!=(const Iterator& rhs) const noexcept {
+      return _node != rhs._node;
+    }
+
+  private:
+    friend class JsonTapeMap;
+
+    explicit Iterator(const JsonTapeNode* node) noexcept
+      : _node(node)
+    { }
+
+    // The key node of the current entry.
+    const JsonTapeNode* _node;
+  }; // class Iterator
+
+  [[nodiscard]]
+  Iterator begin() const noexcept {
+    return Iterator { _node + 1 };
+  }
+
+  [[nodiscard]]
+  Iterator end() const noexcept {
+    return Iterator { _node->GetNext() };
+  }
+
+  /**
+   * @brief Get the number of entries, including entries with duplicate keys.
+   */
+  [[nodiscard]]
+  size_t size() const noexcept {
+    return static_cast<size_t>(_node->_count);
+  }
+
+  [[nodiscard]]
+  bool empty() const noexcept {
+    return _node->_count == 0;
+  }
+
+  /**
+   * @brief Find the value of the specified key. If the key occurs more than once, the last occurrence wins.
+   *
+   * @param key the key.
+   *
+   * @return pointer to the value node, or null if the map does not contain the key.
+   */
+  [[nodiscard]]
+  const JsonTapeNode* Find(std::string_view key) const noexcept {
+    const JsonTapeNode* found = nullptr;
+    for (auto [entryKey, value] : *this) {
+      if (entryKey == key) {
+        found = value;
+      }
+    }
+    return found;
+  }
+
+  /**
+   * @brief Get the value of the specified key.
+   *
+   * @param key the key.
+   *
+   * @return the value node.
+   * @throw JsonException if the map does not contain the key.
+   */
+  [[nodiscard]]
+  const JsonTapeNode& At(std::string_view key) const {
+    auto value = Find(key);
+    if (UNLIKELY(!value)) {
+      throw JsonException { "key not found in map" };
+    }
+    return *value;
+  }
+
+private:
+  friend class JsonTapeNode;
+
+  explicit JsonTapeMap(const JsonTapeNode* node) noexcept
+    : _node(node)
+  { }
+
+  const JsonTapeNode* _node;
+}; // class JsonTapeMap
+
+inline JsonTapeArray JsonTapeNode::GetArray() const {
+  Expect(JsonObjectType::Array);
+  return JsonTapeArray { this };
+}
+
+inline JsonTapeMap JsonTapeNode::GetMap() const {
+  Expect(JsonObjectType::Map);
+  return JsonTapeMap { this };
+}
+
+/**
+ * @brief A compact, read-only JSON document stored as a contiguous tape of 16-byte nodes.
+ *
+ * Compared with a JsonObject tree, a tape needs no allocation per node, stores short strings inline and keeps every
+ * subtree contiguous, so a document typically occupies about as much memory as its text and is traversed sequentially.
+ *
+ * Maps keep every entry in document order, including duplicate keys; lookups return the last occurrence, as in
+ * JsonParser.
+ */
+class JsonTape {
+public:
+  /**
+   * @brief JsonReader handler that appends the events it receives to a tape.
+   */
+  class Builder {
+  public:
+    explicit Builder() noexcept = default;
+
+    void VisitNull() {
+      AppendValue(JsonTapeNode { JsonObjectType::Null });
+    }
+
+    void VisitBoolean(bool value) {
+      AppendValue(JsonTapeNode { JsonObjectType::Boolean, 0, value ? 1U : 0U });
+    }
+
+    void VisitNumber(double value) {
+      uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      AppendValue(JsonTapeNode { JsonObjectType::Number, 0, bits });
+    }
+
+    void VisitString(std::string_view value) {
+      CountValue();
+      AppendString(value);
+    }
+
+    void VisitArray() {
+      AppendValue(JsonTapeNode { JsonObjectType::Array });
+      _open.push_back(_nodes.size() - 1);
+    }
+
+    void VisitArrayEnd() noexcept {
+      Close();
+    }
+
+    void VisitMap() {
+      AppendValue(JsonTapeNode { JsonObjectType::Map });
+      _open.push_back(_nodes.size() - 1);
+    }
+
+    void VisitKey(std::string_view key) {
+      ++_nodes[_open.back()]._count;
+      AppendString(key);
+    }
+
+    void VisitMapEnd() noexcept {
+      Close();
+    }
+
+    /**
+     * @brief Take the built nodes.
+     */
+    [[nodiscard]]
+    std::vector<JsonTapeNode> TakeNodes() noexcept {
+      return std::move(_nodes);
+    }
+
+  private:
+    std::vector<JsonTapeNode> _nodes;
+    // Node indices of the open arrays and maps.
+    std::vector<size_t> _open;
+
+    void CountValue() noexcept {
+      if (!_open.empty() && _nodes[_open.back()].IsArray()) {
+        ++_nodes[_open.back()]._count;
+      }
+    }
+
+    void AppendValue(const JsonTapeNode& node) {
+      CountValue();
+      _nodes.push_back(node);
+    }
+
+    void AppendString(std::string_view s) {
+      if (UNLIKELY(s.size() > std::numeric_limits<uint32_t>::max())) {
+        throw JsonException { "string too long for a tape" };
+      }
+
+      JsonTapeNode node { JsonObjectType::String, static_cast<uint32_t>(s.size()) };
+      if (s.size() <= JsonTapeNode::InlineStringCapacity) {
+        node._header |= JsonTapeNode::InlineStringFlag |
+            (static_cast<uint32_t>(s.size()) << JsonTapeNode::StringSizeShift);
+        std::memcpy(reinterpret_cast<char *>(&node) + JsonTapeNode::InlineStringOffset, s.data(), s.size());
+        _nodes.push_back(node);
+        return;
+      }
+
+      auto index = _nodes.size();
+      _nodes.resize(index + node.GetSpan(), JsonTapeNode { JsonObjectType::Null });
+      _nodes[index] = node;
+      std::memcpy(reinterpret_cast<char *>(&_nodes[index + 1]), s.data(), s.size());
+    }
+
+    void Close() noexcept {
+      auto index = _open.back();
+      _open.pop_back();
+      _nodes[index]._value = _nodes.size() - index;
+    }
+  }; // class Builder
+
+  /**
+   * @brief Construct a new JsonTape object from the nodes built by a Builder.
+   *
+   * @param builder the builder, which has received the events of exactly one JSON value.
+   */
+  explicit JsonTape(Builder&& builder) noexcept
+    : _nodes(builder.TakeNodes())
+  { }
+
+  /**
+   * @brief Get the root node of the tape.
+   *
+   * @return the root node.
+   */
+  [[nodiscard]]
+  const JsonTapeNode& GetRoot() const noexcept {
+    return _nodes.front();
+  }
+
+  /**
+   * @brief Get the number of nodes in the tape.
+   *
+   * @return the number of nodes.
+   */
+  [[nodiscard]]
+  size_t GetNodeCount() const noexcept {
+    return _nodes.size();
+  }
+
+  /**
+   * @brief Get the number of bytes occupied by the nodes of the tape.
+   *
+   * @return the number of bytes.
+   */
+  [[nodiscard]]
+  size_t GetByteSize() const noexcept {
+    return _nodes.size() * sizeof(JsonTapeNode);
+  }
+
+private:
+  std::vector<JsonTapeNode> _nodes;
+}; // class JsonTape
+
+/**
+ * @brief Parse the specified JSON text into a JsonTape.
+ *
+ * Text of at least MinIndexedJsonSize bytes is first scanned into a structural index with the best instruction set of
+ * this machine.
+ *
+ * @param text the JSON text.
+ *
+ * @return the parsed tape.
+ * @throw JsonParseException if the text is not valid JSON.
+ */
+[[nodiscard]]
+inline JsonTape ParseJsonTape(std::string_view text) {
+  JsonTape::Builder builder;
+  ReadJson(text, builder);
+  return JsonTape { std::move(builder) };
+}
+
+/**
+ * @brief Parse the JSON text read from the specified stream into a JsonTape.
+ *
+ * @param input the input stream, which is read up to its end.
+ *
+ * @return the parsed tape.
+ * @throw JsonParseException if the text is not valid JSON.
+ */
+[[nodiscard]]
+inline JsonTape ParseJsonTape(std::istream& input) {
+  JsonTape::Builder builder;
+  ReadJson(input, builder);
+  return JsonTape { std::move(builder) };
+}
+
+/**
+ * @brief Decode the specified tape subtree into a JsonObject tree.
+ *
+ * The nodes of the subtree are decoded in one sequential pass with an explicit stack, so subtrees of any depth can be
+ * decoded. If a key occurs more than once in a map, the last occurrence wins.
+ *
+ * @param root the root of the subtree.
+ * @param allocator the object allocator used for allocating child nodes.
+ * @param storage the storage of the decoded maps.
+ *
+ * @return the decoded tree.
+ * @throw std::bad_alloc if the allocation fails.
+ */
+[[nodiscard]]
+inline JsonObject ToJsonObject(const JsonTapeNode& root,
+                               ObjectAllocator<JsonObject> allocator = ObjectAllocator<JsonObject>(),
+                               JsonMapStorage storage = JsonMapStorage::Hashed) {
+  struct Frame {
+    JsonObject* target;
+    const JsonTapeNode* end;            // The node after the subtree of the target
+  }; // struct Frame
+
+  JsonObject result { nullptr };
+  std::vector<Frame> stack;
+  std::string_view key;
+  auto place = [&](JsonObject value) -> JsonObject* {
+    if (stack.empty()) {
+      result = std::move(value);
+      return &result;
+    }
+
+    auto parent = stack.back().target;
+    auto node = MakeObject<JsonObject>(allocator, std::move(value));
+    auto ptr = node.get();
+    if (parent->IsFlatMap()) {
+      parent->GetFlatMap().insert_or_assign(std::string { key }, std::move(node));
+    } else if (parent->IsMap()) {
+      parent->GetMap().insert_or_assign(std::string { key }, std::move(node));
+    } else {
+      parent->GetArray().push_back(std::move(node));
+    }
+    return ptr;
+  };
+
+  auto node = &root;
+  auto last = root.GetNext();
+  while (node != last) {
+    while (!stack.empty() && node == stack.back().end) {
+      stack.pop_back();
+    }
+
+    // Within a map, the node after the parent or after a value is a key.
+    if (!stack.empty() && stack.back().target->IsMap() && key.data() == nullptr) {
+      key = node->GetString();
+      node = node->GetNext();
+      continue;
+    }
+
+    switch (node->GetType()) {
+      case JsonObjectType::Null:
+        place(JsonObject { nullptr });
+        break;
+      case JsonObjectType::Boolean:
+        place(JsonObject { node->GetBoolean() });
+        break;
+      case JsonObjectType::Number:
+        place(JsonObject { node->GetNumber() });
+        break;
+      case JsonObjectType::String:
+        place(JsonObject { std::string { node->GetString() } });
+        break;
+      case JsonObjectType::Array:
+        stack.push_back(Frame { place(JsonObject::CreateArray()), node->GetNext() });
+        key = std::string_view { };
+        node = node + 1;
+        continue;
+      case JsonObjectType::Map:
+        stack.push_back(Frame { place(JsonObject::CreateMap(storage)), node->GetNext() });
+        key = std::string_view { };
+        node = node + 1;
+        continue;
+      default:
+        UNREACHABLE();
+    }
+    key = std::string_view { };
+    node = node->GetNext();
+  }
+  return result;
+}
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_TAPE_H
@@ -0,0 +1,416 @@
+#ifndef KV_JSON_JSON_TRAVERSAL_H
+#define KV_JSON_JSON_TRAVERSAL_H
+
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "kv/Json/JsonObject.h"
+#include "kv/Support/Intrinsics.h"
+
+namespace kv {
+
+/**
+ * @brief Events of a JsonTreeWalker.
+ */
+enum class JsonWalkEvent {
+  /**
+   * @brief A null, boolean, number or string node.
+   */
+  Value,
+
+  /**
+   * @brief An array or map node, before its children.
+   */
+  Enter,
+
+  /**
+   * @brief An array or map node, after its children.
+   */
+  Leave,
+};
+
+/**
+ * @brief Walk a JsonObject tree depth-first with an explicit stack, so that walking deep trees neither recurses nor
+ * overflows the call stack.
+ *
+ * The walker produces a Value event for every scalar node, and an Enter and a Leave event around the children of every
+ * array and map node. Children of arrays are walked in order, children of maps in their iteration order.
+ *
+ * The tree must not be modified during the walk.
+ */
+class JsonTreeWalker {
+public:
+  /**
+   * @brief Construct a new JsonTreeWalker object whose walk is already complete.
+   */
+  explicit JsonTreeWalker() noexcept
+    : _stack(),
+      _node(nullptr),
+      _key(nullptr),
+      _index(0),
+      _depth(0),
+      _event(JsonWalkEvent::Value)
+  { }
+
+  /**
+   * @brief Construct a new JsonTreeWalker object positioned at the first event of the walk of the specified tree.
+   *
+   * @param root the root of the tree. The tree must outlive the walk.
+   */
+  explicit JsonTreeWalker(const JsonObject& root)
+    : JsonTreeWalker()
+  {
+    Arrive(root, nullptr, 0);
+  }
+
+  /**
+   * @brief Determine whether the walk is complete.
+   *
+   * @return whether the walk is complete, in which case the other accessors must not be called.
+   */
+  [[nodiscard]]
+  bool IsDone() const noexcept {
+    return _node == nullptr;
+  }
+
+  /**
+   * @brief Get the current event.
+   *
+   * @return the event.
+   */
+  [[nodiscard]]
+  JsonWalkEvent GetEvent() const noexcept {
+    return _event;
+  }
+
+  /**
+   * @brief Get the node of the current event.
+   *
+   * @return the node.
+   */
+  [[nodiscard]]
+  const JsonObject& GetNode() const noexcept {
+    return *_node;
+  }
+
+  /**
+   * @brief Get the key of the node of the current event in its parent map.
+   *
+   * @return pointer to the key, or null if the node is the root or an element of an array.
+   */
+  [[nodiscard]]
+  const std::string* GetKey() const noexcept {
+    return _key;
+  }
+
+  /**
+   * @brief Get the position of the node of the current event among the children of its parent.
+   *
+   * @return the position, which is 0 for the root.
+   */
+  [[nodiscard]]
+  size_t GetIndex() const noexcept {
+    return _index;
+  }
+
+  /**
+   * @brief Get the depth of the node of the current event.
+   *
+   * @return the number of ancestors of the node.
+   */
+  [[nodiscard]]
+  size_t GetDepth() const noexcept {
+    return _depth;
+  }
+
+  /**
+   * @brief Advance to the next event.
+   *
+   * The walk must not be complete.
+   */
+  void Next() {
+    if (_stack.empty()) {
+      _node = nullptr;
+      return;
+    }
+
+    auto& frame = _stack.back();
+    const JsonObject* child = nullptr;
+    const std::string* key = nullptr;
+    auto index = frame.next;
+    switch (frame.kind) {
+      case Frame::Array:
+        if (frame.element != frame.elementEnd) {
+          child = frame.element->get();
+          ++frame.element;
+        }
+        break;
+      case Frame::FlatMap:
+        if (frame.flat != frame.flatEnd) {
+          child = frame.flat->second.get();
+          key = &frame.flat->first;
+          ++frame.flat;
+        }
+        break;
+      case Frame::HashedMap:
+        if (frame.hashed != frame.hashedEnd) {
+          child = frame.hashed->second.get();
+          key = &frame.hashed->first;
+          ++frame.hashed;
+        }
+        break;
+      default:
+        UNREACHABLE();
+    }
+
+    if (child) {
+      ++frame.next;
+      Arrive(*child, key, index);
+      return;
+    }
+
+    _event = JsonWalkEvent::Leave;
+    _node = frame.node;
+    _key = frame.key;
+    _index = frame.index;
+    _stack.pop_back();
+    _depth = _stack.size();
+  }
+
+private:
+  using HashedIterator = std::unordered_map<std::string, JsonObjectPtr>::const_iterator;
+
+  struct Frame {
+    enum Kind {
+      Array,
+      FlatMap,
+      HashedMap,
+    };
+
+    const JsonObject* node;
+    const std::string* key;             // The key of the node in its parent map
+    size_t index;                       // The position of the node among the children of its parent
+    size_t next;                        // The position of the next child of the node
+    Kind kind;
+    const JsonObjectPtr* element;       // The next child of arrays
+    const JsonObjectPtr* elementEnd;
+    JsonFlatMap::const_iterator flat;   // The next entry of flat maps
+    JsonFlatMap::const_iterator flatEnd;
+    HashedIterator hashed;              // The next entry of hashed maps
+    HashedIterator hashedEnd;
+  }; // struct Frame
+
+  std::vector<Frame> _stack;
+  const JsonObject* _node;
+  const std::string* _key;
+  size_t _index;
+  size_t _depth;
+  JsonWalkEvent _event;
+
+  void Arrive(const JsonObject& node, const std::string* key, size_t index) {
+    _node = &node;
+    _key = key;
+    _index = index;
+    _depth = _stack.size();
+
+    Frame frame { &node, key, index, 0, Frame::Array, nullptr, nullptr, { }, { }, { }, { } };
+    switch (node.GetType()) {
+      case JsonObjectType::Array: {
+        const auto& array = node.GetArray();
+        frame.element = array.data();
+        frame.elementEnd = array.data() + array.size();
+        break;
+      }
+      case JsonObjectType::Map:
+        if (node.IsFlatMap()) {
+          const auto& map = node.GetFlatMap();
+          frame.kind = Frame::FlatMap;
+          frame.flat = map.begin();
+          frame.flatEnd = map.end();
+        } else {
+          const auto& map = node.GetMap();
+          frame.kind = Frame::HashedMap;
+          frame.hashed = map.begin();
+          frame.hashedEnd = map.end();
+        }
+        break;
+      default:
+        _event = JsonWalkEvent::Value;
+        return;
+    }
+    _event = JsonWalkEvent::Enter;
+    _stack.push_back(frame);
+  }
+}; // class JsonTreeWalker
+
+/**
+ * @brief Orders in which JsonTreeIterator yields the nodes of a tree.
+ */
+enum class JsonTraversalOrder {
+  /**
+   * @brief Every node comes before its descendants.
+   */
+  PreOrder,
+
+  /**
+   * @brief Every node comes after its descendants.
+   */
+  PostOrder,
+};
+
+/**
+ * @brief Iterate the nodes of a JsonObject tree depth-first without recursion.
+ *
+ * JsonTreeIterator meets the C++ named requirement LegacyInputIterator.
+ *
+ * @tparam Order the order of the nodes.
+ */
+template <JsonTraversalOrder Order>
+class JsonTreeIterator {
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = JsonObject;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const JsonObject *;
+  using reference = const JsonObject &;
+
+  /**
+   * @brief Construct a new JsonTreeIterator object past the last node.
+   */
+  explicit JsonTreeIterator() noexcept = default;
+
+  /**
+   * @brief Construct a new JsonTreeIterator object at the first node of the specified tree.
+   *
+   * @param root the root of the tree. The tree must outlive the iteration and must not be modified during it.
+   */
+  explicit JsonTreeIterator(const JsonObject& root)
+    : _walker(root)
+  {
+    Settle();
+  }
+
+  [[nodiscard]]
+  reference operator*() const noexcept {
+    return _walker.GetNode();
+  }
+
+  [[nodiscard]]
+  pointer operator->() const noexcept {
+    return &_walker.GetNode();
+  }
+
+  JsonTreeIterator& operator++() {
+    _walker.Next();
+    Settle();
+    return *this;
+  }
+
+  /**
+   * @brief Get the key of the current node in its parent map.
+   *
+   * @return pointer to the key, or null if the node is the root or an element of an array.
+   */
+  [[nodiscard]]
+  const std::string* GetKey() const noexcept {
+    return _walker.GetKey();
+  }
+
+  /**
+   * @brief Get the depth of the current node.
+   *
+   * @return the number of ancestors of the node.
+   */
+  [[nodiscard]]
+  size_t GetDepth() const noexcept {
+    return _walker.GetDepth();
+  }
+
+  [[nodiscard]]
+  bool operator==(const JsonTreeIterator& rhs) const noexcept {
+    if (_walker.IsDone() || rhs._walker.IsDone()) {
+      return _walker.IsDone() == rhs._walker.IsDone();
+    }
+    return &_walker.GetNode() == &rhs._walker.GetNode();
+  }
+
+  [[nodiscard]]
+  bool operator!=(const JsonTreeIterator& rhs) const noexcept {
+    return !(*this == rhs);
+  }
+
+private:
+  JsonTreeWalker _walker;
+
+  /**
+   * @brief Skip the events that do not yield a node in the order.
+   */
+  void Settle() {
+    constexpr auto Skipped = Order == JsonTraversalOrder::PreOrder ? JsonWalkEvent::Leave : JsonWalkEvent::Enter;
+    while (!_walker.IsDone() && _walker.GetEvent() == Skipped) {
+      _walker.Next();
+    }
+  }
+}; // class JsonTreeIterator
+
+/**
+ * @brief The nodes of a JsonObject tree in the specified order, for use in range-based for loops.
+ *
+ * @tparam Order the order of the nodes.
+ */
+template <JsonTraversalOrder Order>
+class JsonTreeRange {
+public:
+  /**
+   * @brief Construct a new JsonTreeRange object.
+   *
+   * @param root the root of the tree.
+   */
+  explicit JsonTreeRange(const JsonObject& root) noexcept
+    : _root(&root)
+  { }
+
+  [[nodiscard]]
+  JsonTreeIterator<Order> begin() const {
+    return JsonTreeIterator<Order> { *_root };
+  }
+
+  [[nodiscard]]
+  JsonTreeIterator<Order> end() const noexcept {
+    return JsonTreeIterator<Order> { };
+  }
+
+private:
+  const JsonObject* _root;
+}; // class JsonTreeRange
+
+/**
+ * @brief Get the nodes of the specified tree in pre-order.
+ *
+ * @param root the root of the tree.
+ *
+ * @return the nodes, where every node comes before its descendants.
+ */
+[[nodiscard]]
+inline JsonTreeRange<JsonTraversalOrder::PreOrder> TraversePreOrder(const JsonObject& root) noexcept {
+  return JsonTreeRange<JsonTraversalOrder::PreOrder> { root };
+}
+
+/**
+ * @brief Get the nodes of the specified tree in post-order.
+ *
+ * @param root the root of the tree.
+ *
+ * @return the nodes, where every node comes after its descendants.
+ */
+[[nodiscard]]
+inline JsonTreeRange<JsonTraversalOrder::PostOrder> TraversePostOrder(const JsonObject& root) noexcept {
+  return JsonTreeRange<JsonTraversalOrder::PostOrder> { root };
+}
+
+} // namespace kv
+
+#endif // KV_JSON_JSON_TRAVERSAL_H
@@ -0,0 +1,418 @@
+#ifndef KV_STORE_KV_STORE_H
+#define KV_STORE_KV_STORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+#include "kv/Json/JsonObject.h"
+#include "kv/Json/JsonSnapshot.h"
+#include "kv/Support/Intrinsics.h"
+#include "kv/Support/Memory.h"
+#include "kv/Support/SlabPool.h"
+
+namespace kv {
+
+/**
+ * @brief Options of KvStore.
+ */
+struct KvStoreOptions {
+  size_t shards = 64;                   // The number of lock stripes, rounded up to a power of 2
+  size_t initialCapacity = 1024;        // The number of entries the store holds before any index grows
+}; // struct KvStoreOptions
+
+namespace details {
+
+/**
+ * @brief An entry of a KvStore, which is followed by the bytes of its key.
+ */
+struct KvEntry {
+  JsonObject value;
+  size_t keySize;
+
+  [[nodiscard]]
+  std::string_view GetKey() const noexcept {
+    return std::string_view { reinterpret_cast<const char *>(this + 1), keySize };
+  }
+}; // struct KvEntry
+
+/**
+ * @brief A slot of the open addressing index of a KvStore shard.
+ *
+ * Slots keep the full hash of their entry next to the pointer, so probing compares hashes within the slot array and
+ * only dereferences entries whose hash matches. Four slots share a cache line.
+ */
+struct KvSlot {
+  uint64_t hash;
+  KvEntry* entry;                       // Null for empty slots
+}; // struct KvSlot
+
+/**
+ * @brief A lock stripe of a KvStore, which owns the entries whose hashes select it.
+ *
+ * The index uses linear probing with backward shift deletion, so it needs no tombstones. Readers take the lock shared
+ * and writers exclusively; entry memory comes from the slab pools of the shard, which are only used under the
+ * exclusive lock.
+ */
+class alignas(64) KvShard {
+public:
+  explicit KvShard(MemoryResource& upstream, size_t capacity);
+
+  KvShard(const KvShard &) = delete;
+  KvShard(KvShard &&) noexcept = delete;
+
+  ~KvShard();
+
+  KvShard& operator=(const KvShard &) = delete;
+  KvShard& operator=(KvShard &&) noexcept = delete;
+
+  [[nodiscard]]
+  std::shared_mutex& GetMutex() const noexcept {
+    return _mutex;
+  }
+
+  [[nodiscard]]
+  size_t GetSize() const noexcept {
+    return _size.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Find the entry with the specified key and hash. The lock must be held.
+   */
+  [[nodiscard]]
+  const KvEntry* Find(std::string_view key, uint64_t hash) const noexcept {
+    auto slot = FindSlot(key, hash);
+    return _slots[slot].entry;
+  }
+
+  /**
+   * @brief Insert or replace the value of the specified key. The lock must be held exclusively.
+   *
+   * @param replaced receives the previous value of the key, if any, so that it can be destroyed after the lock is
+   * released.
+   * @return whether the key was inserted rather than replaced.
+   * @throw std::bad_alloc if the allocation fails, in which case the shard is unchanged.
+   */
+  bool Put(std::string_view key, uint64_t hash, JsonObject&& value, std::optional<JsonObject>& replaced);
+
+  /**
+   * @brief Delete the entry with the specified key. The lock must be held exclusively.
+   *
+   * @param removed receives the value of the deleted entry, so that it can be destroyed after the lock is released.
+   * @return whether the key was present.
+   */
+  bool Delete(std::string_view key, uint64_t hash, std::optional<JsonObject>& removed) noexcept;
+
+  /**
+   * @brief Delete all entries. The lock must be held exclusively.
+   */
+  void Clear() noexcept;
+
+  /**
+   * @brief Call the specified function with every entry, in slot order. The lock must be held.
+   */
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    for (size_t i = 0; i <= _mask; ++i) {
+      if (auto entry = _slots[i].entry) {
+        fn(*entry);
+      }
+    }
+  }
+
+private:
+  mutable std::shared_mutex _mutex;
+  std::unique_ptr<KvSlot[]> _slots;
+  size_t _mask;
+  std::atomic<size_t> _size;            // Written under the exclusive lock, read without it by KvStore::GetSize
+  SlabPoolSet _pools;
+
+  /**
+   * @brief Get the slot of the entry with the specified key, or the empty slot at which probing for it stopped.
+   */
+  [[nodiscard]]
+  size_t FindSlot(std::string_view key, uint64_t hash) const noexcept {
+    for (auto slot = static_cast<size_t>(hash) & _mask; ; slot = (slot + 1) & _mask) {
+      const auto& candidate = _slots[slot];
+      if (!candidate.entry) {
+        return slot;
+      }
+      if (candidate.hash == hash) {
+        auto entryKey = candidate.entry->GetKey();
+        if (LIKELY(entryKey.size() == key.size() && std::memcmp(entryKey.data(), key.data(), key.size()) == 0)) {
+          return slot;
+        }
+      }
+    }
+  }
+
+  void Grow();
+
+  [[nodiscard]]
+  KvEntry* AllocateEntry(std::string_view key, JsonObject&& value);
+
+  void ReleaseEntry(KvEntry* entry) noexcept;
+}; // class KvShard
+
+} // namespace details
+
+/**
+ * @brief A concurrent in-memory key-value store that maps strings to JSON values.
+ *
+ * Keys are spread over lock stripes by their hashes. Each stripe keeps an open addressing hash index and a reader
+ * writer lock, so readers of different keys rarely contend and readers of the same stripe proceed in parallel. Entries,
+ * which hold the key and the root node of the value, are allocated from slab pools over a private RawAllocator.
+ *
+ * Values removed by Put or Delete are destroyed after the lock of their stripe is released, so tearing down large
+ * values does not block other operations on the stripe.
+ *
+ * Objects of this class are thread safe. Objects of this class cannot be copy constructed, move constructed, copy
+ * assigned or move assigned.
+ */
+class KvStore {
+public:
+  /**
+   * @brief Construct a new KvStore object with default options.
+   */
+  explicit KvStore();
+
+  /**
+   * @brief Construct a new KvStore object.
+   *
+   * @param options the options of the store.
+   */
+  explicit KvStore(const KvStoreOptions& options);
+
+  KvStore(const KvStore &) = delete;
+  KvStore(KvStore &&) noexcept = delete;
+
+  /**
+   * @brief Destroy this KvStore object and all of its values.
+   */
+  ~KvStore();
+
+  KvStore& operator=(const KvStore &) = delete;
+  KvStore& operator=(KvStore &&) noexcept = delete;
+
+  /**
+   * @brief Compute the hash of the specified key as the store does.
+   *
+   * @param key the key.
+   * @return the hash of the key.
+   */
+  [[nodiscard]]
+  static uint64_t HashKey(std::string_view key) noexcept {
+    return std::hash<std::string_view> { }(key);
+  }
+
+  /**
+   * @brief Get the object allocator of the memory of this store, so that values can be built in the memory of the
+   * store, for instance by parsing them with the allocator. The allocator is thread safe.
+   *
+   * @return the object allocator, which is valid as long as the store is alive.
+   */
+  [[nodiscard]]
+  ObjectAllocator<JsonObject> GetNodeAllocator() noexcept {
+    return ObjectAllocator<JsonObject> { _memory };
+  }
+
+  /**
+   * @brief Get the number of entries.
+   *
+   * @return the number of entries, which may be stale by the time it is returned if other threads modify the store.
+   */
+  [[nodiscard]]
+  size_t GetSize() const noexcept;
+
+  /**
+   * @brief Get the number of lock stripes.
+   *
+   * @return the number of stripes, which is a power of 2.
+   */
+  [[nodiscard]]
+  size_t GetShardCount() const noexcept {
+    return _shardMask + 1;
+  }
+
+  /**
+   * @brief Call the specified function with the value of the specified key.
+   *
+   * The function is called with the lock of the stripe of the key held shared, so it must not modify the store.
+   *
+   * @tparam Fn type of the function, which is called with `const JsonObject &`.
+   * @param key the key.
+   * @param fn the function.
+   * @return whether the store contains the key.
+   */
+  template <typename Fn>
+  bool Get(std::string_view key, Fn&& fn) const {
+    auto hash = HashKey(key);
+    const auto& shard = GetShard(hash);
+    std::shared_lock<std::shared_mutex> lock { shard.GetMutex() };
+    auto entry = shard.Find(key, hash);
+    if (!entry) {
+      return false;
+    }
+    fn(entry->value);
+    return true;
+  }
+
+  /**
+   * @brief Get a deep copy of the value of the specified key.
+   *
+   * @param key the key.
+   * @return the copy, or empty if the store does not contain the key.
+   * @throw std::bad_alloc if the allocation fails.
+   */
+  [[nodiscard]]
+  std::optional<JsonObject> Get(std::string_view key) const;
+
+  /**
+   * @brief Determine whether the store contains the specified key.
+   *
+   * @param key the key.
+   * @return whether the store contains the key.
+   */
+  [[nodiscard]]
+  bool Contains(std::string_view key) const {
+    return Get(key, [](const JsonObject &) { });
+  }
+
+  /**
+   * @brief Call the specified function with the values of the specified keys.
+   *
+   * The keys are grouped by stripe, and the lock of every stripe is taken only once, shared. The hashes of all keys are
+   * computed before the first lock is taken.
+   *
+   * @tparam Fn type of the function, which is called with the position of the key in keys and `const JsonObject &`
+   * for every key the store contains, in no particular order.
+   * @param keys the keys.
+   * @param fn the function.
+   * @return the number of keys the store contains.
+   */
+  template <typename Fn>
+  size_t MultiGet(const std::vector<std::string_view>& keys, Fn&& fn) const {
+    std::vector<KeyRef> refs;
+    PrepareMultiGet(keys, refs);
+
+    size_t found = 0;
+    for (size_t first = 0; first < refs.size(); ) {
+      const auto& shard = *_shards[refs[first].shard];
+      auto last = first;
+      std::shared_lock<std::shared_mutex> lock { shard.GetMutex() };
+      for (; last < refs.size() && refs[last].shard == refs[first].shard; ++last) {
+        const auto& ref = refs[last];
+        if (auto entry = shard.Find(keys[ref.position], ref.hash)) {
+          fn(ref.position, entry->value);
+          ++found;
+        }
+      }
+      first = last;
+    }
+    return found;
+  }
+
+  /**
+   * @brief Insert or replace the value of the specified key.
+   *
+   * The root node of the value is moved into the store; its children keep the memory resources they were allocated
+   * from, such as GetNodeAllocator.
+   *
+   * @param key the key.
+   * @param value the value.
+   * @return whether the key was inserted rather than replaced.
+   * @throw std::bad_alloc if the allocation fails, in which case the store is unchanged.
+   */
+  bool Put(std::string_view key, JsonObject value);
+
+  /**
+   * @brief Delete the entry with the specified key.
+   *
+   * @param key the key.
+   * @return whether the store contained the key.
+   */
+  bool Delete(std::string_view key) noexcept;
+
+  /**
+   * @brief Delete all entries.
+   */
+  void Clear() noexcept;
+
+  /**
+   * @brief Write all entries as an index section of a snapshot, from which LoadSnapshot or JsonSnapshotIndex reads
+   * them back.
+   *
+   * The stripes are written one after another, each with its lock held shared, so the section holds a consistent state
+   * of every stripe but not necessarily of the whole store if other threads modify it meanwhile. Entries are streamed
+   * to the writer as they are encoded.
+   *
+   * @tparam Output type of the output of the writer.
+   * @param writer the snapshot writer, which must not have an open index section.
+   * @param name the name of the section.
+   * @throw std::invalid_argument if the name is longer than JsonSnapshotWriter::MaxSectionNameSize.
+   * @throw std::logic_error if the writer has an open index section or is finished.
+   */
+  template <typename Output>
+  void WriteSnapshot(JsonSnapshotWriter<Output>& writer, std::string_view name) const {
+    writer.BeginIndex(name);
+    for (const auto& shard : _shards) {
+      std::shared_lock<std::shared_mutex> lock { shard->GetMutex() };
+      shard->ForEach([&writer](const details::KvEntry& entry) {
+        writer.AddEntry(entry.GetKey(), entry.value);
+      });
+    }
+    writer.EndIndex();
+  }
+
+  /**
+   * @brief Insert or replace the entries of the specified index section of a snapshot.
+   *
+   * The values are decoded into the memory of this store, with hashed maps.
+   *
+   * @param index the index section.
+   * @return the number of entries read.
+   * @throw std::bad_alloc if the allocation fails, in which case the entries read so far remain in the store.
+   * @throw JsonException if the section is corrupt. Call JsonSnapshot::Verify first to rule this out.
+   */
+  size_t LoadSnapshot(const JsonSnapshotIndex& index);
+
+private:
+  /**
+   * @brief A key of a multi-get together with its hash and stripe.
+   */
+  struct KeyRef {
+    uint64_t hash;
+    size_t shard;
+    size_t position;                    // The position of the key in the keys of the multi-get
+  }; // struct KeyRef
+
+  // The memory of all shards and value nodes, which is destroyed after them.
+  RawAllocator _memory;
+  std::vector<std::unique_ptr<details::KvShard>> _shards;
+  size_t _shardMask;
+
+  [[nodiscard]]
+  const details::KvShard& GetShard(uint64_t hash) const noexcept {
+    // The index of every shard uses the low bits of the hash, so the shard is selected by the high bits.
+    return *_shards[static_cast<size_t>(hash >> 48) & _shardMask];
+  }
+
+  [[nodiscard]]
+  details::KvShard& GetShard(uint64_t hash) noexcept {
+    return *_shards[static_cast<size_t>(hash >> 48) & _shardMask];
+  }
+
+  void PrepareMultiGet(const std::vector<std::string_view>& keys, std::vector<KeyRef>& refs) const;
+}; // class KvStore
+
+} // namespace kv
+
+#endif // KV_STORE_KV_STORE_H
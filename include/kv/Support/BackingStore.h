@@ -0,0 +1,195 @@
+#ifndef KV_SUPPORT_BACKING_STORE_H
+#define KV_SUPPORT_BACKING_STORE_H
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+namespace kv {
+
+/**
+ * @brief Source of the memory blocks that a RawAllocator carves memory chunks from.
+ *
+ * Implementations must not allocate memory through `operator new` since they are called from within the global
+ * allocator.
+ */
+class BackingStore {
+public:
+  /**
+   * @brief Destroy this BackingStore object.
+   */
+  virtual ~BackingStore() noexcept = default;
+
+  /**
+   * @brief Get the granularity of memory blocks. The sizes of all memory blocks mapped by this store are multiples of
+   * the granularity.
+   *
+   * @return the granularity of memory blocks, which is a power of 2.
+   */
+  [[nodiscard]]
+  virtual size_t GetGranularity() const noexcept = 0;
+
+  /**
+   * @brief Map a new memory block.
+   *
+   * @param size the size of the memory block. The size must be a multiple of the granularity.
+   *
+   * @return pointer to the memory block, which is aligned to at least 16 bytes.
+   * @throw std::bad_alloc if the mapping fails.
+   */
+  [[nodiscard]]
+  virtual void* Map(size_t size) = 0;
+
+  /**
+   * @brief Unmap a memory block that was mapped by this store.
+   *
+   * @param ptr pointer to the memory block.
+   * @param size the size of the memory block.
+   */
+  virtual void Unmap(void* ptr, size_t size) noexcept = 0;
+
+  /**
+   * @brief Return the physical pages backing the specified memory range to the operating system while keeping the
+   * range mapped. The content of the range is lost.
+   *
+   * Only the whole pages within the range are affected.
+   *
+   * @param ptr pointer to the memory range, which lies within a memory block mapped by this store.
+   * @param size the size of the memory range.
+   */
+  virtual void Purge(void* ptr, size_t size) noexcept = 0;
+}; // class BackingStore
+
+/**
+ * @brief Backing store that obtains memory blocks from `malloc`.
+ *
+ * This store cannot return memory to the operating system, so Purge does nothing.
+ */
+class MallocBackingStore final : public BackingStore {
+public:
+  [[nodiscard]]
+  size_t GetGranularity() const noexcept override {
+    return 16;
+  }
+
+  [[nodiscard]]
+  void* Map(size_t size) override;
+
+  void Unmap(void* ptr, size_t size) noexcept override;
+
+  void Purge(void* ptr, size_t size) noexcept override;
+}; // class MallocBackingStore
+
+/**
+ * @brief Page size policies of MmapBackingStore.
+ */
+enum class HugePagePolicy {
+  /**
+   * @brief Use regular pages.
+   */
+  None,
+
+  /**
+   * @brief Align memory blocks to 2 MiB and ask the kernel to back them with transparent huge pages.
+   */
+  Transparent,
+
+  /**
+   * @brief Back memory blocks with 2 MiB pages from the hugetlbfs pool.
+   */
+  Explicit2M,
+
+  /**
+   * @brief Back memory blocks with 1 GiB pages from the hugetlbfs pool.
+   */
+  Explicit1G,
+};
+
+/**
+ * @brief Backing store that maps memory blocks directly from the kernel with `mmap`.
+ *
+ * If the hugetlbfs pool cannot satisfy a mapping under an explicit huge page policy, the store falls back to
+ * transparent huge pages for that memory block and counts the fallback.
+ */
+class MmapBackingStore final : public BackingStore {
+public:
+  /**
+   * @brief Construct a new MmapBackingStore object.
+   *
+   * @param hugePages the page size policy.
+   * @param numaNode the NUMA node that mapped memory is bound to, or empty if memory is placed by the default policy.
+   */
+  explicit MmapBackingStore(HugePagePolicy hugePages = HugePagePolicy::None,
+                            std::optional<size_t> numaNode = std::nullopt) noexcept
+    : _hugePages(hugePages),
+      _numaNode(numaNode),
+      _hugePageFallbacks(0)
+  { }
+
+  /**
+   * @brief Get the page size policy of this store.
+   *
+   * @return the page size policy.
+   */
+  [[nodiscard]]
+  HugePagePolicy GetHugePagePolicy() const noexcept {
+    return _hugePages;
+  }
+
+  /**
+   * @brief Get the NUMA node that memory of this store is bound to.
+   *
+   * @return the NUMA node, or empty if memory is placed by the default policy.
+   */
+  [[nodiscard]]
+  std::optional<size_t> GetNumaNode() const noexcept {
+    return _numaNode;
+  }
+
+  /**
+   * @brief Get the number of memory blocks that could not be backed by explicit huge pages.
+   *
+   * @return the number of fallbacks.
+   */
+  [[nodiscard]]
+  size_t GetHugePageFallbacks() const noexcept {
+    return _hugePageFallbacks.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]]
+  size_t GetGranularity() const noexcept override;
+
+  [[nodiscard]]
+  void* Map(size_t size) override;
+
+  void Unmap(void* ptr, size_t size) noexcept override;
+
+  void Purge(void* ptr, size_t size) noexcept override;
+
+private:
+  HugePagePolicy _hugePages;
+  std::optional<size_t> _numaNode;
+  std::atomic<size_t> _hugePageFallbacks;
+}; // class MmapBackingStore
+
+/**
+ * @brief Get the process-wide backing store that obtains memory from `malloc`.
+ *
+ * @return the malloc backing store.
+ */
+[[nodiscard]]
+BackingStore* GetMallocBackingStore() noexcept;
+
+/**
+ * @brief Get the process-wide backing store that maps memory bound to the specified NUMA node.
+ *
+ * @param node the NUMA node.
+ *
+ * @return the backing store of the NUMA node, or the malloc backing store if the node is not online.
+ */
+[[nodiscard]]
+BackingStore* GetNodeBackingStore(size_t node) noexcept;
+
+} // namespace kv
+
+#endif // KV_SUPPORT_BACKING_STORE_H
@@ -0,0 +1,26 @@
+#ifndef KV_SUPPORT_CRC32C_H
+#define KV_SUPPORT_CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kv {
+
+/**
+ * @brief Compute the CRC-32C (Castagnoli) checksum of the specified bytes, as used by iSCSI, ext4 and SSE 4.2.
+ *
+ * The checksum can be computed incrementally: passing the checksum of a prefix as the initial value continues it over
+ * the following bytes. The crc32 instructions of SSE 4.2 are used where this machine supports them, and tables
+ * otherwise.
+ *
+ * @param data the bytes.
+ * @param size the number of bytes.
+ * @param crc the checksum of the bytes before, or 0 to start a new checksum.
+ * @return the checksum.
+ */
+[[nodiscard]]
+uint32_t ComputeCrc32c(const void* data, size_t size, uint32_t crc = 0) noexcept;
+
+} // namespace kv
+
+#endif // KV_SUPPORT_CRC32C_H
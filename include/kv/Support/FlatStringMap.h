@@ -0,0 +1,460 @@
+#ifndef KV_SUPPORT_FLAT_STRING_MAP_H
+#define KV_SUPPORT_FLAT_STRING_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "kv/Support/Intrinsics.h"
+
+namespace kv {
+
+/**
+ * @brief Map from strings to values that stores its entries contiguously in insertion order.
+ *
+ * Entries live inline in a single vector, so iterating the map is a linear scan and yields the entries in the order
+ * they were inserted. Maps of at most MaxLinearSize entries are searched linearly. Larger maps additionally keep an
+ * open addressing index in the style of Swiss tables: a control byte holding 7 bits of the hash for every slot, probed
+ * 16 slots at a time, and a parallel array of entry positions.
+ *
+ * The interface follows the part of std::unordered_map that is commonly used. Unlike std::unordered_map, inserting an
+ * entry invalidates iterators and references to other entries, and erasing an entry takes linear time. Keys must not
+ * be modified through iterators.
+ *
+ * Objects of this class are not thread safe. Objects of this class cannot be copy constructed or copy assigned.
+ *
+ * @tparam T type of the mapped values.
+ */
+template <typename T>
+class FlatStringMap {
+public:
+  using key_type = std::string;
+  using mapped_type = T;
+  using value_type = std::pair<std::string, T>;
+  using size_type = size_t;
+  using iterator = typename std::vector<value_type>::iterator;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  /**
+   * @brief The maximal number of entries that are searched linearly, without an index.
+   */
+  constexpr static const size_t MaxLinearSize = 16;
+
+  /**
+   * @brief Construct a new, empty FlatStringMap object.
+   */
+  explicit FlatStringMap() noexcept
+    : _entries(),
+      _index(),
+      _capacity(0)
+  { }
+
+  FlatStringMap(const FlatStringMap &) = delete;
+  FlatStringMap(FlatStringMap &&) noexcept = default;
+
+  FlatStringMap& operator=(const FlatStringMap &) = delete;
+  FlatStringMap& operator=(FlatStringMap &&) noexcept = default;
+
+  [[nodiscard]]
+  size_t size() const noexcept {
+    return _entries.size();
+  }
+
+  [[nodiscard]]
+  bool empty() const noexcept {
+    return _entries.empty();
+  }
+
+  [[nodiscard]]
+  iterator begin() noexcept {
+    return _entries.begin();
+  }
+
+  [[nodiscard]]
+  iterator end() noexcept {
+    return _entries.end();
+  }
+
+  [[nodiscard]]
+  const_iterator begin() const noexcept {
+    return _entries.begin();
+  }
+
+  [[nodiscard]]
+  const_iterator end() const noexcept {
+    return _entries.end();
+  }
+
+  /**
+   * @brief Find the entry with the specified key.
+   *
+   * @param key the key.
+   * @return iterator to the entry, or end() if no entry has the key.
+   */
+  [[nodiscard]]
+  iterator find(std::string_view key) noexcept {
+    auto position = Lookup(key, _index ? Hash(key) : 0);
+    return position == NotFound ? end() : begin() + position;
+  }
+
+  [[nodiscard]]
+  const_iterator find(std::string_view key) const noexcept {
+    auto position = Lookup(key, _index ? Hash(key) : 0);
+    return position == NotFound ? end() : begin() + position;
+  }
+
+  /**
+   * @brief Find the entry with the specified key, whose hash has been computed in advance.
+   *
+   * @param key the key.
+   * @param hash the hash of the key, as computed by HashKey.
+   * @return iterator to the entry, or end() if no entry has the key.
+   */
+  [[nodiscard]]
+  iterator find(std::string_view key, size_t hash) noexcept {
+    auto position = Lookup(key, hash);
+    return position == NotFound ? end() : begin() + position;
+  }
+
+  [[nodiscard]]
+  const_iterator find(std::string_view key, size_t hash) const noexcept {
+    auto position = Lookup(key, hash);
+    return position == NotFound ? end() : begin() + position;
+  }
+
+  /**
+   * @brief Compute the hash of the specified key as the map does, so a key that is looked up repeatedly only needs to
+   * be hashed once.
+   *
+   * @param key the key.
+   * @return the hash of the key.
+   */
+  [[nodiscard]]
+  static size_t HashKey(std::string_view key) noexcept {
+    return Hash(key);
+  }
+
+  [[nodiscard]]
+  size_t count(std::string_view key) const noexcept {
+    return find(key) == end() ? 0 : 1;
+  }
+
+  /**
+   * @brief Get the value mapped to the specified key.
+   *
+   * @param key the key.
+   * @return the mapped value.
+   * @throw std::out_of_range if no entry has the key.
+   */
+  [[nodiscard]]
+  T& at(std::string_view key) {
+    auto it = find(key);
+    if (UNLIKELY(it == end())) {
+      throw std::out_of_range { "key not found in FlatStringMap" };
+    }
+    return it->second;
+  }
+
+  [[nodiscard]]
+  const T& at(std::string_view key) const {
+    auto it = find(key);
+    if (UNLIKELY(it == end())) {
+      throw std::out_of_range { "key not found in FlatStringMap" };
+    }
+    return it->second;
+  }
+
+  /**
+   * @brief Get the value mapped to the specified key, appending a value-initialized entry if no entry has the key.
+   *
+   * @param key the key.
+   * @return the mapped value.
+   */
+  T& operator[](std::string_view key) {
+    return try_emplace(std::string { key }).first->second;
+  }
+
+  /**
+   * @brief Append an entry with the specified key and value if no entry has the key.
+   *
+   * @param key the key.
+   * @param args the constructor arguments of the value.
+   * @return iterator to the entry with the key, and whether the entry was appended.
+   */
+  template <typename ...Args>
+  std::pair<iterator, bool> try_emplace(std::string key, Args&&... args) {
+    auto hash = _index ? Hash(key) : 0;
+    auto position = Lookup(key, hash);
+    if (position != NotFound) {
+      return std::make_pair(begin() + position, false);
+    }
+    return std::make_pair(Append(hash, std::move(key), std::forward<Args>(args)...), true);
+  }
+
+  /**
+   * @brief Append an entry with the specified key and value if no entry has the key.
+   *
+   * @see try_emplace
+   */
+  template <typename Value>
+  std::pair<iterator, bool> emplace(std::string key, Value&& value) {
+    return try_emplace(std::move(key), std::forward<Value>(value));
+  }
+
+  /**
+   * @brief Assign the specified value to the entry with the specified key, appending the entry if no entry has the key.
+   *
+   * An existing entry keeps its position.
+   *
+   * @param key the key.
+   * @param value the value.
+   * @return iterator to the entry with the key, and whether the entry was appended.
+   */
+  template <typename Value>
+  std::pair<iterator, bool> insert_or_assign(std::string key, Value&& value) {
+    auto hash = _index ? Hash(key) : 0;
+    auto position = Lookup(key, hash);
+    if (position != NotFound) {
+      auto it = begin() + position;
+      it->second = std::forward<Value>(value);
+      return std::make_pair(it, false);
+    }
+    return std::make_pair(Append(hash, std::move(key), std::forward<Value>(value)), true);
+  }
+
+  /**
+   * @brief Erase the entry with the specified key, keeping the order of the other entries.
+   *
+   * @param key the key.
+   * @return the number of erased entries.
+   */
+  size_t erase(std::string_view key) {
+    auto position = Lookup(key, _index ? Hash(key) : 0);
+    if (position == NotFound) {
+      return 0;
+    }
+
+    _entries.erase(begin() + position);
+    if (_entries.size() <= MaxLinearSize) {
+      DropIndex();
+    } else {
+      Rehash(_capacity);
+    }
+    return 1;
+  }
+
+  /**
+   * @brief Erase all entries.
+   */
+  void clear() noexcept {
+    _entries.clear();
+    DropIndex();
+  }
+
+  /**
+   * @brief Reserve room for the specified number of entries.
+   *
+   * @param size the number of entries.
+   */
+  void reserve(size_t size) {
+    _entries.reserve(size);
+    if (size > MaxLinearSize && (!_index || size * 8 > _capacity * 7)) {
+      Rehash(GetCapacityFor(size));
+    }
+  }
+
+private:
+  constexpr static const size_t NotFound = SIZE_MAX;
+  constexpr static const size_t GroupSize = 16;
+  constexpr static const uint8_t EmptySlot = 0x80;
+
+  std::vector<value_type> _entries;
+  // The first _capacity bytes are control bytes, which are followed by _capacity entry positions.
+  std::unique_ptr<uint32_t[]> _index;
+  size_t _capacity;
+
+  [[nodiscard]]
+  static size_t Hash(std::string_view key) noexcept {
+    return std::hash<std::string_view> { }(key);
+  }
+
+  /**
+   * @brief Compare the specified keys, rejecting most mismatches by their sizes and last bytes before comparing them
+   * in full.
+   */
+  [[nodiscard]]
+  static bool KeyEquals(const std::string& lhs, std::string_view rhs) noexcept {
+    auto size = lhs.size();
+    if (size != rhs.size()) {
+      return false;
+    }
+    return size == 0 || (lhs[size - 1] == rhs[size - 1] && std::memcmp(lhs.data(), rhs.data(), size - 1) == 0);
+  }
+
+  /**
+   * @brief Get the smallest index capacity at which the specified number of entries keeps the load factor at or below
+   * 7/8.
+   */
+  [[nodiscard]]
+  static size_t GetCapacityFor(size_t size) noexcept {
+    size_t capacity = GroupSize * 2;
+    while (size * 8 > capacity * 7) {
+      capacity *= 2;
+    }
+    return capacity;
+  }
+
+  /**
+   * @brief Get the bit mask of the slots in the group of 16 control bytes at the specified location that are equal to
+   * the specified byte.
+   */
+  [[nodiscard]]
+  static uint32_t MatchGroup(const uint8_t* control, uint8_t byte) noexcept {
+#if defined(__SSE2__)
+    auto group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(control));
+    auto matches = _mm_cmpeq_epi8(group, _mm_set1_epi8(static_cast<char>(byte)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < GroupSize; ++i) {
+      mask |= static_cast<uint32_t>(control[i] == byte) << i;
+    }
+    return mask;
+#endif
+  }
+
+  [[nodiscard]]
+  const uint8_t* GetControl() const noexcept {
+    return reinterpret_cast<const uint8_t *>(_index.get());
+  }
+
+  [[nodiscard]]
+  uint8_t* GetControl() noexcept {
+    return reinterpret_cast<uint8_t *>(_index.get());
+  }
+
+  [[nodiscard]]
+  const uint32_t* GetSlots() const noexcept {
+    return _index.get() + _capacity / sizeof(uint32_t);
+  }
+
+  [[nodiscard]]
+  uint32_t* GetSlots() noexcept {
+    return _index.get() + _capacity / sizeof(uint32_t);
+  }
+
+  /**
+   * @brief Get the position of the entry with the specified key and hash, or NotFound. The hash is only used if the map
+   * is indexed.
+   */
+  [[nodiscard]]
+  size_t Lookup(std::string_view key, size_t hash) const noexcept {
+    if (!_index) {
+      for (size_t i = 0; i < _entries.size(); ++i) {
+        if (KeyEquals(_entries[i].first, key)) {
+          return i;
+        }
+      }
+      return NotFound;
+    }
+
+    auto tag = static_cast<uint8_t>(hash & 0x7F);
+    auto groupMask = _capacity / GroupSize - 1;
+    auto group = (hash >> 7) & groupMask;
+    auto control = GetControl();
+    auto slots = GetSlots();
+
+    // Triangular probing visits every group, and the load factor guarantees that some group has an empty slot.
+    for (size_t step = 1; ; ++step) {
+      auto groupControl = control + group * GroupSize;
+      auto matches = MatchGroup(groupControl, tag);
+      while (matches) {
+        auto position = slots[group * GroupSize + __builtin_ctz(matches)];
+        if (LIKELY(KeyEquals(_entries[position].first, key))) {
+          return position;
+        }
+        matches &= matches - 1;
+      }
+      if (LIKELY(MatchGroup(groupControl, EmptySlot))) {
+        return NotFound;
+      }
+      group = (group + step) & groupMask;
+    }
+  }
+
+  /**
+   * @brief Record the entry at the specified position with the specified hash in the index.
+   */
+  void InsertSlot(size_t position, size_t hash) noexcept {
+    auto groupMask = _capacity / GroupSize - 1;
+    auto group = (hash >> 7) & groupMask;
+    auto control = GetControl();
+
+    for (size_t step = 1; ; ++step) {
+      auto empty = MatchGroup(control + group * GroupSize, EmptySlot);
+      if (LIKELY(empty)) {
+        auto slot = group * GroupSize + __builtin_ctz(empty);
+        control[slot] = static_cast<uint8_t>(hash & 0x7F);
+        GetSlots()[slot] = static_cast<uint32_t>(position);
+        return;
+      }
+      group = (group + step) & groupMask;
+    }
+  }
+
+  /**
+   * @brief Rebuild the index with the specified capacity.
+   */
+  void Rehash(size_t capacity) {
+    _index.reset(new uint32_t[capacity / sizeof(uint32_t) + capacity]);
+    _capacity = capacity;
+    std::memset(GetControl(), EmptySlot, capacity);
+    for (size_t i = 0; i < _entries.size(); ++i) {
+      InsertSlot(i, Hash(_entries[i].first));
+    }
+  }
+
+  void DropIndex() noexcept {
+    _index.reset();
+    _capacity = 0;
+  }
+
+  /**
+   * @brief Append a new entry, whose key is known to be absent, and index it.
+   */
+  template <typename ...Args>
+  iterator Append(size_t hash, std::string key, Args&&... args) {
+    _entries.emplace_back(std::piecewise_construct,
+                          std::forward_as_tuple(std::move(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+    auto position = _entries.size() - 1;
+
+    if (_index) {
+      if (_entries.size() * 8 > _capacity * 7) {
+        Rehash(_capacity * 2);
+      } else {
+        InsertSlot(position, hash);
+      }
+    } else if (_entries.size() > MaxLinearSize) {
+      Rehash(GetCapacityFor(_entries.size()));
+    }
+
+    return begin() + position;
+  }
+}; // class FlatStringMap
+
+} // namespace kv
+
+#endif // KV_SUPPORT_FLAT_STRING_MAP_H
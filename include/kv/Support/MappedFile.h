@@ -0,0 +1,83 @@
+#ifndef KV_SUPPORT_MAPPED_FILE_H
+#define KV_SUPPORT_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace kv {
+
+/**
+ * @brief A read-only memory mapping of a whole file.
+ *
+ * Objects of this class cannot be copy constructed or copy assigned.
+ */
+class MappedFile {
+public:
+  /**
+   * @brief Map the file at the specified path.
+   *
+   * @param path the path of the file.
+   *
+   * @throw std::system_error if the file cannot be opened or mapped.
+   */
+  explicit MappedFile(const char* path);
+
+  MappedFile(const MappedFile &) = delete;
+
+  /**
+   * @brief Take over the mapping of the specified MappedFile object, which becomes empty.
+   */
+  MappedFile(MappedFile&& other) noexcept;
+
+  /**
+   * @brief Destroy this MappedFile object and unmap the file.
+   */
+  ~MappedFile() noexcept;
+
+  MappedFile& operator=(const MappedFile &) = delete;
+
+  /**
+   * @brief Unmap the current file and take over the mapping of the specified MappedFile object, which becomes empty.
+   */
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  /**
+   * @brief Get the content of the file.
+   *
+   * @return pointer to the content of the file, or null if the file is empty.
+   */
+  [[nodiscard]]
+  const char* GetData() const noexcept {
+    return _data;
+  }
+
+  /**
+   * @brief Get the size of the file.
+   *
+   * @return the size of the file.
+   */
+  [[nodiscard]]
+  size_t GetSize() const noexcept {
+    return _size;
+  }
+
+  /**
+   * @brief Get the content of the file as a string view.
+   *
+   * @return the content of the file.
+   */
+  [[nodiscard]]
+  std::string_view GetView() const noexcept {
+    return std::string_view { _data, _size };
+  }
+
+private:
+  const char* _data;
+  size_t _size;
+
+  void Unmap() noexcept;
+}; // class MappedFile
+
+} // namespace kv
+
+#endif // KV_SUPPORT_MAPPED_FILE_H
@@ -1,14 +1,20 @@
 #ifndef KV_SUPPORT_MEMORY_H
 #define KV_SUPPORT_MEMORY_H
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
-#include <list>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <type_traits>
 #include <utility>
 
+#include "kv/Support/BackingStore.h"
+#include "kv/Support/SizeClass.h"
+
 namespace kv {
 
 namespace details {
@@ -49,19 +55,175 @@ public:
 } // namespace details
 
 /**
- * @brief Allocate raw memory chunks.
+ * @brief Options of a RawAllocator.
+ */
+struct RawAllocatorOptions {
+  /**
+   * @brief The NUMA node that the memory of the allocator is bound to, or empty if the memory is placed by the default
+   * policy of the system.
+   *
+   * This option only takes effect if backingStore is null, in which case the backing store of the node is used.
+   */
+  std::optional<size_t> numaNode;
+
+  /**
+   * @brief The store that memory blocks are obtained from. If null, memory blocks are obtained from `malloc`, or from
+   * the backing store of numaNode if it is set.
+   */
+  BackingStore* backingStore = nullptr;
+
+  /**
+   * @brief The size of the first memory block. Larger memory blocks are obtained for larger allocation requests.
+   */
+  size_t blockSize = 4096;
+
+  /**
+   * @brief The factor by which the size of each new memory block grows over the previous one, up to maxBlockSize.
+   */
+  size_t blockGrowthFactor = 1;
+
+  /**
+   * @brief The largest size that memory blocks grow to.
+   */
+  size_t maxBlockSize = static_cast<size_t>(1) << 30;
+
+  /**
+   * @brief Whether the physical pages of memory blocks that become entirely free are returned to the operating system.
+   */
+  bool purgeIdleBlocks = false;
+}; // struct RawAllocatorOptions
+
+/**
+ * @brief Whether the allocators maintain the hot-path counters of RawAllocatorStats.
  *
- * Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned.
+ * The counters are compiled in only if the build defines `KV_ENABLE_ALLOCATOR_STATS`, e.g. by configuring with the
+ * CMake option `MAB_ENABLE_ALLOCATOR_STATS`; otherwise they stay zero and cost nothing.
+ */
+#ifdef KV_ENABLE_ALLOCATOR_STATS
+constexpr static const bool AllocatorStatsEnabled = true;
+#else
+constexpr static const bool AllocatorStatsEnabled = false;
+#endif
+
+/**
+ * @brief A snapshot of the state of a RawAllocator.
+ *
+ * The layout fields, from blockCount to largestFreeChunkSize, are collected by walking the memory blocks and are always
+ * available. The remaining fields are hot-path counters that are only maintained if AllocatorStatsEnabled is true.
+ * Memory chunks held by thread caches count as allocated.
+ */
+struct RawAllocatorStats {
+  size_t blockCount = 0;                // The number of memory blocks
+  size_t reservedBytes = 0;             // The total size of all memory blocks
+  size_t chunkCount = 0;                // The number of chunks, free or allocated
+  size_t freeChunkCount = 0;            // The number of free chunks
+  size_t freeBytes = 0;                 // The total size of all free chunks, including their headers
+  size_t largestFreeChunkSize = 0;      // The size of the largest free chunk, including its header
+
+  std::array<uint64_t, SizeClassCount> allocations { };  // The number of allocations, indexed by floor size class of
+                                                         // the usable size of the allocated chunk
+  std::array<uint64_t, SizeClassCount> releases { };     // The number of releases, indexed in the same way
+  uint64_t splits = 0;                  // The number of chunk splits
+  uint64_t merges = 0;                  // The number of chunk merges
+  uint64_t lockAcquisitions = 0;        // The number of times the allocator lock is taken
+  uint64_t lockContentions = 0;         // The number of lock acquisitions that had to wait
+  uint64_t lockWaitNanoseconds = 0;     // The total time spent waiting for the lock
+
+  /**
+   * @brief Get the number of reserved bytes outside free chunks, i.e. allocated chunks plus block headers.
+   *
+   * @return the number of bytes in use.
+   */
+  [[nodiscard]]
+  size_t GetInUseBytes() const noexcept {
+    return reservedBytes - freeBytes;
+  }
+
+  /**
+   * @brief Get the external fragmentation ratio, which is the share of free bytes outside the largest free chunk.
+   *
+   * @return the fragmentation ratio in [0, 1], or 0 if there is no free byte.
+   */
+  [[nodiscard]]
+  double GetFragmentation() const noexcept {
+    return freeBytes == 0 ? 0.0 : 1.0 - static_cast<double>(largestFreeChunkSize) / static_cast<double>(freeBytes);
+  }
+
+  /**
+   * @brief Accumulate the specified statistics into these statistics.
+   *
+   * @param rhs the statistics to accumulate.
+   *
+   * @return these statistics.
+   */
+  RawAllocatorStats& operator+=(const RawAllocatorStats& rhs) noexcept;
+}; // struct RawAllocatorStats
+
+/**
+ * @brief Interface of sources of raw memory chunks that ObjectAllocator and ObjectDeleter allocate from.
  */
-class RawAllocator {
+class MemoryResource {
 public:
   constexpr static const size_t DefaultAlignment = 8;
 
+  /**
+   * @brief Destroy this MemoryResource object.
+   */
+  virtual ~MemoryResource() noexcept = default;
+
+  /**
+   * @brief Allocates a new memory chunk with the specified chunk size and alignment requirements.
+   *
+   * @param size the minimal size of the allocated memory chunk. The size must be positive.
+   * @param alignment the alignment of the allocated memory chunk. The alignment must be a power of 2.
+   *
+   * @return pointer to the allocated memory chunk.
+   * @throw std::bad_alloc if the allocation fails.
+   */
+  virtual void* Allocate(size_t size, size_t alignment = DefaultAlignment) = 0;
+
+  /**
+   * @brief Releases the memory chunk referred to by the specified pointer.
+   *
+   * @param ptr pointer to the memory chunk to be freed. The pointer must be null or have been returned by Allocate of
+   * this resource.
+   */
+  virtual void Release(void* ptr) noexcept = 0;
+}; // class MemoryResource
+
+namespace details {
+
+/**
+ * @brief Tag type used for selecting the constant constructor of the global allocator.
+ */
+class GlobalAllocatorTag { }; // class GlobalAllocatorTag
+
+union GlobalAllocatorStorage;
+
+} // namespace details
+
+/**
+ * @brief Allocate raw memory chunks.
+ *
+ * Free chunks are kept in segregated free lists, one for each size class, so that finding a suitable free chunk does
+ * not require scanning every chunk owned by the allocator.
+ *
+ * Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned.
+ */
+class RawAllocator final : public MemoryResource {
+public:
   /**
    * @brief Construct a new RawAllocator object.
    */
   explicit RawAllocator() noexcept;
 
+  /**
+   * @brief Construct a new RawAllocator object with the specified options.
+   *
+   * @param options the options of the allocator.
+   */
+  explicit RawAllocator(const RawAllocatorOptions& options) noexcept;
+
   RawAllocator(const RawAllocator &) = delete;
   RawAllocator(RawAllocator &&) noexcept = delete;
 
@@ -84,28 +246,281 @@ public:
    * @return pointer to the allocated memory chunk.
    * @throw std::bad_alloc if the allocation fails.
    */
-  void* Allocate(size_t size, size_t alignment = DefaultAlignment);
+  void* Allocate(size_t size, size_t alignment = DefaultAlignment) override;
 
   /**
    * @brief Releases the memory chunk referred to by the specified pointer.
    *
-   * @param ptr pointer to the memory chunk to be freed.
+   * The chunk is located through the header stored in front of it, thus this function takes constant time besides
+   * merging the chunk with its free neighbours.
+   *
+   * @param ptr pointer to the memory chunk to be freed. The pointer must be null or have been returned by Allocate of
+   * this allocator.
+   */
+  void Release(void* ptr) noexcept override;
+
+  /**
+   * @brief Allocates several memory chunks of the same size and alignment while taking the lock only once.
+   *
+   * @param size the minimal size of each allocated memory chunk. The size must be positive.
+   * @param alignment the alignment of each allocated memory chunk. The alignment must be a power of 2.
+   * @param ptrs the array that receives pointers to the allocated memory chunks.
+   * @param count the number of memory chunks to allocate.
+   *
+   * @return the number of allocated memory chunks, which is positive if count is positive.
+   * @throw std::bad_alloc if not even a single memory chunk can be allocated.
+   */
+  size_t AllocateBatch(size_t size, size_t alignment, void** ptrs, size_t count);
+
+  /**
+   * @brief Releases several memory chunks while taking the lock only once.
+   *
+   * @param ptrs pointers to the memory chunks to be freed. Each pointer must be null or have been returned by this
+   * allocator.
+   * @param count the number of pointers.
+   */
+  void ReleaseBatch(void* const* ptrs, size_t count) noexcept;
+
+  /**
+   * @brief Get the number of bytes that can be used in the memory chunk referred to by the specified pointer.
+   *
+   * The usable size is at least the size requested when the chunk was allocated. This function does not take the
+   * lock of the allocator.
+   *
+   * @param ptr pointer to a memory chunk returned by Allocate that has not been released yet.
+   *
+   * @return the usable size of the memory chunk.
+   */
+  [[nodiscard]]
+  static size_t GetUsableSize(const void* ptr) noexcept;
+
+  /**
+   * @brief Get the allocator that owns the memory chunk referred to by the specified pointer.
+   *
+   * Every allocator registers itself upon construction so that its memory chunks can be traced back to it. This
+   * function does not take the lock of any allocator.
+   *
+   * @param ptr pointer to a memory chunk returned by Allocate that has not been released yet.
+   *
+   * @return the allocator that owns the memory chunk, or null if the owning allocator could not be registered because
+   * too many allocators are alive.
+   */
+  [[nodiscard]]
+  static RawAllocator* GetOwner(const void* ptr) noexcept;
+
+  /**
+   * @brief Get the registry tag of the allocator that owns the memory chunk referred to by the specified pointer.
+   *
+   * Comparing tags is cheaper than comparing owners since it only reads the chunk header.
+   *
+   * @param ptr pointer to a memory chunk returned by Allocate that has not been released yet.
+   *
+   * @return the tag of the owning allocator, which is 0 if the allocator could not be registered.
+   */
+  [[nodiscard]]
+  static uint16_t GetOwnerTag(const void* ptr) noexcept;
+
+  /**
+   * @brief Get the registry tag of this allocator, which is stored in the header of every chunk of this allocator.
+   *
+   * @return the tag of this allocator, or 0 if this allocator could not be registered.
    */
-  void Release(void* ptr) noexcept;
+  [[nodiscard]]
+  uint16_t GetTag() const noexcept {
+    return _tag;
+  }
+
+  /**
+   * @brief Return the physical pages of all memory blocks that are entirely free to the operating system.
+   */
+  void Trim() noexcept;
+
+  /**
+   * @brief Get the options of this allocator.
+   *
+   * @return the options of this allocator.
+   */
+  [[nodiscard]]
+  const RawAllocatorOptions& GetOptions() const noexcept {
+    return _options;
+  }
+
+  /**
+   * @brief Get a snapshot of the state of this allocator.
+   *
+   * This function takes the lock of the allocator and walks all memory blocks.
+   *
+   * @return the statistics of this allocator.
+   */
+  [[nodiscard]]
+  RawAllocatorStats GetStats() noexcept;
 
 private:
+  friend union details::GlobalAllocatorStorage;
+
+  struct Block;
   struct Chunk;
 
+  /**
+   * @brief The registry tag reserved for the global allocator.
+   */
+  constexpr static const uint16_t GlobalAllocatorTag = 1;
+
+  constexpr static const size_t BinMaskBits = 64;
+  constexpr static const size_t BinMaskWords = (SizeClassCount + BinMaskBits - 1) / BinMaskBits;
+
+  RawAllocatorOptions _options;
+  BackingStore* _store;
+  uint16_t _tag;                                   // Index of this allocator in the allocator registry
   std::mutex _mutex;
-  std::list<Chunk, details::LibcAllocator<Chunk>> _chunks;
+  Block* _blocks;                                  // All memory blocks
+  size_t _nextBlockSize;                           // The size of the next memory block
+  std::array<Chunk *, SizeClassCount> _bins;       // Free lists of free chunks, indexed by size class
+  std::array<uint64_t, BinMaskWords> _binMask;     // Bit i is set if and only if _bins[i] is not empty
+#ifdef KV_ENABLE_ALLOCATOR_STATS
+  RawAllocatorStats _stats;                        // Hot-path counters, protected by _mutex
+#endif
+
+  /**
+   * @brief Construct the global allocator. The constructor is a constant expression, so the global allocator is
+   * constant initialized and can be used before any dynamic initialization runs.
+   */
+  constexpr explicit RawAllocator(details::GlobalAllocatorTag) noexcept
+    : _options(),
+      _store(nullptr),
+      _tag(GlobalAllocatorTag),
+      _mutex(),
+      _blocks(nullptr),
+      _nextBlockSize(_options.blockSize),
+      _bins(),
+      _binMask()
+#ifdef KV_ENABLE_ALLOCATOR_STATS
+      , _stats()
+#endif
+  { }
+
+  void Lock() noexcept;
+
+  void* AllocateLocked(size_t size, size_t alignment);
+  void ReleaseLocked(void* ptr) noexcept;
+
+  [[nodiscard]]
+  Block* AllocateBlock(size_t minSize);
+  void ReleaseBlock(Block* block) noexcept;
+  void PurgeBlock(Block* block) noexcept;
+
+  [[nodiscard]]
+  Chunk* FindFreeChunk(size_t chunkSize, size_t alignment) const noexcept;
+
+  void InsertFreeChunk(Chunk* chunk) noexcept;
+  void RemoveFreeChunk(Chunk* chunk) noexcept;
 }; // class Allocator
 
+namespace details {
+
+/**
+ * @brief Static storage of the global allocator, which is never destroyed since memory may be released to it during
+ * static destruction.
+ */
+union GlobalAllocatorStorage {
+  constexpr explicit GlobalAllocatorStorage() noexcept
+    : allocator(GlobalAllocatorTag { })
+  { }
+
+  GlobalAllocatorStorage(const GlobalAllocatorStorage &) = delete;
+  GlobalAllocatorStorage(GlobalAllocatorStorage &&) noexcept = delete;
+
+  ~GlobalAllocatorStorage() noexcept { }
+
+  GlobalAllocatorStorage& operator=(const GlobalAllocatorStorage &) = delete;
+  GlobalAllocatorStorage& operator=(GlobalAllocatorStorage &&) noexcept = delete;
+
+  RawAllocator allocator;
+}; // union GlobalAllocatorStorage
+
+extern GlobalAllocatorStorage globalAllocatorStorage;
+
+} // namespace details
+
 /**
  * @brief Get the global memory allocator.
  *
+ * The global allocator is constant initialized, so getting it involves neither a lock nor an initialization check.
+ *
  * @return pointer to the global memory allocator.
  */
-RawAllocator* GetGlobalAllocator() noexcept;
+[[nodiscard]]
+constexpr RawAllocator* GetGlobalAllocator() noexcept {
+  return &details::globalAllocatorStorage.allocator;
+}
+
+/**
+ * @brief Modes of the allocator behind the global `operator new`.
+ */
+enum class GlobalAllocatorMode {
+  /**
+   * @brief All threads allocate from the global allocator.
+   */
+  Shared,
+
+  /**
+   * @brief Every thread allocates from the arena of the NUMA node it runs on. The memory of each arena is bound to its
+   * node.
+   */
+  PerNode,
+};
+
+/**
+ * @brief Get the mode of the allocator behind the global `operator new`.
+ *
+ * The initial mode is PerNode if the environment variable `MAB_ALLOCATOR_MODE` is set to `per-node`, and Shared
+ * otherwise.
+ *
+ * @return the mode of the allocator behind the global `operator new`.
+ */
+[[nodiscard]]
+GlobalAllocatorMode GetGlobalAllocatorMode() noexcept;
+
+/**
+ * @brief Set the mode of the allocator behind the global `operator new`.
+ *
+ * Memory chunks are always released to the allocator that owns them, thus the mode can be changed at any time. The
+ * thread cache of a thread keeps allocating from the allocator selected when the cache was created.
+ *
+ * @param mode the new mode.
+ */
+void SetGlobalAllocatorMode(GlobalAllocatorMode mode) noexcept;
+
+/**
+ * @brief Get the arena of the specified NUMA node.
+ *
+ * The arena is created upon the first call to this function with the node. Memory allocated from the arena is bound
+ * to the node regardless of the node the calling thread runs on, so the arenas can be used to place memory on a local
+ * or a remote node on purpose.
+ *
+ * @param node the NUMA node.
+ *
+ * @return the arena of the NUMA node, or the global allocator if the node is not online.
+ */
+[[nodiscard]]
+RawAllocator* GetNodeAllocator(size_t node) noexcept;
+
+/**
+ * @brief Get the allocator that the calling thread allocates from under the current global allocator mode.
+ *
+ * @return the arena of the NUMA node that the calling thread runs on if the mode is PerNode, or the global allocator
+ * otherwise.
+ */
+[[nodiscard]]
+RawAllocator* GetLocalAllocator() noexcept;
+
+/**
+ * @brief Get the accumulated statistics of the global allocator and all arenas of NUMA nodes created so far.
+ *
+ * @return the accumulated statistics.
+ */
+[[nodiscard]]
+RawAllocatorStats GetGlobalAllocatorStats() noexcept;
 
 /**
  * @brief Allocate memory chunks for storing objects of the specified type.
@@ -132,21 +547,26 @@ public:
   /**
    * @brief Construct a new ObjectAllocator object.
    *
-   * @param raw the underlying raw memory allocator.
+   * @param raw the underlying memory resource, e.g. a RawAllocator or a MonotonicArena.
    */
-  explicit ObjectAllocator(RawAllocator& raw) noexcept
+  explicit ObjectAllocator(MemoryResource& raw) noexcept
     : _raw(&raw)
   { }
 
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "google-explicit-constructor"
   /**
    * @brief Construct a new ObjectAllocator object.
    *
-   * @param another another ObjectAllocator whose underlying raw memory allocator will be shared.
+   * This constructor is implicit so that containers can rebind the allocator to their node types.
+   *
+   * @param another another ObjectAllocator whose underlying memory resource will be shared.
    */
   template <typename U>
-  explicit ObjectAllocator(const ObjectAllocator<U>& another) noexcept
+  ObjectAllocator(const ObjectAllocator<U>& another) noexcept
     : _raw(another._raw)
   { }
+#pragma clang diagnostic pop
 
   ObjectAllocator(const ObjectAllocator &) noexcept = default;
   ObjectAllocator(ObjectAllocator &&) noexcept = default;
@@ -162,6 +582,7 @@ public:
   template <typename U>
   ObjectAllocator& operator=(const ObjectAllocator<U>& another) noexcept {
     _raw = another._raw;
+    return *this;
   }
 
   /**
@@ -174,7 +595,10 @@ public:
    */
   [[nodiscard]]
   T* allocate(size_t n) const {
-    return reinterpret_cast<T *>(_raw->Allocate(n * sizeof(T), alignof(T)));
+    if (n > static_cast<size_t>(-1) / sizeof(T)) {
+      throw std::bad_alloc { };
+    }
+    return reinterpret_cast<T *>(_raw->Allocate(std::max(n * sizeof(T), static_cast<size_t>(1)), alignof(T)));
   }
 
   /**
@@ -182,26 +606,41 @@ public:
    *
    * @param ptr pointer to the memory space.
    */
-  void deallocate(T* ptr) const noexcept {
+  void deallocate(T* ptr, size_t = 1) const noexcept {
     _raw->Release(ptr);
   }
 
+  /**
+   * @brief Get the underlying memory resource.
+   *
+   * @return the underlying memory resource.
+   */
+  [[nodiscard]]
+  MemoryResource* GetResource() const noexcept {
+    return _raw;
+  }
+
+  template <typename U>
   [[nodiscard]]
-  bool operator==(const ObjectAllocator& rhs) const noexcept {
+  bool operator==(const ObjectAllocator<U>& rhs) const noexcept {
     return _raw == rhs._raw;
   }
 
+  template <typename U>
   [[nodiscard]]
-  bool operator!=(const ObjectAllocator& rhs) const noexcept {
+  bool operator!=(const ObjectAllocator<U>& rhs) const noexcept {
     return _raw != rhs._raw;
   }
 
 private:
-  RawAllocator* _raw;
+  template <typename U>
+  friend class ObjectAllocator;
+
+  MemoryResource* _raw;
 }; // class ObjectAllocator
 
 /**
- * @brief Deleter for smart pointers whose pointee is allocated by RawAllocator.
+ * @brief Deleter for smart pointers whose pointee is allocated by ObjectAllocator.
  *
  * @tparam T the type of the pointee object.
  */
@@ -217,24 +656,101 @@ public:
     : _allocator(allocator)
   { }
 
+  /**
+   * @brief Destroy the specified object and release its memory.
+   *
+   * @param obj the object.
+   */
   void operator()(T* obj) const noexcept {
-    _allocator.deallocate(obj);
+    obj->~T();
+    _allocator.deallocate(obj, 1);
+  }
+
+  /**
+   * @brief Get the object allocator used for deallocating objects.
+   *
+   * @return the object allocator.
+   */
+  [[nodiscard]]
+  const ObjectAllocator<T>& GetAllocator() const noexcept {
+    return _allocator;
   }
 
 private:
   ObjectAllocator<T> _allocator;
 }; // class ObjectDeleter
 
+/**
+ * @brief Construct a new object with memory obtained from the specified object allocator.
+ *
+ * @tparam T the type of the object.
+ * @tparam Args types of the constructor arguments.
+ * @param allocator the object allocator.
+ * @param args the constructor arguments.
+ *
+ * @return a smart pointer that owns the constructed object.
+ */
+template <typename T, typename ...Args>
+[[nodiscard]]
+std::unique_ptr<T, ObjectDeleter<T>> MakeObject(ObjectAllocator<T> allocator, Args&&... args) {
+  auto ptr = allocator.allocate(1);
+  try {
+    ::new (ptr) T(std::forward<Args>(args)...);
+  } catch (...) {
+    allocator.deallocate(ptr, 1);
+    throw;
+  }
+  return std::unique_ptr<T, ObjectDeleter<T>>(ptr, ObjectDeleter<T>(allocator));
+}
+
 } // namespace kv
 
 [[nodiscard]]
 void* operator new(size_t count);
 
+[[nodiscard]]
+void* operator new[](size_t count);
+
+[[nodiscard]]
+void* operator new(size_t count, const std::nothrow_t &) noexcept;
+
+[[nodiscard]]
+void* operator new[](size_t count, const std::nothrow_t &) noexcept;
+
 [[nodiscard]]
 void* operator new(size_t count, std::align_val_t alignment);
 
+[[nodiscard]]
+void* operator new[](size_t count, std::align_val_t alignment);
+
+[[nodiscard]]
+void* operator new(size_t count, std::align_val_t alignment, const std::nothrow_t &) noexcept;
+
+[[nodiscard]]
+void* operator new[](size_t count, std::align_val_t alignment, const std::nothrow_t &) noexcept;
+
 void operator delete(void* ptr) noexcept;
 
+void operator delete[](void* ptr) noexcept;
+
+void operator delete(void* ptr, const std::nothrow_t &) noexcept;
+
+void operator delete[](void* ptr, const std::nothrow_t &) noexcept;
+
+void operator delete(void* ptr, size_t count) noexcept;
+
+void operator delete[](void* ptr, size_t count) noexcept;
+
 void operator delete(void* ptr, std::align_val_t alignment) noexcept;
 
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept;
+
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t &) noexcept;
+
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t &) noexcept;
+
+void operator delete(void* ptr, size_t count, std::align_val_t alignment) noexcept;
+
+void operator delete[](void* ptr, size_t count, std::align_val_t alignment) noexcept;
+
 #endif // KV_SUPPORT_MEMORY_H
@@ -0,0 +1,136 @@
+#ifndef KV_SUPPORT_MONOTONIC_ARENA_H
+#define KV_SUPPORT_MONOTONIC_ARENA_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "kv/Support/Intrinsics.h"
+#include "kv/Support/Memory.h"
+
+namespace kv {
+
+/**
+ * @brief A memory resource that allocates memory chunks by bumping a pointer through large memory blocks and frees
+ * all of them at once.
+ *
+ * Release does nothing; the memory of all chunks is reclaimed by Reset or when the arena is destroyed. This suits
+ * object graphs that are built incrementally and then dropped as a whole, such as a parsed JsonObject tree. Memory
+ * blocks are obtained from an upstream memory resource and grow geometrically; requests that are large compared to the
+ * current block size get a dedicated memory block.
+ *
+ * Objects of this class are not thread safe. Objects of this class cannot be copy constructed, move constructed, copy
+ * assigned or move assigned.
+ */
+class MonotonicArena final : public MemoryResource {
+public:
+  /**
+   * @brief The default size of the first memory block.
+   */
+  constexpr static const size_t DefaultBlockSize = static_cast<size_t>(64) << 10;
+
+  /**
+   * @brief The size beyond which memory blocks stop growing.
+   */
+  constexpr static const size_t MaxBlockSize = static_cast<size_t>(64) << 20;
+
+  /**
+   * @brief Construct a new MonotonicArena object that obtains memory blocks from the global allocator.
+   *
+   * @param blockSize the size of the first memory block.
+   */
+  explicit MonotonicArena(size_t blockSize = DefaultBlockSize) noexcept;
+
+  /**
+   * @brief Construct a new MonotonicArena object.
+   *
+   * @param upstream the memory resource from which memory blocks are obtained.
+   * @param blockSize the size of the first memory block.
+   */
+  explicit MonotonicArena(MemoryResource& upstream, size_t blockSize = DefaultBlockSize) noexcept;
+
+  MonotonicArena(const MonotonicArena &) = delete;
+  MonotonicArena(MonotonicArena &&) noexcept = delete;
+
+  /**
+   * @brief Destroy this MonotonicArena object. All memory blocks are returned to the upstream memory resource.
+   */
+  ~MonotonicArena() noexcept override;
+
+  MonotonicArena& operator=(const MonotonicArena &) = delete;
+  MonotonicArena& operator=(MonotonicArena &&) noexcept = delete;
+
+  /**
+   * @brief Allocates a new memory chunk with the specified chunk size and alignment requirements.
+   *
+   * @param size the minimal size of the allocated memory chunk. The size must be positive.
+   * @param alignment the alignment of the allocated memory chunk. The alignment must be a power of 2.
+   *
+   * @return pointer to the allocated memory chunk.
+   * @throw std::bad_alloc if the allocation fails.
+   */
+  void* Allocate(size_t size, size_t alignment = DefaultAlignment) override {
+    assert(size > 0 && "size should be a positive value");
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment should be a power of 2");
+
+    auto aligned = (_cursor + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    if (LIKELY(aligned >= _cursor && aligned <= _end && size <= _end - aligned)) {
+      _cursor = aligned + size;
+      return reinterpret_cast<void *>(aligned);
+    }
+
+    return AllocateSlow(size, alignment);
+  }
+
+  /**
+   * @brief Does nothing. Memory chunks allocated from an arena are reclaimed by Reset.
+   */
+  void Release(void *) noexcept override { }
+
+  /**
+   * @brief Reclaims all memory chunks allocated from this arena.
+   *
+   * The most recent memory block is kept for subsequent allocations; all other memory blocks are returned to the
+   * upstream memory resource. All pointers returned by Allocate are invalidated.
+   */
+  void Reset() noexcept;
+
+  /**
+   * @brief Get the upstream memory resource.
+   *
+   * @return the upstream memory resource.
+   */
+  [[nodiscard]]
+  MemoryResource* GetUpstream() const noexcept {
+    return _upstream;
+  }
+
+  /**
+   * @brief Get the total size of the memory blocks currently held by this arena.
+   *
+   * @return the total size of the memory blocks, in bytes.
+   */
+  [[nodiscard]]
+  size_t GetReservedSize() const noexcept {
+    return _reservedSize;
+  }
+
+private:
+  struct Block;
+
+  MemoryResource* _upstream;
+  uintptr_t _cursor;
+  uintptr_t _end;
+  Block* _blocks;
+  Block* _largeBlocks;
+  size_t _nextBlockSize;
+  size_t _reservedSize;
+
+  void* AllocateSlow(size_t size, size_t alignment);
+  Block* AllocateBlock(size_t size);
+  void ReleaseBlocks(Block* blocks) noexcept;
+}; // class MonotonicArena
+
+} // namespace kv
+
+#endif // KV_SUPPORT_MONOTONIC_ARENA_H
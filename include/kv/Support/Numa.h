@@ -0,0 +1,160 @@
+#ifndef KV_SUPPORT_NUMA_H
+#define KV_SUPPORT_NUMA_H
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+namespace kv {
+
+/**
+ * @brief The NUMA topology of the machine, as reported by the kernel under `/sys/devices/system/node`.
+ *
+ * On machines without NUMA support the topology consists of a single node that owns every CPU.
+ *
+ * Detecting the topology does not allocate memory through `operator new`, so the topology can be queried from within
+ * the global allocator.
+ */
+class NumaTopology {
+public:
+  constexpr static const size_t MaxNodes = 64;
+  constexpr static const size_t MaxCpus = 1024;
+
+  using CpuSet = std::bitset<MaxCpus>;
+
+  /**
+   * @brief Get the topology of this machine.
+   *
+   * The topology is detected upon the first call to this function.
+   *
+   * @return the topology of this machine.
+   */
+  [[nodiscard]]
+  static const NumaTopology& Get() noexcept;
+
+  /**
+   * @brief Get the NUMA node of the CPU that the calling thread is currently running on.
+   *
+   * @return the NUMA node of the calling thread.
+   */
+  [[nodiscard]]
+  static size_t GetCurrentNode() noexcept;
+
+  /**
+   * @brief Get the number of NUMA nodes, which is one more than the largest online node ID.
+   *
+   * @return the number of NUMA nodes.
+   */
+  [[nodiscard]]
+  size_t GetNodeCount() const noexcept {
+    return _nodeCount;
+  }
+
+  /**
+   * @brief Determine whether the specified NUMA node is online.
+   *
+   * @param node the NUMA node.
+   *
+   * @return whether the specified NUMA node is online.
+   */
+  [[nodiscard]]
+  bool IsNodeOnline(size_t node) const noexcept {
+    return node < _nodeCount && _online[node];
+  }
+
+  /**
+   * @brief Get the number of CPUs, which is one more than the largest CPU ID known to the topology.
+   *
+   * @return the number of CPUs.
+   */
+  [[nodiscard]]
+  size_t GetCpuCount() const noexcept {
+    return _cpuCount;
+  }
+
+  /**
+   * @brief Get the NUMA node that the specified CPU belongs to.
+   *
+   * @param cpu the CPU.
+   *
+   * @return the NUMA node of the CPU. CPUs unknown to the topology belong to node 0.
+   */
+  [[nodiscard]]
+  size_t GetNodeOfCpu(size_t cpu) const noexcept {
+    return cpu < MaxCpus ? _cpuNodes[cpu] : 0;
+  }
+
+  /**
+   * @brief Get the CPUs that belong to the specified NUMA node.
+   *
+   * @param node the NUMA node. The node must be less than GetNodeCount().
+   *
+   * @return the CPUs of the node.
+   */
+  [[nodiscard]]
+  const CpuSet& GetCpusOfNode(size_t node) const noexcept {
+    return _nodeCpus[node];
+  }
+
+  /**
+   * @brief Get the relative distance between two NUMA nodes, as reported by the ACPI SLIT table.
+   *
+   * The distance from a node to itself is 10 by convention.
+   *
+   * @param from the node where memory accesses originate. The node must be less than GetNodeCount().
+   * @param to the node where the accessed memory resides. The node must be less than GetNodeCount().
+   *
+   * @return the relative distance between the nodes.
+   */
+  [[nodiscard]]
+  uint32_t GetDistance(size_t from, size_t to) const noexcept {
+    return _distances[from][to];
+  }
+
+private:
+  size_t _nodeCount;
+  size_t _cpuCount;
+  std::bitset<MaxNodes> _online;
+  std::array<CpuSet, MaxNodes> _nodeCpus;
+  std::array<uint8_t, MaxCpus> _cpuNodes;
+  std::array<std::array<uint32_t, MaxNodes>, MaxNodes> _distances;
+
+  explicit NumaTopology() noexcept;
+}; // class NumaTopology
+
+/**
+ * @brief Bind the physical pages backing the specified memory range to the specified NUMA node.
+ *
+ * The binding only affects pages that have not been touched yet.
+ *
+ * @param ptr pointer to the memory range. The pointer must be aligned to the page size.
+ * @param size the size of the memory range.
+ * @param node the NUMA node.
+ *
+ * @return whether the binding succeeds. The binding fails on kernels without NUMA support, in which case the pages
+ * are placed by the first-touch policy.
+ */
+bool BindMemoryToNumaNode(void* ptr, size_t size, size_t node) noexcept;
+
+/**
+ * @brief Pin the calling thread to the specified CPU.
+ *
+ * @param cpu the CPU.
+ *
+ * @return whether the pinning succeeds.
+ */
+bool PinCurrentThreadToCpu(size_t cpu) noexcept;
+
+/**
+ * @brief Pin the calling thread to the CPUs of the specified NUMA node.
+ *
+ * @param node the NUMA node.
+ *
+ * @return whether the pinning succeeds.
+ */
+bool PinCurrentThreadToNumaNode(size_t node) noexcept;
+
+} // namespace kv
+
+#endif // KV_SUPPORT_NUMA_H
@@ -0,0 +1,120 @@
+#ifndef KV_SUPPORT_SIZE_CLASS_H
+#define KV_SUPPORT_SIZE_CLASS_H
+
+#include <cstddef>
+
+namespace kv {
+
+/**
+ * @brief The spacing between the smallest size classes.
+ */
+constexpr static const size_t SizeClassQuantum = 16;
+
+/**
+ * @brief Sizes up to this value are spaced by SizeClassQuantum; beyond it every power of 2 is divided into
+ * SizeClassesPerDoubling classes.
+ */
+constexpr static const size_t SizeClassLinearLimit = 128;
+
+/**
+ * @brief The number of size classes between two consecutive powers of 2 beyond SizeClassLinearLimit.
+ */
+constexpr static const size_t SizeClassesPerDoubling = 4;
+
+/**
+ * @brief The logarithm of the size of the largest size class.
+ */
+constexpr static const size_t MaxSizeClassShift = 48;
+
+/**
+ * @brief The size of the largest size class.
+ */
+constexpr static const size_t MaxSizeClassSize = static_cast<size_t>(1) << MaxSizeClassShift;
+
+/**
+ * @brief The total number of size classes.
+ */
+constexpr static const size_t SizeClassCount =
+    SizeClassLinearLimit / SizeClassQuantum + (MaxSizeClassShift - 7) * SizeClassesPerDoubling;
+
+namespace details {
+
+[[nodiscard]]
+constexpr size_t FloorLog2(size_t value) noexcept {
+  return sizeof(size_t) * 8 - 1 - static_cast<size_t>(__builtin_clzll(value));
+}
+
+} // namespace details
+
+/**
+ * @brief Get the smallest size class whose size is at least the specified size.
+ *
+ * The size classes are laid out as follows: the sizes 16, 32, ..., 128 are spaced linearly, and every interval
+ * (2^k, 2^(k + 1)] beyond 128 is divided into 4 evenly spaced classes, which bounds the internal fragmentation of a
+ * size class to 25%.
+ *
+ * @param size the size. The size must be positive and must not exceed MaxSizeClassSize.
+ *
+ * @return index of the size class.
+ */
+[[nodiscard]]
+constexpr size_t SizeToClass(size_t size) noexcept {
+  if (size <= SizeClassLinearLimit) {
+    return size <= SizeClassQuantum ? 0 : (size + SizeClassQuantum - 1) / SizeClassQuantum - 1;
+  }
+
+  auto shift = details::FloorLog2(size - 1);
+  auto spacingShift = shift - 2;
+  auto offset = ((size - 1) >> spacingShift) - SizeClassesPerDoubling;
+  return SizeClassLinearLimit / SizeClassQuantum + (shift - 7) * SizeClassesPerDoubling + offset;
+}
+
+/**
+ * @brief Get the size of the specified size class.
+ *
+ * @param sizeClass index of the size class. The index must be less than SizeClassCount.
+ *
+ * @return the size of the size class.
+ */
+[[nodiscard]]
+constexpr size_t ClassToSize(size_t sizeClass) noexcept {
+  constexpr size_t linearClasses = SizeClassLinearLimit / SizeClassQuantum;
+  if (sizeClass < linearClasses) {
+    return (sizeClass + 1) * SizeClassQuantum;
+  }
+
+  auto group = (sizeClass - linearClasses) / SizeClassesPerDoubling;
+  auto offset = (sizeClass - linearClasses) % SizeClassesPerDoubling + 1;
+  auto shift = group + 7;
+  return (static_cast<size_t>(1) << shift) + (offset << (shift - 2));
+}
+
+/**
+ * @brief Get the largest size class whose size does not exceed the specified size.
+ *
+ * Sizes below the smallest size class map to the smallest size class and sizes beyond the largest size class map to
+ * the largest size class.
+ *
+ * @param size the size.
+ *
+ * @return index of the size class.
+ */
+[[nodiscard]]
+constexpr size_t SizeToFloorClass(size_t size) noexcept {
+  if (size >= MaxSizeClassSize) {
+    return SizeClassCount - 1;
+  }
+  if (size <= SizeClassQuantum) {
+    return 0;
+  }
+
+  auto sizeClass = SizeToClass(size);
+  return ClassToSize(sizeClass) == size ? sizeClass : sizeClass - 1;
+}
+
+static_assert(ClassToSize(SizeClassCount - 1) == MaxSizeClassSize, "the largest size class is inconsistent");
+static_assert(SizeToClass(MaxSizeClassSize) == SizeClassCount - 1, "the largest size class is inconsistent");
+
+} // namespace kv
+
+#endif // KV_SUPPORT_SIZE_CLASS_H
@@ -0,0 +1,345 @@
+#ifndef KV_SUPPORT_SLAB_POOL_H
+#define KV_SUPPORT_SLAB_POOL_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+
+#include "kv/Support/Intrinsics.h"
+#include "kv/Support/Memory.h"
+
+namespace kv {
+
+/**
+ * @brief Allocate fixed-size slots from contiguous slabs.
+ *
+ * Free slots are kept in an intrusive free list, so both allocating and releasing a slot take constant time and never
+ * touch the upstream memory resource unless a new slab is needed. Slots are aligned to 16 bytes. Slabs are returned to
+ * the upstream memory resource only when the pool is destroyed.
+ *
+ * Objects of this class are not thread safe. Objects of this class cannot be copy constructed, move constructed, copy
+ * assigned or move assigned.
+ */
+class SlabPool {
+public:
+  /**
+   * @brief The alignment of every slot.
+   */
+  constexpr static const size_t SlotAlignment = 16;
+
+  /**
+   * @brief The default size of a slab.
+   */
+  constexpr static const size_t DefaultSlabSize = static_cast<size_t>(64) << 10;
+
+  /**
+   * @brief Construct a new SlabPool object that obtains slabs from the global allocator.
+   *
+   * @param slotSize the minimal size of a slot. The size must be positive.
+   * @param slabSize the size of a slab. Slabs always hold at least one slot.
+   */
+  explicit SlabPool(size_t slotSize, size_t slabSize = DefaultSlabSize) noexcept;
+
+  /**
+   * @brief Construct a new SlabPool object.
+   *
+   * @param slotSize the minimal size of a slot. The size must be positive.
+   * @param upstream the memory resource from which slabs are obtained.
+   * @param slabSize the size of a slab. Slabs always hold at least one slot.
+   */
+  explicit SlabPool(size_t slotSize, MemoryResource& upstream, size_t slabSize = DefaultSlabSize) noexcept;
+
+  SlabPool(const SlabPool &) = delete;
+  SlabPool(SlabPool &&) noexcept = delete;
+
+  /**
+   * @brief Destroy this SlabPool object. All slabs are returned to the upstream memory resource.
+   */
+  ~SlabPool() noexcept;
+
+  SlabPool& operator=(const SlabPool &) = delete;
+  SlabPool& operator=(SlabPool &&) noexcept = delete;
+
+  /**
+   * @brief Allocates a slot.
+   *
+   * @return pointer to the slot.
+   * @throw std::bad_alloc if a new slab is needed and cannot be allocated.
+   */
+  void* Allocate() {
+    if (LIKELY(_freeSlots)) {
+      auto slot = _freeSlots;
+      _freeSlots = slot->next;
+      return slot;
+    }
+
+    if (LIKELY(_cursor != _end)) {
+      auto slot = reinterpret_cast<void *>(_cursor);
+      _cursor += _slotSize;
+      return slot;
+    }
+
+    return AllocateSlab();
+  }
+
+  /**
+   * @brief Releases a slot that was allocated by this pool.
+   *
+   * @param ptr pointer to the slot. The pointer must not be null.
+   */
+  void Release(void* ptr) noexcept {
+    auto slot = static_cast<FreeSlot *>(ptr);
+    slot->next = _freeSlots;
+    _freeSlots = slot;
+  }
+
+  /**
+   * @brief Get the size of a slot.
+   *
+   * @return the size of a slot, in bytes.
+   */
+  [[nodiscard]]
+  size_t GetSlotSize() const noexcept {
+    return _slotSize;
+  }
+
+  /**
+   * @brief Get the number of slabs held by this pool.
+   *
+   * @return the number of slabs.
+   */
+  [[nodiscard]]
+  size_t GetSlabCount() const noexcept {
+    return _slabCount;
+  }
+
+private:
+  struct Slab;
+
+  struct FreeSlot {
+    FreeSlot* next;
+  };
+
+  MemoryResource* _upstream;
+  size_t _slotSize;
+  size_t _slabSize;
+  FreeSlot* _freeSlots;
+  uintptr_t _cursor;   // The next never allocated slot of the newest slab
+  uintptr_t _end;      // The end of the last whole slot of the newest slab
+  Slab* _slabs;
+  size_t _slabCount;
+
+  void* AllocateSlab();
+}; // class SlabPool
+
+/**
+ * @brief A set of SlabPools, one for each slot size up to MaxPooledSize, shared by PoolAllocators.
+ *
+ * Pools are created upon the first use of their slot size. Allocations that are too large or too strictly aligned for
+ * any pool go to the upstream memory resource.
+ *
+ * Objects of this class are not thread safe. Objects of this class cannot be copy constructed, move constructed, copy
+ * assigned or move assigned.
+ */
+class SlabPoolSet {
+public:
+  /**
+   * @brief The difference between the slot sizes of adjacent pools.
+   */
+  constexpr static const size_t PoolQuantum = SlabPool::SlotAlignment;
+
+  /**
+   * @brief The slot size of the largest pool.
+   */
+  constexpr static const size_t MaxPooledSize = 512;
+
+  /**
+   * @brief Construct a new SlabPoolSet object that obtains memory from the global allocator.
+   *
+   * @param slabSize the size of a slab.
+   */
+  explicit SlabPoolSet(size_t slabSize = SlabPool::DefaultSlabSize) noexcept;
+
+  /**
+   * @brief Construct a new SlabPoolSet object.
+   *
+   * @param upstream the memory resource from which slabs and unpooled memory chunks are obtained.
+   * @param slabSize the size of a slab.
+   */
+  explicit SlabPoolSet(MemoryResource& upstream, size_t slabSize = SlabPool::DefaultSlabSize) noexcept;
+
+  SlabPoolSet(const SlabPoolSet &) = delete;
+  SlabPoolSet(SlabPoolSet &&) noexcept = delete;
+
+  /**
+   * @brief Destroy this SlabPoolSet object. All pools are destroyed.
+   */
+  ~SlabPoolSet() noexcept = default;
+
+  SlabPoolSet& operator=(const SlabPoolSet &) = delete;
+  SlabPoolSet& operator=(SlabPoolSet &&) noexcept = delete;
+
+  /**
+   * @brief Get the pool that serves memory chunks with the specified size and alignment.
+   *
+   * @param size the size of memory chunks.
+   * @param alignment the alignment of memory chunks.
+   *
+   * @return the pool serving the memory chunks, or null if such chunks are not pooled.
+   */
+  [[nodiscard]]
+  SlabPool* GetPool(size_t size, size_t alignment) noexcept {
+    if (UNLIKELY(size == 0 || size > MaxPooledSize || alignment > SlabPool::SlotAlignment)) {
+      return nullptr;
+    }
+
+    auto& pool = _pools[(size - 1) / PoolQuantum];
+    if (UNLIKELY(!pool)) {
+      pool.emplace(((size - 1) / PoolQuantum + 1) * PoolQuantum, *_upstream, _slabSize);
+    }
+    return &pool.value();
+  }
+
+  /**
+   * @brief Get the upstream memory resource.
+   *
+   * @return the upstream memory resource.
+   */
+  [[nodiscard]]
+  MemoryResource* GetUpstream() const noexcept {
+    return _upstream;
+  }
+
+private:
+  MemoryResource* _upstream;
+  size_t _slabSize;
+  std::array<std::optional<SlabPool>, MaxPooledSize / PoolQuantum> _pools;
+}; // class SlabPoolSet
+
+/**
+ * @brief Allocate memory chunks for storing objects of the specified type from fixed-size slots.
+ *
+ * Single objects are served from the SlabPool of the slot size of `T`; arrays and objects that are too large to be
+ * pooled go to the upstream memory resource of the pool set. All PoolAllocators rebound from one another share a
+ * SlabPoolSet, which must outlive them.
+ *
+ * PoolAllocator<T> meets the C++ named requirement Allocator.
+ *
+ * @tparam T the type of the objects.
+ */
+template <typename T>
+class PoolAllocator {
+public:
+  /**
+   * @brief Type of the allocated object.
+   */
+  using value_type = T;
+
+  /**
+   * @brief Construct a new PoolAllocator object.
+   *
+   * @param pools the pool set from which memory chunks are allocated.
+   */
+  explicit PoolAllocator(SlabPoolSet& pools) noexcept
+    : _pools(&pools),
+      _pool(pools.GetPool(sizeof(T), alignof(T)))
+  { }
+
+#pragma clang diagnostic push
+#pragma ide diagnostic ignored "google-explicit-constructor"
+  /**
+   * @brief Construct a new PoolAllocator object.
+   *
+   * This constructor is implicit so that containers can rebind the allocator to their node types.
+   *
+   * @param another another PoolAllocator whose pool set will be shared.
+   */
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>& another) noexcept
+    : PoolAllocator(*another._pools)
+  { }
+#pragma clang diagnostic pop
+
+  PoolAllocator(const PoolAllocator &) noexcept = default;
+  PoolAllocator(PoolAllocator &&) noexcept = default;
+
+  /**
+   * @brief Destroy this PoolAllocator object.
+   */
+  ~PoolAllocator() noexcept = default;
+
+  PoolAllocator& operator=(const PoolAllocator &) noexcept = default;
+  PoolAllocator& operator=(PoolAllocator &&) noexcept = default;
+
+  /**
+   * @brief Allocates memory space for storing `n` objects.
+   *
+   * @param n the number of objects.
+   *
+   * @return pointer to the memory space that can be used for storing `n` objects.
+   * @throw std::bad_alloc if allocation fails.
+   */
+  [[nodiscard]]
+  T* allocate(size_t n) const {
+    if (LIKELY(n == 1 && _pool)) {
+      return static_cast<T *>(_pool->Allocate());
+    }
+
+    if (n > static_cast<size_t>(-1) / sizeof(T)) {
+      throw std::bad_alloc { };
+    }
+    return static_cast<T *>(_pools->GetUpstream()->Allocate(std::max(n * sizeof(T), static_cast<size_t>(1)),
+                                                            alignof(T)));
+  }
+
+  /**
+   * @brief Releases memory space that was previously allocated by this allocator or by an allocator equal to it.
+   *
+   * @param ptr pointer to the memory space.
+   * @param n the number of objects passed to allocate.
+   */
+  void deallocate(T* ptr, size_t n) const noexcept {
+    if (LIKELY(n == 1 && _pool)) {
+      _pool->Release(ptr);
+      return;
+    }
+
+    _pools->GetUpstream()->Release(ptr);
+  }
+
+  /**
+   * @brief Get the underlying pool set.
+   *
+   * @return the underlying pool set.
+   */
+  [[nodiscard]]
+  SlabPoolSet* GetPools() const noexcept {
+    return _pools;
+  }
+
+  template <typename U>
+  [[nodiscard]]
+  bool operator==(const PoolAllocator<U>& rhs) const noexcept {
+    return _pools == rhs._pools;
+  }
+
+  template <typename U>
+  [[nodiscard]]
+  bool operator!=(const PoolAllocator<U>& rhs) const noexcept {
+    return _pools != rhs._pools;
+  }
+
+private:
+  template <typename U>
+  friend class PoolAllocator;
+
+  SlabPoolSet* _pools;
+  SlabPool* _pool;
+}; // class PoolAllocator
+
+} // namespace kv
+
+#endif // KV_SUPPORT_SLAB_POOL_H
@@ -0,0 +1,128 @@
+#ifndef KV_SUPPORT_THREAD_CACHE_H
+#define KV_SUPPORT_THREAD_CACHE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "kv/Support/Memory.h"
+#include "kv/Support/SizeClass.h"
+
+namespace kv {
+
+/**
+ * @brief A per-thread cache of small memory chunks in front of a shared RawAllocator.
+ *
+ * The cache keeps one magazine of free memory chunks for each small size class. Allocations and frees of small chunks
+ * are served from the magazines without taking the lock of the shared allocator; magazines are refilled from and
+ * drained to the shared allocator in batches.
+ *
+ * Every memory chunk in the magazine of a size class is at least as large as the size class, so a chunk allocated by
+ * one thread may be freed into the cache of another thread. Chunks owned by an allocator other than the shared
+ * allocator bypass the magazines and go back to their owner.
+ *
+ * Objects of this class cannot be copy constructed, move constructed, copy assigned or move assigned.
+ */
+class ThreadCache {
+public:
+  /**
+   * @brief The largest allocation size served from the magazines.
+   */
+  constexpr static const size_t MaxCachedSize = 1024;
+
+  /**
+   * @brief The number of size classes that have a magazine.
+   */
+  constexpr static const size_t CachedClassCount = SizeToClass(MaxCachedSize) + 1;
+
+  /**
+   * @brief The maximal number of memory chunks held by a single magazine.
+   */
+  constexpr static const size_t MaxMagazineCapacity = 64;
+
+  /**
+   * @brief Construct a new ThreadCache object.
+   *
+   * @param shared the shared allocator from which memory chunks are obtained.
+   */
+  explicit ThreadCache(RawAllocator& shared) noexcept;
+
+  ThreadCache(const ThreadCache &) = delete;
+  ThreadCache(ThreadCache &&) noexcept = delete;
+
+  /**
+   * @brief Destroy this ThreadCache object. All cached memory chunks are returned to the shared allocator.
+   */
+  ~ThreadCache() noexcept;
+
+  ThreadCache& operator=(const ThreadCache &) = delete;
+  ThreadCache& operator=(ThreadCache &&) noexcept = delete;
+
+  /**
+   * @brief Get the cache of the calling thread that sits in front of the global allocator.
+   *
+   * The cache is created upon the first call in each thread, in front of the allocator returned by
+   * GetLocalAllocator() at that time.
+   *
+   * @return the cache of the calling thread, or null if the calling thread is being torn down and its cache has
+   * already been destroyed.
+   */
+  [[nodiscard]]
+  static ThreadCache* GetCurrent() noexcept;
+
+  /**
+   * @brief Allocates a new memory chunk with at least the specified size.
+   *
+   * Memory chunks are aligned to RawAllocator::DefaultAlignment.
+   *
+   * @param size the minimal size of the allocated memory chunk. The size must be positive.
+   *
+   * @return pointer to the allocated memory chunk.
+   * @throw std::bad_alloc if the allocation fails.
+   */
+  [[nodiscard]]
+  void* Allocate(size_t size);
+
+  /**
+   * @brief Releases a memory chunk that was allocated by the shared allocator, by this cache or by any other cache in
+   * front of the shared allocator.
+   *
+   * @param ptr pointer to the memory chunk, or null.
+   */
+  void Release(void* ptr) noexcept;
+
+  /**
+   * @brief Releases a memory chunk whose requested size is known, e.g. from a sized `operator delete`.
+   *
+   * The magazine is selected from the size instead of the chunk header, and the owner is checked by comparing registry
+   * tags only. Chunks owned by other allocators fall back to Release(void *).
+   *
+   * @param ptr pointer to the memory chunk, or null.
+   * @param size the size passed to Allocate when the chunk was allocated. If the size is at most MaxCachedSize, the
+   * chunk must have been allocated by Allocate of a cache, or have a usable size of at least the size class of `size`.
+   */
+  void Release(void* ptr, size_t size) noexcept;
+
+  /**
+   * @brief Returns all cached memory chunks to the shared allocator.
+   */
+  void Flush() noexcept;
+
+private:
+  struct Magazine {
+    uint32_t count;
+    uint32_t capacity;
+    std::array<void *, MaxMagazineCapacity> slots;
+  };
+
+  RawAllocator* _shared;
+  uint16_t _sharedTag;
+  std::array<Magazine, CachedClassCount> _magazines;
+
+  void* Refill(size_t sizeClass);
+  void Drain(Magazine& magazine, size_t count) noexcept;
+}; // class ThreadCache
+
+} // namespace kv
+
+#endif // KV_SUPPORT_THREAD_CACHE_H
@@ -0,0 +1,354 @@
+#include "kv/Bench/BenchAllocWorkloads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <unistd.h>
+
+#include "kv/Bench/BenchThreads.h"
+#include "kv/Json/JsonObject.h"
+#include "kv/Support/Defer.h"
+
+namespace kv {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief A memory chunk together with the size it was allocated with.
+ */
+struct Chunk {
+  void* ptr;
+  size_t size;
+}; // struct Chunk
+
+/**
+ * @brief A bounded queue of memory chunks from a single producer thread to a single consumer thread.
+ */
+class ChunkQueue {
+public:
+  explicit ChunkQueue(size_t capacity)
+    : _slots(capacity),
+      _head(0),
+      _tail(0)
+  { }
+
+  [[nodiscard]]
+  bool TryPush(Chunk chunk) noexcept {
+    auto tail = _tail.load(std::memory_order_relaxed);
+    if (tail - _head.load(std::memory_order_acquire) == _slots.size()) {
+      return false;
+    }
+    _slots[tail % _slots.size()] = chunk;
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  [[nodiscard]]
+  bool TryPop(Chunk& chunk) noexcept {
+    auto head = _head.load(std::memory_order_relaxed);
+    if (head == _tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+    chunk = _slots[head % _slots.size()];
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  std::vector<Chunk> _slots;
+  alignas(64) std::atomic<uint64_t> _head;
+  alignas(64) std::atomic<uint64_t> _tail;
+}; // class ChunkQueue
+
+[[nodiscard]]
+std::vector<std::unique_ptr<BenchHeap>> CreateHeaps(BenchAllocator& allocator, size_t count) {
+  std::vector<std::unique_ptr<BenchHeap>> heaps;
+  heaps.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    heaps.push_back(allocator.CreateHeap());
+  }
+  return heaps;
+}
+
+void* AllocateTouched(BenchHeap& heap, size_t size) {
+  auto ptr = heap.Allocate(size);
+  *static_cast<volatile unsigned char *>(ptr) = static_cast<unsigned char>(size);
+  return ptr;
+}
+
+[[nodiscard]]
+JsonObjectPtr MakeRecord(ObjectAllocator<JsonObject> allocator, size_t index) {
+  auto record = MakeObject<JsonObject>(allocator, JsonObject::CreateMap(JsonMapStorage::Flat));
+  auto& fields = record->GetFlatMap();
+  fields.insert_or_assign("id", MakeObject<JsonObject>(allocator, index));
+  fields.insert_or_assign("name", MakeObject<JsonObject>(allocator, "record-" + std::to_string(index)));
+  fields.insert_or_assign("active", MakeObject<JsonObject>(allocator, index % 2 == 0));
+
+  auto tags = MakeObject<JsonObject>(allocator, JsonObject::CreateArray());
+  for (auto tag : { "red", "green", "blue", "black" }) {
+    tags->GetArray().push_back(MakeObject<JsonObject>(allocator, tag));
+  }
+  fields.insert_or_assign("tags", std::move(tags));
+
+  auto position = MakeObject<JsonObject>(allocator, JsonObject::CreateMap(JsonMapStorage::Flat));
+  position->GetFlatMap().insert_or_assign("x", MakeObject<JsonObject>(allocator, static_cast<double>(index) * 0.5));
+  position->GetFlatMap().insert_or_assign("y", MakeObject<JsonObject>(allocator, static_cast<double>(index) * 0.25));
+  fields.insert_or_assign("position", std::move(position));
+  return record;
+}
+
+/**
+ * @brief The number of nodes of a record made by MakeRecord.
+ */
+constexpr static const size_t NodesPerRecord = 12;
+
+} // namespace <anonymous>
+
+Measurement MeasureAllocThroughput(BenchAllocator& allocator, const AllocThroughputOptions& options) {
+  auto heap = allocator.CreateHeap();
+  std::vector<void *> chunks(options.batchSize);
+  return Measure([&]() {
+    for (auto& chunk : chunks) {
+      chunk = AllocateTouched(*heap, options.size);
+    }
+    for (auto chunk : chunks) {
+      heap->Release(chunk, options.size);
+    }
+    heap->Recycle();
+  }, options.measure);
+}
+
+AllocWorkloadResult RunCrossThreadFrees(BenchAllocator& allocator, const CrossThreadOptions& options) {
+  auto heaps = CreateHeaps(allocator, options.pairs * 2);
+  std::vector<std::unique_ptr<ChunkQueue>> queues;
+  queues.reserve(options.pairs);
+  for (size_t i = 0; i < options.pairs; ++i) {
+    queues.push_back(std::make_unique<ChunkQueue>(options.queueCapacity));
+  }
+
+  std::atomic<bool> abort { false };
+  auto work = [&](size_t index) {
+    auto& heap = *heaps[index];
+    auto& queue = *queues[index / 2];
+    if (index % 2 == 0) {
+      std::mt19937_64 random { options.seed + index };
+      std::uniform_int_distribution<size_t> sizes { options.minSize, options.maxSize };
+      for (uint64_t i = 0; i < options.operations; ++i) {
+        Chunk chunk { nullptr, sizes(random) };
+        chunk.ptr = AllocateTouched(heap, chunk.size);
+        while (!queue.TryPush(chunk)) {
+          if (abort.load(std::memory_order_relaxed)) {
+            heap.Release(chunk.ptr, chunk.size);
+            return;
+          }
+          std::this_thread::yield();
+        }
+      }
+    } else {
+      for (uint64_t i = 0; i < options.operations; ++i) {
+        Chunk chunk { };
+        while (!queue.TryPop(chunk)) {
+          if (abort.load(std::memory_order_relaxed)) {
+            return;
+          }
+          std::this_thread::yield();
+        }
+        heap.Release(chunk.ptr, chunk.size);
+      }
+    }
+  };
+
+  // Chunks still queued by a failed run are released before the heaps go away.
+  auto drain = [&]() {
+    Chunk chunk { };
+    for (size_t i = 0; i < queues.size(); ++i) {
+      while (queues[i]->TryPop(chunk)) {
+        heaps[i * 2 + 1]->Release(chunk.ptr, chunk.size);
+      }
+    }
+  };
+  DEFER(1, drain());
+
+  AllocWorkloadResult result;
+  result.seconds = RunBenchThreads(options.pairs * 2, abort, work);
+  result.operations = options.pairs * options.operations;
+  return result;
+}
+
+AllocWorkloadResult RunAllocChurn(BenchAllocator& allocator, const ChurnOptions& options) {
+  auto heaps = CreateHeaps(allocator, options.threads);
+  std::vector<std::vector<Chunk>> sets(options.threads, std::vector<Chunk>(options.slots, Chunk { nullptr, 0 }));
+  auto rounds = std::max(options.rounds, static_cast<size_t>(1));
+
+  // Every set is released through the heap of the thread that ends up with it, or of the thread it belongs to if the
+  // run failed before.
+  DEFER(1, for (size_t i = 0; i < sets.size(); ++i) {
+    for (const auto& chunk : sets[i]) {
+      if (chunk.ptr) {
+        heaps[i]->Release(chunk.ptr, chunk.size);
+      }
+    }
+  });
+
+  BenchBarrier barrier { options.threads };
+  std::atomic<bool> abort { false };
+  auto work = [&](size_t index) {
+    auto& heap = *heaps[index];
+    std::mt19937_64 random { options.seed + index };
+    std::uniform_int_distribution<size_t> sizes { options.minSize, options.maxSize };
+    std::uniform_int_distribution<size_t> slots { 0, options.slots - 1 };
+
+    try {
+      for (auto& chunk : sets[index]) {
+        chunk.size = sizes(random);
+        chunk.ptr = AllocateTouched(heap, chunk.size);
+      }
+
+      for (size_t round = 0; round < rounds; ++round) {
+        // Threads only trade their sets once every thread is done with its set of the previous round.
+        barrier.ArriveAndWait();
+        if (abort.load(std::memory_order_relaxed)) {
+          barrier.ArriveAndDrop();
+          return;
+        }
+
+        auto& set = sets[(index + round) % options.threads];
+        auto begin = options.operations * round / rounds;
+        auto end = options.operations * (round + 1) / rounds;
+        for (auto i = begin; i < end; ++i) {
+          auto& chunk = set[slots(random)];
+          heap.Release(chunk.ptr, chunk.size);
+          chunk.ptr = nullptr;
+          chunk.size = sizes(random);
+          chunk.ptr = AllocateTouched(heap, chunk.size);
+        }
+      }
+    } catch (...) {
+      // The other threads must not wait for this one at the next round.
+      abort.store(true, std::memory_order_relaxed);
+      barrier.ArriveAndDrop();
+      throw;
+    }
+  };
+
+  AllocWorkloadResult result;
+  result.seconds = RunBenchThreads(options.threads, abort, work);
+  result.operations = options.threads * options.operations;
+  return result;
+}
+
+double FragmentationResult::GetPeakResidentRatio() const noexcept {
+  size_t peakLive = 0;
+  size_t peakResident = 0;
+  for (const auto& sample : samples) {
+    peakLive = std::max(peakLive, sample.liveBytes);
+    peakResident = std::max(peakResident, sample.residentBytes);
+  }
+  return peakLive == 0 ? 0.0 : static_cast<double>(peakResident) / static_cast<double>(peakLive);
+}
+
+FragmentationResult RunFragmentation(BenchAllocator& allocator, const FragmentationOptions& options) {
+  auto heap = allocator.CreateHeap();
+  std::vector<Chunk> chunks;
+  DEFER(1, for (const auto& chunk : chunks) heap->Release(chunk.ptr, chunk.size));
+
+  FragmentationResult result;
+  auto baseline = GetResidentSetSize();
+  auto start = Clock::now();
+  size_t live = 0;
+  auto sample = [&]() {
+    auto resident = GetResidentSetSize();
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+    result.samples.push_back(FragmentationSample { elapsed.count(), live, resident > baseline ? resident - baseline : 0 });
+  };
+
+  std::mt19937_64 random { options.seed };
+  for (size_t phase = 0; phase < options.phases; ++phase) {
+    std::uniform_int_distribution<size_t> sizes { options.minSize * (phase + 1), options.maxSize * (phase + 1) };
+    while (live < options.liveSize) {
+      Chunk chunk { nullptr, sizes(random) };
+      chunk.ptr = heap->Allocate(chunk.size);
+      chunks.push_back(chunk);
+      std::memset(chunk.ptr, static_cast<int>(phase), chunk.size);
+      live += chunk.size;
+    }
+    sample();
+
+    std::shuffle(chunks.begin(), chunks.end(), random);
+    auto released = static_cast<size_t>(static_cast<double>(chunks.size()) * options.releaseFraction);
+    for (size_t i = chunks.size() - released; i < chunks.size(); ++i) {
+      heap->Release(chunks[i].ptr, chunks[i].size);
+      live -= chunks[i].size;
+    }
+    chunks.resize(chunks.size() - released);
+    sample();
+  }
+
+  for (const auto& chunk : chunks) {
+    heap->Release(chunk.ptr, chunk.size);
+  }
+  chunks.clear();
+  live = 0;
+  sample();
+  return result;
+}
+
+size_t GetResidentSetSize() noexcept {
+  auto file = std::fopen("/proc/self/statm", "r");
+  if (!file) {
+    return 0;
+  }
+  DEFER(1, std::fclose(file));
+
+  unsigned long size;
+  unsigned long resident;
+  if (std::fscanf(file, "%lu %lu", &size, &resident) != 2) {
+    return 0;
+  }
+  return static_cast<size_t>(resident) * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+JsonTreeResult MeasureJsonTree(BenchAllocator& allocator, const JsonTreeOptions& options) {
+  auto heap = allocator.CreateHeap();
+  BenchHeapResource resource { *heap, sizeof(JsonObject) };
+  ObjectAllocator<JsonObject> objects { resource };
+
+  JsonTreeResult result;
+  result.nodes = options.records * NodesPerRecord;
+  result.buildSamples.reserve(options.sampleCount);
+  result.teardownSamples.reserve(options.sampleCount);
+
+  // The first tree warms up the heap and is not sampled.
+  for (size_t sample = 0; sample <= options.sampleCount; ++sample) {
+    auto root = JsonObject::CreateArray();
+    auto& records = root.GetArray();
+    records.reserve(options.records);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < options.records; ++i) {
+      records.push_back(MakeRecord(objects, i));
+    }
+    auto built = Clock::now();
+    records.clear();
+    heap->Recycle();
+    auto end = Clock::now();
+
+    if (sample > 0) {
+      result.buildSamples.push_back(std::chrono::duration<double> { built - start }.count());
+      result.teardownSamples.push_back(std::chrono::duration<double> { end - built }.count());
+    }
+  }
+  return result;
+}
+
+} // namespace kv
@@ -0,0 +1,305 @@
+#include "kv/Bench/BenchAllocators.h"
+
+#include <cstdlib>
+#include <new>
+
+#include <dlfcn.h>
+
+#include "kv/Support/Intrinsics.h"
+#include "kv/Support/MonotonicArena.h"
+#include "kv/Support/SlabPool.h"
+#include "kv/Support/ThreadCache.h"
+
+namespace kv {
+
+namespace {
+
+constexpr static const char* BenchAllocatorNames[BenchAllocatorKindCount] = {
+  "raw",
+  "thread-cache",
+  "arena",
+  "slab-pool",
+  "malloc",
+  "jemalloc",
+  "mimalloc",
+};
+
+using MallocFunction = void* (*)(size_t);
+using FreeFunction = void (*)(void *);
+
+/**
+ * @brief The entry points of an allocator in a shared library.
+ */
+struct LoadedFunctions {
+  MallocFunction malloc = nullptr;
+  FreeFunction free = nullptr;
+}; // struct LoadedFunctions
+
+LoadedFunctions LoadFunctions(const char* const* libraries, const char* mallocName, const char* freeName) noexcept {
+  for (auto library = libraries; *library; ++library) {
+    // The library is never unloaded, since memory it handed out may outlive any benchmark. RTLD_LOCAL keeps its
+    // symbols from interposing on the allocator of the C library.
+    auto handle = ::dlopen(*library, RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+      continue;
+    }
+
+    LoadedFunctions functions;
+    functions.malloc = reinterpret_cast<MallocFunction>(::dlsym(handle, mallocName));
+    functions.free = reinterpret_cast<FreeFunction>(::dlsym(handle, freeName));
+    if (functions.malloc && functions.free) {
+      return functions;
+    }
+    ::dlclose(handle);
+  }
+  return LoadedFunctions { };
+}
+
+const LoadedFunctions& GetJemalloc() noexcept {
+  constexpr static const char* Libraries[] = { "libjemalloc.so.2", "libjemalloc.so", nullptr };
+  static const LoadedFunctions functions = LoadFunctions(Libraries, "malloc", "free");
+  return functions;
+}
+
+const LoadedFunctions& GetMimalloc() noexcept {
+  constexpr static const char* Libraries[] = { "libmimalloc.so.2", "libmimalloc.so", nullptr };
+  static const LoadedFunctions functions = LoadFunctions(Libraries, "mi_malloc", "mi_free");
+  return functions;
+}
+
+class RawHeap final : public BenchHeap {
+public:
+  explicit RawHeap(RawAllocator& allocator) noexcept
+    : _allocator(&allocator)
+  { }
+
+  void* Allocate(size_t size) override {
+    return _allocator->Allocate(size);
+  }
+
+  void Release(void* ptr, size_t) noexcept override {
+    _allocator->Release(ptr);
+  }
+
+private:
+  RawAllocator* _allocator;
+}; // class RawHeap
+
+class RawBenchAllocator final : public BenchAllocator {
+public:
+  BenchAllocatorKind GetKind() const noexcept override {
+    return BenchAllocatorKind::Raw;
+  }
+
+  std::unique_ptr<BenchHeap> CreateHeap() override {
+    return std::make_unique<RawHeap>(_allocator);
+  }
+
+private:
+  RawAllocator _allocator;
+}; // class RawBenchAllocator
+
+class ThreadCacheHeap final : public BenchHeap {
+public:
+  explicit ThreadCacheHeap(RawAllocator& shared) noexcept
+    : _cache(shared)
+  { }
+
+  void* Allocate(size_t size) override {
+    return _cache.Allocate(size);
+  }
+
+  void Release(void* ptr, size_t size) noexcept override {
+    _cache.Release(ptr, size);
+  }
+
+private:
+  ThreadCache _cache;
+}; // class ThreadCacheHeap
+
+class ThreadCacheBenchAllocator final : public BenchAllocator {
+public:
+  BenchAllocatorKind GetKind() const noexcept override {
+    return BenchAllocatorKind::ThreadCache;
+  }
+
+  std::unique_ptr<BenchHeap> CreateHeap() override {
+    return std::make_unique<ThreadCacheHeap>(_shared);
+  }
+
+private:
+  RawAllocator _shared;
+}; // class ThreadCacheBenchAllocator
+
+class ArenaHeap final : public BenchHeap {
+public:
+  explicit ArenaHeap(MemoryResource& upstream) noexcept
+    : _arena(upstream)
+  { }
+
+  void* Allocate(size_t size) override {
+    return _arena.Allocate(size);
+  }
+
+  void Release(void *, size_t) noexcept override { }
+
+  void Recycle() noexcept override {
+    _arena.Reset();
+  }
+
+private:
+  MonotonicArena _arena;
+}; // class ArenaHeap
+
+class SlabPoolHeap final : public BenchHeap {
+public:
+  explicit SlabPoolHeap(MemoryResource& upstream) noexcept
+    : _pools(upstream)
+  { }
+
+  void* Allocate(size_t size) override {
+    if (auto pool = _pools.GetPool(size, MemoryResource::DefaultAlignment)) {
+      return pool->Allocate();
+    }
+    return _pools.GetUpstream()->Allocate(size);
+  }
+
+  void Release(void* ptr, size_t size) noexcept override {
+    if (auto pool = _pools.GetPool(size, MemoryResource::DefaultAlignment)) {
+      pool->Release(ptr);
+    } else {
+      _pools.GetUpstream()->Release(ptr);
+    }
+  }
+
+private:
+  SlabPoolSet _pools;
+}; // class SlabPoolHeap
+
+/**
+ * @brief An allocator whose heaps obtain their memory from a private RawAllocator, so that the memory is returned
+ * when the allocator is destroyed rather than kept by the global allocator for later benchmarks.
+ */
+template <typename Heap, BenchAllocatorKind Kind>
+class PerThreadBenchAllocator final : public BenchAllocator {
+public:
+  BenchAllocatorKind GetKind() const noexcept override {
+    return Kind;
+  }
+
+  std::unique_ptr<BenchHeap> CreateHeap() override {
+    return std::make_unique<Heap>(_upstream);
+  }
+
+private:
+  RawAllocator _upstream;
+}; // class PerThreadBenchAllocator
+
+class FunctionHeap final : public BenchHeap {
+public:
+  explicit FunctionHeap(MallocFunction malloc, FreeFunction free) noexcept
+    : _malloc(malloc),
+      _free(free)
+  { }
+
+  void* Allocate(size_t size) override {
+    auto ptr = _malloc(size);
+    if (UNLIKELY(!ptr)) {
+      throw std::bad_alloc { };
+    }
+    return ptr;
+  }
+
+  void Release(void* ptr, size_t) noexcept override {
+    _free(ptr);
+  }
+
+private:
+  MallocFunction _malloc;
+  FreeFunction _free;
+}; // class FunctionHeap
+
+class FunctionBenchAllocator final : public BenchAllocator {
+public:
+  explicit FunctionBenchAllocator(BenchAllocatorKind kind, MallocFunction malloc, FreeFunction free) noexcept
+    : _kind(kind),
+      _malloc(malloc),
+      _free(free)
+  { }
+
+  BenchAllocatorKind GetKind() const noexcept override {
+    return _kind;
+  }
+
+  std::unique_ptr<BenchHeap> CreateHeap() override {
+    return std::make_unique<FunctionHeap>(_malloc, _free);
+  }
+
+private:
+  BenchAllocatorKind _kind;
+  MallocFunction _malloc;
+  FreeFunction _free;
+}; // class FunctionBenchAllocator
+
+} // namespace <anonymous>
+
+const char* GetBenchAllocatorName(BenchAllocatorKind kind) noexcept {
+  return BenchAllocatorNames[static_cast<size_t>(kind)];
+}
+
+std::optional<BenchAllocatorKind> ParseBenchAllocatorKind(std::string_view name) noexcept {
+  for (size_t i = 0; i < BenchAllocatorKindCount; ++i) {
+    if (name == BenchAllocatorNames[i]) {
+      return static_cast<BenchAllocatorKind>(i);
+    }
+  }
+  return std::nullopt;
+}
+
+std::unique_ptr<BenchAllocator> BenchAllocator::Create(BenchAllocatorKind kind) {
+  switch (kind) {
+    case BenchAllocatorKind::Raw:
+      return std::make_unique<RawBenchAllocator>();
+    case BenchAllocatorKind::ThreadCache:
+      return std::make_unique<ThreadCacheBenchAllocator>();
+    case BenchAllocatorKind::Arena:
+      return std::make_unique<PerThreadBenchAllocator<ArenaHeap, BenchAllocatorKind::Arena>>();
+    case BenchAllocatorKind::SlabPool:
+      return std::make_unique<PerThreadBenchAllocator<SlabPoolHeap, BenchAllocatorKind::SlabPool>>();
+    case BenchAllocatorKind::Malloc:
+      return std::make_unique<FunctionBenchAllocator>(kind, &::malloc, &::free);
+    case BenchAllocatorKind::Jemalloc:
+    case BenchAllocatorKind::Mimalloc: {
+      const auto& functions = kind == BenchAllocatorKind::Jemalloc ? GetJemalloc() : GetMimalloc();
+      if (!functions.malloc) {
+        return nullptr;
+      }
+      return std::make_unique<FunctionBenchAllocator>(kind, functions.malloc, functions.free);
+    }
+  }
+  UNREACHABLE();
+}
+
+bool BenchAllocator::IsAvailable(BenchAllocatorKind kind) noexcept {
+  switch (kind) {
+    case BenchAllocatorKind::Jemalloc:
+      return GetJemalloc().malloc != nullptr;
+    case BenchAllocatorKind::Mimalloc:
+      return GetMimalloc().malloc != nullptr;
+    default:
+      return true;
+  }
+}
+
+std::vector<BenchAllocatorKind> GetAvailableBenchAllocators() {
+  std::vector<BenchAllocatorKind> kinds;
+  for (size_t i = 0; i < BenchAllocatorKindCount; ++i) {
+    auto kind = static_cast<BenchAllocatorKind>(i);
+    if (BenchAllocator::IsAvailable(kind)) {
+      kinds.push_back(kind);
+    }
+  }
+  return kinds;
+}
+
+} // namespace kv
@@ -0,0 +1,80 @@
+#include "kv/Bench/BenchBuffer.h"
+
+#include <cstring>
+
+#include "kv/Support/Intrinsics.h"
+
+namespace kv {
+
+namespace {
+
+std::unique_ptr<MmapBackingStore> CreateBackingStore(const BenchBufferOptions& options) {
+  switch (options.policy) {
+    case MemoryPolicy::Malloc:
+      return nullptr;
+    case MemoryPolicy::Mmap:
+      return std::make_unique<MmapBackingStore>(HugePagePolicy::None, options.numaNode);
+    case MemoryPolicy::TransparentHugePages:
+      return std::make_unique<MmapBackingStore>(HugePagePolicy::Transparent, options.numaNode);
+    case MemoryPolicy::HugePages2M:
+      return std::make_unique<MmapBackingStore>(HugePagePolicy::Explicit2M, options.numaNode);
+    case MemoryPolicy::HugePages1G:
+      return std::make_unique<MmapBackingStore>(HugePagePolicy::Explicit1G, options.numaNode);
+    default:
+      UNREACHABLE();
+  }
+}
+
+RawAllocatorOptions GetAllocatorOptions(const BenchBufferOptions& options, BackingStore* store, size_t size) noexcept {
+  RawAllocatorOptions allocatorOptions;
+  allocatorOptions.numaNode = options.numaNode;
+  allocatorOptions.backingStore = store;
+  // A single memory block holds the whole buffer along with the block and chunk headers.
+  allocatorOptions.blockSize = size + 2 * BenchBuffer::Alignment;
+  return allocatorOptions;
+}
+
+} // namespace <anonymous>
+
+const char* GetMemoryPolicyName(MemoryPolicy policy) noexcept {
+  switch (policy) {
+    case MemoryPolicy::Malloc:
+      return "malloc";
+    case MemoryPolicy::Mmap:
+      return "mmap";
+    case MemoryPolicy::TransparentHugePages:
+      return "thp";
+    case MemoryPolicy::HugePages2M:
+      return "huge-2m";
+    case MemoryPolicy::HugePages1G:
+      return "huge-1g";
+    default:
+      UNREACHABLE();
+  }
+}
+
+std::optional<MemoryPolicy> ParseMemoryPolicy(std::string_view name) noexcept {
+  for (auto policy : { MemoryPolicy::Malloc, MemoryPolicy::Mmap, MemoryPolicy::TransparentHugePages,
+                       MemoryPolicy::HugePages2M, MemoryPolicy::HugePages1G }) {
+    if (name == GetMemoryPolicyName(policy)) {
+      return policy;
+    }
+  }
+  return std::nullopt;
+}
+
+BenchBuffer::BenchBuffer(size_t size, const BenchBufferOptions& options)
+  : _options(options),
+    _store(CreateBackingStore(options)),
+    _allocator(GetAllocatorOptions(options, _store.get(), size)),
+    _data(_allocator.Allocate(size, Alignment)),
+    _size(size)
+{
+  std::memset(_data, 0, _size);
+}
+
+BenchBuffer::~BenchBuffer() noexcept {
+  _allocator.Release(_data);
+}
+
+} // namespace kv
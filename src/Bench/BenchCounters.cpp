@@ -0,0 +1,162 @@
+#include "kv/Bench/BenchCounters.h"
+
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace kv {
+
+namespace {
+
+struct PerfCounterConfig {
+  uint32_t type;
+  uint64_t config;
+}; // struct PerfCounterConfig
+
+constexpr uint64_t MakeCacheConfig(uint64_t cache, uint64_t op, uint64_t result) noexcept {
+  return cache | (op << 8) | (result << 16);
+}
+
+constexpr static const std::array<PerfCounterConfig, PerfCounterCount> PerfCounterConfigs = {{
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+  { PERF_TYPE_HW_CACHE,
+    MakeCacheConfig(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+  { PERF_TYPE_HW_CACHE,
+    MakeCacheConfig(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+  { PERF_TYPE_HW_CACHE,
+    MakeCacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND },
+}};
+
+constexpr static const char* PerfCounterNames[PerfCounterCount] = {
+  "cycles",
+  "instructions",
+  "l1-misses",
+  "llc-misses",
+  "dtlb-misses",
+  "stall-cycles",
+};
+
+int OpenPerfCounter(const PerfCounterConfig& config) noexcept {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = config.type;
+  attr.config = config.config;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+
+  // Count the calling thread on any CPU it runs on.
+  auto fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+  return fd < 0 ? -1 : static_cast<int>(fd);
+}
+
+} // namespace <anonymous>
+
+const char* GetPerfCounterName(PerfCounter counter) noexcept {
+  return PerfCounterNames[static_cast<size_t>(counter)];
+}
+
+bool PerfCounterValues::IsAnyAvailable() const noexcept {
+  for (auto available : _available) {
+    if (available) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::optional<double> PerfCounterValues::GetPer(PerfCounter counter, uint64_t count) const noexcept {
+  auto value = Get(counter);
+  if (!value || count == 0) {
+    return std::nullopt;
+  }
+  return static_cast<double>(*value) / static_cast<double>(count);
+}
+
+std::optional<double> PerfCounterValues::GetInstructionsPerCycle() const noexcept {
+  auto instructions = Get(PerfCounter::Instructions);
+  auto cycles = Get(PerfCounter::Cycles);
+  if (!instructions || !cycles || *cycles == 0) {
+    return std::nullopt;
+  }
+  return static_cast<double>(*instructions) / static_cast<double>(*cycles);
+}
+
+PerfCounterValues& PerfCounterValues::operator+=(const PerfCounterValues& other) noexcept {
+  for (size_t i = 0; i < PerfCounterCount; ++i) {
+    if (other._available[i]) {
+      _values[i] = (_available[i] ? _values[i] : 0) + other._values[i];
+      _available[i] = true;
+    }
+  }
+  return *this;
+}
+
+PerfCounterGroup::PerfCounterGroup() noexcept
+  : _fds()
+{
+  for (size_t i = 0; i < PerfCounterCount; ++i) {
+    _fds[i] = OpenPerfCounter(PerfCounterConfigs[i]);
+  }
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+  for (auto fd : _fds) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+}
+
+bool PerfCounterGroup::IsAnyAvailable() const noexcept {
+  for (auto fd : _fds) {
+    if (fd >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+PerfCounterGroup::Reading PerfCounterGroup::Read() const noexcept {
+  Reading reading { };
+  for (size_t i = 0; i < PerfCounterCount; ++i) {
+    if (_fds[i] < 0) {
+      continue;
+    }
+
+    uint64_t data[3];
+    if (::read(_fds[i], data, sizeof(data)) == static_cast<ssize_t>(sizeof(data))) {
+      reading.values[i] = data[0];
+      reading.enabled[i] = data[1];
+      reading.running[i] = data[2];
+    }
+  }
+  return reading;
+}
+
+PerfCounterValues PerfCounterGroup::GetValues(const Reading& start, const Reading& end) const noexcept {
+  PerfCounterValues values;
+  for (size_t i = 0; i < PerfCounterCount; ++i) {
+    auto running = end.running[i] - start.running[i];
+    if (_fds[i] < 0 || running == 0) {
+      continue;
+    }
+
+    auto value = end.values[i] - start.values[i];
+    auto enabled = end.enabled[i] - start.enabled[i];
+    if (enabled != running) {
+      value = static_cast<uint64_t>(static_cast<double>(value) * static_cast<double>(enabled) /
+                                    static_cast<double>(running));
+    }
+    values.Set(static_cast<PerfCounter>(i), value);
+  }
+  return values;
+}
+
+} // namespace kv
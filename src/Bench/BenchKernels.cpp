@@ -0,0 +1,368 @@
+#include "kv/Bench/BenchKernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "kv/Support/Intrinsics.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KV_BENCH_X86 1
+#elif defined(__aarch64__)
+#define KV_BENCH_NEON 1
+#endif
+
+// Scalar kernels must stay scalar, otherwise the compiler turns them into the SIMD variants.
+#if defined(__clang__)
+#define KV_BENCH_SCALAR
+#else
+#define KV_BENCH_SCALAR __attribute__((optimize("no-tree-vectorize")))
+#endif
+
+#define KV_BENCH_INLINE inline __attribute__((always_inline))
+
+// Vectors passed between the always inlined helpers never cross a real call, so their ABI does not matter.
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace kv {
+
+namespace {
+
+/**
+ * @brief SIMD instruction sets that the Simd kernel variant can use, ordered by vector width.
+ */
+enum class SimdLevel {
+  None,
+  Vector128,
+  Avx2,
+  Avx512,
+};
+
+SimdLevel DetectSimdLevel() noexcept {
+#if defined(KV_BENCH_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return SimdLevel::Avx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return SimdLevel::Avx2;
+  }
+  return SimdLevel::Vector128;
+#elif defined(KV_BENCH_NEON)
+  return SimdLevel::Vector128;
+#else
+  return SimdLevel::None;
+#endif
+}
+
+SimdLevel GetSimdLevel() noexcept {
+  static const SimdLevel level = DetectSimdLevel();
+  return level;
+}
+
+// The kernels are written once against GCC vector extensions and instantiated per vector width. Each instantiation is
+// inlined into a wrapper that is compiled for the instruction set of its width, so no intrinsics are involved.
+using Vector128 = uint64_t __attribute__((vector_size(16)));
+using Vector256 = uint64_t __attribute__((vector_size(32)));
+using Vector512 = uint64_t __attribute__((vector_size(64)));
+
+template <typename T>
+KV_BENCH_INLINE T Load(const uint8_t* ptr) noexcept {
+  T value;
+  std::memcpy(&value, ptr, sizeof(T));
+  return value;
+}
+
+template <typename T>
+KV_BENCH_INLINE void Store(uint8_t* ptr, T value) noexcept {
+  std::memcpy(ptr, &value, sizeof(T));
+}
+
+template <typename T>
+KV_BENCH_INLINE T Broadcast(uint64_t value) noexcept {
+  if constexpr (std::is_same_v<T, uint64_t>) {
+    return value;
+  } else {
+    return T { } + value;
+  }
+}
+
+template <typename T>
+KV_BENCH_INLINE uint64_t Fold(T value) noexcept {
+  if constexpr (std::is_same_v<T, uint64_t>) {
+    return value;
+  } else {
+    uint64_t result = 0;
+    for (size_t i = 0; i < sizeof(T) / sizeof(uint64_t); ++i) {
+      result ^= value[i];
+    }
+    return result;
+  }
+}
+
+template <typename T>
+KV_BENCH_INLINE uint64_t ReadKernel(const uint8_t* buffer, size_t size, size_t stride) noexcept {
+  auto count = size / stride;
+  // Independent accumulators keep several loads in flight.
+  auto acc0 = Broadcast<T>(0);
+  auto acc1 = acc0;
+  auto acc2 = acc0;
+  auto acc3 = acc0;
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    acc0 ^= Load<T>(buffer + i * stride);
+    acc1 ^= Load<T>(buffer + (i + 1) * stride);
+    acc2 ^= Load<T>(buffer + (i + 2) * stride);
+    acc3 ^= Load<T>(buffer + (i + 3) * stride);
+  }
+  for (; i < count; ++i) {
+    acc0 ^= Load<T>(buffer + i * stride);
+  }
+  return Fold<T>(acc0 ^ acc1 ^ acc2 ^ acc3);
+}
+
+template <typename T>
+KV_BENCH_INLINE void WriteKernel(uint8_t* buffer, size_t size, size_t stride, uint64_t value) noexcept {
+  auto count = size / stride;
+  auto v = Broadcast<T>(value);
+  for (size_t i = 0; i < count; ++i) {
+    Store<T>(buffer + i * stride, v);
+  }
+}
+
+template <typename T>
+KV_BENCH_INLINE void CopyKernel(uint8_t* dst, const uint8_t* src, size_t size, size_t stride) noexcept {
+  auto count = size / stride;
+  for (size_t i = 0; i < count; ++i) {
+    Store<T>(dst + i * stride, Load<T>(src + i * stride));
+  }
+}
+
+#if defined(KV_BENCH_X86)
+#define KV_BENCH_TARGET_128 __attribute__((target("sse2")))
+#define KV_BENCH_TARGET_AVX2 __attribute__((target("avx2")))
+#define KV_BENCH_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define KV_BENCH_TARGET_128
+#define KV_BENCH_TARGET_AVX2
+#define KV_BENCH_TARGET_AVX512
+#endif
+
+#define KV_BENCH_DEFINE_KERNELS(suffix, attributes, type)                                                          \
+  attributes uint64_t Read##suffix(const uint8_t* buffer, size_t size, size_t stride) noexcept {                   \
+    return ReadKernel<type>(buffer, size, stride);                                                                 \
+  }                                                                                                                \
+  attributes void Write##suffix(uint8_t* buffer, size_t size, size_t stride, uint64_t value) noexcept {            \
+    WriteKernel<type>(buffer, size, stride, value);                                                                \
+  }                                                                                                                \
+  attributes void Copy##suffix(uint8_t* dst, const uint8_t* src, size_t size, size_t stride) noexcept {            \
+    CopyKernel<type>(dst, src, size, stride);                                                                      \
+  }
+
+KV_BENCH_DEFINE_KERNELS(Scalar, KV_BENCH_SCALAR, uint64_t)
+KV_BENCH_DEFINE_KERNELS(Vector128, KV_BENCH_TARGET_128, Vector128)
+#if defined(KV_BENCH_X86)
+KV_BENCH_DEFINE_KERNELS(Avx2, KV_BENCH_TARGET_AVX2, Vector256)
+KV_BENCH_DEFINE_KERNELS(Avx512, KV_BENCH_TARGET_AVX512, Vector512)
+#endif
+
+#undef KV_BENCH_DEFINE_KERNELS
+
+SimdLevel GetVariantLevel(KernelVariant variant) noexcept {
+  return variant == KernelVariant::Scalar ? SimdLevel::None : GetSimdLevel();
+}
+
+} // namespace <anonymous>
+
+const char* GetAccessKindName(AccessKind kind) noexcept {
+  switch (kind) {
+    case AccessKind::Read:
+      return "read";
+    case AccessKind::Write:
+      return "write";
+    case AccessKind::Copy:
+      return "copy";
+    default:
+      UNREACHABLE();
+  }
+}
+
+std::optional<AccessKind> ParseAccessKind(std::string_view name) noexcept {
+  for (auto kind : { AccessKind::Read, AccessKind::Write, AccessKind::Copy }) {
+    if (name == GetAccessKindName(kind)) {
+      return kind;
+    }
+  }
+  return std::nullopt;
+}
+
+const char* GetKernelVariantName(KernelVariant variant) noexcept {
+  switch (variant) {
+    case KernelVariant::Scalar:
+      return "scalar";
+    case KernelVariant::Simd:
+      return "simd";
+    default:
+      UNREACHABLE();
+  }
+}
+
+std::optional<KernelVariant> ParseKernelVariant(std::string_view name) noexcept {
+  for (auto variant : { KernelVariant::Scalar, KernelVariant::Simd }) {
+    if (name == GetKernelVariantName(variant)) {
+      return variant;
+    }
+  }
+  return std::nullopt;
+}
+
+const char* GetSimdInstructionSet() noexcept {
+  switch (GetSimdLevel()) {
+    case SimdLevel::None:
+      return "none";
+    case SimdLevel::Vector128:
+#if defined(KV_BENCH_NEON)
+      return "neon";
+#else
+      return "sse2";
+#endif
+    case SimdLevel::Avx2:
+      return "avx2";
+    case SimdLevel::Avx512:
+      return "avx512";
+    default:
+      UNREACHABLE();
+  }
+}
+
+size_t GetAccessWidth(KernelVariant variant) noexcept {
+  switch (GetVariantLevel(variant)) {
+    case SimdLevel::None:
+      return sizeof(uint64_t);
+    case SimdLevel::Vector128:
+      return sizeof(Vector128);
+    case SimdLevel::Avx2:
+      return sizeof(Vector256);
+    case SimdLevel::Avx512:
+      return sizeof(Vector512);
+    default:
+      UNREACHABLE();
+  }
+}
+
+void* BuildChaseList(void* buffer, size_t size, size_t stride, uint64_t seed) {
+  if (stride == 0 || stride % sizeof(void *) != 0) {
+    throw std::invalid_argument { "stride is not a positive multiple of the pointer size" };
+  }
+  if (size < stride) {
+    throw std::invalid_argument { "buffer smaller than the stride" };
+  }
+
+  auto count = size / stride;
+  std::vector<size_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  // Keep slot 0 first so that the list starts at the beginning of the buffer.
+  std::shuffle(order.begin() + 1, order.end(), std::mt19937_64 { seed });
+
+  auto base = static_cast<uint8_t *>(buffer);
+  for (size_t i = 0; i < count; ++i) {
+    void* next = base + order[(i + 1) % count] * stride;
+    std::memcpy(base + order[i] * stride, &next, sizeof(next));
+  }
+  return buffer;
+}
+
+const void* ChasePointers(const void* start, size_t steps) noexcept {
+  auto current = start;
+  for (; steps >= 8; steps -= 8) {
+    current = *static_cast<const void* const *>(current);
+    current = *static_cast<const void* const *>(current);
+    current = *static_cast<const void* const *>(current);
+    current = *static_cast<const void* const *>(current);
+    current = *static_cast<const void* const *>(current);
+    current = *static_cast<const void* const *>(current);
+    current = *static_cast<const void* const *>(current);
+    current = *static_cast<const void* const *>(current);
+  }
+  for (; steps > 0; --steps) {
+    current = *static_cast<const void* const *>(current);
+  }
+  return current;
+}
+
+uint64_t ReadMemory(KernelVariant variant, const void* buffer, size_t size, size_t stride) noexcept {
+  assert(stride > 0 && stride % GetAccessWidth(variant) == 0 && "stride should be a multiple of the access width");
+
+  auto data = static_cast<const uint8_t *>(buffer);
+  switch (GetVariantLevel(variant)) {
+    case SimdLevel::None:
+      return ReadScalar(data, size, stride);
+    case SimdLevel::Vector128:
+      return ReadVector128(data, size, stride);
+#if defined(KV_BENCH_X86)
+    case SimdLevel::Avx2:
+      return ReadAvx2(data, size, stride);
+    case SimdLevel::Avx512:
+      return ReadAvx512(data, size, stride);
+#endif
+    default:
+      UNREACHABLE();
+  }
+}
+
+void WriteMemory(KernelVariant variant, void* buffer, size_t size, size_t stride, uint64_t value) noexcept {
+  assert(stride > 0 && stride % GetAccessWidth(variant) == 0 && "stride should be a multiple of the access width");
+
+  auto data = static_cast<uint8_t *>(buffer);
+  switch (GetVariantLevel(variant)) {
+    case SimdLevel::None:
+      WriteScalar(data, size, stride, value);
+      break;
+    case SimdLevel::Vector128:
+      WriteVector128(data, size, stride, value);
+      break;
+#if defined(KV_BENCH_X86)
+    case SimdLevel::Avx2:
+      WriteAvx2(data, size, stride, value);
+      break;
+    case SimdLevel::Avx512:
+      WriteAvx512(data, size, stride, value);
+      break;
+#endif
+    default:
+      UNREACHABLE();
+  }
+}
+
+void CopyMemory(KernelVariant variant, void* dst, const void* src, size_t size, size_t stride) noexcept {
+  assert(stride > 0 && stride % GetAccessWidth(variant) == 0 && "stride should be a multiple of the access width");
+
+  auto to = static_cast<uint8_t *>(dst);
+  auto from = static_cast<const uint8_t *>(src);
+  switch (GetVariantLevel(variant)) {
+    case SimdLevel::None:
+      CopyScalar(to, from, size, stride);
+      break;
+    case SimdLevel::Vector128:
+      CopyVector128(to, from, size, stride);
+      break;
+#if defined(KV_BENCH_X86)
+    case SimdLevel::Avx2:
+      CopyAvx2(to, from, size, stride);
+      break;
+    case SimdLevel::Avx512:
+      CopyAvx512(to, from, size, stride);
+      break;
+#endif
+    default:
+      UNREACHABLE();
+  }
+}
+
+} // namespace kv
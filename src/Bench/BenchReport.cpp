@@ -0,0 +1,425 @@
+#include "kv/Bench/BenchReport.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include "kv/Bench/BenchKernels.h"
+#include "kv/Bench/BenchRunner.h"
+#include "kv/Json/JsonParser.h"
+#include "kv/Json/JsonSerializer.h"
+#include "kv/Json/JsonSink.h"
+#include "kv/Support/Defer.h"
+#include "kv/Support/MappedFile.h"
+#include "kv/Support/Numa.h"
+
+namespace kv {
+
+namespace {
+
+constexpr static const char* CacheDirectory = "/sys/devices/system/cpu/cpu0/cache/index";
+
+constexpr static const size_t MaxCacheIndexes = 16;
+
+template <typename T>
+void Put(JsonFlatMap& map, std::string key, T&& value) {
+  map.insert_or_assign(std::move(key), MakeJsonObject(std::forward<T>(value)));
+}
+
+std::optional<std::string> ReadLine(const std::string& path) {
+  std::ifstream input { path };
+  std::string line;
+  if (!input || !std::getline(input, line)) {
+    return std::nullopt;
+  }
+  return line;
+}
+
+std::optional<std::string> ReadCpuModel() {
+  std::ifstream input { "/proc/cpuinfo" };
+  std::string line;
+  while (std::getline(input, line)) {
+    std::string_view view { line };
+    if (view.compare(0, 10, "model name") != 0) {
+      continue;
+    }
+    auto colon = view.find(':');
+    if (colon == std::string_view::npos) {
+      continue;
+    }
+    view.remove_prefix(std::min(colon + 2, view.size()));
+    return std::string { view };
+  }
+  return std::nullopt;
+}
+
+JsonObject DescribeCaches() {
+  auto caches = JsonObject::CreateArray();
+  for (size_t index = 0; index < MaxCacheIndexes; ++index) {
+    auto directory = CacheDirectory + std::to_string(index) + "/";
+    auto level = ReadLine(directory + "level");
+    if (!level) {
+      break;
+    }
+
+    auto cache = MakeJsonObject(JsonFlatMapTag { });
+    auto& map = cache->GetFlatMap();
+    Put(map, "level", static_cast<uint64_t>(std::strtoull(level->c_str(), nullptr, 10)));
+    if (auto type = ReadLine(directory + "type")) {
+      Put(map, "type", std::move(*type));
+    }
+    if (auto size = ReadLine(directory + "size")) {
+      if (auto bytes = ParseByteSize(*size)) {
+        Put(map, "size", static_cast<uint64_t>(*bytes));
+      }
+    }
+    if (auto lineSize = ReadLine(directory + "coherency_line_size")) {
+      Put(map, "lineSize", static_cast<uint64_t>(std::strtoull(lineSize->c_str(), nullptr, 10)));
+    }
+    if (auto shared = ReadLine(directory + "shared_cpu_list")) {
+      Put(map, "sharedCpus", std::move(*shared));
+    }
+    caches.GetArray().push_back(std::move(cache));
+  }
+  return caches;
+}
+
+JsonObject DescribeNumaNodes() {
+  const auto& topology = NumaTopology::Get();
+
+  auto nodes = JsonObject::CreateArray();
+  for (size_t node = 0; node < topology.GetNodeCount(); ++node) {
+    if (!topology.IsNodeOnline(node)) {
+      continue;
+    }
+
+    auto description = MakeJsonObject(JsonFlatMapTag { });
+    auto& map = description->GetFlatMap();
+    Put(map, "id", static_cast<uint64_t>(node));
+
+    auto cpus = MakeJsonObject(JsonArrayTag { });
+    const auto& nodeCpus = topology.GetCpusOfNode(node);
+    for (size_t cpu = 0; cpu < topology.GetCpuCount(); ++cpu) {
+      if (nodeCpus[cpu]) {
+        cpus->GetArray().push_back(MakeJsonObject(static_cast<uint64_t>(cpu)));
+      }
+    }
+    map.insert_or_assign("cpus", std::move(cpus));
+
+    // Distances to all online nodes, in the order of their IDs.
+    auto distances = MakeJsonObject(JsonArrayTag { });
+    for (size_t other = 0; other < topology.GetNodeCount(); ++other) {
+      if (topology.IsNodeOnline(other)) {
+        distances->GetArray().push_back(MakeJsonObject(topology.GetDistance(node, other)));
+      }
+    }
+    map.insert_or_assign("distances", std::move(distances));
+    nodes.GetArray().push_back(std::move(description));
+  }
+  return nodes;
+}
+
+const JsonObject& GetField(const JsonObject& map, std::string_view key) {
+  const auto* field = map.WithMap([key](const auto& entries) -> const JsonObject* {
+    auto it = entries.find(std::string { key });
+    return it == entries.end() ? nullptr : it->second.get();
+  });
+  if (UNLIKELY(!field)) {
+    throw JsonException { "missing field in benchmark report: " + std::string { key } };
+  }
+  return *field;
+}
+
+std::vector<double> GetSamples(const JsonObject& result) {
+  std::vector<double> samples;
+  for (const auto& sample : GetField(result, "samples").GetArray()) {
+    samples.push_back(sample->GetNumber<double>());
+  }
+  return samples;
+}
+
+MetricDirection GetDirection(const JsonObject& result) {
+  const auto& better = GetField(result, "better").GetString();
+  if (better == "lower") {
+    return MetricDirection::LowerIsBetter;
+  }
+  if (better == "higher") {
+    return MetricDirection::HigherIsBetter;
+  }
+  throw JsonException { "invalid metric direction in benchmark report: " + better };
+}
+
+double ContinueIncompleteBeta(double a, double b, double x) noexcept {
+  constexpr static const size_t MaxIterations = 300;
+  constexpr static const double Epsilon = 1e-14;
+  constexpr static const double Tiny = 1e-300;
+
+  // The continued fraction of the incomplete beta function, evaluated with the modified Lentz method.
+  auto c = 1.0;
+  auto d = 1.0 - (a + b) * x / (a + 1);
+  d = 1.0 / (std::fabs(d) < Tiny ? Tiny : d);
+  auto result = d;
+  for (size_t m = 1; m <= MaxIterations; ++m) {
+    auto m2 = static_cast<double>(2 * m);
+    auto md = static_cast<double>(m);
+
+    auto numerator = md * (b - md) * x / ((a + m2 - 1) * (a + m2));
+    d = 1.0 + numerator * d;
+    d = 1.0 / (std::fabs(d) < Tiny ? Tiny : d);
+    c = 1.0 + numerator / c;
+    c = std::fabs(c) < Tiny ? Tiny : c;
+    result *= d * c;
+
+    numerator = -(a + md) * (a + b + md) * x / ((a + m2) * (a + m2 + 1));
+    d = 1.0 + numerator * d;
+    d = 1.0 / (std::fabs(d) < Tiny ? Tiny : d);
+    c = 1.0 + numerator / c;
+    c = std::fabs(c) < Tiny ? Tiny : c;
+    auto delta = d * c;
+    result *= delta;
+    if (std::fabs(delta - 1.0) < Epsilon) {
+      break;
+    }
+  }
+  return result;
+}
+
+double RegularizedIncompleteBeta(double a, double b, double x) noexcept {
+  if (x <= 0) {
+    return 0;
+  }
+  if (x >= 1) {
+    return 1;
+  }
+
+  auto front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) +
+                        b * std::log1p(-x));
+  if (x < (a + 1) / (a + b + 2)) {
+    return front * ContinueIncompleteBeta(a, b, x) / a;
+  }
+  return 1.0 - front * ContinueIncompleteBeta(b, a, 1 - x) / b;
+}
+
+} // namespace <anonymous>
+
+SampleStatistics ComputeStatistics(std::vector<double> samples) {
+  SampleStatistics statistics;
+  if (samples.empty()) {
+    return statistics;
+  }
+
+  std::sort(samples.begin(), samples.end());
+  auto count = samples.size();
+  statistics.count = count;
+  statistics.min = samples.front();
+  statistics.max = samples.back();
+
+  double sum = 0;
+  for (auto sample : samples) {
+    sum += sample;
+  }
+  statistics.mean = sum / static_cast<double>(count);
+
+  auto percentile = [&samples](double fraction) {
+    auto rank = fraction * static_cast<double>(samples.size() - 1);
+    auto lower = static_cast<size_t>(rank);
+    auto upper = std::min(lower + 1, samples.size() - 1);
+    return samples[lower] + (samples[upper] - samples[lower]) * (rank - static_cast<double>(lower));
+  };
+  statistics.median = percentile(0.5);
+  statistics.p99 = percentile(0.99);
+
+  if (count >= 2) {
+    double squares = 0;
+    for (auto sample : samples) {
+      squares += (sample - statistics.mean) * (sample - statistics.mean);
+    }
+    statistics.stddev = std::sqrt(squares / static_cast<double>(count - 1));
+  }
+  return statistics;
+}
+
+JsonObject DescribeMachine() {
+  const auto& topology = NumaTopology::Get();
+
+  auto machine = JsonObject::CreateMap(JsonMapStorage::Flat);
+  auto& map = machine.GetFlatMap();
+  utsname name;
+  if (::uname(&name) == 0) {
+    Put(map, "hostname", name.nodename);
+    Put(map, "kernel", std::string { name.sysname } + " " + name.release);
+    Put(map, "architecture", name.machine);
+  }
+  if (auto model = ReadCpuModel()) {
+    Put(map, "cpuModel", std::move(*model));
+  }
+  Put(map, "cpuCount", static_cast<uint64_t>(topology.GetCpuCount()));
+  Put(map, "simd", GetSimdInstructionSet());
+  map.insert_or_assign("caches", MakeJsonObject(DescribeCaches()));
+  map.insert_or_assign("numaNodes", MakeJsonObject(DescribeNumaNodes()));
+  return machine;
+}
+
+JsonObject DescribeCounters(const PerfCounterValues& counters, uint64_t accesses) {
+  auto description = JsonObject::CreateMap(JsonMapStorage::Flat);
+  auto& map = description.GetFlatMap();
+  for (size_t i = 0; i < PerfCounterCount; ++i) {
+    auto counter = static_cast<PerfCounter>(i);
+    auto value = counters.Get(counter);
+    if (!value) {
+      continue;
+    }
+
+    auto entry = MakeJsonObject(JsonFlatMapTag { });
+    Put(entry->GetFlatMap(), "total", *value);
+    if (auto perAccess = counters.GetPer(counter, accesses)) {
+      Put(entry->GetFlatMap(), "perAccess", *perAccess);
+    }
+    map.insert_or_assign(GetPerfCounterName(counter), std::move(entry));
+  }
+  return description;
+}
+
+BenchReport::BenchReport(std::string mode)
+  : _root(JsonObject::CreateMap(JsonMapStorage::Flat)),
+    _parameters(nullptr),
+    _results(nullptr)
+{
+  auto& map = _root.GetFlatMap();
+  Put(map, "schema", Schema);
+  Put(map, "version", Version);
+  Put(map, "mode", std::move(mode));
+  map.insert_or_assign("machine", MakeJsonObject(DescribeMachine()));
+
+  auto parameters = MakeJsonObject(JsonFlatMapTag { });
+  _parameters = parameters.get();
+  map.insert_or_assign("parameters", std::move(parameters));
+
+  auto results = MakeJsonObject(JsonArrayTag { });
+  _results = results.get();
+  map.insert_or_assign("results", std::move(results));
+}
+
+JsonFlatMap& BenchReport::AddResult(std::string name, std::string metric, MetricDirection direction,
+                                    const std::vector<double>& samples) {
+  auto result = MakeJsonObject(JsonFlatMapTag { });
+  auto& map = result->GetFlatMap();
+  Put(map, "name", std::move(name));
+  Put(map, "metric", std::move(metric));
+  Put(map, "better", direction == MetricDirection::LowerIsBetter ? "lower" : "higher");
+
+  auto array = MakeJsonObject(JsonArrayTag { });
+  for (auto sample : samples) {
+    array->GetArray().push_back(MakeJsonObject(sample));
+  }
+  map.insert_or_assign("samples", std::move(array));
+
+  auto statistics = ComputeStatistics(samples);
+  auto summary = MakeJsonObject(JsonFlatMapTag { });
+  auto& summaryMap = summary->GetFlatMap();
+  Put(summaryMap, "count", static_cast<uint64_t>(statistics.count));
+  Put(summaryMap, "min", statistics.min);
+  Put(summaryMap, "max", statistics.max);
+  Put(summaryMap, "mean", statistics.mean);
+  Put(summaryMap, "median", statistics.median);
+  Put(summaryMap, "p99", statistics.p99);
+  Put(summaryMap, "stddev", statistics.stddev);
+  map.insert_or_assign("statistics", std::move(summary));
+
+  auto& results = _results->GetArray();
+  results.push_back(std::move(result));
+  return results.back()->GetFlatMap();
+}
+
+void BenchReport::WriteFile(const char* path) const {
+  auto fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw std::system_error { errno, std::generic_category(), path };
+  }
+  DEFER(1, ::close(fd));
+
+  JsonFileSink sink { fd };
+  JsonSerializer<JsonFileSink> serializer { sink };
+  serializer.Serialize(_root);
+  sink.Append('\n');
+  sink.Flush();
+}
+
+JsonObject LoadReport(const char* path) {
+  MappedFile file { path };
+  auto report = ParseJson(file.GetView(), ObjectAllocator<JsonObject>(), JsonMapStorage::Flat);
+  if (!report.IsMap() || GetField(report, "schema").GetString() != BenchReport::Schema) {
+    throw JsonException { std::string { "not a benchmark report: " } + path };
+  }
+  if (GetField(report, "version").GetNumber<uint64_t>() != BenchReport::Version) {
+    throw JsonException { std::string { "unsupported benchmark report version: " } + path };
+  }
+  return report;
+}
+
+std::vector<Comparison> CompareReports(const JsonObject& baseline, const JsonObject& current,
+                                       const ComparisonOptions& options) {
+  if (GetField(baseline, "mode").GetString() != GetField(current, "mode").GetString()) {
+    throw JsonException { "benchmark reports of different modes cannot be compared" };
+  }
+
+  const auto& baselineResults = GetField(baseline, "results").GetArray();
+  std::vector<Comparison> comparisons;
+  for (const auto& result : GetField(current, "results").GetArray()) {
+    const auto& name = GetField(*result, "name").GetString();
+    const auto& metric = GetField(*result, "metric").GetString();
+    auto match = std::find_if(baselineResults.begin(), baselineResults.end(), [&](const auto& candidate) {
+      return GetField(*candidate, "name").GetString() == name && GetField(*candidate, "metric").GetString() == metric;
+    });
+    if (match == baselineResults.end()) {
+      continue;
+    }
+
+    Comparison comparison;
+    comparison.name = name;
+    comparison.metric = metric;
+    comparison.direction = GetDirection(*result);
+    comparison.baseline = ComputeStatistics(GetSamples(**match));
+    comparison.current = ComputeStatistics(GetSamples(*result));
+    if (comparison.baseline.median != 0) {
+      comparison.change = (comparison.current.median - comparison.baseline.median) / comparison.baseline.median;
+    }
+    comparison.pValue = ComputeWelchPValue(comparison.baseline, comparison.current);
+
+    if (comparison.pValue < options.alpha && std::fabs(comparison.change) >= options.threshold) {
+      auto increased = comparison.change > 0;
+      auto better = increased == (comparison.direction == MetricDirection::HigherIsBetter);
+      comparison.verdict = better ? ComparisonVerdict::Improvement : ComparisonVerdict::Regression;
+    }
+    comparisons.push_back(std::move(comparison));
+  }
+  return comparisons;
+}
+
+double ComputeWelchPValue(const SampleStatistics& lhs, const SampleStatistics& rhs) noexcept {
+  if (lhs.count < 2 || rhs.count < 2) {
+    return 1;
+  }
+
+  auto lhsVariance = lhs.stddev * lhs.stddev / static_cast<double>(lhs.count);
+  auto rhsVariance = rhs.stddev * rhs.stddev / static_cast<double>(rhs.count);
+  auto variance = lhsVariance + rhsVariance;
+  if (variance == 0) {
+    return lhs.mean == rhs.mean ? 1 : 0;
+  }
+
+  auto t = (lhs.mean - rhs.mean) / std::sqrt(variance);
+  auto df = variance * variance / (lhsVariance * lhsVariance / static_cast<double>(lhs.count - 1) +
+                                   rhsVariance * rhsVariance / static_cast<double>(rhs.count - 1));
+  return RegularizedIncompleteBeta(df / 2, 0.5, df / (df + t * t));
+}
+
+} // namespace kv
@@ -0,0 +1,186 @@
+#include "kv/Bench/BenchRunner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace kv {
+
+namespace {
+
+constexpr static const size_t SweepGranularity = 64;
+
+constexpr static const char* ByteSizeSuffixes = "KMGT";
+
+size_t GetStride(size_t workingSetSize, const BandwidthBenchOptions& options) {
+  auto width = GetAccessWidth(options.variant);
+  auto stride = options.stride == 0 ? width : options.stride;
+  if (stride % width != 0) {
+    throw std::invalid_argument { "stride is not a multiple of the access width" };
+  }
+  if (workingSetSize < GetMinBandwidthWorkingSetSize(options)) {
+    throw std::invalid_argument { "working set smaller than one access per buffer" };
+  }
+  return stride;
+}
+
+} // namespace <anonymous>
+
+double Measurement::GetMedian() const {
+  if (samples.empty()) {
+    return 0;
+  }
+
+  auto sorted = samples;
+  auto middle = sorted.begin() + static_cast<ptrdiff_t>(sorted.size() / 2);
+  std::nth_element(sorted.begin(), middle, sorted.end());
+  if (sorted.size() % 2 == 1) {
+    return *middle;
+  }
+  return (*middle + *std::max_element(sorted.begin(), middle)) / 2;
+}
+
+size_t GetMinBandwidthWorkingSetSize(const BandwidthBenchOptions& options) noexcept {
+  auto stride = options.stride == 0 ? GetAccessWidth(options.variant) : options.stride;
+  return options.kind == AccessKind::Copy ? 2 * stride : stride;
+}
+
+ChaseKernel::ChaseKernel(size_t workingSetSize, const LatencyBenchOptions& options)
+  : _buffer(workingSetSize, options.buffer),
+    _current(BuildChaseList(_buffer.GetData(), _buffer.GetSize(), options.stride, options.seed)),
+    _steps(options.steps)
+{ }
+
+BenchResult RunLatencyBench(size_t workingSetSize, const LatencyBenchOptions& options) {
+  ChaseKernel kernel { workingSetSize, options };
+
+  BenchResult result;
+  result.workingSetSize = workingSetSize;
+  result.accesses = kernel.GetAccesses();
+  result.bytes = kernel.GetBytes();
+  result.measurement = Measure([&kernel]() {
+    kernel.Run();
+  }, options.measure);
+  return result;
+}
+
+BandwidthKernel::BandwidthKernel(size_t workingSetSize, const BandwidthBenchOptions& options)
+  : _kind(options.kind),
+    _variant(options.variant),
+    _stride(GetStride(workingSetSize, options)),
+    _src(options.kind == AccessKind::Copy ? workingSetSize / 2 : workingSetSize, options.buffer),
+    _dst(),
+    _value(0),
+    _accesses(_src.GetSize() / _stride),
+    _bytes(_accesses * GetAccessWidth(options.variant))
+{
+  if (_kind == AccessKind::Copy) {
+    _dst.emplace(_src.GetSize(), options.buffer);
+    _bytes *= 2;
+  }
+}
+
+void BandwidthKernel::Run() noexcept {
+  switch (_kind) {
+    case AccessKind::Read:
+      DoNotOptimize(ReadMemory(_variant, _src.GetData(), _src.GetSize(), _stride));
+      break;
+    case AccessKind::Write:
+      WriteMemory(_variant, _src.GetData(), _src.GetSize(), _stride, ++_value);
+      DoNotOptimize(_src.GetData());
+      break;
+    case AccessKind::Copy:
+      CopyMemory(_variant, _dst->GetData(), _src.GetData(), _src.GetSize(), _stride);
+      DoNotOptimize(_dst->GetData());
+      break;
+  }
+}
+
+BenchResult RunBandwidthBench(size_t workingSetSize, const BandwidthBenchOptions& options) {
+  BandwidthKernel kernel { workingSetSize, options };
+
+  BenchResult result;
+  result.workingSetSize = workingSetSize;
+  result.accesses = kernel.GetAccesses();
+  result.bytes = kernel.GetBytes();
+  result.measurement = Measure([&kernel]() {
+    kernel.Run();
+  }, options.measure);
+  return result;
+}
+
+std::vector<size_t> MakeSizeSweep(size_t minSize, size_t maxSize, size_t stepsPerOctave) {
+  std::vector<size_t> sizes;
+  if (minSize == 0 || minSize > maxSize || stepsPerOctave == 0) {
+    return sizes;
+  }
+
+  for (size_t step = 0; ; ++step) {
+    auto exact = static_cast<double>(minSize) * std::exp2(static_cast<double>(step) / stepsPerOctave);
+    if (exact >= static_cast<double>(maxSize)) {
+      break;
+    }
+
+    auto size = static_cast<size_t>(std::llround(exact));
+    if (step > 0 && size >= SweepGranularity) {
+      size = (size + SweepGranularity / 2) / SweepGranularity * SweepGranularity;
+    }
+    if (sizes.empty() || size > sizes.back()) {
+      sizes.push_back(size);
+    }
+  }
+
+  if (sizes.empty() || sizes.back() < maxSize) {
+    sizes.push_back(maxSize);
+  }
+  return sizes;
+}
+
+std::optional<size_t> ParseByteSize(std::string_view text) noexcept {
+  size_t value = 0;
+  size_t i = 0;
+  for (; i < text.size() && std::isdigit(static_cast<unsigned char>(text[i])); ++i) {
+    auto digit = static_cast<size_t>(text[i] - '0');
+    if (value > (std::numeric_limits<size_t>::max() - digit) / 10) {
+      return std::nullopt;
+    }
+    value = value * 10 + digit;
+  }
+  if (i == 0) {
+    return std::nullopt;
+  }
+
+  auto suffix = text.substr(i);
+  if (suffix.empty() || suffix == "B") {
+    return value;
+  }
+
+  auto upper = static_cast<char>(std::toupper(static_cast<unsigned char>(suffix[0])));
+  auto position = std::string_view { ByteSizeSuffixes }.find(upper);
+  suffix.remove_prefix(1);
+  if (position == std::string_view::npos || !(suffix.empty() || suffix == "B" || suffix == "iB")) {
+    return std::nullopt;
+  }
+
+  auto shift = 10 * (position + 1);
+  if (value > (std::numeric_limits<size_t>::max() >> shift)) {
+    return std::nullopt;
+  }
+  return value << shift;
+}
+
+std::string FormatByteSize(size_t size) {
+  std::string_view suffixes { ByteSizeSuffixes };
+  for (auto position = suffixes.size(); position > 0; --position) {
+    auto shift = 10 * position;
+    auto unit = static_cast<size_t>(1) << shift;
+    if (size >= unit && size % unit == 0) {
+      return std::to_string(size >> shift) + suffixes[position - 1];
+    }
+  }
+  return std::to_string(size);
+}
+
+} // namespace kv
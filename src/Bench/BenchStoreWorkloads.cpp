@@ -0,0 +1,170 @@
+#include "kv/Bench/BenchStoreWorkloads.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "kv/Bench/BenchRunner.h"
+#include "kv/Bench/BenchThreads.h"
+#include "kv/Json/JsonObject.h"
+#include "kv/Support/Intrinsics.h"
+
+namespace kv {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ComputeZeta(uint64_t items, double theta) noexcept {
+  double zeta = 0;
+  for (uint64_t i = 1; i <= items; ++i) {
+    zeta += 1.0 / std::pow(static_cast<double>(i), theta);
+  }
+  return zeta;
+}
+
+[[nodiscard]]
+JsonObject MakeStoreRecord(ObjectAllocator<JsonObject> allocator, size_t index, uint64_t version) {
+  auto record = JsonObject::CreateMap(JsonMapStorage::Flat);
+  auto& fields = record.GetFlatMap();
+  fields.insert_or_assign("id", MakeObject<JsonObject>(allocator, index));
+  fields.insert_or_assign("version", MakeObject<JsonObject>(allocator, version));
+  fields.insert_or_assign("name", MakeObject<JsonObject>(allocator, "user-" + std::to_string(index)));
+  return record;
+}
+
+/**
+ * @brief Read a field of the specified record, so that reads touch the value and not only the index.
+ */
+void TouchStoreRecord(const JsonObject& record) noexcept {
+  if (auto fields = record.TryGetFlatMap()) {
+    auto it = fields->find("version");
+    if (it != fields->end()) {
+      DoNotOptimize(it->second->TryGetNumber());
+    }
+  }
+}
+
+[[nodiscard]]
+double GetNanosecondsSince(Clock::time_point start) noexcept {
+  std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+  return elapsed.count();
+}
+
+} // namespace <anonymous>
+
+ZipfianGenerator::ZipfianGenerator(uint64_t items, double theta)
+  : _items(items),
+    _alpha(0),
+    _zetaN(0),
+    _eta(0),
+    _rank1Bound(0)
+{
+  if (items == 0) {
+    throw std::invalid_argument { "zipfian generator without items" };
+  }
+  if (!(theta >= 0 && theta < 1)) {
+    throw std::invalid_argument { "zipfian skew must be in [0, 1)" };
+  }
+
+  _alpha = 1.0 / (1.0 - theta);
+  _zetaN = ComputeZeta(items, theta);
+  auto zeta2 = ComputeZeta(2, theta);
+  _eta = items > 2 ? (1.0 - std::pow(2.0 / static_cast<double>(items), 1.0 - theta)) / (1.0 - zeta2 / _zetaN) : 1.0;
+  _rank1Bound = 1.0 + std::pow(0.5, theta);
+}
+
+StoreWorkloadResult RunStoreWorkload(const StoreWorkloadOptions& options) {
+  ZipfianGenerator ranks { options.keys, options.theta };
+
+  KvStoreOptions storeOptions;
+  storeOptions.shards = options.shards;
+  storeOptions.initialCapacity = options.keys;
+  KvStore store { storeOptions };
+
+  std::vector<std::string> names;
+  names.reserve(options.keys);
+  for (size_t i = 0; i < options.keys; ++i) {
+    names.push_back("user" + std::to_string(i));
+    store.Put(names.back(), MakeStoreRecord(store.GetNodeAllocator(), i, 0));
+  }
+
+  struct ThreadTally {
+    uint64_t reads = 0;
+    uint64_t hits = 0;
+    std::vector<double> readLatencies;
+    std::vector<double> writeLatencies;
+  };
+  std::vector<ThreadTally> threads(options.threads);
+  auto batchSize = std::max(options.batchSize, static_cast<size_t>(1));
+  auto interval = std::max(options.latencyInterval, static_cast<size_t>(1));
+
+  std::atomic<bool> abort { false };
+  auto work = [&](size_t index) {
+    auto& result = threads[index];
+    std::mt19937_64 random { options.seed + index };
+    std::bernoulli_distribution isRead { options.readFraction };
+    std::vector<std::string_view> batch;
+    batch.reserve(batchSize);
+
+    uint64_t done = 0;
+    for (size_t request = 0; done < options.operations; ++request) {
+      if (UNLIKELY(abort.load(std::memory_order_relaxed))) {
+        return;
+      }
+
+      auto sampled = request % interval == 0;
+      Clock::time_point start;
+      if (isRead(random)) {
+        batch.clear();
+        for (size_t i = 0; i < batchSize && done + i < options.operations; ++i) {
+          batch.push_back(names[ranks(random)]);
+        }
+        if (sampled) {
+          start = Clock::now();
+        }
+        if (batch.size() == 1) {
+          result.hits += store.Get(batch.front(), TouchStoreRecord) ? 1 : 0;
+        } else {
+          result.hits += store.MultiGet(batch, [](size_t, const JsonObject& record) {
+            TouchStoreRecord(record);
+          });
+        }
+        if (sampled) {
+          result.readLatencies.push_back(GetNanosecondsSince(start));
+        }
+        result.reads += batch.size();
+        done += batch.size();
+      } else {
+        auto key = ranks(random);
+        auto record = MakeStoreRecord(store.GetNodeAllocator(), key, request);
+        if (sampled) {
+          start = Clock::now();
+        }
+        store.Put(names[key], std::move(record));
+        if (sampled) {
+          result.writeLatencies.push_back(GetNanosecondsSince(start));
+        }
+        ++done;
+      }
+    }
+  };
+
+  StoreWorkloadResult result;
+  result.seconds = RunBenchThreads(options.threads, abort, work);
+  result.operations = options.threads * options.operations;
+  for (auto& thread : threads) {
+    result.reads += thread.reads;
+    result.hits += thread.hits;
+    result.readLatencies.insert(result.readLatencies.end(), thread.readLatencies.begin(), thread.readLatencies.end());
+    result.writeLatencies.insert(result.writeLatencies.end(), thread.writeLatencies.begin(),
+                                 thread.writeLatencies.end());
+  }
+  return result;
+}
+
+} // namespace kv
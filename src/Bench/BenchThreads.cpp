@@ -0,0 +1,220 @@
+#include "kv/Bench/BenchThreads.h"
+
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+
+#include <sched.h>
+
+#include "kv/Support/Defer.h"
+#include "kv/Support/Numa.h"
+
+namespace kv {
+
+void BenchBarrier::ArriveAndWait() {
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock { _mutex };
+    generation = _generation.load(std::memory_order_relaxed);
+    if (++_waiting == _count) {
+      _waiting = 0;
+      _generation.store(generation + 1, std::memory_order_release);
+      return;
+    }
+  }
+
+  while (_generation.load(std::memory_order_acquire) == generation) {
+    std::this_thread::yield();
+  }
+}
+
+void BenchBarrier::ArriveAndDrop() {
+  std::lock_guard<std::mutex> lock { _mutex };
+  --_count;
+  if (_waiting > 0 && _waiting == _count) {
+    _waiting = 0;
+    _generation.fetch_add(1, std::memory_order_release);
+  }
+}
+
+double ThreadBenchResult::GetGigabytesPerSecond(ThreadRole role) const noexcept {
+  double total = 0;
+  for (const auto& thread : threads) {
+    if (thread.role == role) {
+      total += thread.GetGigabytesPerSecond();
+    }
+  }
+  return total;
+}
+
+double ThreadBenchResult::GetNanosecondsPerAccess(ThreadRole role) const noexcept {
+  double total = 0;
+  size_t count = 0;
+  for (const auto& thread : threads) {
+    if (thread.role == role) {
+      total += thread.GetNanosecondsPerAccess();
+      ++count;
+    }
+  }
+  return count == 0 ? 0.0 : total / static_cast<double>(count);
+}
+
+std::vector<size_t> SelectBenchCpus(std::optional<size_t> node) {
+  const auto& topology = NumaTopology::Get();
+
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  auto hasAffinity = ::sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+  std::vector<size_t> cpus;
+  std::vector<size_t> disallowed;
+  for (size_t n = 0; n < topology.GetNodeCount(); ++n) {
+    if (!topology.IsNodeOnline(n) || (node && *node != n)) {
+      continue;
+    }
+
+    const auto& nodeCpus = topology.GetCpusOfNode(n);
+    for (size_t cpu = 0; cpu < topology.GetCpuCount(); ++cpu) {
+      if (!nodeCpus[cpu]) {
+        continue;
+      }
+      if (!hasAffinity || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))) {
+        cpus.push_back(cpu);
+      } else {
+        disallowed.push_back(cpu);
+      }
+    }
+  }
+
+  // Pinning to CPUs outside the affinity mask of the process fails, but it is still better than no CPU at all.
+  if (cpus.empty()) {
+    cpus = std::move(disallowed);
+  }
+  if (cpus.empty()) {
+    cpus.push_back(0);
+  }
+  return cpus;
+}
+
+ThreadBenchResult RunThreadBench(const std::vector<ThreadRole>& roles, const ThreadBenchOptions& options) {
+  using Clock = std::chrono::steady_clock;
+
+  auto cpus = options.cpus.empty() ? SelectBenchCpus() : options.cpus;
+
+  ThreadBenchResult result;
+  result.threads.resize(roles.size());
+  std::vector<std::exception_ptr> errors(roles.size());
+
+  // All workers and the calling thread meet twice at the barrier: once their buffers are ready, and once more to start.
+  BenchBarrier barrier { roles.size() + 1 };
+  std::atomic<bool> abort { false };
+  std::atomic<bool> stop { false };
+
+  auto work = [&](size_t index) {
+    auto& thread = result.threads[index];
+    thread.role = roles[index];
+    thread.cpu = cpus[index % cpus.size()];
+    thread.pinned = PinCurrentThreadToCpu(thread.cpu);
+    thread.memoryNode = options.memoryNode.value_or(NumaTopology::Get().GetNodeOfCpu(thread.cpu));
+
+    std::optional<ChaseKernel> chase;
+    std::optional<BandwidthKernel> bandwidth;
+    std::optional<PerfCounterGroup> group;
+    if (options.collectCounters) {
+      group.emplace();
+    }
+    try {
+      if (thread.role == ThreadRole::Chase) {
+        auto latency = options.latency;
+        latency.buffer.numaNode = thread.memoryNode;
+        chase.emplace(options.workingSetSize, latency);
+      } else {
+        auto bandwidthOptions = options.bandwidth;
+        bandwidthOptions.buffer.numaNode = thread.memoryNode;
+        bandwidth.emplace(options.workingSetSize, bandwidthOptions);
+      }
+    } catch (...) {
+      errors[index] = std::current_exception();
+      abort.store(true, std::memory_order_relaxed);
+    }
+
+    barrier.ArriveAndWait();
+    barrier.ArriveAndWait();
+    if (abort.load(std::memory_order_relaxed)) {
+      return;
+    }
+
+    auto accesses = chase ? chase->GetAccesses() : bandwidth->GetAccesses();
+    auto bytes = chase ? chase->GetBytes() : bandwidth->GetBytes();
+    auto start = Clock::now();
+    {
+      PerfCounterScope scope { group ? &*group : nullptr, thread.counters };
+      while (!stop.load(std::memory_order_relaxed)) {
+        if (chase) {
+          chase->Run();
+        } else {
+          bandwidth->Run();
+        }
+        ++thread.runs;
+      }
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    thread.accesses = thread.runs * accesses;
+    thread.bytes = thread.runs * bytes;
+    thread.seconds = elapsed.count();
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(roles.size());
+  {
+    DEFER(1, for (auto& thread : threads) thread.join());
+
+    std::exception_ptr spawnError;
+    for (size_t i = 0; i < roles.size(); ++i) {
+      try {
+        threads.emplace_back(work, i);
+      } catch (const std::system_error &) {
+        spawnError = std::current_exception();
+        abort.store(true, std::memory_order_relaxed);
+        // The threads that could not be started never arrive.
+        for (auto missing = i; missing < roles.size(); ++missing) {
+          barrier.ArriveAndDrop();
+        }
+        break;
+      }
+    }
+
+    barrier.ArriveAndWait();
+    barrier.ArriveAndWait();
+    if (!abort.load(std::memory_order_relaxed)) {
+      std::this_thread::sleep_for(options.duration);
+    }
+    stop.store(true, std::memory_order_relaxed);
+
+    if (spawnError) {
+      errors.push_back(spawnError);
+    }
+  }
+
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+  return result;
+}
+
+std::vector<size_t> MakeThreadSweep(size_t maxThreads) {
+  std::vector<size_t> counts;
+  for (size_t count = 1; count < maxThreads; count *= 2) {
+    counts.push_back(count);
+  }
+  if (maxThreads > 0) {
+    counts.push_back(maxThreads);
+  }
+  return counts;
+}
+
+} // namespace kv
@@ -0,0 +1,1228 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "kv/Bench/BenchAllocWorkloads.h"
+#include "kv/Bench/BenchAllocators.h"
+#include "kv/Bench/BenchBuffer.h"
+#include "kv/Bench/BenchCounters.h"
+#include "kv/Bench/BenchKernels.h"
+#include "kv/Bench/BenchReport.h"
+#include "kv/Bench/BenchRunner.h"
+#include "kv/Bench/BenchStoreWorkloads.h"
+#include "kv/Bench/BenchThreads.h"
+#include "kv/Support/Intrinsics.h"
+#include "kv/Support/Numa.h"
+
+namespace {
+
+constexpr const char* Usage =
+    "usage: mab <mode> [options]\n"
+    "       mab compare BASELINE CURRENT [--threshold PCT] [--alpha P]\n"
+    "\n"
+    "modes:\n"
+    "  latency               chase pointers through randomly linked cache lines\n"
+    "  bandwidth             read, write or copy memory sequentially or with a stride\n"
+    "  scaling               run the latency or bandwidth workload on a growing number of threads\n"
+    "  loaded-latency        chase pointers on one thread next to a growing number of bandwidth threads\n"
+    "  alloc-throughput      allocate and release batches of chunks of one size on a single thread\n"
+    "  alloc-cross-thread    allocate chunks on producer threads and release them on consumer threads\n"
+    "  alloc-churn           replace random live chunks on a growing number of threads that trade them (larson)\n"
+    "  alloc-fragmentation   allocate growing chunks, release most of them, and track the resident set\n"
+    "  alloc-json            build and tear down JsonObject trees\n"
+    "  kv-zipf               read and write a KvStore with zipfian keys on a growing number of threads\n"
+    "  compare               compare two reports written with --json and flag significant changes\n"
+    "\n"
+    "options:\n"
+    "  --min-size SIZE       smallest working set (default 4K)\n"
+    "  --max-size SIZE       largest working set (default 256M)\n"
+    "  --steps-per-octave N  working sets per doubling of the size (default 1)\n"
+    "  --stride SIZE         distance between accesses (default 64 for latency, sequential for bandwidth)\n"
+    "  --kernel KIND         bandwidth kernel: read, write or copy (default read)\n"
+    "  --variant VARIANT     bandwidth kernel variant: scalar or simd (default simd)\n"
+    "  --memory POLICY       buffer memory: malloc, mmap, thp, huge-2m or huge-1g (default mmap)\n"
+    "  --node N              bind buffers to NUMA node N (default: the node of the accessing thread)\n"
+    "  --samples N           samples per result (default 5, or 3 runs for multi-threaded modes)\n"
+    "  --min-time MS         minimal duration of a sample in milliseconds (default 10)\n"
+    "  --seed N              seed of the random list order (default 1)\n"
+    "  --counters            report hardware performance counters per access, where available\n"
+    "  --json FILE           write the machine, the parameters and all samples as JSON to FILE\n"
+    "\n"
+    "multi-threaded options:\n"
+    "  --workload WORKLOAD   scaling workload: latency or bandwidth (default bandwidth)\n"
+    "  --threads N           largest number of threads (default: all selected CPUs)\n"
+    "  --cpu-node N          run threads on the CPUs of NUMA node N (default: all nodes, one after another)\n"
+    "  --size SIZE           working set of every thread (default 64M)\n"
+    "  --duration MS         duration of every run in milliseconds (default 200)\n"
+    "  --per-thread          report every thread in addition to the aggregate\n"
+    "\n"
+    "allocator options:\n"
+    "  --allocators LIST     comma-separated allocators: raw, thread-cache, arena, slab-pool, malloc, jemalloc or\n"
+    "                        mimalloc (default: all that are available)\n"
+    "  --operations N        allocations per thread, or per producer for alloc-cross-thread (default 512K)\n"
+    "  --records N           records of every tree of alloc-json (default 1024)\n"
+    "--min-size and --max-size bound the chunk sizes, --threads the threads or producer and consumer pairs, and\n"
+    "--size the live size of alloc-fragmentation.\n"
+    "\n"
+    "store options:\n"
+    "  --keys N              keys loaded into the store (default 256K)\n"
+    "  --reads PCT           percentage of requests that read (default 95)\n"
+    "  --theta X             zipfian skew of the keys in [0, 1), 0 for uniform (default 0.99)\n"
+    "  --batch N             keys of every read, which uses MultiGet if more than 1 (default 1)\n"
+    "  --shards N            lock stripes of the store (default 64)\n"
+    "--threads and --operations apply as for the allocator modes, with --operations the keys every thread accesses.\n"
+    "\n"
+    "compare options:\n"
+    "  --threshold PCT       smallest relative change of the median that is flagged (default 5)\n"
+    "  --alpha P             significance level of the Welch t-test on the samples (default 0.05)\n"
+    "compare exits with status 3 if it flags a regression.\n"
+    "\n"
+    "Sizes accept the suffixes K, M, G and T, e.g. 64K or 4G.\n";
+
+enum class Mode {
+  Latency,
+  Bandwidth,
+  Scaling,
+  LoadedLatency,
+  AllocThroughput,
+  AllocCrossThread,
+  AllocChurn,
+  AllocFragmentation,
+  AllocJson,
+  KvZipf,
+  Compare,
+};
+
+struct Options {
+  Mode mode = Mode::Latency;
+  size_t minSize = 4096;
+  size_t maxSize = static_cast<size_t>(256) << 20;
+  size_t stepsPerOctave = 1;
+  std::optional<size_t> stride;
+  kv::AccessKind kind = kv::AccessKind::Read;
+  kv::KernelVariant variant = kv::KernelVariant::Simd;
+  kv::BenchBufferOptions buffer;
+  kv::MeasureOptions measure;
+  std::optional<size_t> samples;
+  uint64_t seed = 1;
+
+  kv::ThreadRole workload = kv::ThreadRole::Bandwidth;
+  std::optional<size_t> threads;
+  std::optional<size_t> cpuNode;
+  size_t size = static_cast<size_t>(64) << 20;
+  std::chrono::milliseconds duration { 200 };
+  bool perThread = false;
+  bool counters = false;
+  std::string json;
+
+  std::vector<kv::BenchAllocatorKind> allocators;
+  std::optional<uint64_t> operations;
+  size_t records = kv::JsonTreeOptions { }.records;
+
+  kv::StoreWorkloadOptions store;
+
+  std::string baseline;
+  std::string current;
+  kv::ComparisonOptions comparison;
+}; // struct Options
+
+constexpr static const size_t DefaultThreadRepetitions = 3;
+
+const char* GetModeName(Mode mode) noexcept {
+  switch (mode) {
+    case Mode::Latency:
+      return "latency";
+    case Mode::Bandwidth:
+      return "bandwidth";
+    case Mode::Scaling:
+      return "scaling";
+    case Mode::LoadedLatency:
+      return "loaded-latency";
+    case Mode::AllocThroughput:
+      return "alloc-throughput";
+    case Mode::AllocCrossThread:
+      return "alloc-cross-thread";
+    case Mode::AllocChurn:
+      return "alloc-churn";
+    case Mode::AllocFragmentation:
+      return "alloc-fragmentation";
+    case Mode::AllocJson:
+      return "alloc-json";
+    case Mode::KvZipf:
+      return "kv-zipf";
+    case Mode::Compare:
+      return "compare";
+  }
+  UNREACHABLE();
+}
+
+bool IsAllocMode(Mode mode) noexcept {
+  return mode == Mode::AllocThroughput || mode == Mode::AllocCrossThread || mode == Mode::AllocChurn ||
+         mode == Mode::AllocFragmentation || mode == Mode::AllocJson;
+}
+
+std::pair<size_t, size_t> GetDefaultSizes(Mode mode) noexcept {
+  switch (mode) {
+    case Mode::AllocThroughput:
+      return { 16, static_cast<size_t>(16) << 10 };
+    case Mode::AllocCrossThread:
+      return { kv::CrossThreadOptions { }.minSize, kv::CrossThreadOptions { }.maxSize };
+    case Mode::AllocChurn:
+      return { kv::ChurnOptions { }.minSize, kv::ChurnOptions { }.maxSize };
+    case Mode::AllocFragmentation:
+      return { kv::FragmentationOptions { }.minSize, kv::FragmentationOptions { }.maxSize };
+    default:
+      return { 4096, static_cast<size_t>(256) << 20 };
+  }
+}
+
+[[noreturn]]
+void Fail(const std::string& message) {
+  std::fprintf(stderr, "mab: %s\n\n%s", message.c_str(), Usage);
+  std::exit(2);
+}
+
+size_t ParseCount(std::string_view option, std::string_view value) {
+  size_t count = 0;
+  auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), count);
+  if (ec != std::errc { } || ptr != value.data() + value.size()) {
+    Fail("invalid value for " + std::string { option } + ": " + std::string { value });
+  }
+  return count;
+}
+
+size_t ParseSize(std::string_view option, std::string_view value) {
+  auto size = kv::ParseByteSize(value);
+  if (!size || *size == 0) {
+    Fail("invalid size for " + std::string { option } + ": " + std::string { value });
+  }
+  return *size;
+}
+
+size_t ParseNode(std::string_view option, std::string_view value) {
+  auto node = ParseCount(option, value);
+  if (!kv::NumaTopology::Get().IsNodeOnline(node)) {
+    Fail("NUMA node is not online: " + std::string { value });
+  }
+  return node;
+}
+
+double ParseFraction(std::string_view option, std::string_view value, double scale) {
+  std::string text { value };
+  char* end = nullptr;
+  auto number = std::strtod(text.c_str(), &end);
+  if (text.empty() || end != text.c_str() + text.size() || !(number >= 0) || !std::isfinite(number)) {
+    Fail("invalid value for " + std::string { option } + ": " + text);
+  }
+  return number / scale;
+}
+
+std::vector<kv::BenchAllocatorKind> ParseAllocators(std::string_view option, std::string_view value) {
+  std::vector<kv::BenchAllocatorKind> kinds;
+  while (true) {
+    auto comma = value.find(',');
+    auto name = value.substr(0, comma);
+    auto kind = kv::ParseBenchAllocatorKind(name);
+    if (!kind) {
+      Fail("invalid value for " + std::string { option } + ": " + std::string { name });
+    }
+    if (!kv::BenchAllocator::IsAvailable(*kind)) {
+      Fail("allocator is not available: " + std::string { name });
+    }
+    kinds.push_back(*kind);
+    if (comma == std::string_view::npos) {
+      return kinds;
+    }
+    value.remove_prefix(comma + 1);
+  }
+}
+
+template <typename T>
+T ParseName(std::string_view option, std::string_view value, std::optional<T> parsed) {
+  if (!parsed) {
+    Fail("invalid value for " + std::string { option } + ": " + std::string { value });
+  }
+  return *parsed;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  if (argc < 2) {
+    Fail("missing mode");
+  }
+
+  Options options;
+  std::string_view mode { argv[1] };
+  if (mode == "latency") {
+    options.mode = Mode::Latency;
+  } else if (mode == "bandwidth") {
+    options.mode = Mode::Bandwidth;
+  } else if (mode == "scaling") {
+    options.mode = Mode::Scaling;
+  } else if (mode == "loaded-latency") {
+    options.mode = Mode::LoadedLatency;
+  } else if (mode == "alloc-throughput") {
+    options.mode = Mode::AllocThroughput;
+  } else if (mode == "alloc-cross-thread") {
+    options.mode = Mode::AllocCrossThread;
+  } else if (mode == "alloc-churn") {
+    options.mode = Mode::AllocChurn;
+  } else if (mode == "alloc-fragmentation") {
+    options.mode = Mode::AllocFragmentation;
+  } else if (mode == "alloc-json") {
+    options.mode = Mode::AllocJson;
+  } else if (mode == "kv-zipf") {
+    options.mode = Mode::KvZipf;
+  } else if (mode == "compare") {
+    options.mode = Mode::Compare;
+    if (argc < 4) {
+      Fail("compare needs a baseline and a current report");
+    }
+    options.baseline = argv[2];
+    options.current = argv[3];
+  } else if (mode == "-h" || mode == "--help") {
+    std::fputs(Usage, stdout);
+    std::exit(0);
+  } else {
+    Fail("unknown mode: " + std::string { mode });
+  }
+
+  std::optional<size_t> minSize;
+  std::optional<size_t> maxSize;
+  for (auto i = options.mode == Mode::Compare ? 4 : 2; i < argc; ++i) {
+    std::string_view option { argv[i] };
+    if (option == "--per-thread") {
+      options.perThread = true;
+      continue;
+    }
+    if (option == "--counters") {
+      options.counters = true;
+      continue;
+    }
+
+    if (i + 1 >= argc) {
+      Fail("missing value for " + std::string { option });
+    }
+    std::string_view value { argv[++i] };
+
+    if (option == "--min-size") {
+      minSize = ParseSize(option, value);
+    } else if (option == "--max-size") {
+      maxSize = ParseSize(option, value);
+    } else if (option == "--steps-per-octave") {
+      options.stepsPerOctave = ParseCount(option, value);
+    } else if (option == "--stride") {
+      options.stride = ParseSize(option, value);
+    } else if (option == "--kernel") {
+      options.kind = ParseName(option, value, kv::ParseAccessKind(value));
+    } else if (option == "--variant") {
+      options.variant = ParseName(option, value, kv::ParseKernelVariant(value));
+    } else if (option == "--memory") {
+      options.buffer.policy = ParseName(option, value, kv::ParseMemoryPolicy(value));
+    } else if (option == "--node") {
+      options.buffer.numaNode = ParseNode(option, value);
+    } else if (option == "--samples") {
+      options.samples = ParseCount(option, value);
+    } else if (option == "--min-time") {
+      options.measure.minSampleTime = std::chrono::milliseconds { ParseCount(option, value) };
+    } else if (option == "--seed") {
+      options.seed = ParseCount(option, value);
+    } else if (option == "--workload") {
+      if (value == "latency") {
+        options.workload = kv::ThreadRole::Chase;
+      } else if (value == "bandwidth") {
+        options.workload = kv::ThreadRole::Bandwidth;
+      } else {
+        Fail("invalid value for --workload: " + std::string { value });
+      }
+    } else if (option == "--threads") {
+      options.threads = ParseCount(option, value);
+    } else if (option == "--cpu-node") {
+      options.cpuNode = ParseNode(option, value);
+    } else if (option == "--size") {
+      options.size = ParseSize(option, value);
+    } else if (option == "--duration") {
+      options.duration = std::chrono::milliseconds { ParseCount(option, value) };
+    } else if (option == "--allocators") {
+      options.allocators = ParseAllocators(option, value);
+    } else if (option == "--operations") {
+      options.operations = ParseCount(option, value);
+    } else if (option == "--records") {
+      options.records = ParseCount(option, value);
+    } else if (option == "--keys") {
+      options.store.keys = ParseSize(option, value);
+    } else if (option == "--reads") {
+      options.store.readFraction = ParseFraction(option, value, 100);
+    } else if (option == "--theta") {
+      options.store.theta = ParseFraction(option, value, 1);
+    } else if (option == "--batch") {
+      options.store.batchSize = ParseCount(option, value);
+    } else if (option == "--shards") {
+      options.store.shards = ParseCount(option, value);
+    } else if (option == "--json") {
+      options.json = value;
+    } else if (option == "--threshold") {
+      options.comparison.threshold = ParseFraction(option, value, 100);
+    } else if (option == "--alpha") {
+      options.comparison.alpha = ParseFraction(option, value, 1);
+    } else {
+      Fail("unknown option: " + std::string { option });
+    }
+  }
+
+  auto defaultSizes = GetDefaultSizes(options.mode);
+  options.minSize = minSize.value_or(defaultSizes.first);
+  options.maxSize = maxSize.value_or(defaultSizes.second);
+  if (options.allocators.empty()) {
+    options.allocators = kv::GetAvailableBenchAllocators();
+  }
+  if (options.minSize > options.maxSize) {
+    Fail("--min-size exceeds --max-size");
+  }
+  options.measure.sampleCount = options.samples.value_or(options.measure.sampleCount);
+  options.measure.collectCounters = options.counters;
+  if (options.stepsPerOctave == 0 || options.samples == 0 || options.threads == 0 || options.operations == 0 ||
+      options.records == 0 || options.store.keys == 0 || options.store.batchSize == 0 || options.store.shards == 0) {
+    Fail("--steps-per-octave, --samples, --threads, --operations, --records, --keys, --batch and --shards must be "
+         "positive");
+  }
+  if (options.store.readFraction > 1) {
+    Fail("--reads exceeds 100");
+  }
+  if (options.store.theta >= 1) {
+    Fail("--theta must be below 1");
+  }
+  return options;
+}
+
+kv::LatencyBenchOptions GetLatencyOptions(const Options& options) {
+  kv::LatencyBenchOptions latency;
+  latency.stride = options.stride.value_or(latency.stride);
+  latency.seed = options.seed;
+  latency.buffer = options.buffer;
+  latency.measure = options.measure;
+  if (latency.stride % sizeof(void *) != 0) {
+    Fail("--stride must be a multiple of the pointer size");
+  }
+  return latency;
+}
+
+kv::BandwidthBenchOptions GetBandwidthOptions(const Options& options) {
+  kv::BandwidthBenchOptions bandwidth;
+  bandwidth.kind = options.kind;
+  bandwidth.variant = options.variant;
+  bandwidth.stride = options.stride.value_or(0);
+  bandwidth.buffer = options.buffer;
+  bandwidth.measure = options.measure;
+
+  auto width = kv::GetAccessWidth(bandwidth.variant);
+  if (bandwidth.stride % width != 0) {
+    Fail("--stride must be a multiple of the access width of " + std::to_string(width) + " bytes");
+  }
+  return bandwidth;
+}
+
+kv::ThreadBenchOptions GetThreadOptions(const Options& options) {
+  kv::ThreadBenchOptions threads;
+  threads.workingSetSize = options.size;
+  threads.duration = options.duration;
+  threads.cpus = kv::SelectBenchCpus(options.cpuNode);
+  threads.memoryNode = options.buffer.numaNode;
+  threads.collectCounters = options.counters;
+  threads.latency = GetLatencyOptions(options);
+  threads.bandwidth = GetBandwidthOptions(options);
+
+  // Loaded latency runs both workloads, while scaling runs only the selected one.
+  auto loaded = options.mode == Mode::LoadedLatency;
+  if ((loaded || options.workload == kv::ThreadRole::Chase) && options.size < threads.latency.stride) {
+    Fail("--size must be at least the latency stride of " + kv::FormatByteSize(threads.latency.stride));
+  }
+  auto minBandwidthSize = kv::GetMinBandwidthWorkingSetSize(threads.bandwidth);
+  if ((loaded || options.workload == kv::ThreadRole::Bandwidth) && options.size < minBandwidthSize) {
+    Fail("--size must be at least " + kv::FormatByteSize(minBandwidthSize) + " for the bandwidth kernel");
+  }
+  return threads;
+}
+
+void PrintHeader(const Options& options) {
+  std::printf("# mab %s: memory %s", GetModeName(options.mode), kv::GetMemoryPolicyName(options.buffer.policy));
+  if (options.buffer.numaNode) {
+    std::printf(", node %zu", *options.buffer.numaNode);
+  }
+  std::printf(", simd %s\n", kv::GetSimdInstructionSet());
+  if (options.counters && !kv::PerfCounterGroup { }.IsAnyAvailable()) {
+    std::printf("# hardware performance counters are unavailable\n");
+  }
+}
+
+std::string FormatCounterHeader(const Options& options) {
+  if (!options.counters) {
+    return "";
+  }
+  char text[128];
+  std::snprintf(text, sizeof(text), " %8s %11s %11s %11s %11s", "ipc", "l1/access", "llc/access", "dtlb/access",
+                "stall/cycle");
+  return text;
+}
+
+std::string FormatCounters(const Options& options, const kv::PerfCounterValues& counters, uint64_t accesses) {
+  if (!options.counters) {
+    return "";
+  }
+
+  auto format = [](std::optional<double> value, int width, int precision) {
+    char text[32];
+    if (value) {
+      std::snprintf(text, sizeof(text), " %*.*f", width, precision, *value);
+    } else {
+      std::snprintf(text, sizeof(text), " %*s", width, "-");
+    }
+    return std::string { text };
+  };
+
+  std::optional<double> stalls;
+  auto stallCycles = counters.Get(kv::PerfCounter::StallCycles);
+  auto cycles = counters.Get(kv::PerfCounter::Cycles);
+  if (stallCycles && cycles && *cycles > 0) {
+    stalls = static_cast<double>(*stallCycles) / static_cast<double>(*cycles);
+  }
+
+  return format(counters.GetInstructionsPerCycle(), 8, 2) +
+         format(counters.GetPer(kv::PerfCounter::L1Misses, accesses), 11, 4) +
+         format(counters.GetPer(kv::PerfCounter::LlcMisses, accesses), 11, 4) +
+         format(counters.GetPer(kv::PerfCounter::DtlbMisses, accesses), 11, 4) +
+         format(stalls, 11, 3);
+}
+
+std::string FormatCounters(const Options& options, const kv::BenchResult& result) {
+  return FormatCounters(options, result.measurement.counters, result.measurement.GetSampledCalls() * result.accesses);
+}
+
+void SumCounters(const std::vector<kv::ThreadBenchResult>& runs, kv::ThreadRole role, kv::PerfCounterValues& counters,
+                 uint64_t& accesses) {
+  for (const auto& run : runs) {
+    for (const auto& thread : run.threads) {
+      if (thread.role == role) {
+        counters += thread.counters;
+        accesses += thread.accesses;
+      }
+    }
+  }
+}
+
+std::string FormatCounters(const Options& options, const std::vector<kv::ThreadBenchResult>& runs,
+                           kv::ThreadRole role) {
+  kv::PerfCounterValues counters;
+  uint64_t accesses = 0;
+  SumCounters(runs, role, counters, accesses);
+  return FormatCounters(options, counters, accesses);
+}
+
+void PrintThreads(const Options& options, const kv::ThreadBenchResult& result) {
+  for (size_t i = 0; i < result.threads.size(); ++i) {
+    const auto& thread = result.threads[i];
+    std::printf("#   thread %zu: %s, cpu %zu%s, node %zu, %.2f GB/s, %.3f ns/access%s\n", i,
+                thread.role == kv::ThreadRole::Chase ? "latency" : "bandwidth", thread.cpu,
+                thread.pinned ? "" : " (unpinned)", thread.memoryNode, thread.GetGigabytesPerSecond(),
+                thread.GetNanosecondsPerAccess(), FormatCounters(options, thread.counters, thread.accesses).c_str());
+  }
+}
+
+
+template <typename T>
+void Put(kv::JsonFlatMap& map, std::string key, T&& value) {
+  map.insert_or_assign(std::move(key), kv::MakeJsonObject(std::forward<T>(value)));
+}
+
+size_t GetThreadRepetitions(const Options& options) noexcept {
+  return options.samples.value_or(DefaultThreadRepetitions);
+}
+
+void DescribeAllocParameters(const Options& options, kv::JsonFlatMap& parameters);
+void DescribeStoreParameters(const Options& options, kv::JsonFlatMap& parameters);
+
+void DescribeParameters(const Options& options, kv::JsonFlatMap& parameters) {
+  if (IsAllocMode(options.mode)) {
+    DescribeAllocParameters(options, parameters);
+    return;
+  }
+  if (options.mode == Mode::KvZipf) {
+    DescribeStoreParameters(options, parameters);
+    return;
+  }
+
+  auto isSweep = options.mode == Mode::Latency || options.mode == Mode::Bandwidth;
+  auto hasLatency = options.mode != Mode::Bandwidth;
+  auto hasBandwidth = options.mode != Mode::Latency;
+
+  Put(parameters, "memory", kv::GetMemoryPolicyName(options.buffer.policy));
+  if (options.buffer.numaNode) {
+    Put(parameters, "node", static_cast<uint64_t>(*options.buffer.numaNode));
+  } else {
+    Put(parameters, "node", nullptr);
+  }
+  auto samples = isSweep ? options.measure.sampleCount : GetThreadRepetitions(options);
+  Put(parameters, "samples", static_cast<uint64_t>(samples));
+  Put(parameters, "counters", options.counters);
+
+  if (isSweep) {
+    Put(parameters, "minSize", static_cast<uint64_t>(options.minSize));
+    Put(parameters, "maxSize", static_cast<uint64_t>(options.maxSize));
+    Put(parameters, "stepsPerOctave", static_cast<uint64_t>(options.stepsPerOctave));
+    Put(parameters, "minSampleTimeNs", static_cast<uint64_t>(options.measure.minSampleTime.count()));
+  }
+  if (hasLatency) {
+    auto latency = GetLatencyOptions(options);
+    Put(parameters, "latencyStride", static_cast<uint64_t>(latency.stride));
+    Put(parameters, "chaseSteps", static_cast<uint64_t>(latency.steps));
+    Put(parameters, "seed", latency.seed);
+  }
+  if (hasBandwidth) {
+    auto bandwidth = GetBandwidthOptions(options);
+    Put(parameters, "kernel", kv::GetAccessKindName(bandwidth.kind));
+    Put(parameters, "variant", kv::GetKernelVariantName(bandwidth.variant));
+    Put(parameters, "bandwidthStride",
+        static_cast<uint64_t>(bandwidth.stride == 0 ? kv::GetAccessWidth(bandwidth.variant) : bandwidth.stride));
+  }
+  if (!isSweep) {
+    auto threadOptions = GetThreadOptions(options);
+    if (options.mode == Mode::Scaling) {
+      Put(parameters, "workload", options.workload == kv::ThreadRole::Chase ? "latency" : "bandwidth");
+    }
+    Put(parameters, "threads", static_cast<uint64_t>(options.threads.value_or(threadOptions.cpus.size())));
+    auto cpus = kv::MakeJsonObject(kv::JsonArrayTag { });
+    for (auto cpu : threadOptions.cpus) {
+      cpus->GetArray().push_back(kv::MakeJsonObject(static_cast<uint64_t>(cpu)));
+    }
+    parameters.insert_or_assign("cpus", std::move(cpus));
+    Put(parameters, "size", static_cast<uint64_t>(options.size));
+    Put(parameters, "durationNs", static_cast<uint64_t>(std::chrono::nanoseconds { options.duration }.count()));
+  }
+}
+
+void AddSweepResult(const Options& options, kv::BenchReport& report, const kv::BenchResult& result, bool bandwidth) {
+  std::vector<double> samples;
+  for (auto sample : result.measurement.samples) {
+    samples.push_back(bandwidth ? static_cast<double>(result.bytes) / sample / 1e9
+                                : sample * 1e9 / static_cast<double>(result.accesses));
+  }
+
+  auto& map = report.AddResult("size=" + kv::FormatByteSize(result.workingSetSize),
+                               bandwidth ? "GB/s" : "ns/access",
+                               bandwidth ? kv::MetricDirection::HigherIsBetter : kv::MetricDirection::LowerIsBetter,
+                               samples);
+  Put(map, "workingSetSize", static_cast<uint64_t>(result.workingSetSize));
+  Put(map, "accesses", static_cast<uint64_t>(result.accesses));
+  Put(map, "bytes", static_cast<uint64_t>(result.bytes));
+  Put(map, "iterations", static_cast<uint64_t>(result.measurement.iterations));
+  if (options.counters) {
+    Put(map, "counters", kv::DescribeCounters(result.measurement.counters,
+                                              result.measurement.GetSampledCalls() * result.accesses));
+  }
+}
+
+void AddThreadResult(const Options& options, kv::JsonFlatMap& map, const std::vector<kv::ThreadBenchResult>& runs,
+                     kv::ThreadRole role) {
+  if (options.counters) {
+    kv::PerfCounterValues counters;
+    uint64_t accesses = 0;
+    SumCounters(runs, role, counters, accesses);
+    Put(map, "counters", kv::DescribeCounters(counters, accesses));
+  }
+
+  // The threads of the last run, which ran on the same CPUs as those of all other runs.
+  auto threads = kv::MakeJsonObject(kv::JsonArrayTag { });
+  for (const auto& thread : runs.back().threads) {
+    auto description = kv::MakeJsonObject(kv::JsonFlatMapTag { });
+    auto& entry = description->GetFlatMap();
+    Put(entry, "role", thread.role == kv::ThreadRole::Chase ? "latency" : "bandwidth");
+    Put(entry, "cpu", static_cast<uint64_t>(thread.cpu));
+    Put(entry, "pinned", thread.pinned);
+    Put(entry, "memoryNode", static_cast<uint64_t>(thread.memoryNode));
+    Put(entry, "runs", thread.runs);
+    Put(entry, "gigabytesPerSecond", thread.GetGigabytesPerSecond());
+    Put(entry, "nanosecondsPerAccess", thread.GetNanosecondsPerAccess());
+    if (options.counters) {
+      Put(entry, "counters", kv::DescribeCounters(thread.counters, thread.accesses));
+    }
+    threads->GetArray().push_back(std::move(description));
+  }
+  map.insert_or_assign("threads", std::move(threads));
+}
+
+std::vector<kv::ThreadBenchResult> RunThreadBenchRepeatedly(const Options& options,
+                                                            const std::vector<kv::ThreadRole>& roles,
+                                                            const kv::ThreadBenchOptions& threadOptions) {
+  std::vector<kv::ThreadBenchResult> runs;
+  for (size_t i = 0; i < GetThreadRepetitions(options); ++i) {
+    runs.push_back(kv::RunThreadBench(roles, threadOptions));
+  }
+  return runs;
+}
+
+void RunLatency(const Options& options, kv::BenchReport* report) {
+  auto latency = GetLatencyOptions(options);
+
+  PrintHeader(options);
+  std::printf("# stride %s\n", kv::FormatByteSize(latency.stride).c_str());
+  std::printf("%-12s %12s%s\n", "size", "ns/access", FormatCounterHeader(options).c_str());
+  for (auto size : kv::MakeSizeSweep(options.minSize, options.maxSize, options.stepsPerOctave)) {
+    if (size < latency.stride) {
+      continue;
+    }
+    auto result = kv::RunLatencyBench(size, latency);
+    std::printf("%-12s %12.2f%s\n", kv::FormatByteSize(size).c_str(), result.GetNanosecondsPerAccess(),
+                FormatCounters(options, result).c_str());
+    std::fflush(stdout);
+    if (report) {
+      AddSweepResult(options, *report, result, false);
+    }
+  }
+}
+
+void RunBandwidth(const Options& options, kv::BenchReport* report) {
+  auto bandwidth = GetBandwidthOptions(options);
+  auto stride = bandwidth.stride == 0 ? kv::GetAccessWidth(bandwidth.variant) : bandwidth.stride;
+  auto minSize = kv::GetMinBandwidthWorkingSetSize(bandwidth);
+
+  PrintHeader(options);
+  std::printf("# kernel %s, variant %s, stride %s\n", kv::GetAccessKindName(bandwidth.kind),
+              kv::GetKernelVariantName(bandwidth.variant), kv::FormatByteSize(stride).c_str());
+  std::printf("%-12s %12s %12s%s\n", "size", "GB/s", "ns/access", FormatCounterHeader(options).c_str());
+  for (auto size : kv::MakeSizeSweep(options.minSize, options.maxSize, options.stepsPerOctave)) {
+    if (size < minSize) {
+      continue;
+    }
+    auto result = kv::RunBandwidthBench(size, bandwidth);
+    std::printf("%-12s %12.2f %12.3f%s\n", kv::FormatByteSize(size).c_str(), result.GetGigabytesPerSecond(),
+                result.GetNanosecondsPerAccess(), FormatCounters(options, result).c_str());
+    std::fflush(stdout);
+    if (report) {
+      AddSweepResult(options, *report, result, true);
+    }
+  }
+}
+
+void RunScaling(const Options& options, kv::BenchReport* report) {
+  auto threadOptions = GetThreadOptions(options);
+  auto maxThreads = options.threads.value_or(threadOptions.cpus.size());
+  auto isLatency = options.workload == kv::ThreadRole::Chase;
+
+  PrintHeader(options);
+  std::printf("# workload %s, kernel %s, variant %s, size %s per thread, %zu CPUs, %zu runs\n",
+              isLatency ? "latency" : "bandwidth", kv::GetAccessKindName(options.kind),
+              kv::GetKernelVariantName(options.variant), kv::FormatByteSize(options.size).c_str(),
+              threadOptions.cpus.size(), GetThreadRepetitions(options));
+  std::printf("%-8s %12s %12s %18s%s\n", "threads", "GB/s", "ns/access", "GB/s per thread",
+              FormatCounterHeader(options).c_str());
+  for (auto count : kv::MakeThreadSweep(maxThreads)) {
+    auto runs = RunThreadBenchRepeatedly(options, std::vector<kv::ThreadRole>(count, options.workload), threadOptions);
+    std::vector<double> bandwidths;
+    std::vector<double> latencies;
+    for (const auto& run : runs) {
+      bandwidths.push_back(run.GetGigabytesPerSecond(options.workload));
+      latencies.push_back(run.GetNanosecondsPerAccess(options.workload));
+    }
+
+    auto bandwidth = kv::ComputeStatistics(bandwidths).median;
+    std::printf("%-8zu %12.2f %12.3f %18.2f%s\n", count, bandwidth, kv::ComputeStatistics(latencies).median,
+                bandwidth / static_cast<double>(count), FormatCounters(options, runs, options.workload).c_str());
+    if (options.perThread) {
+      PrintThreads(options, runs.back());
+    }
+    std::fflush(stdout);
+
+    if (report) {
+      auto& map = isLatency
+          ? report->AddResult("threads=" + std::to_string(count), "ns/access", kv::MetricDirection::LowerIsBetter,
+                              latencies)
+          : report->AddResult("threads=" + std::to_string(count), "GB/s", kv::MetricDirection::HigherIsBetter,
+                              bandwidths);
+      Put(map, "threadCount", static_cast<uint64_t>(count));
+      AddThreadResult(options, map, runs, options.workload);
+    }
+  }
+}
+
+void RunLoadedLatency(const Options& options, kv::BenchReport* report) {
+  auto threadOptions = GetThreadOptions(options);
+  auto maxThreads = options.threads.value_or(threadOptions.cpus.size());
+
+  PrintHeader(options);
+  std::printf("# kernel %s, variant %s, size %s per thread, %zu CPUs, %zu runs\n", kv::GetAccessKindName(options.kind),
+              kv::GetKernelVariantName(options.variant), kv::FormatByteSize(options.size).c_str(),
+              threadOptions.cpus.size(), GetThreadRepetitions(options));
+  std::printf("%-12s %12s %12s%s\n", "generators", "ns/access", "GB/s", FormatCounterHeader(options).c_str());
+  // The chase thread runs on the first CPU, and the bandwidth generators on the following ones.
+  for (size_t generators = 0; generators < maxThreads; ++generators) {
+    std::vector<kv::ThreadRole> roles(generators + 1, kv::ThreadRole::Bandwidth);
+    roles[0] = kv::ThreadRole::Chase;
+    auto runs = RunThreadBenchRepeatedly(options, roles, threadOptions);
+    std::vector<double> latencies;
+    std::vector<double> bandwidths;
+    for (const auto& run : runs) {
+      latencies.push_back(run.GetNanosecondsPerAccess(kv::ThreadRole::Chase));
+      bandwidths.push_back(run.GetGigabytesPerSecond(kv::ThreadRole::Bandwidth));
+    }
+
+    auto bandwidth = kv::ComputeStatistics(bandwidths).median;
+    std::printf("%-12zu %12.2f %12.2f%s\n", generators, kv::ComputeStatistics(latencies).median, bandwidth,
+                FormatCounters(options, runs, kv::ThreadRole::Chase).c_str());
+    if (options.perThread) {
+      PrintThreads(options, runs.back());
+    }
+    std::fflush(stdout);
+
+    if (report) {
+      auto& map = report->AddResult("generators=" + std::to_string(generators), "ns/access",
+                                    kv::MetricDirection::LowerIsBetter, latencies);
+      Put(map, "generatorCount", static_cast<uint64_t>(generators));
+      Put(map, "generatorGigabytesPerSecond", bandwidth);
+      AddThreadResult(options, map, runs, kv::ThreadRole::Chase);
+    }
+  }
+}
+
+std::vector<std::unique_ptr<kv::BenchAllocator>> CreateAllocators(const Options& options) {
+  std::vector<std::unique_ptr<kv::BenchAllocator>> allocators;
+  for (auto kind : options.allocators) {
+    allocators.push_back(kv::BenchAllocator::Create(kind));
+  }
+  return allocators;
+}
+
+size_t GetAllocThreads(const Options& options) {
+  auto cpus = kv::SelectBenchCpus(options.cpuNode).size();
+  // Producers and consumers come in pairs.
+  return options.threads.value_or(options.mode == Mode::AllocCrossThread ? std::max(cpus / 2, size_t { 1 }) : cpus);
+}
+
+kv::AllocThroughputOptions GetAllocThroughputOptions(const Options& options, size_t size) {
+  kv::AllocThroughputOptions throughput;
+  throughput.size = size;
+  throughput.measure = options.measure;
+  throughput.measure.collectCounters = false;
+  return throughput;
+}
+
+kv::CrossThreadOptions GetCrossThreadOptions(const Options& options, size_t pairs) {
+  kv::CrossThreadOptions crossThread;
+  crossThread.pairs = pairs;
+  crossThread.operations = options.operations.value_or(crossThread.operations);
+  crossThread.minSize = options.minSize;
+  crossThread.maxSize = options.maxSize;
+  crossThread.seed = options.seed;
+  return crossThread;
+}
+
+kv::ChurnOptions GetChurnOptions(const Options& options, size_t threads) {
+  kv::ChurnOptions churn;
+  churn.threads = threads;
+  churn.operations = options.operations.value_or(churn.operations);
+  churn.minSize = options.minSize;
+  churn.maxSize = options.maxSize;
+  churn.seed = options.seed;
+  return churn;
+}
+
+kv::FragmentationOptions GetFragmentationOptions(const Options& options) {
+  kv::FragmentationOptions fragmentation;
+  fragmentation.liveSize = options.size;
+  fragmentation.minSize = options.minSize;
+  fragmentation.maxSize = options.maxSize;
+  fragmentation.seed = options.seed;
+  return fragmentation;
+}
+
+kv::JsonTreeOptions GetJsonTreeOptions(const Options& options) {
+  kv::JsonTreeOptions tree;
+  tree.records = options.records;
+  tree.sampleCount = options.measure.sampleCount;
+  return tree;
+}
+
+void DescribeAllocParameters(const Options& options, kv::JsonFlatMap& parameters) {
+  auto allocators = kv::MakeJsonObject(kv::JsonArrayTag { });
+  for (auto kind : options.allocators) {
+    allocators->GetArray().push_back(kv::MakeJsonObject(kv::GetBenchAllocatorName(kind)));
+  }
+  parameters.insert_or_assign("allocators", std::move(allocators));
+
+  auto isThreaded = options.mode == Mode::AllocCrossThread || options.mode == Mode::AllocChurn;
+  auto samples = isThreaded || options.mode == Mode::AllocFragmentation ? GetThreadRepetitions(options)
+                                                                       : options.measure.sampleCount;
+  Put(parameters, "samples", static_cast<uint64_t>(samples));
+  if (options.mode != Mode::AllocJson) {
+    Put(parameters, "minSize", static_cast<uint64_t>(options.minSize));
+    Put(parameters, "maxSize", static_cast<uint64_t>(options.maxSize));
+    Put(parameters, "seed", options.seed);
+  }
+
+  switch (options.mode) {
+    case Mode::AllocThroughput: {
+      auto throughput = GetAllocThroughputOptions(options, options.minSize);
+      Put(parameters, "stepsPerOctave", static_cast<uint64_t>(options.stepsPerOctave));
+      Put(parameters, "batchSize", static_cast<uint64_t>(throughput.batchSize));
+      Put(parameters, "minSampleTimeNs", static_cast<uint64_t>(options.measure.minSampleTime.count()));
+      break;
+    }
+    case Mode::AllocCrossThread: {
+      auto crossThread = GetCrossThreadOptions(options, GetAllocThreads(options));
+      Put(parameters, "pairs", static_cast<uint64_t>(crossThread.pairs));
+      Put(parameters, "operations", crossThread.operations);
+      Put(parameters, "queueCapacity", static_cast<uint64_t>(crossThread.queueCapacity));
+      break;
+    }
+    case Mode::AllocChurn: {
+      auto churn = GetChurnOptions(options, GetAllocThreads(options));
+      Put(parameters, "threads", static_cast<uint64_t>(churn.threads));
+      Put(parameters, "operations", churn.operations);
+      Put(parameters, "slots", static_cast<uint64_t>(churn.slots));
+      Put(parameters, "rounds", static_cast<uint64_t>(churn.rounds));
+      break;
+    }
+    case Mode::AllocFragmentation: {
+      auto fragmentation = GetFragmentationOptions(options);
+      Put(parameters, "liveSize", static_cast<uint64_t>(fragmentation.liveSize));
+      Put(parameters, "phases", static_cast<uint64_t>(fragmentation.phases));
+      Put(parameters, "releaseFraction", fragmentation.releaseFraction);
+      break;
+    }
+    case Mode::AllocJson:
+      Put(parameters, "records", static_cast<uint64_t>(options.records));
+      break;
+    default:
+      UNREACHABLE();
+  }
+}
+
+void PrintAllocHeader(const Options& options) {
+  std::printf("# mab %s: allocators", GetModeName(options.mode));
+  for (size_t i = 0; i < options.allocators.size(); ++i) {
+    std::printf("%s %s", i == 0 ? "" : ",", kv::GetBenchAllocatorName(options.allocators[i]));
+  }
+  std::printf("\n");
+}
+
+void PrintAllocColumns(const Options& options, const char* first) {
+  std::printf("%-12s", first);
+  for (auto kind : options.allocators) {
+    std::printf(" %14s", kv::GetBenchAllocatorName(kind));
+  }
+  std::printf("\n");
+}
+
+void RunAllocThroughput(const Options& options, kv::BenchReport* report) {
+  auto allocators = CreateAllocators(options);
+  auto batchSize = GetAllocThroughputOptions(options, options.minSize).batchSize;
+
+  PrintAllocHeader(options);
+  std::printf("# ns per allocation and release, batches of %zu chunks\n", batchSize);
+  PrintAllocColumns(options, "size");
+  for (auto size : kv::MakeSizeSweep(options.minSize, options.maxSize, options.stepsPerOctave)) {
+    std::printf("%-12s", kv::FormatByteSize(size).c_str());
+    for (const auto& allocator : allocators) {
+      auto throughput = GetAllocThroughputOptions(options, size);
+      auto measurement = kv::MeasureAllocThroughput(*allocator, throughput);
+      std::vector<double> samples;
+      for (auto sample : measurement.samples) {
+        samples.push_back(sample * 1e9 / static_cast<double>(throughput.batchSize));
+      }
+      std::printf(" %14.2f", kv::ComputeStatistics(samples).median);
+      std::fflush(stdout);
+
+      if (report) {
+        auto name = kv::GetBenchAllocatorName(allocator->GetKind());
+        auto& map = report->AddResult(std::string { name } + "/size=" + kv::FormatByteSize(size), "ns/op",
+                                      kv::MetricDirection::LowerIsBetter, samples);
+        Put(map, "allocator", name);
+        Put(map, "size", static_cast<uint64_t>(size));
+        Put(map, "iterations", static_cast<uint64_t>(measurement.iterations));
+      }
+    }
+    std::printf("\n");
+  }
+}
+
+void RunAllocThreads(const Options& options, kv::BenchReport* report) {
+  auto allocators = CreateAllocators(options);
+  auto isCrossThread = options.mode == Mode::AllocCrossThread;
+
+  PrintAllocHeader(options);
+  std::printf("# million allocations and releases per second, chunks of %s to %s, %zu runs\n",
+              kv::FormatByteSize(options.minSize).c_str(), kv::FormatByteSize(options.maxSize).c_str(),
+              GetThreadRepetitions(options));
+  PrintAllocColumns(options, isCrossThread ? "pairs" : "threads");
+  for (auto count : kv::MakeThreadSweep(GetAllocThreads(options))) {
+    std::printf("%-12zu", count);
+    for (const auto& allocator : allocators) {
+      std::vector<double> samples;
+      uint64_t operations = 0;
+      for (size_t i = 0; i < GetThreadRepetitions(options); ++i) {
+        auto result = isCrossThread ? kv::RunCrossThreadFrees(*allocator, GetCrossThreadOptions(options, count))
+                                    : kv::RunAllocChurn(*allocator, GetChurnOptions(options, count));
+        samples.push_back(result.GetMillionOperationsPerSecond());
+        operations = result.operations;
+      }
+      std::printf(" %14.2f", kv::ComputeStatistics(samples).median);
+      std::fflush(stdout);
+
+      if (report) {
+        auto name = kv::GetBenchAllocatorName(allocator->GetKind());
+        auto& map = report->AddResult(std::string { name } + (isCrossThread ? "/pairs=" : "/threads=") +
+                                      std::to_string(count), "Mops/s", kv::MetricDirection::HigherIsBetter, samples);
+        Put(map, "allocator", name);
+        Put(map, isCrossThread ? "pairCount" : "threadCount", static_cast<uint64_t>(count));
+        Put(map, "operations", operations);
+      }
+    }
+    std::printf("\n");
+  }
+}
+
+void RunAllocFragmentation(const Options& options, kv::BenchReport* report) {
+  auto fragmentation = GetFragmentationOptions(options);
+
+  PrintAllocHeader(options);
+  std::printf("# %zu phases up to %s live, chunks of %s to %s growing every phase, %zu runs\n", fragmentation.phases,
+              kv::FormatByteSize(fragmentation.liveSize).c_str(), kv::FormatByteSize(fragmentation.minSize).c_str(),
+              kv::FormatByteSize(fragmentation.maxSize).c_str(), GetThreadRepetitions(options));
+  std::printf("%-14s %14s %14s %14s\n", "allocator", "peak rss MB", "retained MB", "peak rss/live");
+  for (auto kind : options.allocators) {
+    std::vector<double> ratios;
+    std::vector<double> peaks;
+    std::vector<double> retained;
+    kv::FragmentationResult last;
+    for (size_t i = 0; i < GetThreadRepetitions(options); ++i) {
+      // A fresh allocator for every run, so that no run reuses the memory retained by the one before.
+      auto allocator = kv::BenchAllocator::Create(kind);
+      last = kv::RunFragmentation(*allocator, fragmentation);
+      ratios.push_back(last.GetPeakResidentRatio());
+      peaks.push_back(ratios.back() * static_cast<double>(fragmentation.liveSize) / 1e6);
+      retained.push_back(static_cast<double>(last.samples.back().residentBytes) / 1e6);
+    }
+    std::printf("%-14s %14.1f %14.1f %14.3f\n", kv::GetBenchAllocatorName(kind), kv::ComputeStatistics(peaks).median,
+                kv::ComputeStatistics(retained).median, kv::ComputeStatistics(ratios).median);
+    std::fflush(stdout);
+
+    if (report) {
+      auto& map = report->AddResult(kv::GetBenchAllocatorName(kind), "rss/live", kv::MetricDirection::LowerIsBetter,
+                                    ratios);
+      Put(map, "allocator", kv::GetBenchAllocatorName(kind));
+      // The resident set over time of the last run.
+      auto samples = kv::MakeJsonObject(kv::JsonArrayTag { });
+      for (const auto& sample : last.samples) {
+        auto description = kv::MakeJsonObject(kv::JsonFlatMapTag { });
+        Put(description->GetFlatMap(), "seconds", sample.seconds);
+        Put(description->GetFlatMap(), "liveBytes", static_cast<uint64_t>(sample.liveBytes));
+        Put(description->GetFlatMap(), "residentBytes", static_cast<uint64_t>(sample.residentBytes));
+        samples->GetArray().push_back(std::move(description));
+      }
+      map.insert_or_assign("residentSet", std::move(samples));
+    }
+  }
+}
+
+void RunAllocJson(const Options& options, kv::BenchReport* report) {
+  auto allocators = CreateAllocators(options);
+  auto tree = GetJsonTreeOptions(options);
+
+  PrintAllocHeader(options);
+  std::printf("# ns per node, trees of %zu records, %zu samples\n", tree.records, tree.sampleCount);
+  std::printf("%-14s %14s %14s\n", "allocator", "build", "teardown");
+  for (const auto& allocator : allocators) {
+    auto result = kv::MeasureJsonTree(*allocator, tree);
+    auto perNode = [&result](const std::vector<double>& samples) {
+      std::vector<double> nanoseconds;
+      for (auto sample : samples) {
+        nanoseconds.push_back(sample * 1e9 / static_cast<double>(result.nodes));
+      }
+      return nanoseconds;
+    };
+    auto build = perNode(result.buildSamples);
+    auto teardown = perNode(result.teardownSamples);
+
+    auto name = kv::GetBenchAllocatorName(allocator->GetKind());
+    std::printf("%-14s %14.2f %14.2f\n", name, kv::ComputeStatistics(build).median,
+                kv::ComputeStatistics(teardown).median);
+    std::fflush(stdout);
+
+    if (report) {
+      for (auto phase : { "build", "teardown" }) {
+        auto& map = report->AddResult(std::string { name } + "/" + phase, "ns/node", kv::MetricDirection::LowerIsBetter,
+                                      phase == std::string_view { "build" } ? build : teardown);
+        Put(map, "allocator", name);
+        Put(map, "nodes", static_cast<uint64_t>(result.nodes));
+      }
+    }
+  }
+}
+
+kv::StoreWorkloadOptions GetStoreWorkloadOptions(const Options& options, size_t threads) {
+  auto store = options.store;
+  store.threads = threads;
+  store.operations = options.operations.value_or(store.operations);
+  store.seed = options.seed;
+  return store;
+}
+
+size_t GetStoreThreads(const Options& options) {
+  return options.threads.value_or(kv::SelectBenchCpus(options.cpuNode).size());
+}
+
+void DescribeStoreParameters(const Options& options, kv::JsonFlatMap& parameters) {
+  auto store = GetStoreWorkloadOptions(options, GetStoreThreads(options));
+  Put(parameters, "samples", static_cast<uint64_t>(GetThreadRepetitions(options)));
+  Put(parameters, "threads", static_cast<uint64_t>(store.threads));
+  Put(parameters, "keys", static_cast<uint64_t>(store.keys));
+  Put(parameters, "operations", store.operations);
+  Put(parameters, "readFraction", store.readFraction);
+  Put(parameters, "theta", store.theta);
+  Put(parameters, "batchSize", static_cast<uint64_t>(store.batchSize));
+  Put(parameters, "latencyInterval", static_cast<uint64_t>(store.latencyInterval));
+  Put(parameters, "shards", static_cast<uint64_t>(store.shards));
+  Put(parameters, "seed", store.seed);
+}
+
+void RunKvZipf(const Options& options, kv::BenchReport* report) {
+  auto base = GetStoreWorkloadOptions(options, 1);
+  std::printf("# mab %s: %zu keys, theta %.2f, %.0f%% reads in batches of %zu, %zu stripes, %zu runs\n",
+              GetModeName(options.mode), base.keys, base.theta, base.readFraction * 100, base.batchSize, base.shards,
+              GetThreadRepetitions(options));
+  std::printf("# throughput in million keys per second, latency of sampled requests in ns\n");
+  std::printf("%-12s %10s %10s %10s %10s %10s\n", "threads", "Mops/s", "read p50", "read p99", "write p50",
+              "write p99");
+  for (auto count : kv::MakeThreadSweep(GetStoreThreads(options))) {
+    auto store = GetStoreWorkloadOptions(options, count);
+    std::vector<double> samples;
+    std::vector<double> readLatencies;
+    std::vector<double> writeLatencies;
+    uint64_t operations = 0;
+    for (size_t i = 0; i < GetThreadRepetitions(options); ++i) {
+      auto result = kv::RunStoreWorkload(store);
+      samples.push_back(result.GetMillionOperationsPerSecond());
+      readLatencies.insert(readLatencies.end(), result.readLatencies.begin(), result.readLatencies.end());
+      writeLatencies.insert(writeLatencies.end(), result.writeLatencies.begin(), result.writeLatencies.end());
+      operations = result.operations;
+    }
+    auto reads = kv::ComputeStatistics(readLatencies);
+    auto writes = kv::ComputeStatistics(writeLatencies);
+    std::printf("%-12zu %10.2f %10.0f %10.0f %10.0f %10.0f\n", count, kv::ComputeStatistics(samples).median,
+                reads.median, reads.p99, writes.median, writes.p99);
+    std::fflush(stdout);
+
+    if (report) {
+      auto& map = report->AddResult("threads=" + std::to_string(count), "Mops/s", kv::MetricDirection::HigherIsBetter,
+                                    samples);
+      Put(map, "threadCount", static_cast<uint64_t>(count));
+      Put(map, "operations", operations);
+      Put(map, "readMedianNs", reads.median);
+      Put(map, "readP99Ns", reads.p99);
+      Put(map, "writeMedianNs", writes.median);
+      Put(map, "writeP99Ns", writes.p99);
+    }
+  }
+}
+
+const char* GetVerdictName(kv::ComparisonVerdict verdict) noexcept {
+  switch (verdict) {
+    case kv::ComparisonVerdict::Unchanged:
+      return "~";
+    case kv::ComparisonVerdict::Improvement:
+      return "improvement";
+    case kv::ComparisonVerdict::Regression:
+      return "REGRESSION";
+  }
+  UNREACHABLE();
+}
+
+int RunCompare(const Options& options) {
+  auto baseline = kv::LoadReport(options.baseline.c_str());
+  auto current = kv::LoadReport(options.current.c_str());
+  auto comparisons = kv::CompareReports(baseline, current, options.comparison);
+
+  std::printf("# mab compare: %s against %s, threshold %.1f%%, alpha %g\n", options.current.c_str(),
+              options.baseline.c_str(), options.comparison.threshold * 100, options.comparison.alpha);
+  std::printf("%-16s %-10s %12s %12s %9s %9s  %s\n", "name", "metric", "baseline", "current", "change", "p-value",
+              "verdict");
+  size_t regressions = 0;
+  for (const auto& comparison : comparisons) {
+    std::printf("%-16s %-10s %12.3f %12.3f %+8.1f%% %9.4f  %s\n", comparison.name.c_str(), comparison.metric.c_str(),
+                comparison.baseline.median, comparison.current.median, comparison.change * 100, comparison.pValue,
+                GetVerdictName(comparison.verdict));
+    if (comparison.verdict == kv::ComparisonVerdict::Regression) {
+      ++regressions;
+    }
+  }
+  std::printf("# %zu results compared, %zu regressions\n", comparisons.size(), regressions);
+  return regressions == 0 ? 0 : 3;
+}
+
+} // namespace <anonymous>
+
+int main(int argc, char** argv) {
+  auto options = ParseOptions(argc, argv);
+  try {
+    if (options.mode == Mode::Compare) {
+      return RunCompare(options);
+    }
+
+    std::optional<kv::BenchReport> report;
+    if (!options.json.empty()) {
+      report.emplace(GetModeName(options.mode));
+      DescribeParameters(options, report->GetParameters());
+    }
+    auto* reportPtr = report ? &*report : nullptr;
+
+    switch (options.mode) {
+      case Mode::Latency:
+        RunLatency(options, reportPtr);
+        break;
+      case Mode::Bandwidth:
+        RunBandwidth(options, reportPtr);
+        break;
+      case Mode::Scaling:
+        RunScaling(options, reportPtr);
+        break;
+      case Mode::LoadedLatency:
+        RunLoadedLatency(options, reportPtr);
+        break;
+      case Mode::AllocThroughput:
+        RunAllocThroughput(options, reportPtr);
+        break;
+      case Mode::AllocCrossThread:
+      case Mode::AllocChurn:
+        RunAllocThreads(options, reportPtr);
+        break;
+      case Mode::AllocFragmentation:
+        RunAllocFragmentation(options, reportPtr);
+        break;
+      case Mode::AllocJson:
+        RunAllocJson(options, reportPtr);
+        break;
+      case Mode::KvZipf:
+        RunKvZipf(options, reportPtr);
+        break;
+      case Mode::Compare:
+        UNREACHABLE();
+    }
+
+    if (report) {
+      report->WriteFile(options.json.c_str());
+    }
+  } catch (const std::exception& ex) {
+    std::fprintf(stderr, "mab: %s\n", ex.what());
+    return 1;
+  }
+  return 0;
+}
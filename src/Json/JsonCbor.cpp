@@ -0,0 +1,353 @@
+#include "kv/Json/JsonCbor.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "kv/Json/JsonException.h"
+
+namespace kv {
+
+namespace {
+
+constexpr static const uint8_t BreakCode = 0xFF;
+
+constexpr static const uint8_t IndefiniteInfo = 31;
+
+/**
+ * @brief Convert the bits of an IEEE 754 half precision float to double.
+ */
+double HalfToDouble(uint16_t bits) noexcept {
+  auto exponent = (bits >> 10) & 0x1F;
+  auto mantissa = bits & 0x3FF;
+
+  double value;
+  if (exponent == 0) {
+    value = std::ldexp(mantissa, -24);
+  } else if (exponent == 0x1F) {
+    value = mantissa == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+  } else {
+    value = std::ldexp(mantissa + 1024, exponent - 25);
+  }
+  return (bits & 0x8000) ? -value : value;
+}
+
+} // namespace <anonymous>
+
+JsonObject JsonCborDecoder::Decode() {
+  return DecodeItem(0);
+}
+
+void JsonCborDecoder::Skip() {
+  SkipItem(0);
+}
+
+JsonCborDecoder::Head JsonCborDecoder::ReadHead() {
+  if (UNLIKELY(_offset >= _data.size())) {
+    Fail("unexpected end of data", _offset);
+  }
+
+  Head head { };
+  head.Offset = _offset;
+  auto initial = static_cast<uint8_t>(_data[_offset++]);
+  head.Major = static_cast<CborMajorType>(initial >> 5);
+  head.Info = initial & 0x1F;
+
+  if (head.Info < 24) {
+    head.Argument = head.Info;
+    return head;
+  }
+
+  if (head.Info == IndefiniteInfo) {
+    switch (head.Major) {
+      case CborMajorType::UnsignedInteger:
+      case CborMajorType::NegativeInteger:
+      case CborMajorType::Tag:
+        Fail("invalid indefinite length", head.Offset);
+      default:
+        return head;
+    }
+  }
+
+  if (UNLIKELY(head.Info > 27)) {
+    Fail("reserved additional information", head.Offset);
+  }
+
+  size_t size = static_cast<size_t>(1) << (head.Info - 24);
+  if (UNLIKELY(_data.size() - _offset < size)) {
+    Fail("unexpected end of data", _offset);
+  }
+
+  head.Argument = 0;
+  for (size_t i = 0; i < size; ++i) {
+    head.Argument = (head.Argument << 8) | static_cast<uint8_t>(_data[_offset++]);
+  }
+  return head;
+}
+
+bool JsonCborDecoder::ReadBreak() noexcept {
+  if (_offset < _data.size() && static_cast<uint8_t>(_data[_offset]) == BreakCode) {
+    ++_offset;
+    return true;
+  }
+  return false;
+}
+
+std::string JsonCborDecoder::ReadString(const Head& head) {
+  if (!head.IsIndefinite()) {
+    if (UNLIKELY(head.Argument > _data.size() - _offset)) {
+      Fail("string exceeds the data", head.Offset);
+    }
+    std::string s { _data.substr(_offset, head.Argument) };
+    _offset += head.Argument;
+    return s;
+  }
+
+  std::string s;
+  while (!ReadBreak()) {
+    auto chunk = ReadHead();
+    if (UNLIKELY(chunk.Major != CborMajorType::TextString || chunk.IsIndefinite())) {
+      Fail("invalid chunk in indefinite length string", chunk.Offset);
+    }
+    if (UNLIKELY(chunk.Argument > _data.size() - _offset)) {
+      Fail("string exceeds the data", chunk.Offset);
+    }
+    s.append(_data.substr(_offset, chunk.Argument));
+    _offset += chunk.Argument;
+  }
+  return s;
+}
+
+void JsonCborDecoder::SkipString(const Head& head) {
+  if (!head.IsIndefinite()) {
+    if (UNLIKELY(head.Argument > _data.size() - _offset)) {
+      Fail("string exceeds the data", head.Offset);
+    }
+    _offset += head.Argument;
+    return;
+  }
+
+  while (!ReadBreak()) {
+    auto chunk = ReadHead();
+    if (UNLIKELY(chunk.Major != CborMajorType::TextString || chunk.IsIndefinite())) {
+      Fail("invalid chunk in indefinite length string", chunk.Offset);
+    }
+    if (UNLIKELY(chunk.Argument > _data.size() - _offset)) {
+      Fail("string exceeds the data", chunk.Offset);
+    }
+    _offset += chunk.Argument;
+  }
+}
+
+JsonObject JsonCborDecoder::DecodeItem(size_t depth) {
+  auto head = ReadHead();
+  switch (head.Major) {
+    case CborMajorType::UnsignedInteger:
+      return JsonObject { static_cast<double>(head.Argument) };
+
+    case CborMajorType::NegativeInteger:
+      // The value is -1 - argument. Adding 1 before converting rounds once instead of twice; only 2^64 - 1 has no
+      // successor in uint64_t, and -2^64 is exactly its value rounded.
+      if (UNLIKELY(head.Argument == std::numeric_limits<uint64_t>::max())) {
+        return JsonObject { -0x1p64 };
+      }
+      return JsonObject { -static_cast<double>(head.Argument + 1) };
+
+    case CborMajorType::ByteString:
+      Fail("byte strings are not supported", head.Offset);
+
+    case CborMajorType::TextString:
+      return JsonObject { ReadString(head) };
+
+    case CborMajorType::Array: {
+      if (UNLIKELY(depth >= MaxDepth)) {
+        Fail("nesting too deep", head.Offset);
+      }
+
+      auto obj = JsonObject::CreateArray();
+      auto& arr = obj.GetArray();
+      if (head.IsIndefinite()) {
+        while (!ReadBreak()) {
+          arr.push_back(MakeObject<JsonObject>(_allocator, DecodeItem(depth + 1)));
+        }
+      } else {
+        // Every element takes at least one byte, which bounds the preallocation for corrupt lengths.
+        arr.reserve(std::min<uint64_t>(head.Argument, _data.size() - _offset));
+        for (uint64_t i = 0; i < head.Argument; ++i) {
+          arr.push_back(MakeObject<JsonObject>(_allocator, DecodeItem(depth + 1)));
+        }
+      }
+      return obj;
+    }
+
+    case CborMajorType::Map: {
+      if (UNLIKELY(depth >= MaxDepth)) {
+        Fail("nesting too deep", head.Offset);
+      }
+
+      auto obj = JsonObject::CreateMap(_storage);
+      auto decodeEntries = [this, &head, depth](auto& map) {
+        auto decodeEntry = [this, &map, depth]() {
+          auto keyHead = ReadHead();
+          if (UNLIKELY(keyHead.Major != CborMajorType::TextString)) {
+            Fail("expected a text string as map key", keyHead.Offset);
+          }
+          auto key = ReadString(keyHead);
+          map.insert_or_assign(std::move(key), MakeObject<JsonObject>(_allocator, DecodeItem(depth + 1)));
+        };
+
+        if (head.IsIndefinite()) {
+          while (!ReadBreak()) {
+            decodeEntry();
+          }
+        } else {
+          // Every entry takes at least two bytes.
+          map.reserve(std::min<uint64_t>(head.Argument, (_data.size() - _offset) / 2));
+          for (uint64_t i = 0; i < head.Argument; ++i) {
+            decodeEntry();
+          }
+        }
+      };
+
+      if (obj.IsFlatMap()) {
+        decodeEntries(obj.GetFlatMap());
+      } else {
+        decodeEntries(obj.GetMap());
+      }
+      return obj;
+    }
+
+    case CborMajorType::Tag:
+      // Tags carry semantics JSON cannot express, so the tagged item is decoded as is.
+      if (UNLIKELY(depth >= MaxDepth)) {
+        Fail("nesting too deep", head.Offset);
+      }
+      return DecodeItem(depth + 1);
+
+    case CborMajorType::Simple:
+      switch (head.Info) {
+        case 20:
+          return JsonObject { false };
+        case 21:
+          return JsonObject { true };
+        case 22:
+        case 23:
+          return JsonObject { nullptr };
+        case 25:
+        case 26:
+        case 27:
+          return JsonObject { DecodeFloat(head) };
+        case IndefiniteInfo:
+          Fail("unexpected break", head.Offset);
+        default:
+          Fail("unsupported simple value", head.Offset);
+      }
+  }
+
+  UNREACHABLE();
+}
+
+void JsonCborDecoder::SkipItem(size_t depth) {
+  auto head = ReadHead();
+  switch (head.Major) {
+    case CborMajorType::UnsignedInteger:
+    case CborMajorType::NegativeInteger:
+      return;
+
+    case CborMajorType::ByteString:
+      Fail("byte strings are not supported", head.Offset);
+
+    case CborMajorType::TextString:
+      SkipString(head);
+      return;
+
+    case CborMajorType::Array:
+    case CborMajorType::Map: {
+      if (UNLIKELY(depth >= MaxDepth)) {
+        Fail("nesting too deep", head.Offset);
+      }
+
+      auto isMap = head.Major == CborMajorType::Map;
+      auto skipEntry = [this, isMap, depth]() {
+        if (isMap) {
+          auto keyHead = ReadHead();
+          if (UNLIKELY(keyHead.Major != CborMajorType::TextString)) {
+            Fail("expected a text string as map key", keyHead.Offset);
+          }
+          SkipString(keyHead);
+        }
+        SkipItem(depth + 1);
+      };
+
+      if (head.IsIndefinite()) {
+        while (!ReadBreak()) {
+          skipEntry();
+        }
+      } else {
+        for (uint64_t i = 0; i < head.Argument; ++i) {
+          skipEntry();
+        }
+      }
+      return;
+    }
+
+    case CborMajorType::Tag:
+      if (UNLIKELY(depth >= MaxDepth)) {
+        Fail("nesting too deep", head.Offset);
+      }
+      SkipItem(depth + 1);
+      return;
+
+    case CborMajorType::Simple:
+      switch (head.Info) {
+        case 20:
+        case 21:
+        case 22:
+        case 23:
+        case 25:
+        case 26:
+        case 27:
+          return;
+        case IndefiniteInfo:
+          Fail("unexpected break", head.Offset);
+        default:
+          Fail("unsupported simple value", head.Offset);
+      }
+  }
+
+  UNREACHABLE();
+}
+
+double JsonCborDecoder::DecodeFloat(const Head& head) const {
+  switch (head.Info) {
+    case 25:
+      return HalfToDouble(static_cast<uint16_t>(head.Argument));
+    case 26: {
+      auto bits = static_cast<uint32_t>(head.Argument);
+      float value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+    case 27: {
+      double value;
+      std::memcpy(&value, &head.Argument, sizeof(value));
+      return value;
+    }
+    default:
+      UNREACHABLE();
+  }
+}
+
+void JsonCborDecoder::Fail(const char* message, size_t offset) {
+  throw JsonParseException { message, offset };
+}
+
+JsonObject DecodeCbor(std::string_view data, ObjectAllocator<JsonObject> allocator, JsonMapStorage storage) {
+  JsonCborDecoder decoder { data, allocator, storage };
+  auto obj = decoder.Decode();
+  if (!decoder.IsAtEnd()) {
+    throw JsonParseException { "unexpected trailing data", decoder.GetOffset() };
+  }
+  return obj;
+}
+
+} // namespace kv
@@ -0,0 +1,376 @@
+#include "kv/Json/JsonDocument.h"
+
+#include <cstring>
+#include <string>
+
+#include "kv/Json/JsonException.h"
+#include "kv/Json/JsonParser.h"
+#include "kv/Json/JsonReader.h"
+#include "kv/Json/JsonScanner.h"
+#include "kv/Support/Intrinsics.h"
+
+namespace kv {
+
+namespace {
+
+/**
+ * @brief JsonReader handler that captures a single scalar.
+ */
+class ScalarCapture {
+public:
+  explicit ScalarCapture() noexcept
+    : String(),
+      Number(0),
+      Boolean(false)
+  { }
+
+  std::string String;
+  double Number;
+  bool Boolean;
+
+  void VisitNull() noexcept { }
+
+  void VisitBoolean(bool value) noexcept {
+    Boolean = value;
+  }
+
+  void VisitNumber(double value) noexcept {
+    Number = value;
+  }
+
+  void VisitString(std::string&& value) noexcept {
+    String = std::move(value);
+  }
+
+  void VisitArray() noexcept { }
+  void VisitArrayEnd() noexcept { }
+  void VisitMap() noexcept { }
+  void VisitKey(std::string &&) noexcept { }
+  void VisitMapEnd() noexcept { }
+}; // class ScalarCapture
+
+/**
+ * @brief Decode the scalar at the beginning of the specified text, which starts at the specified offset of the
+ * document.
+ */
+void DecodeScalar(std::string_view text, size_t offset, ScalarCapture& capture) {
+  JsonReader<const char *> reader { text.data(), text.data() + text.size(), offset };
+  reader.Read(capture);
+}
+
+[[noreturn]]
+void Fail(const char* message, size_t offset) {
+  throw JsonParseException { message, offset };
+}
+
+} // namespace <anonymous>
+
+JsonDocument::JsonDocument(std::string_view text)
+  : _file(),
+    _text(text),
+    _positions(),
+    _matches(),
+    _strings(),
+    _decodedStrings()
+{
+  Index();
+}
+
+JsonDocument::JsonDocument(MappedFile file)
+  : _file(std::move(file)),
+    _text(_file->GetView()),
+    _positions(),
+    _matches(),
+    _strings(),
+    _decodedStrings()
+{
+  Index();
+}
+
+void JsonDocument::Index() {
+  if (UNLIKELY(_text.size() > MaxIndexedJsonSize)) {
+    throw JsonException { "JSON text too large to be indexed" };
+  }
+
+  ScanJsonStructurals(_text, _positions);
+  _matches.resize(_positions.size());
+
+  enum class State {
+    Value,
+    Key,
+    AfterValue,
+  };
+
+  // Token indices of the open brackets.
+  std::vector<uint32_t> open;
+  auto count = static_cast<uint32_t>(_positions.size());
+  auto state = State::Value;
+  uint32_t token = 0;
+
+  for (; token < count; ++token) {
+    auto offset = _positions[token];
+    auto ch = _text[offset];
+
+    switch (state) {
+      case State::Value:
+        state = State::AfterValue;
+        switch (ch) {
+          case '{':
+          case '[': {
+            auto isMap = ch == '{';
+            if (UNLIKELY(open.size() == JsonReader<const char *>::MaxDepth)) {
+              Fail("nesting too deep", offset);
+            }
+            if (token + 1 < count && GetChar(token + 1) == (isMap ? '}' : ']')) {
+              _matches[token] = token + 1;
+              ++token;
+              break;
+            }
+            open.push_back(token);
+            state = isMap ? State::Key : State::Value;
+            break;
+          }
+          case '"':
+          case 't':
+          case 'f':
+          case 'n':
+          case '-':
+          case '0': case '1': case '2': case '3': case '4':
+          case '5': case '6': case '7': case '8': case '9':
+            break;
+          default:
+            Fail("unexpected character", offset);
+        }
+        break;
+
+      case State::Key:
+        if (UNLIKELY(ch != '"')) {
+          Fail("expected a string as map key", offset);
+        }
+        if (UNLIKELY(token + 1 == count)) {
+          Fail("expected ':' after map key", _text.size());
+        }
+        if (UNLIKELY(GetChar(token + 1) != ':')) {
+          Fail("expected ':' after map key", _positions[token + 1]);
+        }
+        ++token;
+        state = State::Value;
+        break;
+
+      case State::AfterValue: {
+        if (UNLIKELY(open.empty())) {
+          Fail("unexpected trailing content", offset);
+        }
+
+        auto isMap = GetChar(open.back()) == '{';
+        if (ch == ',') {
+          state = isMap ? State::Key : State::Value;
+        } else if (ch == (isMap ? '}' : ']')) {
+          _matches[open.back()] = token;
+          open.pop_back();
+        } else {
+          Fail(isMap ? "expected ',' or '}'" : "expected ',' or ']'", offset);
+        }
+        break;
+      }
+
+      default:
+        UNREACHABLE();
+    }
+  }
+
+  switch (state) {
+    case State::Value:
+      Fail("unexpected end of input", _text.size());
+    case State::Key:
+      Fail("expected a string as map key", _text.size());
+    case State::AfterValue:
+      if (UNLIKELY(!open.empty())) {
+        Fail(GetChar(open.back()) == '{' ? "expected ',' or '}'" : "expected ',' or ']'", _text.size());
+      }
+      break;
+    default:
+      UNREACHABLE();
+  }
+}
+
+std::optional<std::string_view> JsonDocument::GetRawString(uint32_t token) const noexcept {
+  auto text = GetTokenText(token);
+  for (size_t i = 1; i < text.size(); ++i) {
+    auto ch = static_cast<unsigned char>(text[i]);
+    if (ch == '"') {
+      return text.substr(1, i - 1);
+    }
+    if (ch == '\\' || ch < 0x20) {
+      break;
+    }
+  }
+  return std::nullopt;
+}
+
+std::string_view JsonDocument::DecodeString(uint32_t token) const {
+  if (auto raw = GetRawString(token)) {
+    return *raw;
+  }
+
+  auto it = _decodedStrings.find(token);
+  if (it != _decodedStrings.end()) {
+    return it->second;
+  }
+
+  ScalarCapture capture;
+  DecodeScalar(GetTokenText(token), _positions[token], capture);
+
+  auto storage = static_cast<char *>(_strings.Allocate(capture.String.size(), 1));
+  std::memcpy(storage, capture.String.data(), capture.String.size());
+  std::string_view decoded { storage, capture.String.size() };
+  _decodedStrings.emplace(token, decoded);
+  return decoded;
+}
+
+bool JsonDocument::StringEquals(uint32_t token, std::string_view s) const {
+  if (auto raw = GetRawString(token)) {
+    return *raw == s;
+  }
+
+  ScalarCapture capture;
+  DecodeScalar(GetTokenText(token), _positions[token], capture);
+  return capture.String == s;
+}
+
+JsonObjectType JsonValue::GetType() const noexcept {
+  switch (_document->GetChar(_token)) {
+    case 'n':
+      return JsonObjectType::Null;
+    case 't':
+    case 'f':
+      return JsonObjectType::Boolean;
+    case '"':
+      return JsonObjectType::String;
+    case '[':
+      return JsonObjectType::Array;
+    case '{':
+      return JsonObjectType::Map;
+    default:
+      return JsonObjectType::Number;
+  }
+}
+
+bool JsonValue::GetBoolean() const {
+  if (UNLIKELY(!IsBoolean())) {
+    throw JsonException { };
+  }
+
+  ScalarCapture capture;
+  DecodeScalar(_document->GetTokenText(_token), _document->_positions[_token], capture);
+  return capture.Boolean;
+}
+
+double JsonValue::DecodeNumber() const {
+  if (UNLIKELY(!IsNumber())) {
+    throw JsonException { };
+  }
+
+  ScalarCapture capture;
+  DecodeScalar(_document->GetTokenText(_token), _document->_positions[_token], capture);
+  return capture.Number;
+}
+
+std::string_view JsonValue::GetString() const {
+  if (UNLIKELY(!IsString())) {
+    throw JsonException { };
+  }
+  return _document->DecodeString(_token);
+}
+
+JsonArrayView JsonValue::GetArray() const {
+  if (UNLIKELY(!IsArray())) {
+    throw JsonException { };
+  }
+  return JsonArrayView { _document, _token };
+}
+
+JsonMapView JsonValue::GetMap() const {
+  if (UNLIKELY(!IsMap())) {
+    throw JsonException { };
+  }
+  return JsonMapView { _document, _token };
+}
+
+size_t JsonValue::GetOffset() const noexcept {
+  return _document->_positions[_token];
+}
+
+JsonObject JsonValue::ToJsonObject(ObjectAllocator<JsonObject> allocator) const {
+  auto begin = static_cast<size_t>(_document->_positions[_token]);
+  auto next = _document->SkipValue(_token);
+  auto end = next < _document->_positions.size() ? static_cast<size_t>(_document->_positions[next])
+                                                 : _document->_text.size();
+
+  JsonParser<const char *> parser {
+      _document->_text.data() + begin, _document->_text.data() + end, allocator, begin };
+  return parser.Parse();
+}
+
+JsonArrayView::Iterator& JsonArrayView::Iterator::operator++() noexcept {
+  _token = _document->NextElement(_document->SkipValue(_token));
+  return *this;
+}
+
+JsonArrayView::Iterator JsonArrayView::begin() const noexcept {
+  auto close = _document->_matches[_token];
+  return Iterator { _document, close == _token + 1 ? close : _token + 1 };
+}
+
+JsonArrayView::Iterator JsonArrayView::end() const noexcept {
+  return Iterator { _document, _document->_matches[_token] };
+}
+
+JsonValue JsonArrayView::At(size_t index) const {
+  auto last = end();
+  for (auto it = begin(); it != last; ++it) {
+    if (index-- == 0) {
+      return *it;
+    }
+  }
+  throw JsonException { "array index out of range" };
+}
+
+JsonMapView::Iterator::value_type JsonMapView::Iterator::operator*() const {
+  return value_type { _document->DecodeString(_token), GetValue() };
+}
+
+JsonMapView::Iterator& JsonMapView::Iterator::operator++() noexcept {
+  _token = _document->NextElement(_document->SkipValue(_token + 2));
+  return *this;
+}
+
+JsonMapView::Iterator JsonMapView::begin() const noexcept {
+  auto close = _document->_matches[_token];
+  return Iterator { _document, close == _token + 1 ? close : _token + 1 };
+}
+
+JsonMapView::Iterator JsonMapView::end() const noexcept {
+  return Iterator { _document, _document->_matches[_token] };
+}
+
+std::optional<JsonValue> JsonMapView::Find(std::string_view key) const {
+  std::optional<JsonValue> found;
+  auto last = end();
+  for (auto it = begin(); it != last; ++it) {
+    if (_document->StringEquals(it._token, key)) {
+      found = it.GetValue();
+    }
+  }
+  return found;
+}
+
+JsonValue JsonMapView::At(std::string_view key) const {
+  auto value = Find(key);
+  if (UNLIKELY(!value)) {
+    throw JsonException { "key not found in map" };
+  }
+  return *value;
+}
+
+} // namespace kv
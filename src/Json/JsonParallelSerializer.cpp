@@ -0,0 +1,122 @@
+#include "kv/Json/JsonParallelSerializer.h"
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include <sys/uio.h>
+
+#include "kv/Support/Defer.h"
+
+namespace kv {
+
+JsonParallelSerializer::JsonParallelSerializer(size_t threadCount, size_t threshold) noexcept
+  : _threadCount(threadCount),
+    _threshold(threshold)
+{
+  if (_threadCount == 0) {
+    _threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+}
+
+void JsonParallelSerializer::Plan::Run(size_t threadCount) {
+  std::atomic<size_t> next { 0 };
+  std::mutex mutex;
+  std::exception_ptr error;
+
+  auto work = [this, &next, &mutex, &error]() {
+    while (true) {
+      auto index = next.fetch_add(1, std::memory_order_relaxed);
+      if (index >= _tasks.size()) {
+        return;
+      }
+
+      auto& [buffer, task] = _tasks[index];
+      try {
+        task(_buffers[buffer]);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock { mutex };
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  {
+    DEFER(1, for (auto& thread : threads) thread.join());
+
+    auto extraThreads = std::min(threadCount, _tasks.size());
+    extraThreads = extraThreads > 0 ? extraThreads - 1 : 0;
+    threads.reserve(extraThreads);
+    for (size_t i = 0; i < extraThreads; ++i) {
+      try {
+        threads.emplace_back(work);
+      } catch (const std::system_error &) {
+        // Run with the threads that could be started.
+        break;
+      }
+    }
+
+    work();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void JsonParallelSerializer::Plan::Concatenate(std::string& output) const {
+  size_t size = 0;
+  for (const auto& buffer : _buffers) {
+    size += buffer.size();
+  }
+
+  output.reserve(output.size() + size);
+  for (const auto& buffer : _buffers) {
+    output.append(buffer);
+  }
+}
+
+void JsonParallelSerializer::Plan::Write(int fd) const {
+  constexpr size_t MaxVectors = IOV_MAX < 1024 ? IOV_MAX : 1024;
+
+  std::vector<iovec> vectors;
+  vectors.reserve(_buffers.size());
+  for (const auto& buffer : _buffers) {
+    if (!buffer.empty()) {
+      vectors.push_back(iovec { const_cast<char *>(buffer.data()), buffer.size() });
+    }
+  }
+
+  auto first = vectors.data();
+  auto last = first + vectors.size();
+  while (first != last) {
+    auto count = std::min(static_cast<size_t>(last - first), MaxVectors);
+    auto written = ::writev(fd, first, static_cast<int>(count));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error { errno, std::generic_category(), "writev" };
+    }
+
+    // Skip the fully written vectors and advance into the partially written one.
+    auto remaining = static_cast<size_t>(written);
+    while (first != last && remaining >= first->iov_len) {
+      remaining -= first->iov_len;
+      ++first;
+    }
+    if (first != last) {
+      first->iov_base = static_cast<char *>(first->iov_base) + remaining;
+      first->iov_len -= remaining;
+    }
+  }
+}
+
+} // namespace kv
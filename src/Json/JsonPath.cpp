@@ -0,0 +1,122 @@
+#include "kv/Json/JsonPath.h"
+
+#include "kv/Json/JsonException.h"
+
+namespace kv {
+
+namespace {
+
+/**
+ * @brief Parse the specified token as an array index.
+ *
+ * @return the index, or SIZE_MAX if the token is not `0` or a decimal number without leading zeros, or is too large.
+ */
+size_t ParseArrayIndex(std::string_view token) noexcept {
+  if (token.empty() || (token.size() > 1 && token[0] == '0')) {
+    return SIZE_MAX;
+  }
+
+  size_t index = 0;
+  for (auto ch : token) {
+    if (ch < '0' || ch > '9') {
+      return SIZE_MAX;
+    }
+    auto digit = static_cast<size_t>(ch - '0');
+    if (index > (SIZE_MAX - 1 - digit) / 10) {
+      return SIZE_MAX;
+    }
+    index = index * 10 + digit;
+  }
+  return index;
+}
+
+} // namespace <anonymous>
+
+JsonPath::JsonPath(std::string_view pointer)
+  : _steps(),
+    _wildcards(false)
+{
+  if (pointer.empty()) {
+    return;
+  }
+  if (pointer[0] != '/') {
+    throw JsonParseException { "JSON pointer should start with '/'", 0 };
+  }
+
+  size_t offset = 1;
+  while (true) {
+    auto end = pointer.find('/', offset);
+    if (end == std::string_view::npos) {
+      end = pointer.size();
+    }
+    auto token = pointer.substr(offset, end - offset);
+
+    Step step { std::string { }, 0, NoIndex, token == "*" };
+    if (step.wildcard) {
+      _wildcards = true;
+    } else {
+      step.key.reserve(token.size());
+      for (size_t i = 0; i < token.size(); ++i) {
+        if (token[i] != '~') {
+          step.key.push_back(token[i]);
+          continue;
+        }
+
+        auto escape = i + 1 < token.size() ? token[i + 1] : '\0';
+        switch (escape) {
+          case '0':
+            step.key.push_back('~');
+            break;
+          case '1':
+            step.key.push_back('/');
+            break;
+          case '2':
+            step.key.push_back('*');
+            break;
+          default:
+            throw JsonParseException { "invalid escape in JSON pointer", offset + i };
+        }
+        ++i;
+      }
+      step.hash = JsonFlatMap::HashKey(step.key);
+      step.index = ParseArrayIndex(step.key);
+    }
+    _steps.push_back(std::move(step));
+
+    if (end == pointer.size()) {
+      break;
+    }
+    offset = end + 1;
+  }
+}
+
+std::string JsonPath::ToString() const {
+  std::string pointer;
+  for (const auto& step : _steps) {
+    pointer.push_back('/');
+    if (step.wildcard) {
+      pointer.push_back('*');
+      continue;
+    }
+    if (step.key == "*") {
+      pointer.append("~2");
+      continue;
+    }
+    for (auto ch : step.key) {
+      switch (ch) {
+        case '~':
+          pointer.append("~0");
+          break;
+        case '/':
+          pointer.append("~1");
+          break;
+        default:
+          pointer.push_back(ch);
+          break;
+      }
+    }
+  }
+  return pointer;
+}
+
+} // namespace kv
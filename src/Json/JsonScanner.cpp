@@ -0,0 +1,433 @@
+#include "kv/Json/JsonScanner.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "kv/Support/Intrinsics.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KV_JSON_SCANNER_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define KV_JSON_SCANNER_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace kv {
+
+namespace {
+
+constexpr static const size_t BlockSize = 64;
+
+constexpr static const uint64_t EvenBits = 0x5555555555555555ULL;
+
+/**
+ * @brief Classification of the 64 bytes of a block. Bit i of each mask corresponds to byte i of the block.
+ */
+struct BlockMasks {
+  uint64_t quote;
+  uint64_t backslash;
+  uint64_t whitespace;
+  uint64_t op;
+};
+
+/**
+ * @brief The instruction set independent part of the scanner, which carries state from one block to the next.
+ *
+ * Every per-instruction-set driver classifies a block into BlockMasks, calls FindQuotes, computes the prefix XOR of
+ * the quotes, and calls Emit. All members are inlined into the drivers.
+ */
+class StructuralScanner {
+public:
+  explicit StructuralScanner(std::vector<uint32_t>& positions) noexcept
+    : _positions(positions),
+      _escapeCarry(0),
+      _inStringCarry(0),
+      _scalarCarry(0)
+  { }
+
+  /**
+   * @brief Find the quotes that are not escaped by an odd-length run of backslashes.
+   */
+  [[nodiscard]]
+  uint64_t FindQuotes(uint64_t quote, uint64_t backslash) noexcept {
+    // A backslash that is itself escaped by the previous block does not start a run.
+    backslash &= ~_escapeCarry;
+
+    // Adding the start of a run to the run carries into the character right after the run. A run starting on an even
+    // bit has odd length if and only if it ends on an odd bit, and vice versa.
+    auto starts = backslash & ~(backslash << 1);
+    auto evenCarries = backslash + (starts & EvenBits);
+    uint64_t oddCarries;
+    auto oddOverflow = __builtin_add_overflow(backslash, starts & ~EvenBits, &oddCarries);
+
+    auto escaped = (evenCarries & ~backslash & ~EvenBits) | (oddCarries & ~backslash & EvenBits) | _escapeCarry;
+
+    // A run reaching the end of the block escapes the first character of the next block if it has odd length, which
+    // is the case exactly when it started on an odd bit.
+    _escapeCarry = oddOverflow ? 1 : 0;
+    return quote & ~escaped;
+  }
+
+  /**
+   * @brief Append the structural positions of the block at the specified offset.
+   *
+   * @param base the offset of the block.
+   * @param quotes the unescaped quotes.
+   * @param quotesPrefixXor the prefix XOR of the unescaped quotes.
+   * @param whitespace the whitespace mask.
+   * @param op the mask of structural characters.
+   */
+  void Emit(size_t base, uint64_t quotes, uint64_t quotesPrefixXor, uint64_t whitespace, uint64_t op) {
+    // Bits from an opening quote up to but excluding the closing quote.
+    auto inString = quotesPrefixXor ^ _inStringCarry;
+    _inStringCarry = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+    auto scalar = ~(op | whitespace | quotes) & ~inString;
+    auto scalarStarts = scalar & ~((scalar << 1) | _scalarCarry);
+    _scalarCarry = scalar >> 63;
+
+    auto structurals = (op & ~inString) | scalarStarts | (quotes & inString);
+    if (!structurals) {
+      return;
+    }
+
+    auto count = static_cast<size_t>(__builtin_popcountll(structurals));
+    auto offset = _positions.size();
+    _positions.resize(offset + count);
+
+    auto out = _positions.data() + offset;
+    while (structurals) {
+      *out++ = static_cast<uint32_t>(base + static_cast<size_t>(__builtin_ctzll(structurals)));
+      structurals &= structurals - 1;
+    }
+  }
+
+private:
+  std::vector<uint32_t>& _positions;
+  uint64_t _escapeCarry;     // 1 if the first character of the next block is escaped
+  uint64_t _inStringCarry;   // All ones if the next block starts within a string
+  uint64_t _scalarCarry;     // 1 if the last character of the previous block is part of a scalar token
+}; // class StructuralScanner
+
+/**
+ * @brief Get the block at the specified offset. The final partial block is copied into the specified buffer and padded
+ * with whitespace.
+ */
+[[nodiscard]]
+inline const uint8_t* GetBlock(const char* data, size_t size, size_t base, uint8_t* tail) noexcept {
+  if (LIKELY(size - base >= BlockSize)) {
+    return reinterpret_cast<const uint8_t *>(data + base);
+  }
+
+  std::memset(tail, ' ', BlockSize);
+  std::memcpy(tail, data + base, size - base);
+  return tail;
+}
+
+[[nodiscard]]
+inline uint64_t PrefixXorPortable(uint64_t bits) noexcept {
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+[[nodiscard]]
+BlockMasks ClassifyScalar(const uint8_t* block) noexcept {
+  BlockMasks masks { };
+  for (size_t i = 0; i < BlockSize; ++i) {
+    auto bit = static_cast<uint64_t>(1) << i;
+    switch (block[i]) {
+      case '"':
+        masks.quote |= bit;
+        break;
+      case '\\':
+        masks.backslash |= bit;
+        break;
+      case ' ':
+      case '\t':
+      case '\n':
+      case '\r':
+        masks.whitespace |= bit;
+        break;
+      case '{':
+      case '}':
+      case '[':
+      case ']':
+      case ':':
+      case ',':
+        masks.op |= bit;
+        break;
+      default:
+        break;
+    }
+  }
+  return masks;
+}
+
+void ScanScalar(const char* data, size_t size, std::vector<uint32_t>& positions) {
+  StructuralScanner scanner { positions };
+  alignas(BlockSize) uint8_t tail[BlockSize];
+  for (size_t base = 0; base < size; base += BlockSize) {
+    auto masks = ClassifyScalar(GetBlock(data, size, base, tail));
+    auto quotes = scanner.FindQuotes(masks.quote, masks.backslash);
+    scanner.Emit(base, quotes, PrefixXorPortable(quotes), masks.whitespace, masks.op);
+  }
+}
+
+#ifdef KV_JSON_SCANNER_X86
+
+__attribute__((target("pclmul,sse2")))
+inline uint64_t PrefixXorClmul(uint64_t bits) noexcept {
+  auto product = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(bits)), _mm_set1_epi8(-1), 0);
+  return static_cast<uint64_t>(_mm_cvtsi128_si64(product));
+}
+
+__attribute__((target("sse4.2")))
+inline BlockMasks ClassifySse42(const uint8_t* block) noexcept {
+  BlockMasks masks { };
+  for (size_t lane = 0; lane < BlockSize / 16; ++lane) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + lane * 16));
+
+    // Setting bit 5 maps '[' to '{' and ']' to '}'.
+    auto folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    auto op = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+    auto ws = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'))));
+
+    auto shift = lane * 16;
+    masks.quote |= static_cast<uint64_t>(static_cast<uint16_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))))) << shift;
+    masks.backslash |= static_cast<uint64_t>(static_cast<uint16_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))))) << shift;
+    masks.whitespace |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(ws))) << shift;
+    masks.op |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(op))) << shift;
+  }
+  return masks;
+}
+
+__attribute__((target("sse4.2,pclmul")))
+void ScanSse42(const char* data, size_t size, std::vector<uint32_t>& positions) {
+  StructuralScanner scanner { positions };
+  alignas(BlockSize) uint8_t tail[BlockSize];
+  for (size_t base = 0; base < size; base += BlockSize) {
+    auto masks = ClassifySse42(GetBlock(data, size, base, tail));
+    auto quotes = scanner.FindQuotes(masks.quote, masks.backslash);
+    scanner.Emit(base, quotes, PrefixXorClmul(quotes), masks.whitespace, masks.op);
+  }
+}
+
+__attribute__((target("avx2")))
+inline BlockMasks ClassifyAvx2(const uint8_t* block) noexcept {
+  BlockMasks masks { };
+  for (size_t lane = 0; lane < BlockSize / 32; ++lane) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + lane * 32));
+
+    auto folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    auto op = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')),
+                        _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+    auto ws = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r'))));
+
+    auto shift = lane * 32;
+    masks.quote |= static_cast<uint64_t>(static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'))))) << shift;
+    masks.backslash |= static_cast<uint64_t>(static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))))) << shift;
+    masks.whitespace |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(ws))) << shift;
+    masks.op |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(op))) << shift;
+  }
+  return masks;
+}
+
+__attribute__((target("avx2,pclmul")))
+void ScanAvx2(const char* data, size_t size, std::vector<uint32_t>& positions) {
+  StructuralScanner scanner { positions };
+  alignas(BlockSize) uint8_t tail[BlockSize];
+  for (size_t base = 0; base < size; base += BlockSize) {
+    auto masks = ClassifyAvx2(GetBlock(data, size, base, tail));
+    auto quotes = scanner.FindQuotes(masks.quote, masks.backslash);
+    scanner.Emit(base, quotes, PrefixXorClmul(quotes), masks.whitespace, masks.op);
+  }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline BlockMasks ClassifyAvx512(const uint8_t* block) noexcept {
+  auto v = _mm512_loadu_si512(block);
+  auto folded = _mm512_or_si512(v, _mm512_set1_epi8(0x20));
+
+  BlockMasks masks { };
+  masks.quote = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"'));
+  masks.backslash = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\'));
+  masks.whitespace = _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(' ')) |
+      _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\t')) |
+      _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n')) |
+      _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\r'));
+  masks.op = _mm512_cmpeq_epi8_mask(folded, _mm512_set1_epi8('{')) |
+      _mm512_cmpeq_epi8_mask(folded, _mm512_set1_epi8('}')) |
+      _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(':')) |
+      _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8(','));
+  return masks;
+}
+
+__attribute__((target("avx512f,avx512bw,pclmul")))
+void ScanAvx512(const char* data, size_t size, std::vector<uint32_t>& positions) {
+  StructuralScanner scanner { positions };
+  alignas(BlockSize) uint8_t tail[BlockSize];
+  for (size_t base = 0; base < size; base += BlockSize) {
+    auto masks = ClassifyAvx512(GetBlock(data, size, base, tail));
+    auto quotes = scanner.FindQuotes(masks.quote, masks.backslash);
+    scanner.Emit(base, quotes, PrefixXorClmul(quotes), masks.whitespace, masks.op);
+  }
+}
+
+#endif // KV_JSON_SCANNER_X86
+
+#ifdef KV_JSON_SCANNER_NEON
+
+/**
+ * @brief Compress the 64 comparison result bytes of four vectors into a 64-bit mask.
+ */
+inline uint64_t MoveMaskNeon(uint8x16_t v0, uint8x16_t v1, uint8x16_t v2, uint8x16_t v3) noexcept {
+  const uint8x16_t bits = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+  auto sum0 = vpaddq_u8(vandq_u8(v0, bits), vandq_u8(v1, bits));
+  auto sum1 = vpaddq_u8(vandq_u8(v2, bits), vandq_u8(v3, bits));
+  sum0 = vpaddq_u8(sum0, sum1);
+  sum0 = vpaddq_u8(sum0, sum0);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+inline BlockMasks ClassifyNeon(const uint8_t* block) noexcept {
+  uint8x16_t quote[4], backslash[4], ws[4], op[4];
+  for (size_t lane = 0; lane < 4; ++lane) {
+    auto v = vld1q_u8(block + lane * 16);
+    auto folded = vorrq_u8(v, vdupq_n_u8(0x20));
+    quote[lane] = vceqq_u8(v, vdupq_n_u8('"'));
+    backslash[lane] = vceqq_u8(v, vdupq_n_u8('\\'));
+    ws[lane] = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')), vceqq_u8(v, vdupq_n_u8('\t'))),
+                        vorrq_u8(vceqq_u8(v, vdupq_n_u8('\n')), vceqq_u8(v, vdupq_n_u8('\r'))));
+    op[lane] = vorrq_u8(vorrq_u8(vceqq_u8(folded, vdupq_n_u8('{')), vceqq_u8(folded, vdupq_n_u8('}'))),
+                        vorrq_u8(vceqq_u8(v, vdupq_n_u8(':')), vceqq_u8(v, vdupq_n_u8(','))));
+  }
+
+  BlockMasks masks;
+  masks.quote = MoveMaskNeon(quote[0], quote[1], quote[2], quote[3]);
+  masks.backslash = MoveMaskNeon(backslash[0], backslash[1], backslash[2], backslash[3]);
+  masks.whitespace = MoveMaskNeon(ws[0], ws[1], ws[2], ws[3]);
+  masks.op = MoveMaskNeon(op[0], op[1], op[2], op[3]);
+  return masks;
+}
+
+void ScanNeon(const char* data, size_t size, std::vector<uint32_t>& positions) {
+  StructuralScanner scanner { positions };
+  alignas(BlockSize) uint8_t tail[BlockSize];
+  for (size_t base = 0; base < size; base += BlockSize) {
+    auto masks = ClassifyNeon(GetBlock(data, size, base, tail));
+    auto quotes = scanner.FindQuotes(masks.quote, masks.backslash);
+    scanner.Emit(base, quotes, PrefixXorPortable(quotes), masks.whitespace, masks.op);
+  }
+}
+
+#endif // KV_JSON_SCANNER_NEON
+
+[[nodiscard]]
+JsonScannerIsa DetectJsonScannerIsa() noexcept {
+  for (auto isa : { JsonScannerIsa::Avx512, JsonScannerIsa::Avx2, JsonScannerIsa::Sse42, JsonScannerIsa::Neon }) {
+    if (IsJsonScannerIsaSupported(isa)) {
+      return isa;
+    }
+  }
+  return JsonScannerIsa::Scalar;
+}
+
+} // namespace <anonymous>
+
+const char* GetJsonScannerIsaName(JsonScannerIsa isa) noexcept {
+  switch (isa) {
+    case JsonScannerIsa::Scalar:
+      return "scalar";
+    case JsonScannerIsa::Sse42:
+      return "sse4.2";
+    case JsonScannerIsa::Avx2:
+      return "avx2";
+    case JsonScannerIsa::Avx512:
+      return "avx512";
+    case JsonScannerIsa::Neon:
+      return "neon";
+    default:
+      UNREACHABLE();
+  }
+}
+
+bool IsJsonScannerIsaSupported(JsonScannerIsa isa) noexcept {
+  switch (isa) {
+    case JsonScannerIsa::Scalar:
+      return true;
+#ifdef KV_JSON_SCANNER_X86
+    case JsonScannerIsa::Sse42:
+      return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul");
+    case JsonScannerIsa::Avx2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("pclmul");
+    case JsonScannerIsa::Avx512:
+      return __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("pclmul");
+#endif
+#ifdef KV_JSON_SCANNER_NEON
+    case JsonScannerIsa::Neon:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+JsonScannerIsa GetJsonScannerIsa() noexcept {
+  static const auto isa = DetectJsonScannerIsa();
+  return isa;
+}
+
+void ScanJsonStructurals(std::string_view text, std::vector<uint32_t>& positions) {
+  ScanJsonStructurals(text, positions, GetJsonScannerIsa());
+}
+
+void ScanJsonStructurals(std::string_view text, std::vector<uint32_t>& positions, JsonScannerIsa isa) {
+  assert(text.size() <= MaxIndexedJsonSize && "the text is too large to be indexed");
+  assert(IsJsonScannerIsaSupported(isa) && "the instruction set is not supported on this machine");
+
+  positions.clear();
+  // Typical JSON text has a structural position every few bytes.
+  positions.reserve(text.size() / 4 + BlockSize);
+
+  switch (isa) {
+#ifdef KV_JSON_SCANNER_X86
+    case JsonScannerIsa::Sse42:
+      ScanSse42(text.data(), text.size(), positions);
+      break;
+    case JsonScannerIsa::Avx2:
+      ScanAvx2(text.data(), text.size(), positions);
+      break;
+    case JsonScannerIsa::Avx512:
+      ScanAvx512(text.data(), text.size(), positions);
+      break;
+#endif
+#ifdef KV_JSON_SCANNER_NEON
+    case JsonScannerIsa::Neon:
+      ScanNeon(text.data(), text.size(), positions);
+      break;
+#endif
+    default:
+      ScanScalar(text.data(), text.size(), positions);
+      break;
+  }
+}
+
+} // namespace kv
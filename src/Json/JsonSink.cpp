@@ -0,0 +1,67 @@
+#include "kv/Json/JsonSink.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <sys/uio.h>
+
+namespace kv {
+
+JsonFileSink::JsonFileSink(int fd, size_t bufferSize)
+  : _fd(fd),
+    _buffer(new char[bufferSize]),
+    _size(0),
+    _capacity(bufferSize),
+    _written(0)
+{ }
+
+JsonFileSink::~JsonFileSink() noexcept {
+  try {
+    Flush();
+  } catch (const std::system_error &) {
+    // Errors are reported only by explicit calls to Flush.
+  }
+}
+
+void JsonFileSink::Flush() {
+  Write(nullptr, 0);
+}
+
+void JsonFileSink::Write(const char* data, size_t size) {
+  iovec vec[2] = {
+      { _buffer.get(), _size },
+      { const_cast<char *>(data), size },
+  };
+  auto first = vec;
+  auto last = vec + (size == 0 ? 1 : 2);
+  auto remaining = _size + size;
+
+  // The buffer is released up front, so it is empty again after both a successful and a failed write.
+  _size = 0;
+
+  while (remaining > 0) {
+    auto written = ::writev(_fd, first, static_cast<int>(last - first));
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error { errno, std::generic_category(), "writev" };
+    }
+
+    auto count = static_cast<size_t>(written);
+    _written += count;
+    remaining -= count;
+
+    // Skip the fully written vectors and advance into the partially written one.
+    while (first != last && count >= first->iov_len) {
+      count -= first->iov_len;
+      ++first;
+    }
+    if (first != last) {
+      first->iov_base = static_cast<char *>(first->iov_base) + count;
+      first->iov_len -= count;
+    }
+  }
+}
+
+} // namespace kv
@@ -0,0 +1,206 @@
+#include "kv/Json/JsonSnapshot.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "kv/Json/JsonException.h"
+#include "kv/Support/Intrinsics.h"
+
+namespace kv {
+
+namespace {
+
+constexpr static const size_t SnapshotAlignment = sizeof(JsonTapeNode);
+
+/**
+ * @brief Read a trivially copyable struct at the specified offset of the image, whose bounds the caller has checked.
+ */
+template <typename T>
+const T* GetStruct(std::string_view image, uint64_t offset) noexcept {
+  return reinterpret_cast<const T *>(image.data() + offset);
+}
+
+[[noreturn]]
+void ThrowMalformed(const char* message, uint64_t offset) {
+  throw JsonParseException { std::string { "malformed snapshot: " } + message, static_cast<size_t>(offset) };
+}
+
+[[nodiscard]]
+bool IsPowerOfTwo(uint64_t value) noexcept {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+
+void CheckDocument(std::string_view image, const details::JsonSnapshotSectionEntry& entry) {
+  if (UNLIKELY(entry.size == 0 || entry.size % sizeof(JsonTapeNode) != 0)) {
+    ThrowMalformed("document section size", entry.offset);
+  }
+  const auto& root = *GetStruct<JsonTapeNode>(image, entry.offset);
+  if (UNLIKELY(root.GetSpan() != entry.size / sizeof(JsonTapeNode))) {
+    ThrowMalformed("document root span", entry.offset);
+  }
+}
+
+void CheckIndex(std::string_view image, const details::JsonSnapshotSectionEntry& entry) {
+  if (UNLIKELY(entry.size < sizeof(details::JsonSnapshotIndexFooter) || entry.size % SnapshotAlignment != 0)) {
+    ThrowMalformed("index section size", entry.offset);
+  }
+  auto footerOffset = entry.offset + entry.size - sizeof(details::JsonSnapshotIndexFooter);
+  const auto& footer = *GetStruct<details::JsonSnapshotIndexFooter>(image, footerOffset);
+  auto payload = entry.size - sizeof(details::JsonSnapshotIndexFooter);
+  auto limit = payload / sizeof(JsonTapeNode);
+  if (UNLIKELY(!IsPowerOfTwo(footer.slotCount) || footer.slotCount > limit || footer.nodeCount > limit ||
+               footer.nodeCount + footer.slotCount != limit || footer.entryCount > footer.slotCount ||
+               footer.entryCount * 2 > footer.nodeCount)) {
+    ThrowMalformed("index section footer", footerOffset);
+  }
+}
+
+} // namespace <anonymous>
+
+JsonSnapshot::JsonSnapshot(const char* path)
+  : _file(std::in_place, path),
+    _image(_file->GetView()),
+    _table(nullptr),
+    _sectionCount(0)
+{
+  Open();
+}
+
+JsonSnapshot::JsonSnapshot(std::string_view image)
+  : _file(),
+    _image(image),
+    _table(nullptr),
+    _sectionCount(0)
+{
+  if (reinterpret_cast<uintptr_t>(image.data()) % SnapshotAlignment != 0) {
+    throw std::invalid_argument { "snapshot image not aligned to 16 bytes" };
+  }
+  Open();
+}
+
+void JsonSnapshot::Open() {
+  auto size = static_cast<uint64_t>(_image.size());
+  if (UNLIKELY(size < sizeof(details::JsonSnapshotHeader) + sizeof(details::JsonSnapshotFooter))) {
+    ThrowMalformed("file too short", size);
+  }
+
+  const auto& header = *GetStruct<details::JsonSnapshotHeader>(_image, 0);
+  if (UNLIKELY(std::memcmp(header.magic, details::JsonSnapshotMagic, sizeof(header.magic)) != 0)) {
+    ThrowMalformed("header magic", 0);
+  }
+  if (UNLIKELY(header.byteOrder != details::JsonSnapshotByteOrderMark)) {
+    ThrowMalformed("byte order", offsetof(details::JsonSnapshotHeader, byteOrder));
+  }
+  if (UNLIKELY(header.version != details::JsonSnapshotVersion)) {
+    ThrowMalformed("version", offsetof(details::JsonSnapshotHeader, version));
+  }
+
+  auto footerOffset = size - sizeof(details::JsonSnapshotFooter);
+  const auto& footer = *GetStruct<details::JsonSnapshotFooter>(_image, footerOffset);
+  if (UNLIKELY(std::memcmp(footer.magic, details::JsonSnapshotFooterMagic, sizeof(footer.magic)) != 0)) {
+    ThrowMalformed("footer magic", footerOffset + offsetof(details::JsonSnapshotFooter, magic));
+  }
+
+  // The section table ends where the footer starts.
+  auto tableSize = static_cast<uint64_t>(footer.sectionCount) * sizeof(details::JsonSnapshotSectionEntry);
+  if (UNLIKELY(footer.tableOffset < sizeof(details::JsonSnapshotHeader) || footer.tableOffset > footerOffset ||
+               footerOffset - footer.tableOffset != tableSize || footer.tableOffset % SnapshotAlignment != 0)) {
+    ThrowMalformed("section table bounds", footerOffset);
+  }
+  if (UNLIKELY(ComputeCrc32c(_image.data() + footer.tableOffset, tableSize) != footer.tableCrc)) {
+    ThrowMalformed("section table checksum", footer.tableOffset);
+  }
+
+  auto table = GetStruct<details::JsonSnapshotSectionEntry>(_image, footer.tableOffset);
+  for (uint32_t i = 0; i < footer.sectionCount; ++i) {
+    const auto& entry = table[i];
+    auto entryOffset = footer.tableOffset + i * sizeof(details::JsonSnapshotSectionEntry);
+    if (UNLIKELY(entry.nameSize > sizeof(entry.name))) {
+      ThrowMalformed("section name size", entryOffset);
+    }
+    if (UNLIKELY(entry.offset < sizeof(details::JsonSnapshotHeader) || entry.offset > footer.tableOffset ||
+                 entry.size > footer.tableOffset - entry.offset || entry.offset % SnapshotAlignment != 0)) {
+      ThrowMalformed("section bounds", entryOffset);
+    }
+
+    switch (static_cast<JsonSnapshotSectionKind>(entry.kind)) {
+      case JsonSnapshotSectionKind::Document:
+        CheckDocument(_image, entry);
+        break;
+      case JsonSnapshotSectionKind::Index:
+        CheckIndex(_image, entry);
+        break;
+      default:
+        ThrowMalformed("section kind", entryOffset);
+    }
+  }
+
+  _table = table;
+  _sectionCount = footer.sectionCount;
+}
+
+JsonSnapshotSection JsonSnapshot::GetSection(size_t index) const noexcept {
+  const auto& entry = _table[index];
+  return JsonSnapshotSection {
+      std::string_view { entry.name, entry.nameSize },
+      static_cast<JsonSnapshotSectionKind>(entry.kind),
+      entry.offset,
+      entry.size,
+  };
+}
+
+std::optional<size_t> JsonSnapshot::FindSection(std::string_view name) const noexcept {
+  for (size_t i = 0; i < _sectionCount; ++i) {
+    if (std::string_view { _table[i].name, _table[i].nameSize } == name) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
+
+const details::JsonSnapshotSectionEntry* JsonSnapshot::FindEntry(std::string_view name,
+                                                                 JsonSnapshotSectionKind kind) const noexcept {
+  for (size_t i = 0; i < _sectionCount; ++i) {
+    const auto& entry = _table[i];
+    if (entry.kind == static_cast<uint32_t>(kind) && std::string_view { entry.name, entry.nameSize } == name) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+const JsonTapeNode* JsonSnapshot::FindDocument(std::string_view name) const noexcept {
+  auto entry = FindEntry(name, JsonSnapshotSectionKind::Document);
+  return entry ? reinterpret_cast<const JsonTapeNode *>(GetSectionData(*entry)) : nullptr;
+}
+
+std::optional<JsonSnapshotIndex> JsonSnapshot::FindIndex(std::string_view name) const noexcept {
+  auto entry = FindEntry(name, JsonSnapshotSectionKind::Index);
+  if (!entry) {
+    return std::nullopt;
+  }
+
+  auto data = GetSectionData(*entry);
+  const auto& footer = *reinterpret_cast<const details::JsonSnapshotIndexFooter *>(
+      data + entry->size - sizeof(details::JsonSnapshotIndexFooter));
+  auto nodes = reinterpret_cast<const JsonTapeNode *>(data);
+  auto slots = reinterpret_cast<const details::JsonSnapshotSlot *>(nodes + footer.nodeCount);
+  return JsonSnapshotIndex { nodes, footer.nodeCount, slots, footer.slotCount, footer.entryCount };
+}
+
+bool JsonSnapshot::VerifySection(size_t index) const noexcept {
+  const auto& entry = _table[index];
+  return ComputeCrc32c(GetSectionData(entry), entry.size) == entry.crc;
+}
+
+bool JsonSnapshot::Verify() const noexcept {
+  for (size_t i = 0; i < _sectionCount; ++i) {
+    if (!VerifySection(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace kv
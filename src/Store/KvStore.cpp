@@ -0,0 +1,234 @@
+#include "kv/Store/KvStore.h"
+
+#include <algorithm>
+#include <new>
+#include <utility>
+
+namespace kv {
+
+namespace details {
+
+namespace {
+
+/**
+ * @brief Get the smallest index capacity at which the specified number of entries keeps the load factor at or below
+ * 3/4.
+ */
+size_t GetCapacityFor(size_t size) noexcept {
+  size_t capacity = 16;
+  while (size * 4 > capacity * 3) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+} // namespace <anonymous>
+
+KvShard::KvShard(MemoryResource& upstream, size_t capacity)
+  : _mutex(),
+    _slots(),
+    _mask(GetCapacityFor(capacity) - 1),
+    _size(0),
+    _pools(upstream)
+{
+  _slots.reset(new KvSlot[_mask + 1]());
+}
+
+KvShard::~KvShard() {
+  Clear();
+}
+
+bool KvShard::Put(std::string_view key, uint64_t hash, JsonObject&& value, std::optional<JsonObject>& replaced) {
+  auto slot = FindSlot(key, hash);
+  if (auto entry = _slots[slot].entry) {
+    replaced.emplace(std::move(entry->value));
+    entry->value = std::move(value);
+    return false;
+  }
+
+  auto size = _size.load(std::memory_order_relaxed);
+  if (UNLIKELY((size + 1) * 4 > (_mask + 1) * 3)) {
+    Grow();
+    slot = FindSlot(key, hash);
+  }
+
+  _slots[slot] = KvSlot { hash, AllocateEntry(key, std::move(value)) };
+  _size.store(size + 1, std::memory_order_relaxed);
+  return true;
+}
+
+bool KvShard::Delete(std::string_view key, uint64_t hash, std::optional<JsonObject>& removed) noexcept {
+  auto slot = FindSlot(key, hash);
+  auto entry = _slots[slot].entry;
+  if (!entry) {
+    return false;
+  }
+
+  removed.emplace(std::move(entry->value));
+  ReleaseEntry(entry);
+
+  // Shift the following entries of the probe sequence back, so that no tombstone is needed: an entry moves into the
+  // hole unless its home slot lies cyclically within (hole, position].
+  auto hole = slot;
+  for (auto position = (slot + 1) & _mask; _slots[position].entry; position = (position + 1) & _mask) {
+    auto home = static_cast<size_t>(_slots[position].hash) & _mask;
+    if (((position - home) & _mask) >= ((position - hole) & _mask)) {
+      _slots[hole] = _slots[position];
+      hole = position;
+    }
+  }
+  _slots[hole] = KvSlot { 0, nullptr };
+
+  _size.store(_size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+  return true;
+}
+
+void KvShard::Clear() noexcept {
+  for (size_t i = 0; i <= _mask; ++i) {
+    if (auto entry = _slots[i].entry) {
+      ReleaseEntry(entry);
+      _slots[i] = KvSlot { 0, nullptr };
+    }
+  }
+  _size.store(0, std::memory_order_relaxed);
+}
+
+void KvShard::Grow() {
+  auto capacity = (_mask + 1) * 2;
+  std::unique_ptr<KvSlot[]> slots { new KvSlot[capacity]() };
+  auto mask = capacity - 1;
+  for (size_t i = 0; i <= _mask; ++i) {
+    const auto& old = _slots[i];
+    if (!old.entry) {
+      continue;
+    }
+    auto slot = static_cast<size_t>(old.hash) & mask;
+    while (slots[slot].entry) {
+      slot = (slot + 1) & mask;
+    }
+    slots[slot] = old;
+  }
+  _slots = std::move(slots);
+  _mask = mask;
+}
+
+KvEntry* KvShard::AllocateEntry(std::string_view key, JsonObject&& value) {
+  auto size = sizeof(KvEntry) + key.size();
+  void* memory;
+  if (auto pool = _pools.GetPool(size, alignof(KvEntry))) {
+    memory = pool->Allocate();
+  } else {
+    memory = _pools.GetUpstream()->Allocate(size, alignof(KvEntry));
+  }
+
+  auto entry = ::new (memory) KvEntry { std::move(value), key.size() };
+  std::memcpy(reinterpret_cast<char *>(entry + 1), key.data(), key.size());
+  return entry;
+}
+
+void KvShard::ReleaseEntry(KvEntry* entry) noexcept {
+  auto size = sizeof(KvEntry) + entry->keySize;
+  entry->~KvEntry();
+  if (auto pool = _pools.GetPool(size, alignof(KvEntry))) {
+    pool->Release(entry);
+  } else {
+    _pools.GetUpstream()->Release(entry);
+  }
+}
+
+} // namespace details
+
+namespace {
+
+constexpr static const size_t MaxShards = static_cast<size_t>(1) << 16;
+
+size_t GetShardCountFor(size_t shards) noexcept {
+  size_t count = 1;
+  while (count < shards && count < MaxShards) {
+    count *= 2;
+  }
+  return count;
+}
+
+} // namespace <anonymous>
+
+KvStore::KvStore()
+  : KvStore(KvStoreOptions { })
+{ }
+
+KvStore::KvStore(const KvStoreOptions& options)
+  : _memory(),
+    _shards(),
+    _shardMask(GetShardCountFor(options.shards) - 1)
+{
+  auto count = _shardMask + 1;
+  auto capacity = (options.initialCapacity + count - 1) / count;
+  _shards.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    _shards.push_back(std::make_unique<details::KvShard>(_memory, capacity));
+  }
+}
+
+KvStore::~KvStore() = default;
+
+size_t KvStore::GetSize() const noexcept {
+  size_t size = 0;
+  for (const auto& shard : _shards) {
+    size += shard->GetSize();
+  }
+  return size;
+}
+
+std::optional<JsonObject> KvStore::Get(std::string_view key) const {
+  std::optional<JsonObject> copy;
+  Get(key, [&copy](const JsonObject& value) {
+    copy.emplace(value);
+  });
+  return copy;
+}
+
+bool KvStore::Put(std::string_view key, JsonObject value) {
+  auto hash = HashKey(key);
+  auto& shard = GetShard(hash);
+  // The lock is declared after the replaced value, so it is released before the value is destroyed.
+  std::optional<JsonObject> replaced;
+  std::unique_lock<std::shared_mutex> lock { shard.GetMutex() };
+  return shard.Put(key, hash, std::move(value), replaced);
+}
+
+bool KvStore::Delete(std::string_view key) noexcept {
+  auto hash = HashKey(key);
+  auto& shard = GetShard(hash);
+  std::optional<JsonObject> removed;
+  std::unique_lock<std::shared_mutex> lock { shard.GetMutex() };
+  return shard.Delete(key, hash, removed);
+}
+
+void KvStore::Clear() noexcept {
+  for (auto& shard : _shards) {
+    std::unique_lock<std::shared_mutex> lock { shard->GetMutex() };
+    shard->Clear();
+  }
+}
+
+size_t KvStore::LoadSnapshot(const JsonSnapshotIndex& index) {
+  size_t count = 0;
+  index.ForEach([this, &count](std::string_view key, const JsonTapeNode& value) {
+    Put(key, ToJsonObject(value, GetNodeAllocator()));
+    ++count;
+  });
+  return count;
+}
+
+void KvStore::PrepareMultiGet(const std::vector<std::string_view>& keys, std::vector<KeyRef>& refs) const {
+  refs.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto hash = HashKey(keys[i]);
+    refs.push_back(KeyRef { hash, static_cast<size_t>(hash >> 48) & _shardMask, i });
+  }
+  std::sort(refs.begin(), refs.end(), [](const KeyRef& lhs, const KeyRef& rhs) {
+    return lhs.shard < rhs.shard;
+  });
+}
+
+} // namespace kv
@@ -0,0 +1,187 @@
+#include "kv/Support/BackingStore.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "kv/Support/Defer.h"
+#include "kv/Support/Intrinsics.h"
+#include "kv/Support/Numa.h"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+namespace kv {
+
+namespace {
+
+constexpr static const size_t HugePageSize2M = static_cast<size_t>(1) << 21;
+constexpr static const size_t HugePageSize1G = static_cast<size_t>(1) << 30;
+
+[[nodiscard]]
+size_t GetPageSize() noexcept {
+  static const auto pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  return pageSize;
+}
+
+/**
+ * @brief Map regular pages whose base address is aligned to the specified alignment.
+ *
+ * @return pointer to the mapped pages, or null if the mapping fails.
+ */
+[[nodiscard]]
+void* MapAligned(size_t size, size_t alignment) noexcept {
+  auto padded = size + alignment - GetPageSize();
+  auto ptr = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (ptr == MAP_FAILED) {
+    return nullptr;
+  }
+
+  // Trim the unaligned head and the excess tail of the mapping.
+  auto base = reinterpret_cast<uintptr_t>(ptr);
+  auto aligned = (base + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+  if (aligned != base) {
+    ::munmap(ptr, aligned - base);
+  }
+  auto tail = base + padded - (aligned + size);
+  if (tail != 0) {
+    ::munmap(reinterpret_cast<void *>(aligned + size), tail);
+  }
+
+  return reinterpret_cast<void *>(aligned);
+}
+
+} // namespace <anonymous>
+
+void* MallocBackingStore::Map(size_t size) {
+  auto ptr = ::malloc(size);
+  if (UNLIKELY(!ptr)) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void MallocBackingStore::Unmap(void* ptr, size_t) noexcept {
+  ::free(ptr);
+}
+
+void MallocBackingStore::Purge(void *, size_t) noexcept { }
+
+size_t MmapBackingStore::GetGranularity() const noexcept {
+  switch (_hugePages) {
+    case HugePagePolicy::None:
+      return GetPageSize();
+    case HugePagePolicy::Transparent:
+    case HugePagePolicy::Explicit2M:
+      return HugePageSize2M;
+    case HugePagePolicy::Explicit1G:
+      return HugePageSize1G;
+    default:
+      UNREACHABLE();
+  }
+}
+
+void* MmapBackingStore::Map(size_t size) {
+  void* ptr = nullptr;
+  switch (_hugePages) {
+    case HugePagePolicy::None: {
+      ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      if (ptr == MAP_FAILED) {
+        ptr = nullptr;
+      }
+      break;
+    }
+    case HugePagePolicy::Explicit2M:
+    case HugePagePolicy::Explicit1G: {
+      auto shift = _hugePages == HugePagePolicy::Explicit2M ? 21 : 30;
+      ptr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (shift << MAP_HUGE_SHIFT), -1, 0);
+      if (ptr != MAP_FAILED) {
+        break;
+      }
+
+      // The hugetlbfs pool cannot satisfy the mapping. Fall back to transparent huge pages.
+      _hugePageFallbacks.fetch_add(1, std::memory_order_relaxed);
+      [[fallthrough]];
+    }
+    case HugePagePolicy::Transparent: {
+      ptr = MapAligned(size, HugePageSize2M);
+      if (ptr) {
+        ::madvise(ptr, size, MADV_HUGEPAGE);
+      }
+      break;
+    }
+    default:
+      UNREACHABLE();
+  }
+
+  if (UNLIKELY(!ptr)) {
+    throw std::bad_alloc();
+  }
+
+  if (_numaNode) {
+    // If the kernel does not support NUMA, the pages are placed where they are first touched.
+    BindMemoryToNumaNode(ptr, size, _numaNode.value());
+  }
+
+  return ptr;
+}
+
+void MmapBackingStore::Unmap(void* ptr, size_t size) noexcept {
+  ::munmap(ptr, size);
+}
+
+void MmapBackingStore::Purge(void* ptr, size_t size) noexcept {
+  // Pages from the hugetlbfs pool can only be discarded as a whole.
+  auto pageSize = _hugePages == HugePagePolicy::Explicit2M || _hugePages == HugePagePolicy::Explicit1G
+      ? GetGranularity()
+      : GetPageSize();
+
+  auto begin = (reinterpret_cast<uintptr_t>(ptr) + pageSize - 1) & ~static_cast<uintptr_t>(pageSize - 1);
+  auto end = (reinterpret_cast<uintptr_t>(ptr) + size) & ~static_cast<uintptr_t>(pageSize - 1);
+  if (begin < end) {
+    ::madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+  }
+}
+
+namespace {
+
+alignas(MmapBackingStore) unsigned char nodeBackingStoreStorage[NumaTopology::MaxNodes][sizeof(MmapBackingStore)];
+std::atomic<BackingStore *> nodeBackingStores[NumaTopology::MaxNodes];
+std::mutex nodeBackingStoreLock;
+
+} // namespace <anonymous>
+
+BackingStore* GetMallocBackingStore() noexcept {
+  // The store is never destroyed since the global allocator may use it during static destruction.
+  alignas(MallocBackingStore) static unsigned char storage[sizeof(MallocBackingStore)];
+  static BackingStore* store = ::new (storage) MallocBackingStore();
+  return store;
+}
+
+BackingStore* GetNodeBackingStore(size_t node) noexcept {
+  if (UNLIKELY(!NumaTopology::Get().IsNodeOnline(node))) {
+    return GetMallocBackingStore();
+  }
+
+  auto store = nodeBackingStores[node].load(std::memory_order_acquire);
+  if (UNLIKELY(!store)) {
+    nodeBackingStoreLock.lock();
+    DEFER(1, nodeBackingStoreLock.unlock());
+
+    store = nodeBackingStores[node].load(std::memory_order_relaxed);
+    if (!store) {
+      store = ::new (nodeBackingStoreStorage[node]) MmapBackingStore(HugePagePolicy::None, node);
+      nodeBackingStores[node].store(store, std::memory_order_release);
+    }
+  }
+
+  return store;
+}
+
+} // namespace kv
@@ -0,0 +1,96 @@
+#include "kv/Support/Crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#define KV_CRC32C_X86 1
+#include <immintrin.h>
+#endif
+
+namespace kv {
+
+namespace {
+
+/**
+ * @brief The reflected CRC-32C polynomial.
+ */
+constexpr static const uint32_t Polynomial = 0x82F63B78;
+
+using Crc32cTables = std::array<std::array<uint32_t, 256>, 8>;
+
+/**
+ * @brief Make the tables of the slicing-by-8 algorithm: table k maps a byte to its checksum followed by k zero bytes.
+ */
+constexpr Crc32cTables MakeTables() noexcept {
+  Crc32cTables tables { };
+  for (uint32_t i = 0; i < 256; ++i) {
+    auto crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) ? Polynomial : 0);
+    }
+    tables[0][i] = crc;
+  }
+  for (size_t k = 1; k < tables.size(); ++k) {
+    for (size_t i = 0; i < 256; ++i) {
+      tables[k][i] = (tables[k - 1][i] >> 8) ^ tables[0][tables[k - 1][i] & 0xFF];
+    }
+  }
+  return tables;
+}
+
+constexpr static const Crc32cTables Tables = MakeTables();
+
+uint32_t UpdateScalar(const unsigned char* data, size_t size, uint32_t crc) noexcept {
+  for (; size >= 8; data += 8, size -= 8) {
+    uint32_t low;
+    uint32_t high;
+    std::memcpy(&low, data, sizeof(low));
+    std::memcpy(&high, data + 4, sizeof(high));
+    low ^= crc;
+    crc = Tables[7][low & 0xFF] ^ Tables[6][(low >> 8) & 0xFF] ^ Tables[5][(low >> 16) & 0xFF] ^
+          Tables[4][low >> 24] ^ Tables[3][high & 0xFF] ^ Tables[2][(high >> 8) & 0xFF] ^
+          Tables[1][(high >> 16) & 0xFF] ^ Tables[0][high >> 24];
+  }
+  for (; size > 0; ++data, --size) {
+    crc = (crc >> 8) ^ Tables[0][(crc ^ *data) & 0xFF];
+  }
+  return crc;
+}
+
+#ifdef KV_CRC32C_X86
+__attribute__((target("sse4.2")))
+uint32_t UpdateSse42(const unsigned char* data, size_t size, uint32_t crc) noexcept {
+  uint64_t crc64 = crc;
+  for (; size >= 8; data += 8, size -= 8) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; size > 0; ++data, --size) {
+    crc = _mm_crc32_u8(crc, *data);
+  }
+  return crc;
+}
+#endif // KV_CRC32C_X86
+
+using UpdateFn = uint32_t (*)(const unsigned char *, size_t, uint32_t) noexcept;
+
+UpdateFn SelectUpdate() noexcept {
+#ifdef KV_CRC32C_X86
+  if (__builtin_cpu_supports("sse4.2")) {
+    return UpdateSse42;
+  }
+#endif
+  return UpdateScalar;
+}
+
+} // namespace <anonymous>
+
+uint32_t ComputeCrc32c(const void* data, size_t size, uint32_t crc) noexcept {
+  static const auto update = SelectUpdate();
+  return ~update(static_cast<const unsigned char *>(data), size, ~crc);
+}
+
+} // namespace kv
@@ -0,0 +1,76 @@
+#include "kv/Support/MappedFile.h"
+
+#include <cerrno>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "kv/Support/Defer.h"
+
+namespace kv {
+
+MappedFile::MappedFile(const char* path)
+  : _data(nullptr),
+    _size(0)
+{
+  auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::system_error { errno, std::generic_category(), path };
+  }
+  DEFER(1, ::close(fd));
+
+  struct stat st { };
+  if (::fstat(fd, &st) != 0) {
+    throw std::system_error { errno, std::generic_category(), path };
+  }
+
+  // Empty files cannot be mapped.
+  if (st.st_size == 0) {
+    return;
+  }
+
+  auto size = static_cast<size_t>(st.st_size);
+  auto ptr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (ptr == MAP_FAILED) {
+    throw std::system_error { errno, std::generic_category(), path };
+  }
+
+  _data = static_cast<const char *>(ptr);
+  _size = size;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+  : _data(other._data),
+    _size(other._size)
+{
+  other._data = nullptr;
+  other._size = 0;
+}
+
+MappedFile::~MappedFile() noexcept {
+  Unmap();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    Unmap();
+    _data = other._data;
+    _size = other._size;
+    other._data = nullptr;
+    other._size = 0;
+  }
+  return *this;
+}
+
+void MappedFile::Unmap() noexcept {
+  if (_data) {
+    ::munmap(const_cast<char *>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+  }
+}
+
+} // namespace kv
@@ -1,83 +1,205 @@
 #include "kv/Support/Memory.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
-#include <optional>
 
 #include "kv/Support/Defer.h"
 #include "kv/Support/Intrinsics.h"
+#include "kv/Support/Numa.h"
+
+#ifdef KV_ENABLE_ALLOCATOR_STATS
+#define ALLOCATOR_STAT(expr) (expr)
+#else
+#define ALLOCATOR_STAT(expr) ((void)0)
+#endif
 
 namespace kv {
 
-constexpr static const size_t NewChunkSize = 4096;
+/**
+ * @brief The granularity of chunk sizes. Every chunk starts at an address that is aligned to this value.
+ */
+constexpr static const size_t ChunkGranularity = 16;
+
+/**
+ * @brief The largest size and alignment of an allocation request, which keeps chunk sizes within 48 bits.
+ */
+constexpr static const size_t MaxAllocationSize = MaxSizeClassSize / 2;
+
+/**
+ * @brief The number of bits in a chunk header that hold the tag of the owning allocator.
+ */
+constexpr static const size_t AllocatorTagBits = 14;
+
+/**
+ * @brief The capacity of the allocator registry. Tag 0 is reserved for allocators that could not be registered.
+ */
+constexpr static const size_t MaxAllocatorTags = static_cast<size_t>(1) << AllocatorTagBits;
+
+namespace {
+
+[[nodiscard]]
+constexpr uintptr_t AlignUp(uintptr_t value, size_t alignment) noexcept {
+  return (value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+}
+
+} // namespace <anonymous>
+
+details::GlobalAllocatorStorage details::globalAllocatorStorage;
+
+namespace {
 
+// The first real tag is reserved for the global allocator, so the global allocator is registered without ever running
+// any code. The registry must be constant initialized: before a dynamic initializer ran, GetOwner would not find the
+// global allocator, and memory allocated from it would be released elsewhere. Declaring the entry constexpr makes the
+// build fail if it ever stops being a constant expression.
+constexpr static RawAllocator* const GlobalAllocatorEntry = GetGlobalAllocator();
+std::atomic<RawAllocator *> allocatorRegistry[MaxAllocatorTags] = { nullptr, GlobalAllocatorEntry };
+
+[[nodiscard]]
+uint16_t RegisterAllocator(RawAllocator* allocator) noexcept {
+  for (size_t tag = 2; tag < MaxAllocatorTags; ++tag) {
+    RawAllocator* expected = nullptr;
+    if (allocatorRegistry[tag].load(std::memory_order_relaxed) == nullptr &&
+        allocatorRegistry[tag].compare_exchange_strong(expected, allocator, std::memory_order_release)) {
+      return static_cast<uint16_t>(tag);
+    }
+  }
+  return 0;
+}
+
+void UnregisterAllocator(uint16_t tag) noexcept {
+  if (tag != 0) {
+    allocatorRegistry[tag].store(nullptr, std::memory_order_release);
+  }
+}
+
+} // namespace <anonymous>
+
+struct RawAllocator::Block {
+  Block* next;   // The next memory block owned by the same allocator
+  size_t size;   // The size of this memory block, including this header
+};
+
+/**
+ * @brief Header of a memory chunk.
+ *
+ * The header is stored immediately in front of the memory chunk handed out to the user, so the header of a chunk can
+ * be found from the user pointer in constant time. Chunks within a memory block are laid out back to back; the next
+ * chunk is found by adding the size of the chunk and the previous chunk is recorded explicitly, so merging does not
+ * depend on any list order. A free chunk additionally stores its free list links in the first bytes of its payload.
+ */
 struct RawAllocator::Chunk {
-  bool isFirst;  // Is this chunk the first chunk within a memory block that is allocated using `malloc`?
-  bool isFree;   // Is this chunk in free state?
-  size_t size;   // The size of this chunk
-  void* ptr;     // Pointer to the first byte of this memory chunk
+  constexpr static const size_t MinChunkSize = 32;
+
+  size_t size : 48;    // The size of this chunk, including this header
+  size_t isFree : 1;   // Is this chunk in free state?
+  size_t isLast : 1;   // Is this chunk the last chunk within its memory block?
+  size_t tag : AllocatorTagBits;  // Tag of the allocator that owns this chunk
+  Chunk* prev;         // The chunk that immediately precedes this chunk within the same memory block, or null
+
+  struct FreeLinks {
+    Chunk* prevFree;   // The previous chunk in the same free list
+    Chunk* nextFree;   // The next chunk in the same free list
+  };
+
+  [[nodiscard]]
+  static Chunk* FromPayload(const void* ptr) noexcept {
+    return reinterpret_cast<Chunk *>(reinterpret_cast<uintptr_t>(ptr) - sizeof(Chunk));
+  }
+
+  [[nodiscard]]
+  void* GetPayload() noexcept {
+    return reinterpret_cast<uint8_t *>(this) + sizeof(Chunk);
+  }
+
+  /**
+   * @brief Get the chunk that immediately follows this chunk within the same memory block.
+   *
+   * @return the next chunk, or null if this chunk is the last chunk within its memory block.
+   */
+  [[nodiscard]]
+  Chunk* GetNext() noexcept {
+    return isLast ? nullptr : reinterpret_cast<Chunk *>(reinterpret_cast<uint8_t *>(this) + size);
+  }
+
+  [[nodiscard]]
+  FreeLinks& GetFreeLinks() noexcept {
+    assert(isFree && "only free chunks have free list links");
+    return *reinterpret_cast<FreeLinks *>(GetPayload());
+  }
+
+  /**
+   * @brief Get the address of the first payload within this chunk that is aligned with respect to the specified
+   * alignment and leaves either no gap or a gap large enough for a free chunk at the beginning of this chunk.
+   *
+   * @param alignment the alignment.
+   *
+   * @return the address of the aligned payload.
+   */
+  [[nodiscard]]
+  uintptr_t GetAlignedPayload(size_t alignment) noexcept {
+    auto payload = reinterpret_cast<uintptr_t>(GetPayload());
+    auto aligned = AlignUp(payload, alignment);
+    if (aligned != payload && aligned - payload < MinChunkSize) {
+      aligned += alignment;
+    }
+    return aligned;
+  }
 
   /**
    * @brief Determine whether the specified memory allocation request can be satisfied with this chunk.
    *
-   * @param requestSize the size of the memory allocation request.
+   * @param chunkSize the size of the chunk required by the memory allocation request, including the chunk header.
    * @param alignment the alignment of the memory allocation request.
    *
    * @return whether the specified memory allocation request can be satisfied with this chunk.
    */
   [[nodiscard]]
-  bool CanFit(size_t requestSize, size_t alignment) const noexcept {
+  bool CanFit(size_t chunkSize, size_t alignment) noexcept {
     assert(isFree && "the chunk under examine should be in free state");
-    assert(requestSize > 0 && "size is out of range");
+    assert(chunkSize >= MinChunkSize && "size is out of range");
     assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment should be a power of 2");
 
-    auto basePtr = reinterpret_cast<uintptr_t>(ptr);
-    auto arithPtr = reinterpret_cast<uintptr_t>(ptr);
-    if (arithPtr & (alignment - 1)) {
-      // The chunk pointer is not aligned.
-      arithPtr += alignment - (arithPtr & (alignment - 1));
+    if (LIKELY(alignment <= ChunkGranularity)) {
+      return chunkSize <= size;
     }
 
-    arithPtr += requestSize;
-    return arithPtr - basePtr <= size;
+    auto gap = GetAlignedPayload(alignment) - reinterpret_cast<uintptr_t>(GetPayload());
+    return gap + chunkSize <= size;
   }
 
   /**
-   * @brief Split this chunk to get a new chunk whose base address is aligned with respect to the specified alignment.
+   * @brief Split this chunk to get a new chunk whose payload is aligned with respect to the specified alignment.
    *
-   * This function splits this chunk C into two sub-chunks C1 and C2 such that C = C1 + C2 and the alignment of C2 is
-   * at least `alignment`.
+   * This function splits this chunk C into two sub-chunks C1 and C2 such that C = C1 + C2 and the alignment of the
+   * payload of C2 is at least `alignment`.
    *
    * @param alignment the alignment.
    *
-   * @return If this chunk is already aligned, returns empty; otherwise returns the aligned chunk. In the latter case,
-   * the `size` field of this chunk will be truncated to the distance between the base of this chunk and the base of the
-   * aligned chunk.
+   * @return If the payload of this chunk is already aligned, returns null; otherwise returns the aligned chunk. In the
+   * latter case, the `size` field of this chunk will be truncated to the distance between the base of this chunk and
+   * the base of the aligned chunk.
    */
   [[nodiscard]]
-  std::optional<Chunk> SplitAlignment(size_t alignment) noexcept {
+  Chunk* SplitAlignment(size_t alignment) noexcept {
     assert(isFree && "the splitting chunk must be in free state");
     assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment should be a power of 2");
 
-    auto arithPtr = reinterpret_cast<uintptr_t>(ptr);
-    if (LIKELY((arithPtr & (alignment - 1)) == 0)) {
-      return std::nullopt;
+    if (LIKELY(alignment <= ChunkGranularity)) {
+      return nullptr;
     }
 
-    auto alignedArithPtr = arithPtr + (alignment - (arithPtr & (alignment - 1)));
-    assert(alignedArithPtr <= arithPtr + size && "the pointer is out of bound after alignment");
-
-    Chunk alignedChunk{};
-    alignedChunk.isFirst = false;
-    alignedChunk.isFree = true;
-    alignedChunk.size = size - (alignedArithPtr - arithPtr);
-    alignedChunk.ptr = reinterpret_cast<void *>(alignedArithPtr);
-
-    size = alignedArithPtr - arithPtr;
+    auto gap = GetAlignedPayload(alignment) - reinterpret_cast<uintptr_t>(GetPayload());
+    if (gap == 0) {
+      return nullptr;
+    }
 
-    return alignedChunk;
+    assert(gap < size && "the pointer is out of bound after alignment");
+    return SplitAt(gap);
   }
 
   /**
@@ -88,34 +210,27 @@ struct RawAllocator::Chunk {
    *
    * @param splitSize the size of the split chunk. This argument should be less than or equal to the size of this chunk.
    *
-   * @return If splitSize is equal to the size of this chunk, then this function returns empty; otherwise this function
-   * returns the chunk C2 mentioned above. In the latter case, the size field of this chunk will be set to splitSize.
+   * @return If the rest of this chunk is too small to form a chunk, then this function returns null; otherwise this
+   * function returns the chunk C2 mentioned above. In the latter case, the size field of this chunk will be set to
+   * splitSize.
    */
   [[nodiscard]]
-  std::optional<Chunk> SplitSize(size_t splitSize) noexcept {
+  Chunk* SplitSize(size_t splitSize) noexcept {
     assert(isFree && "the splitting chunk must be in free state");
-    assert(splitSize > 0 && splitSize <= size && "splitSize is out of range");
+    assert(splitSize >= MinChunkSize && splitSize <= size && "splitSize is out of range");
 
-    if (splitSize == size) {
-      return std::nullopt;
+    if (size - splitSize < MinChunkSize) {
+      return nullptr;
     }
 
-    Chunk rest{};
-    rest.isFirst = false;
-    rest.isFree = true;
-    rest.size = size - splitSize;
-    rest.ptr = reinterpret_cast<uint8_t *>(ptr) + splitSize;
-
-    size = splitSize;
-    return rest;
+    return SplitAt(splitSize);
   }
 
   /**
    * @brief Try to merge the specified chunk into this chunk.
    *
-   * The specified chunk can be merged into this chunk only if the following conditions hold:
-   * * another.ptr > this->ptr
-   * * this->ptr + this->size == another.ptr
+   * The specified chunk can be merged into this chunk only if both chunks are free and the specified chunk immediately
+   * follows this chunk within the same memory block.
    *
    * @param another another chunk to merge.
    * @return whether the merge is successful or not.
@@ -123,105 +238,389 @@ struct RawAllocator::Chunk {
   bool Merge(Chunk& another) noexcept {
     assert(isFree && another.isFree && "the merging chunks should be in free state");
 
-    if (another.isFirst) {
+    if (GetNext() != &another) {
       return false;
     }
 
-    if (another.ptr < ptr) {
-      return false;
+    size += another.size;
+    isLast = another.isLast;
+    if (auto next = GetNext()) {
+      next->prev = this;
     }
 
-    auto arithPtr = reinterpret_cast<uintptr_t>(ptr);
-    if (arithPtr + size != reinterpret_cast<uintptr_t>(another.ptr)) {
-      return false;
+    return true;
+  }
+
+private:
+  Chunk* SplitAt(size_t offset) noexcept {
+    auto rest = reinterpret_cast<Chunk *>(reinterpret_cast<uint8_t *>(this) + offset);
+    rest->size = size - offset;
+    rest->isFree = true;
+    rest->isLast = isLast;
+    rest->tag = tag;
+    rest->prev = this;
+    if (auto next = rest->GetNext()) {
+      next->prev = rest;
     }
 
-    size += another.size;
-    return true;
+    size = offset;
+    isLast = false;
+    return rest;
   }
 };
 
-RawAllocator::RawAllocator() noexcept = default;
+RawAllocatorStats& RawAllocatorStats::operator+=(const RawAllocatorStats& rhs) noexcept {
+  blockCount += rhs.blockCount;
+  reservedBytes += rhs.reservedBytes;
+  chunkCount += rhs.chunkCount;
+  freeChunkCount += rhs.freeChunkCount;
+  freeBytes += rhs.freeBytes;
+  largestFreeChunkSize = std::max(largestFreeChunkSize, rhs.largestFreeChunkSize);
+  for (size_t sizeClass = 0; sizeClass < SizeClassCount; ++sizeClass) {
+    allocations[sizeClass] += rhs.allocations[sizeClass];
+    releases[sizeClass] += rhs.releases[sizeClass];
+  }
+  splits += rhs.splits;
+  merges += rhs.merges;
+  lockAcquisitions += rhs.lockAcquisitions;
+  lockContentions += rhs.lockContentions;
+  lockWaitNanoseconds += rhs.lockWaitNanoseconds;
+  return *this;
+}
+
+RawAllocator::RawAllocator() noexcept
+  : RawAllocator(RawAllocatorOptions { })
+{ }
+
+RawAllocator::RawAllocator(const RawAllocatorOptions& options) noexcept
+  : _options(options),
+    _store(options.backingStore),
+    _tag(RegisterAllocator(this)),
+    _blocks(nullptr),
+    _nextBlockSize(options.blockSize),
+    _bins(),
+    _binMask()
+#ifdef KV_ENABLE_ALLOCATOR_STATS
+    , _stats()
+#endif
+{
+  if (!_store) {
+    _store = options.numaNode ? GetNodeBackingStore(options.numaNode.value()) : GetMallocBackingStore();
+  }
+
+  static_assert(sizeof(Chunk) == ChunkGranularity, "chunk headers should not break chunk granularity");
+  static_assert(sizeof(Block) % ChunkGranularity == 0, "block headers should not break chunk granularity");
+  static_assert(sizeof(Chunk) + sizeof(Chunk::FreeLinks) <= Chunk::MinChunkSize,
+      "free chunks should be able to hold their free list links");
+}
 
 RawAllocator::~RawAllocator() noexcept {
-  // Free all allocated chunks.
-  for (const auto& chunk : _chunks) {
-    if (chunk.isFirst) {
-      ::free(chunk.ptr);
-    }
+  UnregisterAllocator(_tag);
+
+  // Free all allocated memory blocks.
+  auto block = _blocks;
+  while (block) {
+    auto next = block->next;
+    ReleaseBlock(block);
+    block = next;
   }
-  _chunks.clear();
+
+  _blocks = nullptr;
 }
 
 void* RawAllocator::Allocate(size_t size, size_t alignment) {
   assert(size > 0 && "size should be a positive value");
   assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment should be a power of 2");
 
-  _mutex.lock();
+  if (UNLIKELY(size > MaxAllocationSize || alignment > MaxAllocationSize)) {
+    throw std::bad_alloc();
+  }
+
+  Lock();
+  DEFER(1, _mutex.unlock());
+
+  return AllocateLocked(size, alignment);
+}
+
+size_t RawAllocator::AllocateBatch(size_t size, size_t alignment, void** ptrs, size_t count) {
+  assert(size > 0 && "size should be a positive value");
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment should be a power of 2");
+
+  if (UNLIKELY(size > MaxAllocationSize || alignment > MaxAllocationSize)) {
+    throw std::bad_alloc();
+  }
+
+  Lock();
+  DEFER(1, _mutex.unlock());
+
+  for (size_t i = 0; i < count; ++i) {
+    try {
+      ptrs[i] = AllocateLocked(size, alignment);
+    } catch (const std::bad_alloc &) {
+      if (i == 0) {
+        throw;
+      }
+      return i;
+    }
+  }
+
+  return count;
+}
+
+void RawAllocator::Release(void *ptr) noexcept {
+  if (UNLIKELY(!ptr)) {
+    return;
+  }
+
+  Lock();
   DEFER(1, _mutex.unlock());
 
-  // Scan existing chunks for any suitable chunk.
-  auto it = std::find_if(_chunks.begin(), _chunks.end(), [size, alignment](const Chunk& chunk) noexcept {
-    return chunk.isFree && chunk.CanFit(size, alignment);
-  });
+  ReleaseLocked(ptr);
+}
+
+void RawAllocator::ReleaseBatch(void* const* ptrs, size_t count) noexcept {
+  Lock();
+  DEFER(1, _mutex.unlock());
 
-  if (it == _chunks.end()) {
-    // No suitable chunk found. Allocate a new chunk to meet the request.
-    Chunk chunk{};
-    chunk.isFirst = true;
-    chunk.isFree = true;
-    chunk.size = std::max(size + alignment, NewChunkSize);
-    chunk.ptr = ::malloc(chunk.size);
-    if (!chunk.ptr) {
-      throw std::bad_alloc();
+  for (size_t i = 0; i < count; ++i) {
+    if (LIKELY(ptrs[i])) {
+      ReleaseLocked(ptrs[i]);
     }
+  }
+}
 
-    it = _chunks.insert(_chunks.begin(), chunk);
+size_t RawAllocator::GetUsableSize(const void* ptr) noexcept {
+  return Chunk::FromPayload(ptr)->size - sizeof(Chunk);
+}
+
+RawAllocator* RawAllocator::GetOwner(const void* ptr) noexcept {
+  return allocatorRegistry[Chunk::FromPayload(ptr)->tag].load(std::memory_order_acquire);
+}
+
+uint16_t RawAllocator::GetOwnerTag(const void* ptr) noexcept {
+  return static_cast<uint16_t>(Chunk::FromPayload(ptr)->tag);
+}
+
+RawAllocatorStats RawAllocator::GetStats() noexcept {
+  Lock();
+  DEFER(1, _mutex.unlock());
+
+#ifdef KV_ENABLE_ALLOCATOR_STATS
+  auto stats = _stats;
+#else
+  RawAllocatorStats stats;
+#endif
+
+  for (auto block = _blocks; block; block = block->next) {
+    ++stats.blockCount;
+    stats.reservedBytes += block->size;
+
+    for (auto chunk = reinterpret_cast<Chunk *>(block + 1); chunk; chunk = chunk->GetNext()) {
+      ++stats.chunkCount;
+      if (chunk->isFree) {
+        ++stats.freeChunkCount;
+        stats.freeBytes += chunk->size;
+        stats.largestFreeChunkSize = std::max(stats.largestFreeChunkSize, static_cast<size_t>(chunk->size));
+      }
+    }
   }
 
-  auto alignedChunk = it->SplitAlignment(alignment);
+  return stats;
+}
+
+void RawAllocator::Lock() noexcept {
+#ifdef KV_ENABLE_ALLOCATOR_STATS
+  if (UNLIKELY(!_mutex.try_lock())) {
+    auto start = std::chrono::steady_clock::now();
+    _mutex.lock();
+    auto wait = std::chrono::steady_clock::now() - start;
+    ++_stats.lockContentions;
+    _stats.lockWaitNanoseconds += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count());
+  }
+  ++_stats.lockAcquisitions;
+#else
+  _mutex.lock();
+#endif
+}
+
+void* RawAllocator::AllocateLocked(size_t size, size_t alignment) {
+  auto chunkSize = std::max(static_cast<size_t>(AlignUp(size, ChunkGranularity)) + sizeof(Chunk),
+                            Chunk::MinChunkSize);
+
+  auto chunk = FindFreeChunk(chunkSize, alignment);
+  if (chunk) {
+    RemoveFreeChunk(chunk);
+  } else {
+    // No suitable chunk found. Allocate a new memory block to meet the request.
+    auto alignmentSlack = alignment > ChunkGranularity ? alignment + Chunk::MinChunkSize : 0;
+    auto block = AllocateBlock(sizeof(Block) + chunkSize + alignmentSlack);
+
+    chunk = reinterpret_cast<Chunk *>(block + 1);
+    chunk->size = (block->size - sizeof(Block)) & ~(ChunkGranularity - 1);
+    chunk->isFree = true;
+    chunk->isLast = true;
+    chunk->tag = _tag;
+    chunk->prev = nullptr;
+  }
+
+  auto alignedChunk = chunk->SplitAlignment(alignment);
   if (alignedChunk) {
-    it = _chunks.insert(std::next(it), alignedChunk.value());
+    // The leading part of the chunk stays free.
+    InsertFreeChunk(chunk);
+    chunk = alignedChunk;
+    ALLOCATOR_STAT(++_stats.splits);
   }
 
-  auto restChunk = it->SplitSize(size);
+  auto restChunk = chunk->SplitSize(chunkSize);
   if (restChunk) {
-    _chunks.insert(std::next(it), restChunk.value());
+    InsertFreeChunk(restChunk);
+    ALLOCATOR_STAT(++_stats.splits);
   }
 
-  it->isFree = false;
-  return it->ptr;
+  chunk->isFree = false;
+  ALLOCATOR_STAT(++_stats.allocations[SizeToFloorClass(chunk->size - sizeof(Chunk))]);
+  return chunk->GetPayload();
 }
 
-void RawAllocator::Release(void *ptr) noexcept {
-  _mutex.lock();
-  DEFER(1, _mutex.unlock());
+void RawAllocator::ReleaseLocked(void* ptr) noexcept {
+  auto chunk = Chunk::FromPayload(ptr);
+  if (UNLIKELY(chunk->isFree)) {
+    // Double free.
+    return;
+  }
 
-  auto it = std::find_if(_chunks.begin(), _chunks.end(), [ptr](const Chunk& chunk) noexcept {
-    return !chunk.isFree && chunk.ptr == ptr;
-  });
+  chunk->isFree = true;
+  ALLOCATOR_STAT(++_stats.releases[SizeToFloorClass(chunk->size - sizeof(Chunk))]);
 
-  if (UNLIKELY(it == _chunks.end())) {
-    return;
+  // Try to merge with the previous chunk. The previous chunk must leave its free list before its size changes.
+  auto pv = chunk->prev;
+  if (pv && pv->isFree) {
+    RemoveFreeChunk(pv);
+    pv->Merge(*chunk);
+    chunk = pv;
+    ALLOCATOR_STAT(++_stats.merges);
+  }
+
+  // Try to merge with the next chunk
+  auto nx = chunk->GetNext();
+  if (nx && nx->isFree) {
+    RemoveFreeChunk(nx);
+    chunk->Merge(*nx);
+    ALLOCATOR_STAT(++_stats.merges);
+  }
+
+  InsertFreeChunk(chunk);
+
+  if (_options.purgeIdleBlocks && !chunk->prev && chunk->isLast) {
+    // The whole memory block is free now.
+    PurgeBlock(reinterpret_cast<Block *>(chunk) - 1);
+  }
+}
+
+RawAllocator::Block* RawAllocator::AllocateBlock(size_t minSize) {
+  if (UNLIKELY(!_store)) {
+    // The global allocator is constant initialized and picks up its backing store upon the first memory block.
+    _store = GetMallocBackingStore();
+  }
+
+  auto granularity = _store->GetGranularity();
+  auto blockSize = AlignUp(std::max(minSize, _nextBlockSize), std::max(granularity, ChunkGranularity));
+
+  auto block = reinterpret_cast<Block *>(_store->Map(blockSize));
+  assert((reinterpret_cast<uintptr_t>(block) & (ChunkGranularity - 1)) == 0 && "memory blocks should be aligned");
+
+  block->next = _blocks;
+  block->size = blockSize;
+  _blocks = block;
+
+  if (_options.blockGrowthFactor > 1 && _nextBlockSize < _options.maxBlockSize) {
+    _nextBlockSize = std::min(_nextBlockSize * _options.blockGrowthFactor, _options.maxBlockSize);
   }
 
-  it->isFree = true;
+  return block;
+}
+
+void RawAllocator::ReleaseBlock(Block* block) noexcept {
+  _store->Unmap(block, block->size);
+}
 
-  // Try to merge with the previous chunk
-  if (it != _chunks.begin()) {
-    auto pv = std::prev(it);
-    if (pv->isFree && pv->Merge(*it)) {
-      _chunks.erase(it);
-      it = pv;
+void RawAllocator::PurgeBlock(Block* block) noexcept {
+  // The block header, the chunk header and the free list links of the only chunk in the block must survive.
+  auto chunk = reinterpret_cast<Chunk *>(block + 1);
+  assert(chunk->isFree && chunk->isLast && "only idle blocks can be purged");
+
+  auto keep = reinterpret_cast<uint8_t *>(chunk->GetPayload()) + sizeof(Chunk::FreeLinks);
+  auto end = reinterpret_cast<uint8_t *>(block) + block->size;
+  _store->Purge(keep, static_cast<size_t>(end - keep));
+}
+
+void RawAllocator::Trim() noexcept {
+  Lock();
+  DEFER(1, _mutex.unlock());
+
+  for (auto block = _blocks; block; block = block->next) {
+    auto chunk = reinterpret_cast<Chunk *>(block + 1);
+    if (chunk->isFree && chunk->isLast) {
+      PurgeBlock(block);
     }
   }
+}
 
-  // Try to merge with the next chunk
-  auto nx = std::next(it);
-  if (nx != _chunks.end()) {
-    if (nx->isFree && it->Merge(*nx)) {
-      _chunks.erase(nx);
+RawAllocator::Chunk* RawAllocator::FindFreeChunk(size_t chunkSize, size_t alignment) const noexcept {
+  // Chunks in the bin of the request's floor size class may or may not be large enough, so they are examined one by
+  // one. Chunks in any higher bin are at least as large as the request and only the alignment can fail.
+  auto bin = SizeToFloorClass(chunkSize);
+  auto word = bin / BinMaskBits;
+  auto mask = _binMask[word] & (~static_cast<uint64_t>(0) << (bin % BinMaskBits));
+
+  while (true) {
+    while (mask == 0) {
+      if (++word == BinMaskWords) {
+        return nullptr;
+      }
+      mask = _binMask[word];
     }
+
+    bin = word * BinMaskBits + static_cast<size_t>(__builtin_ctzll(mask));
+    for (auto chunk = _bins[bin]; chunk; chunk = chunk->GetFreeLinks().nextFree) {
+      if (chunk->CanFit(chunkSize, alignment)) {
+        return chunk;
+      }
+    }
+
+    mask &= mask - 1;
+  }
+}
+
+void RawAllocator::InsertFreeChunk(Chunk* chunk) noexcept {
+  assert(chunk->isFree && "only free chunks can be inserted into free lists");
+
+  auto bin = SizeToFloorClass(chunk->size);
+  auto& links = chunk->GetFreeLinks();
+  links.prevFree = nullptr;
+  links.nextFree = _bins[bin];
+  if (_bins[bin]) {
+    _bins[bin]->GetFreeLinks().prevFree = chunk;
+  }
+  _bins[bin] = chunk;
+  _binMask[bin / BinMaskBits] |= static_cast<uint64_t>(1) << (bin % BinMaskBits);
+}
+
+void RawAllocator::RemoveFreeChunk(Chunk* chunk) noexcept {
+  auto bin = SizeToFloorClass(chunk->size);
+  auto& links = chunk->GetFreeLinks();
+  if (links.prevFree) {
+    links.prevFree->GetFreeLinks().nextFree = links.nextFree;
+  } else {
+    assert(_bins[bin] == chunk && "the chunk is not in the free list of its size class");
+    _bins[bin] = links.nextFree;
+    if (!_bins[bin]) {
+      _binMask[bin / BinMaskBits] &= ~(static_cast<uint64_t>(1) << (bin % BinMaskBits));
+    }
+  }
+  if (links.nextFree) {
+    links.nextFree->GetFreeLinks().prevFree = links.prevFree;
   }
 }
 
@@ -1,46 +1,243 @@
 #include "kv/Support/Memory.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
+#include <cstring>
 #include <mutex>
 
 #include "kv/Support/Intrinsics.h"
 #include "kv/Support/Defer.h"
+#include "kv/Support/Numa.h"
+#include "kv/Support/ThreadCache.h"
 
 namespace kv {
 
-static RawAllocator* globalAllocator;
-static std::mutex globalAllocatorLock;
+namespace {
 
-RawAllocator* GetGlobalAllocator() noexcept {
-  if (UNLIKELY(!globalAllocator)) {
-    globalAllocatorLock.lock();
-    DEFER(1, globalAllocatorLock.unlock());
+/**
+ * @brief The value of globalAllocatorMode before the initial mode is read from the environment.
+ */
+constexpr static const int UnresolvedAllocatorMode = -1;
 
-    if (!globalAllocator) {
-      // Note that we CANNOT simply use `new RawAllocator()` to allocate a RawAllocator object since this will cause
-      // a infinite recurse. Instead, use malloc + placement new to manually construct a RawAllocator object.
-      globalAllocator = reinterpret_cast<RawAllocator *>(::malloc(sizeof(RawAllocator)));
-      ::new (globalAllocator) RawAllocator();
+// Constant initialized, so reading the mode on the allocation path involves no initialization guard.
+std::atomic<int> globalAllocatorMode { UnresolvedAllocatorMode };
+
+[[nodiscard]]
+GlobalAllocatorMode GetInitialGlobalAllocatorMode() noexcept {
+  auto mode = ::getenv("MAB_ALLOCATOR_MODE");
+  return mode && std::strcmp(mode, "per-node") == 0 ? GlobalAllocatorMode::PerNode : GlobalAllocatorMode::Shared;
+}
+
+alignas(RawAllocator) unsigned char nodeAllocatorStorage[NumaTopology::MaxNodes][sizeof(RawAllocator)];
+std::atomic<RawAllocator *> nodeAllocators[NumaTopology::MaxNodes];
+std::mutex nodeAllocatorLock;
+
+} // namespace <anonymous>
+
+GlobalAllocatorMode GetGlobalAllocatorMode() noexcept {
+  auto mode = globalAllocatorMode.load(std::memory_order_relaxed);
+  if (UNLIKELY(mode == UnresolvedAllocatorMode)) {
+    // Racing threads read the same environment, so whichever store wins is the same value unless the mode has been
+    // set explicitly in the meantime, which then takes precedence.
+    auto expected = UnresolvedAllocatorMode;
+    globalAllocatorMode.compare_exchange_strong(expected, static_cast<int>(GetInitialGlobalAllocatorMode()),
+                                                std::memory_order_relaxed);
+    mode = globalAllocatorMode.load(std::memory_order_relaxed);
+  }
+  return static_cast<GlobalAllocatorMode>(mode);
+}
+
+void SetGlobalAllocatorMode(GlobalAllocatorMode mode) noexcept {
+  globalAllocatorMode.store(static_cast<int>(mode), std::memory_order_relaxed);
+}
+
+RawAllocator* GetNodeAllocator(size_t node) noexcept {
+  if (UNLIKELY(!NumaTopology::Get().IsNodeOnline(node))) {
+    return GetGlobalAllocator();
+  }
+
+  auto allocator = nodeAllocators[node].load(std::memory_order_acquire);
+  if (UNLIKELY(!allocator)) {
+    nodeAllocatorLock.lock();
+    DEFER(1, nodeAllocatorLock.unlock());
+
+    allocator = nodeAllocators[node].load(std::memory_order_relaxed);
+    if (!allocator) {
+      // Node arenas live as long as the process, so they are constructed in static storage and never destroyed.
+      RawAllocatorOptions options;
+      options.numaNode = node;
+      options.blockSize = static_cast<size_t>(1) << 20;
+      options.blockGrowthFactor = 2;
+      options.maxBlockSize = static_cast<size_t>(1) << 26;
+      allocator = ::new (nodeAllocatorStorage[node]) RawAllocator(options);
+      nodeAllocators[node].store(allocator, std::memory_order_release);
     }
   }
 
-  return globalAllocator;
+  return allocator;
+}
+
+RawAllocator* GetLocalAllocator() noexcept {
+  if (LIKELY(GetGlobalAllocatorMode() == GlobalAllocatorMode::Shared)) {
+    return GetGlobalAllocator();
+  }
+  return GetNodeAllocator(NumaTopology::GetCurrentNode());
+}
+
+RawAllocatorStats GetGlobalAllocatorStats() noexcept {
+  auto stats = GetGlobalAllocator()->GetStats();
+  for (const auto& allocator : nodeAllocators) {
+    if (auto node = allocator.load(std::memory_order_acquire)) {
+      stats += node->GetStats();
+    }
+  }
+  return stats;
 }
 
 } // namespace kv
 
+namespace {
+
+[[nodiscard]]
+void* AllocateGlobal(size_t count) {
+  // Zero-sized allocations still return distinct pointers.
+  count = std::max(count, static_cast<size_t>(1));
+  if (auto cache = kv::ThreadCache::GetCurrent()) {
+    return cache->Allocate(count);
+  }
+
+  // Round small requests up to their size class, like the caches do, so that sized deletes can put the chunks into
+  // the magazine of their size class.
+  if (count <= kv::ThreadCache::MaxCachedSize) {
+    count = kv::ClassToSize(kv::SizeToClass(count));
+  }
+  return kv::GetLocalAllocator()->Allocate(count);
+}
+
+[[nodiscard]]
+void* AllocateGlobal(size_t count, std::align_val_t alignment) {
+  return kv::GetLocalAllocator()->Allocate(std::max(count, static_cast<size_t>(1)), static_cast<size_t>(alignment));
+}
+
+void ReleaseGlobal(void* ptr) noexcept {
+  if (UNLIKELY(!ptr)) {
+    return;
+  }
+
+  if (auto cache = kv::ThreadCache::GetCurrent()) {
+    cache->Release(ptr);
+  } else if (auto owner = kv::RawAllocator::GetOwner(ptr)) {
+    owner->Release(ptr);
+  } else {
+    kv::GetGlobalAllocator()->Release(ptr);
+  }
+}
+
+void ReleaseGlobal(void* ptr, size_t count) noexcept {
+  if (auto cache = kv::ThreadCache::GetCurrent()) {
+    cache->Release(ptr, count);
+  } else {
+    ReleaseGlobal(ptr);
+  }
+}
+
+} // namespace <anonymous>
+
 void* operator new(size_t count) {
-  return kv::GetGlobalAllocator()->Allocate(count);
+  return AllocateGlobal(count);
+}
+
+void* operator new[](size_t count) {
+  return AllocateGlobal(count);
+}
+
+void* operator new(size_t count, const std::nothrow_t &) noexcept {
+  try {
+    return AllocateGlobal(count);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+void* operator new[](size_t count, const std::nothrow_t &) noexcept {
+  try {
+    return AllocateGlobal(count);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
 }
 
 void* operator new(size_t count, std::align_val_t alignment) {
-  return kv::GetGlobalAllocator()->Allocate(count, static_cast<size_t>(alignment));
+  return AllocateGlobal(count, alignment);
+}
+
+void* operator new[](size_t count, std::align_val_t alignment) {
+  return AllocateGlobal(count, alignment);
+}
+
+void* operator new(size_t count, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  try {
+    return AllocateGlobal(count, alignment);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+void* operator new[](size_t count, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+  try {
+    return AllocateGlobal(count, alignment);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
 }
 
 void operator delete(void* ptr) noexcept {
-  kv::GetGlobalAllocator()->Release(ptr);
+  ReleaseGlobal(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  ReleaseGlobal(ptr);
 }
 
+void operator delete(void* ptr, const std::nothrow_t &) noexcept {
+  ReleaseGlobal(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t &) noexcept {
+  ReleaseGlobal(ptr);
+}
+
+void operator delete(void* ptr, size_t count) noexcept {
+  ReleaseGlobal(ptr, count);
+}
+
+void operator delete[](void* ptr, size_t count) noexcept {
+  ReleaseGlobal(ptr, count);
+}
+
+// Aligned chunks are not rounded up to size classes, so aligned deletes never take the sized path.
+
 void operator delete(void* ptr, std::align_val_t) noexcept {
-  operator delete(ptr);
+  ReleaseGlobal(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+  ReleaseGlobal(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  ReleaseGlobal(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t &) noexcept {
+  ReleaseGlobal(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+  ReleaseGlobal(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+  ReleaseGlobal(ptr);
 }
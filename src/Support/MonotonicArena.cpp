@@ -0,0 +1,106 @@
+#include "kv/Support/MonotonicArena.h"
+
+#include <algorithm>
+#include <limits>
+#include <new>
+
+namespace kv {
+
+namespace {
+
+constexpr static const size_t MinBlockSize = 256;
+
+} // namespace <anonymous>
+
+struct MonotonicArena::Block {
+  Block* next;
+  size_t size;
+
+  [[nodiscard]]
+  uintptr_t GetBegin() const noexcept {
+    return reinterpret_cast<uintptr_t>(this) + sizeof(Block);
+  }
+
+  [[nodiscard]]
+  uintptr_t GetEnd() const noexcept {
+    return reinterpret_cast<uintptr_t>(this) + size;
+  }
+};
+
+MonotonicArena::MonotonicArena(size_t blockSize) noexcept
+  : MonotonicArena(*GetGlobalAllocator(), blockSize)
+{ }
+
+MonotonicArena::MonotonicArena(MemoryResource& upstream, size_t blockSize) noexcept
+  : _upstream(&upstream),
+    _cursor(0),
+    _end(0),
+    _blocks(nullptr),
+    _largeBlocks(nullptr),
+    _nextBlockSize(std::clamp(blockSize, MinBlockSize, MaxBlockSize)),
+    _reservedSize(0)
+{ }
+
+MonotonicArena::~MonotonicArena() noexcept {
+  ReleaseBlocks(_blocks);
+  ReleaseBlocks(_largeBlocks);
+}
+
+void MonotonicArena::Reset() noexcept {
+  ReleaseBlocks(_largeBlocks);
+  _largeBlocks = nullptr;
+
+  if (_blocks) {
+    ReleaseBlocks(_blocks->next);
+    _blocks->next = nullptr;
+    _reservedSize = _blocks->size;
+    _cursor = _blocks->GetBegin();
+    _end = _blocks->GetEnd();
+  } else {
+    _reservedSize = 0;
+  }
+}
+
+void* MonotonicArena::AllocateSlow(size_t size, size_t alignment) {
+  if (UNLIKELY(size > std::numeric_limits<size_t>::max() - sizeof(Block) - alignment)) {
+    throw std::bad_alloc();
+  }
+
+  auto required = sizeof(Block) + size + (alignment > alignof(Block) ? alignment : 0);
+  if (required > _nextBlockSize / 4) {
+    // Serving a large request from a dedicated block avoids wasting the tail of the current block.
+    auto block = AllocateBlock(required);
+    block->next = _largeBlocks;
+    _largeBlocks = block;
+    return reinterpret_cast<void *>((block->GetBegin() + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+  }
+
+  auto block = AllocateBlock(_nextBlockSize);
+  block->next = _blocks;
+  _blocks = block;
+  _nextBlockSize = std::min(_nextBlockSize * 2, MaxBlockSize);
+
+  auto aligned = (block->GetBegin() + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+  _cursor = aligned + size;
+  _end = block->GetEnd();
+  return reinterpret_cast<void *>(aligned);
+}
+
+MonotonicArena::Block* MonotonicArena::AllocateBlock(size_t size) {
+  auto block = static_cast<Block *>(_upstream->Allocate(size, alignof(Block)));
+  block->next = nullptr;
+  block->size = size;
+  _reservedSize += size;
+  return block;
+}
+
+void MonotonicArena::ReleaseBlocks(Block* blocks) noexcept {
+  while (blocks) {
+    auto next = blocks->next;
+    _reservedSize -= blocks->size;
+    _upstream->Release(blocks);
+    blocks = next;
+  }
+}
+
+} // namespace kv
@@ -0,0 +1,207 @@
+#include "kv/Support/Numa.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace kv {
+
+namespace {
+
+constexpr static const int MemoryPolicyBind = 2;  // MPOL_BIND in <linux/mempolicy.h>
+
+/**
+ * @brief Read the content of a small sysfs file into the specified buffer as a null-terminated string.
+ *
+ * @return whether the file is read.
+ */
+bool ReadSysFile(const char* path, char* buffer, size_t bufferSize) noexcept {
+  auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  size_t length = 0;
+  while (length + 1 < bufferSize) {
+    auto n = ::read(fd, buffer + length, bufferSize - length - 1);
+    if (n <= 0) {
+      break;
+    }
+    length += static_cast<size_t>(n);
+  }
+
+  ::close(fd);
+  buffer[length] = '\0';
+  return length > 0;
+}
+
+/**
+ * @brief Parse a list of ranges in the kernel's list format, e.g. `0-3,8,10-11`, and invoke the specified function
+ * for every value in the list.
+ */
+template <typename F>
+void ParseRangeList(const char* text, F&& func) noexcept {
+  while (*text) {
+    char* end;
+    auto first = std::strtoul(text, &end, 10);
+    if (end == text) {
+      break;
+    }
+
+    auto last = first;
+    text = end;
+    if (*text == '-') {
+      last = std::strtoul(text + 1, &end, 10);
+      text = end;
+    }
+
+    for (auto value = first; value <= last; ++value) {
+      func(static_cast<size_t>(value));
+    }
+
+    if (*text != ',') {
+      break;
+    }
+    ++text;
+  }
+}
+
+} // namespace <anonymous>
+
+NumaTopology::NumaTopology() noexcept
+  : _nodeCount(0),
+    _cpuCount(0),
+    _online(),
+    _nodeCpus(),
+    _cpuNodes(),
+    _distances()
+{
+  char buffer[4096];
+  if (ReadSysFile("/sys/devices/system/node/online", buffer, sizeof(buffer))) {
+    ParseRangeList(buffer, [this](size_t node) noexcept {
+      if (node < MaxNodes) {
+        _online[node] = true;
+        _nodeCount = std::max(_nodeCount, node + 1);
+      }
+    });
+  }
+
+  if (_nodeCount == 0) {
+    // No NUMA support. Treat the machine as a single node that owns all CPUs.
+    _nodeCount = 1;
+    _online[0] = true;
+    auto cpus = ::sysconf(_SC_NPROCESSORS_CONF);
+    _cpuCount = std::min(static_cast<size_t>(cpus > 0 ? cpus : 1), MaxCpus);
+    for (size_t cpu = 0; cpu < _cpuCount; ++cpu) {
+      _nodeCpus[0][cpu] = true;
+    }
+    _distances[0][0] = 10;
+    return;
+  }
+
+  for (size_t node = 0; node < _nodeCount; ++node) {
+    if (!_online[node]) {
+      continue;
+    }
+
+    char path[128];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%zu/cpulist", node);
+    if (ReadSysFile(path, buffer, sizeof(buffer))) {
+      ParseRangeList(buffer, [this, node](size_t cpu) noexcept {
+        if (cpu < MaxCpus) {
+          _nodeCpus[node][cpu] = true;
+          _cpuNodes[cpu] = static_cast<uint8_t>(node);
+          _cpuCount = std::max(_cpuCount, cpu + 1);
+        }
+      });
+    }
+
+    for (size_t to = 0; to < _nodeCount; ++to) {
+      _distances[node][to] = node == to ? 10 : 20;
+    }
+
+    std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%zu/distance", node);
+    if (ReadSysFile(path, buffer, sizeof(buffer))) {
+      // The distance file lists the distances to all online nodes in order of their IDs.
+      auto text = static_cast<const char *>(buffer);
+      for (size_t to = 0; to < _nodeCount; ++to) {
+        if (!_online[to]) {
+          continue;
+        }
+
+        char* end;
+        auto distance = std::strtoul(text, &end, 10);
+        if (end == text) {
+          break;
+        }
+        _distances[node][to] = static_cast<uint32_t>(distance);
+        text = end;
+      }
+    }
+  }
+}
+
+const NumaTopology& NumaTopology::Get() noexcept {
+  static const NumaTopology topology;
+  return topology;
+}
+
+size_t NumaTopology::GetCurrentNode() noexcept {
+  const auto& topology = Get();
+  if (topology.GetNodeCount() == 1) {
+    return 0;
+  }
+
+  auto cpu = ::sched_getcpu();
+  return cpu < 0 ? 0 : topology.GetNodeOfCpu(static_cast<size_t>(cpu));
+}
+
+bool BindMemoryToNumaNode(void* ptr, size_t size, size_t node) noexcept {
+  if (node >= NumaTopology::MaxNodes) {
+    return false;
+  }
+
+  constexpr size_t maskBits = sizeof(unsigned long) * 8;
+  unsigned long nodeMask[NumaTopology::MaxNodes / maskBits] = { };
+  nodeMask[node / maskBits] = 1UL << (node % maskBits);
+
+  // The kernel drops the last bit of maxnode, hence the extra one.
+  return ::syscall(SYS_mbind, ptr, size, MemoryPolicyBind, nodeMask, NumaTopology::MaxNodes + 1, 0) == 0;
+}
+
+bool PinCurrentThreadToCpu(size_t cpu) noexcept {
+  if (cpu >= CPU_SETSIZE) {
+    return false;
+  }
+
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  return ::pthread_setaffinity_np(::pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+bool PinCurrentThreadToNumaNode(size_t node) noexcept {
+  const auto& topology = NumaTopology::Get();
+  if (!topology.IsNodeOnline(node)) {
+    return false;
+  }
+
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  const auto& nodeCpus = topology.GetCpusOfNode(node);
+  for (size_t cpu = 0; cpu < topology.GetCpuCount() && cpu < CPU_SETSIZE; ++cpu) {
+    if (nodeCpus[cpu]) {
+      CPU_SET(cpu, &cpus);
+    }
+  }
+
+  return CPU_COUNT(&cpus) > 0 && ::pthread_setaffinity_np(::pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+} // namespace kv
@@ -0,0 +1,64 @@
+#include "kv/Support/SlabPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace kv {
+
+struct SlabPool::Slab {
+  Slab* next;
+  size_t size;
+};
+
+SlabPool::SlabPool(size_t slotSize, size_t slabSize) noexcept
+  : SlabPool(slotSize, *GetGlobalAllocator(), slabSize)
+{ }
+
+SlabPool::SlabPool(size_t slotSize, MemoryResource& upstream, size_t slabSize) noexcept
+  : _upstream(&upstream),
+    _slotSize((std::max(slotSize, sizeof(FreeSlot)) + SlotAlignment - 1) & ~(SlotAlignment - 1)),
+    _slabSize(std::max(slabSize, sizeof(Slab) + _slotSize)),
+    _freeSlots(nullptr),
+    _cursor(0),
+    _end(0),
+    _slabs(nullptr),
+    _slabCount(0)
+{
+  static_assert(sizeof(Slab) % SlotAlignment == 0, "slots after the slab header should be aligned");
+  assert(slotSize > 0 && "slot size should be a positive value");
+}
+
+SlabPool::~SlabPool() noexcept {
+  while (_slabs) {
+    auto next = _slabs->next;
+    _upstream->Release(_slabs);
+    _slabs = next;
+  }
+}
+
+void* SlabPool::AllocateSlab() {
+  auto slab = static_cast<Slab *>(_upstream->Allocate(_slabSize, SlotAlignment));
+  slab->next = _slabs;
+  slab->size = _slabSize;
+  _slabs = slab;
+  ++_slabCount;
+
+  auto begin = reinterpret_cast<uintptr_t>(slab) + sizeof(Slab);
+  _end = begin + (_slabSize - sizeof(Slab)) / _slotSize * _slotSize;
+
+  // Hand out the first slot right away.
+  _cursor = begin + _slotSize;
+  return reinterpret_cast<void *>(begin);
+}
+
+SlabPoolSet::SlabPoolSet(size_t slabSize) noexcept
+  : SlabPoolSet(*GetGlobalAllocator(), slabSize)
+{ }
+
+SlabPoolSet::SlabPoolSet(MemoryResource& upstream, size_t slabSize) noexcept
+  : _upstream(&upstream),
+    _slabSize(slabSize),
+    _pools()
+{ }
+
+} // namespace kv
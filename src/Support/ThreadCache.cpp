@@ -0,0 +1,166 @@
+#include "kv/Support/ThreadCache.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "kv/Support/Intrinsics.h"
+
+namespace kv {
+
+namespace {
+
+/**
+ * @brief The number of bytes a single magazine aims to hold.
+ */
+constexpr static const size_t MagazineBytes = 8192;
+
+constexpr static const size_t MinMagazineCapacity = 4;
+
+enum class ThreadCacheState {
+  Uninitialized,
+  Active,
+  Destroyed,
+};
+
+// Both variables are constant initialized and trivially destructible, so accessing them does not go through the
+// dynamic TLS initialization wrappers.
+thread_local ThreadCache* currentCache = nullptr;
+thread_local ThreadCacheState currentCacheState = ThreadCacheState::Uninitialized;
+
+class CurrentCacheHolder {
+public:
+  explicit CurrentCacheHolder() noexcept
+    : _cache(*GetLocalAllocator())
+  {
+    currentCache = &_cache;
+    currentCacheState = ThreadCacheState::Active;
+  }
+
+  CurrentCacheHolder(const CurrentCacheHolder &) = delete;
+  CurrentCacheHolder(CurrentCacheHolder &&) noexcept = delete;
+
+  ~CurrentCacheHolder() noexcept {
+    // Frees issued by thread local destructors that run after this one go to the global allocator directly.
+    currentCache = nullptr;
+    currentCacheState = ThreadCacheState::Destroyed;
+  }
+
+  CurrentCacheHolder& operator=(const CurrentCacheHolder &) = delete;
+  CurrentCacheHolder& operator=(CurrentCacheHolder &&) noexcept = delete;
+
+private:
+  ThreadCache _cache;
+}; // class CurrentCacheHolder
+
+} // namespace <anonymous>
+
+ThreadCache::ThreadCache(RawAllocator& shared) noexcept
+  : _shared(&shared),
+    _sharedTag(shared.GetTag()),
+    _magazines()
+{
+  for (size_t sizeClass = 0; sizeClass < CachedClassCount; ++sizeClass) {
+    auto capacity = std::clamp(MagazineBytes / ClassToSize(sizeClass), MinMagazineCapacity, MaxMagazineCapacity);
+    _magazines[sizeClass].count = 0;
+    _magazines[sizeClass].capacity = static_cast<uint32_t>(capacity);
+  }
+}
+
+ThreadCache::~ThreadCache() noexcept {
+  Flush();
+}
+
+ThreadCache* ThreadCache::GetCurrent() noexcept {
+  if (LIKELY(currentCache)) {
+    return currentCache;
+  }
+
+  if (currentCacheState == ThreadCacheState::Destroyed) {
+    return nullptr;
+  }
+
+  static thread_local CurrentCacheHolder holder;
+  return currentCache;
+}
+
+void* ThreadCache::Allocate(size_t size) {
+  if (UNLIKELY(size > MaxCachedSize)) {
+    return _shared->Allocate(size);
+  }
+
+  auto sizeClass = SizeToClass(size);
+  auto& magazine = _magazines[sizeClass];
+  if (LIKELY(magazine.count > 0)) {
+    return magazine.slots[--magazine.count];
+  }
+
+  return Refill(sizeClass);
+}
+
+void ThreadCache::Release(void* ptr) noexcept {
+  if (UNLIKELY(!ptr)) {
+    return;
+  }
+
+  // Chunks owned by other allocators, e.g. the arena of another NUMA node, go back to their owners directly so that
+  // the magazines only ever hand out memory of the shared allocator.
+  auto usableSize = RawAllocator::GetUsableSize(ptr);
+  if (UNLIKELY(usableSize > MaxCachedSize || RawAllocator::GetOwnerTag(ptr) != _sharedTag)) {
+    auto owner = RawAllocator::GetOwner(ptr);
+    (owner ? owner : _shared)->Release(ptr);
+    return;
+  }
+
+  // The floor size class of the usable size is the largest size class this chunk can serve.
+  auto& magazine = _magazines[SizeToFloorClass(usableSize)];
+  if (UNLIKELY(magazine.count == magazine.capacity)) {
+    Drain(magazine, magazine.capacity / 2);
+  }
+
+  magazine.slots[magazine.count++] = ptr;
+}
+
+void ThreadCache::Release(void* ptr, size_t size) noexcept {
+  if (UNLIKELY(!ptr)) {
+    return;
+  }
+
+  if (UNLIKELY(size > MaxCachedSize || RawAllocator::GetOwnerTag(ptr) != _sharedTag)) {
+    Release(ptr);
+    return;
+  }
+
+  auto& magazine = _magazines[SizeToClass(std::max(size, static_cast<size_t>(1)))];
+  if (UNLIKELY(magazine.count == magazine.capacity)) {
+    Drain(magazine, magazine.capacity / 2);
+  }
+
+  magazine.slots[magazine.count++] = ptr;
+}
+
+void ThreadCache::Flush() noexcept {
+  for (auto& magazine : _magazines) {
+    Drain(magazine, magazine.count);
+  }
+}
+
+void* ThreadCache::Refill(size_t sizeClass) {
+  auto& magazine = _magazines[sizeClass];
+  assert(magazine.count == 0 && "only empty magazines should be refilled");
+
+  auto count = _shared->AllocateBatch(ClassToSize(sizeClass), RawAllocator::DefaultAlignment, magazine.slots.data(),
+                                      magazine.capacity / 2 + 1);
+  magazine.count = static_cast<uint32_t>(count - 1);
+  return magazine.slots[magazine.count];
+}
+
+void ThreadCache::Drain(Magazine& magazine, size_t count) noexcept {
+  assert(count <= magazine.count && "cannot drain more chunks than the magazine holds");
+
+  // Drain the oldest chunks and keep the most recently freed ones, which are more likely to be in cache.
+  _shared->ReleaseBatch(magazine.slots.data(), count);
+  std::copy(magazine.slots.begin() + count, magazine.slots.begin() + magazine.count, magazine.slots.begin());
+  magazine.count -= static_cast<uint32_t>(count);
+}
+
+} // namespace kv
@@ -0,0 +1,85 @@
+#include "kv/Bench/BenchAllocWorkloads.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+TEST(BenchAllocWorkloads, TestThroughput) {
+  kv::AllocThroughputOptions options;
+  options.size = 48;
+  options.batchSize = 64;
+  options.measure.minSampleTime = std::chrono::microseconds { 100 };
+  options.measure.sampleCount = 2;
+  for (auto kind : kv::GetAvailableBenchAllocators()) {
+    SCOPED_TRACE(kv::GetBenchAllocatorName(kind));
+    auto allocator = kv::BenchAllocator::Create(kind);
+    auto measurement = kv::MeasureAllocThroughput(*allocator, options);
+    ASSERT_EQ(measurement.samples.size(), 2);
+    ASSERT_GT(measurement.GetMedian(), 0);
+  }
+}
+
+TEST(BenchAllocWorkloads, TestCrossThreadFrees) {
+  kv::CrossThreadOptions options;
+  options.pairs = 2;
+  options.operations = 10000;
+  options.queueCapacity = 16;
+  for (auto kind : kv::GetAvailableBenchAllocators()) {
+    SCOPED_TRACE(kv::GetBenchAllocatorName(kind));
+    auto allocator = kv::BenchAllocator::Create(kind);
+    auto result = kv::RunCrossThreadFrees(*allocator, options);
+    ASSERT_EQ(result.operations, 20000);
+    ASSERT_GT(result.seconds, 0);
+    ASSERT_GT(result.GetMillionOperationsPerSecond(), 0);
+  }
+}
+
+TEST(BenchAllocWorkloads, TestChurn) {
+  kv::ChurnOptions options;
+  options.threads = 3;
+  options.slots = 64;
+  options.operations = 10000;
+  options.rounds = 4;
+  for (auto kind : kv::GetAvailableBenchAllocators()) {
+    SCOPED_TRACE(kv::GetBenchAllocatorName(kind));
+    auto allocator = kv::BenchAllocator::Create(kind);
+    auto result = kv::RunAllocChurn(*allocator, options);
+    ASSERT_EQ(result.operations, 30000);
+    ASSERT_GT(result.seconds, 0);
+  }
+}
+
+TEST(BenchAllocWorkloads, TestFragmentation) {
+  ASSERT_GT(kv::GetResidentSetSize(), 0);
+
+  kv::FragmentationOptions options;
+  options.liveSize = static_cast<size_t>(1) << 20;
+  options.phases = 3;
+  options.releaseFraction = 0.5;
+  auto allocator = kv::BenchAllocator::Create(kv::BenchAllocatorKind::Raw);
+  auto result = kv::RunFragmentation(*allocator, options);
+  ASSERT_EQ(result.samples.size(), 7);
+  for (size_t phase = 0; phase < 3; ++phase) {
+    ASSERT_GE(result.samples[phase * 2].liveBytes, options.liveSize);
+    ASSERT_LT(result.samples[phase * 2 + 1].liveBytes, result.samples[phase * 2].liveBytes);
+  }
+  ASSERT_EQ(result.samples.back().liveBytes, 0);
+  ASSERT_GE(result.samples.back().seconds, result.samples.front().seconds);
+  ASSERT_GE(result.GetPeakResidentRatio(), 0);
+
+  ASSERT_EQ(kv::FragmentationResult { }.GetPeakResidentRatio(), 0);
+}
+
+TEST(BenchAllocWorkloads, TestJsonTree) {
+  kv::JsonTreeOptions options;
+  options.records = 100;
+  options.sampleCount = 3;
+  for (auto kind : kv::GetAvailableBenchAllocators()) {
+    SCOPED_TRACE(kv::GetBenchAllocatorName(kind));
+    auto allocator = kv::BenchAllocator::Create(kind);
+    auto result = kv::MeasureJsonTree(*allocator, options);
+    ASSERT_EQ(result.nodes, 1200);
+    ASSERT_EQ(result.buildSamples.size(), 3);
+    ASSERT_EQ(result.teardownSamples.size(), 3);
+  }
+}
@@ -0,0 +1,66 @@
+#include "kv/Bench/BenchAllocators.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "kv/Json/JsonObject.h"
+
+TEST(BenchAllocators, TestNames) {
+  for (size_t i = 0; i < kv::BenchAllocatorKindCount; ++i) {
+    auto kind = static_cast<kv::BenchAllocatorKind>(i);
+    ASSERT_EQ(kv::ParseBenchAllocatorKind(kv::GetBenchAllocatorName(kind)), kind);
+  }
+  ASSERT_EQ(std::string_view { kv::GetBenchAllocatorName(kv::BenchAllocatorKind::ThreadCache) }, "thread-cache");
+  ASSERT_FALSE(kv::ParseBenchAllocatorKind("tcmalloc").has_value());
+}
+
+TEST(BenchAllocators, TestAvailability) {
+  auto kinds = kv::GetAvailableBenchAllocators();
+  ASSERT_GE(kinds.size(), 5);
+  ASSERT_EQ(kinds[0], kv::BenchAllocatorKind::Raw);
+  ASSERT_NE(kv::BenchAllocator::Create(kv::BenchAllocatorKind::Malloc), nullptr);
+  ASSERT_EQ(kv::BenchAllocator::Create(kv::BenchAllocatorKind::Jemalloc) != nullptr,
+            kv::BenchAllocator::IsAvailable(kv::BenchAllocatorKind::Jemalloc));
+  ASSERT_EQ(kv::BenchAllocator::Create(kv::BenchAllocatorKind::Mimalloc) != nullptr,
+            kv::BenchAllocator::IsAvailable(kv::BenchAllocatorKind::Mimalloc));
+}
+
+TEST(BenchAllocators, TestHeaps) {
+  for (auto kind : kv::GetAvailableBenchAllocators()) {
+    SCOPED_TRACE(kv::GetBenchAllocatorName(kind));
+    auto allocator = kv::BenchAllocator::Create(kind);
+    ASSERT_EQ(allocator->GetKind(), kind);
+
+    auto heap = allocator->CreateHeap();
+    auto other = allocator->CreateHeap();
+    std::vector<std::pair<void *, size_t>> chunks;
+    for (size_t size : { 1, 8, 16, 100, 512, 513, 1024, 4096, 100000 }) {
+      auto ptr = heap->Allocate(size);
+      ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % 8, 0);
+      std::memset(ptr, 0x5a, size);
+      chunks.emplace_back(ptr, size);
+    }
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      // Every other chunk is released through another heap, as if by another thread.
+      (i % 2 == 0 ? heap : other)->Release(chunks[i].first, chunks[i].second);
+    }
+    heap->Recycle();
+  }
+}
+
+TEST(BenchAllocators, TestHeapResource) {
+  auto allocator = kv::BenchAllocator::Create(kv::BenchAllocatorKind::SlabPool);
+  auto heap = allocator->CreateHeap();
+  kv::BenchHeapResource resource { *heap, sizeof(kv::JsonObject) };
+  kv::ObjectAllocator<kv::JsonObject> objects { resource };
+
+  auto array = kv::MakeObject<kv::JsonObject>(objects, kv::JsonObject::CreateArray());
+  for (int i = 0; i < 100; ++i) {
+    array->GetArray().push_back(kv::MakeObject<kv::JsonObject>(objects, i));
+  }
+  ASSERT_EQ(array->GetArray()[42]->GetNumber<int>(), 42);
+  resource.Release(nullptr);
+}
@@ -0,0 +1,41 @@
+#include "kv/Bench/BenchBuffer.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+TEST(BenchBuffer, TestPolicyNames) {
+  for (auto policy : { kv::MemoryPolicy::Malloc, kv::MemoryPolicy::Mmap, kv::MemoryPolicy::TransparentHugePages,
+                       kv::MemoryPolicy::HugePages2M, kv::MemoryPolicy::HugePages1G }) {
+    ASSERT_EQ(kv::ParseMemoryPolicy(kv::GetMemoryPolicyName(policy)), policy);
+  }
+  ASSERT_FALSE(kv::ParseMemoryPolicy("huge"));
+}
+
+TEST(BenchBuffer, TestPolicies) {
+  for (auto policy : { kv::MemoryPolicy::Malloc, kv::MemoryPolicy::Mmap, kv::MemoryPolicy::TransparentHugePages,
+                       kv::MemoryPolicy::HugePages2M }) {
+    kv::BenchBufferOptions options;
+    options.policy = policy;
+    kv::BenchBuffer buffer { 3 << 20, options };
+    ASSERT_EQ(buffer.GetSize(), 3 << 20);
+    ASSERT_EQ(buffer.GetOptions().policy, policy);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(buffer.GetData()) % kv::BenchBuffer::Alignment, 0);
+
+    // Buffers are zeroed by the initial touch.
+    auto data = static_cast<uint8_t *>(buffer.GetData());
+    for (size_t i = 0; i < buffer.GetSize(); i += 4096) {
+      ASSERT_EQ(data[i], 0);
+    }
+    std::memset(data, 0xFF, buffer.GetSize());
+  }
+}
+
+TEST(BenchBuffer, TestNumaNode) {
+  kv::BenchBufferOptions options;
+  options.numaNode = 0;
+  kv::BenchBuffer buffer { 1 << 16, options };
+  ASSERT_EQ(buffer.GetOptions().numaNode, 0);
+  std::memset(buffer.GetData(), 0xFF, buffer.GetSize());
+}
@@ -0,0 +1,84 @@
+#include "kv/Bench/BenchCounters.h"
+
+#include <chrono>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "kv/Bench/BenchRunner.h"
+
+TEST(BenchCounters, TestCounterNames) {
+  ASSERT_EQ(std::string_view { kv::GetPerfCounterName(kv::PerfCounter::Cycles) }, "cycles");
+  ASSERT_EQ(std::string_view { kv::GetPerfCounterName(kv::PerfCounter::LlcMisses) }, "llc-misses");
+  ASSERT_EQ(std::string_view { kv::GetPerfCounterName(kv::PerfCounter::StallCycles) }, "stall-cycles");
+}
+
+TEST(BenchCounters, TestValues) {
+  kv::PerfCounterValues values;
+  ASSERT_FALSE(values.IsAnyAvailable());
+  ASSERT_FALSE(values.Get(kv::PerfCounter::Cycles).has_value());
+  ASSERT_FALSE(values.GetPer(kv::PerfCounter::Cycles, 10).has_value());
+  ASSERT_FALSE(values.GetInstructionsPerCycle().has_value());
+
+  values.Set(kv::PerfCounter::Cycles, 100);
+  ASSERT_TRUE(values.IsAnyAvailable());
+  ASSERT_EQ(values.Get(kv::PerfCounter::Cycles), 100);
+  ASSERT_EQ(values.GetPer(kv::PerfCounter::Cycles, 10), 10.0);
+  ASSERT_FALSE(values.GetPer(kv::PerfCounter::Cycles, 0).has_value());
+  ASSERT_FALSE(values.GetInstructionsPerCycle().has_value());
+
+  kv::PerfCounterValues other;
+  other.Set(kv::PerfCounter::Cycles, 50);
+  other.Set(kv::PerfCounter::Instructions, 300);
+  values += other;
+  ASSERT_EQ(values.Get(kv::PerfCounter::Cycles), 150);
+  ASSERT_EQ(values.Get(kv::PerfCounter::Instructions), 300);
+  ASSERT_EQ(values.GetInstructionsPerCycle(), 2.0);
+  ASSERT_FALSE(values.Get(kv::PerfCounter::DtlbMisses).has_value());
+}
+
+TEST(BenchCounters, TestScope) {
+  kv::PerfCounterGroup group;
+  kv::PerfCounterValues values;
+  {
+    kv::PerfCounterScope scope { group, values };
+    volatile uint64_t sum = 0;
+    for (uint64_t i = 0; i < 1000000; ++i) {
+      sum = sum + i;
+    }
+  }
+
+  // Counters may be unavailable in this environment, but then they must be unavailable in the values as well.
+  for (size_t i = 0; i < kv::PerfCounterCount; ++i) {
+    auto counter = static_cast<kv::PerfCounter>(i);
+    if (!group.IsAvailable(counter)) {
+      ASSERT_FALSE(values.Get(counter).has_value());
+    }
+  }
+  ASSERT_EQ(values.IsAnyAvailable() && !group.IsAnyAvailable(), false);
+  if (group.IsAvailable(kv::PerfCounter::Instructions) && values.Get(kv::PerfCounter::Instructions)) {
+    ASSERT_GE(*values.Get(kv::PerfCounter::Instructions), 1000000);
+  }
+}
+
+TEST(BenchCounters, TestScopeWithoutGroup) {
+  kv::PerfCounterValues values;
+  values.Set(kv::PerfCounter::Cycles, 7);
+  {
+    kv::PerfCounterScope scope { nullptr, values };
+  }
+  ASSERT_EQ(values.Get(kv::PerfCounter::Cycles), 7);
+  ASSERT_FALSE(values.Get(kv::PerfCounter::Instructions).has_value());
+}
+
+TEST(BenchCounters, TestMeasureCounters) {
+  kv::MeasureOptions options;
+  options.minSampleTime = std::chrono::microseconds { 100 };
+  options.sampleCount = 3;
+  auto measurement = kv::Measure([]() { }, options);
+  ASSERT_FALSE(measurement.counters.IsAnyAvailable());
+
+  options.collectCounters = true;
+  measurement = kv::Measure([]() { }, options);
+  ASSERT_EQ(measurement.GetSampledCalls(), measurement.iterations * 3);
+  ASSERT_EQ(measurement.counters.IsAnyAvailable(), kv::PerfCounterGroup { }.IsAnyAvailable());
+}
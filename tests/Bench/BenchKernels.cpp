@@ -0,0 +1,106 @@
+#include "kv/Bench/BenchKernels.h"
+
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "kv/Bench/BenchBuffer.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr const kv::KernelVariant Variants[] = { kv::KernelVariant::Scalar, kv::KernelVariant::Simd };
+
+} // namespace <anonymous>
+
+TEST(BenchKernels, TestNames) {
+  for (auto kind : { kv::AccessKind::Read, kv::AccessKind::Write, kv::AccessKind::Copy }) {
+    ASSERT_EQ(kv::ParseAccessKind(kv::GetAccessKindName(kind)), kind);
+  }
+  for (auto variant : Variants) {
+    ASSERT_EQ(kv::ParseKernelVariant(kv::GetKernelVariantName(variant)), variant);
+  }
+  ASSERT_FALSE(kv::ParseAccessKind("move"));
+  ASSERT_FALSE(kv::ParseKernelVariant("avx"));
+}
+
+TEST(BenchKernels, TestAccessWidth) {
+  ASSERT_EQ(kv::GetAccessWidth(kv::KernelVariant::Scalar), 8);
+  auto width = kv::GetAccessWidth(kv::KernelVariant::Simd);
+  ASSERT_GE(width, 8);
+  ASSERT_EQ(width & (width - 1), 0);
+  ASSERT_NE(kv::GetSimdInstructionSet(), nullptr);
+}
+
+TEST(BenchKernels, TestChaseList) {
+  constexpr size_t Stride = 64;
+  constexpr size_t Count = 1000;
+
+  kv::BenchBuffer buffer { Stride * Count };
+  auto head = kv::BuildChaseList(buffer.GetData(), buffer.GetSize(), Stride, 42);
+  ASSERT_EQ(head, buffer.GetData());
+
+  // The list is a single cycle through all slots.
+  std::set<const void *> visited;
+  const void* current = head;
+  for (size_t i = 0; i < Count; ++i) {
+    auto offset = static_cast<const uint8_t *>(current) - static_cast<const uint8_t *>(buffer.GetData());
+    ASSERT_EQ(offset % Stride, 0);
+    ASSERT_LT(offset, Stride * Count);
+    ASSERT_TRUE(visited.insert(current).second);
+    current = kv::ChasePointers(current, 1);
+  }
+  ASSERT_EQ(current, head);
+  ASSERT_EQ(kv::ChasePointers(head, Count * 3), head);
+
+  // The order is random rather than sequential.
+  ASSERT_NE(kv::ChasePointers(head, 1), static_cast<uint8_t *>(buffer.GetData()) + Stride);
+}
+
+TEST(BenchKernels, TestReadWrite) {
+  for (auto variant : Variants) {
+    auto width = kv::GetAccessWidth(variant);
+    for (auto stride : { width, width * 2, width * 8 }) {
+      kv::BenchBuffer buffer { 4096 + stride / 2 };
+      kv::WriteMemory(variant, buffer.GetData(), buffer.GetSize(), stride, 0x0123456789ABCDEF);
+
+      auto data = static_cast<const uint8_t *>(buffer.GetData());
+      size_t written = 0;
+      for (size_t offset = 0; offset < buffer.GetSize(); offset += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + offset, sizeof(word));
+        auto expected = offset % stride < width && offset + stride - offset % stride <= buffer.GetSize();
+        ASSERT_EQ(word, expected ? 0x0123456789ABCDEF : 0) << offset;
+        written += expected;
+      }
+      ASSERT_EQ(written, buffer.GetSize() / stride * width / 8);
+
+      // Each access XORs in an odd number of copies of the value per lane, and lanes fold to the value again.
+      auto accesses = buffer.GetSize() / stride;
+      auto expected = (accesses * (width / 8)) % 2 == 1 ? 0x0123456789ABCDEF : 0;
+      ASSERT_EQ(kv::ReadMemory(variant, buffer.GetData(), buffer.GetSize(), stride), expected);
+    }
+  }
+}
+
+TEST(BenchKernels, TestCopy) {
+  for (auto variant : Variants) {
+    auto width = kv::GetAccessWidth(variant);
+    for (auto stride : { width, width * 4 }) {
+      kv::BenchBuffer src { 8192 };
+      kv::BenchBuffer dst { 8192 };
+      auto from = static_cast<uint8_t *>(src.GetData());
+      for (size_t i = 0; i < src.GetSize(); ++i) {
+        from[i] = static_cast<uint8_t>(i * 7 + 1);
+      }
+
+      kv::CopyMemory(variant, dst.GetData(), src.GetData(), src.GetSize(), stride);
+      auto to = static_cast<const uint8_t *>(dst.GetData());
+      for (size_t i = 0; i < dst.GetSize(); ++i) {
+        ASSERT_EQ(to[i], i % stride < width ? from[i] : 0) << i;
+      }
+    }
+  }
+}
@@ -0,0 +1,155 @@
+#include "kv/Bench/BenchReport.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "kv/Json/JsonException.h"
+
+namespace {
+
+const kv::JsonObject& GetField(const kv::JsonObject& map, const char* key) {
+  return *map.GetFlatMap().at(key);
+}
+
+std::string MakeTemporaryPath() {
+  return "/tmp/kv-bench-report-" + std::to_string(::getpid()) + ".json";
+}
+
+} // namespace <anonymous>
+
+TEST(BenchReport, TestStatistics) {
+  auto empty = kv::ComputeStatistics({ });
+  ASSERT_EQ(empty.count, 0);
+  ASSERT_EQ(empty.median, 0);
+
+  auto single = kv::ComputeStatistics({ 3 });
+  ASSERT_EQ(single.count, 1);
+  ASSERT_EQ(single.median, 3);
+  ASSERT_EQ(single.p99, 3);
+  ASSERT_EQ(single.stddev, 0);
+
+  auto statistics = kv::ComputeStatistics({ 5, 1, 4, 2, 3 });
+  ASSERT_EQ(statistics.count, 5);
+  ASSERT_EQ(statistics.min, 1);
+  ASSERT_EQ(statistics.max, 5);
+  ASSERT_EQ(statistics.mean, 3);
+  ASSERT_EQ(statistics.median, 3);
+  ASSERT_DOUBLE_EQ(statistics.p99, 4.96);
+  ASSERT_DOUBLE_EQ(statistics.stddev, std::sqrt(2.5));
+
+  ASSERT_EQ(kv::ComputeStatistics({ 4, 1, 3, 2 }).median, 2.5);
+}
+
+TEST(BenchReport, TestWelchPValue) {
+  auto lhs = kv::ComputeStatistics({ 1, 2, 3, 4, 5 });
+  auto rhs = kv::ComputeStatistics({ 6, 7, 8, 9, 10 });
+  // t = -5 with 8 degrees of freedom.
+  ASSERT_NEAR(kv::ComputeWelchPValue(lhs, rhs), 0.001052, 1e-6);
+  ASSERT_NEAR(kv::ComputeWelchPValue(lhs, lhs), 1, 1e-12);
+
+  auto unequal = kv::ComputeStatistics({ 19.8, 20.4, 19.6, 17.8, 18.5, 18.9, 18.3, 18.9, 19.5, 22.0 });
+  auto other = kv::ComputeStatistics({ 28.2, 26.6, 20.1, 23.3, 25.2, 22.1, 17.7, 27.6, 20.6, 13.7, 23.2, 17.5, 20.6,
+                                       18.0, 23.9, 21.6, 24.3, 20.4, 23.9, 13.3 });
+  ASSERT_NEAR(kv::ComputeWelchPValue(unequal, other), 0.035485, 1e-5);
+
+  ASSERT_EQ(kv::ComputeWelchPValue(kv::ComputeStatistics({ 1 }), rhs), 1);
+  ASSERT_EQ(kv::ComputeWelchPValue(kv::ComputeStatistics({ 2, 2 }), kv::ComputeStatistics({ 3, 3 })), 0);
+}
+
+TEST(BenchReport, TestDescribeMachine) {
+  auto machine = kv::DescribeMachine();
+  ASSERT_TRUE(machine.IsFlatMap());
+  ASSERT_GE(GetField(machine, "cpuCount").GetNumber<size_t>(), 1);
+  ASSERT_TRUE(GetField(machine, "simd").IsString());
+  ASSERT_TRUE(GetField(machine, "caches").IsArray());
+  ASSERT_FALSE(GetField(machine, "numaNodes").GetArray().empty());
+}
+
+TEST(BenchReport, TestDescribeCounters) {
+  kv::PerfCounterValues counters;
+  ASSERT_TRUE(kv::DescribeCounters(counters, 10).GetFlatMap().empty());
+
+  counters.Set(kv::PerfCounter::LlcMisses, 50);
+  auto description = kv::DescribeCounters(counters, 10);
+  ASSERT_EQ(description.GetFlatMap().size(), 1);
+  const auto& misses = GetField(description, "llc-misses");
+  ASSERT_EQ(GetField(misses, "total").GetNumber<uint64_t>(), 50);
+  ASSERT_EQ(GetField(misses, "perAccess").GetNumber<double>(), 5);
+}
+
+TEST(BenchReport, TestReportRoundTrip) {
+  kv::BenchReport report { "latency" };
+  report.GetParameters().insert_or_assign("stride", kv::MakeJsonObject(64));
+  auto& result = report.AddResult("size=4K", "ns/access", kv::MetricDirection::LowerIsBetter, { 1.5, 1.25, 1.75 });
+  result.insert_or_assign("workingSetSize", kv::MakeJsonObject(4096));
+
+  const auto& root = report.GetRoot();
+  ASSERT_EQ(GetField(root, "schema").GetString(), kv::BenchReport::Schema);
+  ASSERT_EQ(GetField(root, "mode").GetString(), "latency");
+  ASSERT_EQ(GetField(GetField(root, "parameters"), "stride").GetNumber<int>(), 64);
+  const auto& results = GetField(root, "results").GetArray();
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_EQ(GetField(GetField(*results[0], "statistics"), "median").GetNumber<double>(), 1.5);
+
+  auto path = MakeTemporaryPath();
+  report.WriteFile(path.c_str());
+  auto loaded = kv::LoadReport(path.c_str());
+  std::remove(path.c_str());
+  ASSERT_EQ(loaded, root);
+}
+
+TEST(BenchReport, TestLoadInvalidReport) {
+  auto path = MakeTemporaryPath();
+  auto* file = std::fopen(path.c_str(), "w");
+  ASSERT_NE(file, nullptr);
+  std::fputs("{\"schema\":\"something-else\"}", file);
+  std::fclose(file);
+  ASSERT_THROW(static_cast<void>(kv::LoadReport(path.c_str())), kv::JsonException);
+  std::remove(path.c_str());
+}
+
+TEST(BenchReport, TestCompareReports) {
+  kv::BenchReport baseline { "bandwidth" };
+  baseline.AddResult("size=4K", "GB/s", kv::MetricDirection::HigherIsBetter, { 100, 101, 99, 100, 100.5 });
+  baseline.AddResult("size=8K", "GB/s", kv::MetricDirection::HigherIsBetter, { 100, 101, 99, 100, 100.5 });
+  baseline.AddResult("size=16K", "GB/s", kv::MetricDirection::HigherIsBetter, { 100, 101, 99, 100, 100.5 });
+  baseline.AddResult("size=32K", "GB/s", kv::MetricDirection::HigherIsBetter, { 100, 101, 99, 100, 100.5 });
+  baseline.AddResult("size=64K", "GB/s", kv::MetricDirection::HigherIsBetter, { 100 });
+
+  kv::BenchReport current { "bandwidth" };
+  current.AddResult("size=4K", "GB/s", kv::MetricDirection::HigherIsBetter, { 80, 81, 79, 80, 80.5 });
+  current.AddResult("size=8K", "GB/s", kv::MetricDirection::HigherIsBetter, { 120, 121, 119, 120, 120.5 });
+  current.AddResult("size=16K", "GB/s", kv::MetricDirection::HigherIsBetter, { 100.5, 101, 99.5, 100, 100.5 });
+  // Significant, but below the threshold.
+  current.AddResult("size=32K", "GB/s", kv::MetricDirection::HigherIsBetter, { 98, 98.1, 97.9, 98, 98.05 });
+  // A single sample cannot be tested.
+  current.AddResult("size=64K", "GB/s", kv::MetricDirection::HigherIsBetter, { 50 });
+  current.AddResult("size=128K", "GB/s", kv::MetricDirection::HigherIsBetter, { 100, 101, 99 });
+
+  auto comparisons = kv::CompareReports(baseline.GetRoot(), current.GetRoot());
+  ASSERT_EQ(comparisons.size(), 5);
+  ASSERT_EQ(comparisons[0].name, "size=4K");
+  ASSERT_EQ(comparisons[0].verdict, kv::ComparisonVerdict::Regression);
+  ASSERT_NEAR(comparisons[0].change, -0.2, 1e-3);
+  ASSERT_LT(comparisons[0].pValue, 0.05);
+  ASSERT_EQ(comparisons[1].verdict, kv::ComparisonVerdict::Improvement);
+  ASSERT_EQ(comparisons[2].verdict, kv::ComparisonVerdict::Unchanged);
+  ASSERT_EQ(comparisons[3].verdict, kv::ComparisonVerdict::Unchanged);
+  ASSERT_EQ(comparisons[4].verdict, kv::ComparisonVerdict::Unchanged);
+  ASSERT_EQ(comparisons[4].pValue, 1);
+
+  kv::BenchReport latency { "latency" };
+  latency.AddResult("size=4K", "ns/access", kv::MetricDirection::LowerIsBetter, { 1, 1.01, 0.99 });
+  ASSERT_THROW(static_cast<void>(kv::CompareReports(baseline.GetRoot(), latency.GetRoot())), kv::JsonException);
+
+  kv::BenchReport slower { "latency" };
+  slower.AddResult("size=4K", "ns/access", kv::MetricDirection::LowerIsBetter, { 2, 2.01, 1.99 });
+  auto latencyComparisons = kv::CompareReports(latency.GetRoot(), slower.GetRoot());
+  ASSERT_EQ(latencyComparisons.size(), 1);
+  ASSERT_EQ(latencyComparisons[0].verdict, kv::ComparisonVerdict::Regression);
+}
@@ -0,0 +1,116 @@
+#include "kv/Bench/BenchRunner.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+kv::MeasureOptions QuickMeasure() {
+  kv::MeasureOptions options;
+  options.minSampleTime = std::chrono::microseconds { 100 };
+  options.sampleCount = 3;
+  return options;
+}
+
+} // namespace <anonymous>
+
+TEST(BenchRunner, TestMeasure) {
+  size_t calls = 0;
+  auto measurement = kv::Measure([&calls]() {
+    ++calls;
+  }, QuickMeasure());
+  ASSERT_GE(measurement.iterations, 1);
+  ASSERT_EQ(measurement.samples.size(), 3);
+  ASSERT_GE(calls, measurement.iterations * 4);
+  ASSERT_GT(measurement.GetMedian(), 0);
+}
+
+TEST(BenchRunner, TestMeasureMaxIterations) {
+  // The calls take far less than the minimal sample time, so only the cap ends the calibration. The barrier after
+  // every call keeps an optimizing compiler from folding the calls into one.
+  auto options = QuickMeasure();
+  options.minSampleTime = std::chrono::seconds { 10 };
+  options.maxIterations = 1000;
+  size_t calls = 0;
+  auto measurement = kv::Measure([&calls]() {
+    ++calls;
+  }, options);
+  ASSERT_EQ(measurement.iterations, 1000);
+  ASSERT_EQ(measurement.samples.size(), 3);
+  ASSERT_EQ(calls, 1 + 2 + 4 + 8 + 16 + 32 + 64 + 128 + 256 + 512 + 1000 + 1000 * 3);
+  ASSERT_GT(measurement.GetMedian(), 0);
+}
+
+TEST(BenchRunner, TestMedian) {
+  kv::Measurement measurement;
+  ASSERT_EQ(measurement.GetMedian(), 0);
+  measurement.samples = { 3, 1, 2 };
+  ASSERT_EQ(measurement.GetMedian(), 2);
+  measurement.samples = { 4, 1, 3, 2 };
+  ASSERT_EQ(measurement.GetMedian(), 2.5);
+}
+
+TEST(BenchRunner, TestLatencyBench) {
+  kv::LatencyBenchOptions options;
+  options.steps = 1024;
+  options.measure = QuickMeasure();
+  auto result = kv::RunLatencyBench(64 << 10, options);
+  ASSERT_EQ(result.workingSetSize, 64 << 10);
+  ASSERT_EQ(result.accesses, 1024);
+  ASSERT_GT(result.GetNanosecondsPerAccess(), 0);
+}
+
+TEST(BenchRunner, TestBandwidthBench) {
+  for (auto kind : { kv::AccessKind::Read, kv::AccessKind::Write, kv::AccessKind::Copy }) {
+    for (auto variant : { kv::KernelVariant::Scalar, kv::KernelVariant::Simd }) {
+      kv::BandwidthBenchOptions options;
+      options.kind = kind;
+      options.variant = variant;
+      options.measure = QuickMeasure();
+      auto result = kv::RunBandwidthBench(64 << 10, options);
+
+      auto width = kv::GetAccessWidth(variant);
+      auto bufferSize = kind == kv::AccessKind::Copy ? 32 << 10 : 64 << 10;
+      ASSERT_EQ(result.accesses, bufferSize / width);
+      ASSERT_EQ(result.bytes, 64 << 10);
+      ASSERT_GT(result.GetGigabytesPerSecond(), 0);
+    }
+  }
+
+  kv::BandwidthBenchOptions options;
+  options.variant = kv::KernelVariant::Scalar;
+  options.stride = 12;
+  ASSERT_THROW((void)kv::RunBandwidthBench(4096, options), std::invalid_argument);
+}
+
+TEST(BenchRunner, TestSizeSweep) {
+  ASSERT_EQ(kv::MakeSizeSweep(4096, 65536), (std::vector<size_t> { 4096, 8192, 16384, 32768, 65536 }));
+  ASSERT_EQ(kv::MakeSizeSweep(4096, 16384, 2), (std::vector<size_t> { 4096, 5824, 8192, 11584, 16384 }));
+  ASSERT_EQ(kv::MakeSizeSweep(4096, 20000), (std::vector<size_t> { 4096, 8192, 16384, 20000 }));
+  ASSERT_EQ(kv::MakeSizeSweep(100, 100), (std::vector<size_t> { 100 }));
+  ASSERT_TRUE(kv::MakeSizeSweep(200, 100).empty());
+}
+
+TEST(BenchRunner, TestByteSizes) {
+  ASSERT_EQ(kv::ParseByteSize("4096"), 4096);
+  ASSERT_EQ(kv::ParseByteSize("64K"), 64 << 10);
+  ASSERT_EQ(kv::ParseByteSize("64k"), 64 << 10);
+  ASSERT_EQ(kv::ParseByteSize("2MiB"), 2 << 20);
+  ASSERT_EQ(kv::ParseByteSize("4GB"), static_cast<size_t>(4) << 30);
+  ASSERT_EQ(kv::ParseByteSize("1T"), static_cast<size_t>(1) << 40);
+  ASSERT_FALSE(kv::ParseByteSize(""));
+  ASSERT_FALSE(kv::ParseByteSize("K"));
+  ASSERT_FALSE(kv::ParseByteSize("12X"));
+  ASSERT_FALSE(kv::ParseByteSize("12KX"));
+  ASSERT_FALSE(kv::ParseByteSize("99999999999999999999"));
+  ASSERT_FALSE(kv::ParseByteSize("99999999999T"));
+
+  ASSERT_EQ(kv::FormatByteSize(100), "100");
+  ASSERT_EQ(kv::FormatByteSize(4096), "4K");
+  ASSERT_EQ(kv::FormatByteSize(6144), "6K");
+  ASSERT_EQ(kv::FormatByteSize(3 << 20), "3M");
+  ASSERT_EQ(kv::FormatByteSize(static_cast<size_t>(4) << 30), "4G");
+}
@@ -0,0 +1,81 @@
+#include "kv/Bench/BenchStoreWorkloads.h"
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(BenchStoreWorkloads, TestZipfianGenerator) {
+  kv::ZipfianGenerator generator { 1000 };
+  ASSERT_EQ(generator.GetItemCount(), 1000);
+
+  std::mt19937_64 random { 1 };
+  std::vector<size_t> counts(1000);
+  constexpr size_t Draws = 100000;
+  for (size_t i = 0; i < Draws; ++i) {
+    auto rank = generator(random);
+    ASSERT_LT(rank, 1000);
+    ++counts[rank];
+  }
+  // With theta 0.99 over 1000 items, rank 0 takes about 13% of the draws and rank 1 about half as many.
+  ASSERT_GT(counts[0], Draws / 10);
+  ASSERT_LT(counts[0], Draws / 6);
+  ASSERT_GT(counts[1], counts[0] / 3);
+  ASSERT_LT(counts[1], counts[0]);
+  ASSERT_GT(counts[0], counts[100] * 20);
+
+  kv::ZipfianGenerator uniform { 10, 0 };
+  std::vector<size_t> uniformCounts(10);
+  for (size_t i = 0; i < Draws; ++i) {
+    ++uniformCounts[uniform(random)];
+  }
+  for (auto count : uniformCounts) {
+    ASSERT_GT(count, Draws / 20);
+    ASSERT_LT(count, Draws / 5);
+  }
+
+  kv::ZipfianGenerator single { 1 };
+  ASSERT_EQ(single(random), 0);
+
+  ASSERT_THROW(kv::ZipfianGenerator(0), std::invalid_argument);
+  ASSERT_THROW(kv::ZipfianGenerator(10, 1), std::invalid_argument);
+  ASSERT_THROW(kv::ZipfianGenerator(10, -0.5), std::invalid_argument);
+}
+
+TEST(BenchStoreWorkloads, TestStoreWorkload) {
+  kv::StoreWorkloadOptions options;
+  options.threads = 2;
+  options.keys = 1000;
+  options.operations = 5000;
+  options.readFraction = 0.9;
+  options.latencyInterval = 4;
+  options.shards = 8;
+  auto result = kv::RunStoreWorkload(options);
+  ASSERT_EQ(result.operations, 10000);
+  ASSERT_GT(result.reads, 8000);
+  ASSERT_LT(result.reads, 10000);
+  ASSERT_EQ(result.hits, result.reads);
+  ASSERT_GT(result.seconds, 0);
+  ASSERT_GT(result.GetMillionOperationsPerSecond(), 0);
+  ASSERT_FALSE(result.readLatencies.empty());
+  ASSERT_FALSE(result.writeLatencies.empty());
+  // Every request accesses one key, and every fourth request of each thread is timed.
+  ASSERT_EQ(result.readLatencies.size() + result.writeLatencies.size(), 2500);
+}
+
+TEST(BenchStoreWorkloads, TestBatchedReads) {
+  kv::StoreWorkloadOptions options;
+  options.keys = 100;
+  options.operations = 1000;
+  options.readFraction = 1;
+  options.batchSize = 16;
+  options.latencyInterval = 1;
+  auto result = kv::RunStoreWorkload(options);
+  ASSERT_EQ(result.operations, 1000);
+  ASSERT_EQ(result.reads, 1000);
+  ASSERT_EQ(result.hits, 1000);
+  // 62 batches of 16 keys and a last one of 8.
+  ASSERT_EQ(result.readLatencies.size(), 63);
+  ASSERT_TRUE(result.writeLatencies.empty());
+}
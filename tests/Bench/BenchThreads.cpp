@@ -0,0 +1,129 @@
+#include "kv/Bench/BenchThreads.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+kv::ThreadBenchOptions QuickThreadBench() {
+  kv::ThreadBenchOptions options;
+  options.workingSetSize = 64 * 1024;
+  options.duration = std::chrono::milliseconds { 20 };
+  return options;
+}
+
+} // namespace <anonymous>
+
+TEST(BenchThreads, TestBarrier) {
+  constexpr static const size_t ThreadCount = 4;
+  constexpr static const size_t PhaseCount = 100;
+
+  kv::BenchBarrier barrier { ThreadCount };
+  std::atomic<size_t> arrivals { 0 };
+  std::atomic<bool> failed { false };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < ThreadCount; ++i) {
+    threads.emplace_back([&]() {
+      for (size_t phase = 0; phase < PhaseCount; ++phase) {
+        arrivals.fetch_add(1);
+        barrier.ArriveAndWait();
+        // All threads of this phase have arrived, and none of the next phase can arrive before this thread.
+        if (arrivals.load() < (phase + 1) * ThreadCount) {
+          failed.store(true);
+        }
+        barrier.ArriveAndWait();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_FALSE(failed.load());
+  ASSERT_EQ(arrivals.load(), ThreadCount * PhaseCount);
+}
+
+TEST(BenchThreads, TestBarrierDrop) {
+  kv::BenchBarrier barrier { 2 };
+  std::thread waiter { [&barrier]() {
+    barrier.ArriveAndWait();
+    barrier.ArriveAndWait();
+  } };
+
+  // Dropping releases the waiting thread, and the next phase only waits for that thread.
+  barrier.ArriveAndDrop();
+  waiter.join();
+}
+
+TEST(BenchThreads, TestMakeThreadSweep) {
+  ASSERT_TRUE(kv::MakeThreadSweep(0).empty());
+  ASSERT_EQ(kv::MakeThreadSweep(1), (std::vector<size_t> { 1 }));
+  ASSERT_EQ(kv::MakeThreadSweep(4), (std::vector<size_t> { 1, 2, 4 }));
+  ASSERT_EQ(kv::MakeThreadSweep(6), (std::vector<size_t> { 1, 2, 4, 6 }));
+}
+
+TEST(BenchThreads, TestSelectBenchCpus) {
+  auto cpus = kv::SelectBenchCpus();
+  ASSERT_FALSE(cpus.empty());
+  ASSERT_FALSE(kv::SelectBenchCpus(0).empty());
+}
+
+TEST(BenchThreads, TestRunThreadBench) {
+  auto options = QuickThreadBench();
+  auto result = kv::RunThreadBench({ kv::ThreadRole::Chase, kv::ThreadRole::Bandwidth, kv::ThreadRole::Bandwidth },
+                                   options);
+
+  ASSERT_EQ(result.threads.size(), 3);
+  ASSERT_EQ(result.threads[0].role, kv::ThreadRole::Chase);
+  ASSERT_EQ(result.threads[1].role, kv::ThreadRole::Bandwidth);
+  for (const auto& thread : result.threads) {
+    ASSERT_GT(thread.runs, 0);
+    ASSERT_GT(thread.seconds, 0);
+    ASSERT_GT(thread.GetNanosecondsPerAccess(), 0);
+    ASSERT_GT(thread.GetGigabytesPerSecond(), 0);
+  }
+  ASSERT_GT(result.GetNanosecondsPerAccess(kv::ThreadRole::Chase), 0);
+  ASSERT_GT(result.GetGigabytesPerSecond(kv::ThreadRole::Bandwidth), result.threads[1].GetGigabytesPerSecond());
+}
+
+TEST(BenchThreads, TestRunThreadBenchMemoryNode) {
+  auto options = QuickThreadBench();
+  options.memoryNode = 0;
+  auto result = kv::RunThreadBench({ kv::ThreadRole::Bandwidth }, options);
+  ASSERT_EQ(result.threads.size(), 1);
+  ASSERT_EQ(result.threads[0].memoryNode, 0);
+  ASSERT_GT(result.threads[0].runs, 0);
+}
+
+TEST(BenchThreads, TestRunThreadBenchTooSmallWorkingSet) {
+  // A working set below one slot would give an empty chase list, and below one access an empty bandwidth kernel.
+  auto options = QuickThreadBench();
+  options.workingSetSize = 32;
+  ASSERT_THROW(static_cast<void>(kv::RunThreadBench({ kv::ThreadRole::Chase }, options)), std::invalid_argument);
+
+  options.latency.stride = 4096;
+  options.workingSetSize = 1024;
+  ASSERT_THROW(static_cast<void>(kv::RunThreadBench({ kv::ThreadRole::Chase }, options)), std::invalid_argument);
+
+  options.bandwidth.kind = kv::AccessKind::Copy;
+  options.workingSetSize = kv::GetMinBandwidthWorkingSetSize(options.bandwidth) - 1;
+  ASSERT_THROW(static_cast<void>(kv::RunThreadBench({ kv::ThreadRole::Bandwidth }, options)), std::invalid_argument);
+
+  options.workingSetSize += 1;
+  auto result = kv::RunThreadBench({ kv::ThreadRole::Bandwidth }, options);
+  ASSERT_GT(result.threads[0].runs, 0);
+  ASSERT_EQ(result.threads[0].accesses, result.threads[0].runs);
+}
+
+TEST(BenchThreads, TestRunThreadBenchInvalidStride) {
+  auto options = QuickThreadBench();
+  options.bandwidth.stride = 3;
+  ASSERT_THROW(static_cast<void>(kv::RunThreadBench({ kv::ThreadRole::Chase, kv::ThreadRole::Bandwidth }, options)),
+               std::invalid_argument);
+}
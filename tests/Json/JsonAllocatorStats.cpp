@@ -0,0 +1,30 @@
+#include "kv/Json/JsonAllocatorStats.h"
+
+#include "gtest/gtest.h"
+
+TEST(JsonAllocatorStats, TestToJsonObject) {
+  kv::RawAllocator allocator;
+  auto ptr = allocator.Allocate(100);
+
+  auto stats = allocator.GetStats();
+  auto json = kv::ToJsonObject(stats);
+  ASSERT_TRUE(json.IsMap());
+  ASSERT_EQ(json.GetMap().at("blockCount")->GetNumber<size_t>(), 1);
+  ASSERT_EQ(json.GetMap().at("inUseBytes")->GetNumber<size_t>(), stats.GetInUseBytes());
+  ASSERT_EQ(json.GetMap().count("sizeClasses"), kv::AllocatorStatsEnabled ? 1 : 0);
+
+  allocator.Release(ptr);
+}
+
+TEST(JsonAllocatorStats, TestDump) {
+  kv::RawAllocator allocator;
+  auto ptr = allocator.Allocate(100);
+
+  auto text = kv::DumpAllocatorStats(allocator.GetStats());
+  ASSERT_EQ(text.front(), '{');
+  ASSERT_EQ(text.back(), '}');
+  ASSERT_NE(text.find("\"reservedBytes\":"), std::string::npos);
+  ASSERT_NE(text.find("\"fragmentation\":"), std::string::npos);
+
+  allocator.Release(ptr);
+}
@@ -0,0 +1,228 @@
+#include "kv/Json/JsonCbor.h"
+
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "kv/Json/JsonParser.h"
+#include "kv/Json/JsonSerializer.h"
+#include "kv/Json/JsonTape.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr const char* Document =
+    R"({"name": "cbor", "values": [0, 23, 24, -1, -1000, 1.5, 0.1, 1e300, -0.0, 4294967296],)"
+    R"( "flags": [true, false, null], "nested": {"empty": [], "map": {}, "text": "with \"quotes\""}})";
+
+std::string Hex(std::string_view bytes) {
+  constexpr const char* Digits = "0123456789abcdef";
+  std::string hex;
+  for (auto ch : bytes) {
+    auto byte = static_cast<unsigned char>(ch);
+    hex.push_back(Digits[byte >> 4]);
+    hex.push_back(Digits[byte & 0xF]);
+  }
+  return hex;
+}
+
+std::string Unhex(std::string_view hex) {
+  std::string bytes;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+    bytes.push_back(static_cast<char>(std::stoi(std::string { hex.substr(i, 2) }, nullptr, 16)));
+  }
+  return bytes;
+}
+
+std::string Encode(double value) {
+  return Hex(kv::EncodeCbor(kv::JsonObject { value }));
+}
+
+std::string Reencode(std::string_view hex) {
+  return kv::SerializeJson(kv::DecodeCbor(Unhex(hex), kv::ObjectAllocator<kv::JsonObject> { },
+                                          kv::JsonMapStorage::Flat));
+}
+
+} // namespace <anonymous>
+
+TEST(JsonCbor, TestEncodeScalars) {
+  // Examples from RFC 8949, Appendix A.
+  ASSERT_EQ(Encode(0), "00");
+  ASSERT_EQ(Encode(23), "17");
+  ASSERT_EQ(Encode(24), "1818");
+  ASSERT_EQ(Encode(1000), "1903e8");
+  ASSERT_EQ(Encode(1000000), "1a000f4240");
+  ASSERT_EQ(Encode(1e12), "1b000000e8d4a51000");
+  ASSERT_EQ(Encode(18446744073709549568.0), "1bfffffffffffff800");
+  ASSERT_EQ(Encode(-1), "20");
+  ASSERT_EQ(Encode(-1000), "3903e7");
+  ASSERT_EQ(Encode(1.1), "fb3ff199999999999a");
+  ASSERT_EQ(Encode(1e300), "fb7e37e43c8800759c");
+  ASSERT_EQ(Encode(100000.5), "fa47c35040");
+  ASSERT_EQ(Encode(-0.0), "fa80000000");
+  ASSERT_EQ(Encode(std::numeric_limits<double>::infinity()), "fa7f800000");
+
+  ASSERT_EQ(Hex(kv::EncodeCbor(kv::JsonObject { false })), "f4");
+  ASSERT_EQ(Hex(kv::EncodeCbor(kv::JsonObject { true })), "f5");
+  ASSERT_EQ(Hex(kv::EncodeCbor(kv::JsonObject { nullptr })), "f6");
+  ASSERT_EQ(Hex(kv::EncodeCbor(kv::JsonObject { "" })), "60");
+  ASSERT_EQ(Hex(kv::EncodeCbor(kv::JsonObject { "IETF" })), "6449455446");
+  ASSERT_EQ(Hex(kv::EncodeCbor(kv::JsonObject { "\xC3\xBC" })), "62c3bc");
+}
+
+TEST(JsonCbor, TestEncodeContainers) {
+  ASSERT_EQ(Hex(kv::EncodeCbor(kv::ParseJson("[]"))), "80");
+  ASSERT_EQ(Hex(kv::EncodeCbor(kv::ParseJson("[1, 2, 3]"))), "83010203");
+  ASSERT_EQ(Hex(kv::EncodeCbor(kv::ParseJson("[1, [2, 3], [4, 5]]"))), "8301820203820405");
+  ASSERT_EQ(Hex(kv::EncodeCbor(kv::ParseJson("{}"))), "a0");
+
+  auto flat = kv::ParseJson(R"({"a": 1, "b": [2, 3]})", kv::ObjectAllocator<kv::JsonObject> { },
+                            kv::JsonMapStorage::Flat);
+  ASSERT_EQ(Hex(kv::EncodeCbor(flat)), "a26161016162820203");
+
+  // Sizes above 23 move into the argument bytes.
+  std::string longText(300, 'x');
+  auto encoded = kv::EncodeCbor(kv::JsonObject { longText });
+  ASSERT_EQ(Hex(encoded.substr(0, 3)), "79012c");
+  ASSERT_EQ(encoded.size(), 303);
+
+  // All output kinds agree.
+  std::string iterOutput;
+  kv::JsonCborEncoder<std::back_insert_iterator<std::string>> encoder { std::back_inserter(iterOutput) };
+  encoder.Encode(flat);
+  ASSERT_EQ(Hex(iterOutput), "a26161016162820203");
+}
+
+TEST(JsonCbor, TestDecode) {
+  ASSERT_EQ(Reencode("00"), "0");
+  ASSERT_EQ(Reencode("1bffffffffffffffff"), "18446744073709551616");
+  ASSERT_EQ(Reencode("3903e7"), "-1000");
+  ASSERT_EQ(Reencode("f90000"), "0");
+  ASSERT_EQ(Reencode("f98000"), "-0");
+  ASSERT_EQ(Reencode("f93e00"), "1.5");
+  ASSERT_EQ(Reencode("f97bff"), "65504");
+  ASSERT_EQ(Reencode("f90001"), "5.960464477539063e-08");
+  ASSERT_EQ(Reencode("f9c400"), "-4");
+  ASSERT_EQ(Reencode("f97c00"), "null");
+  ASSERT_EQ(Reencode("fa47c35000"), "100000");
+  ASSERT_EQ(Reencode("fb3ff199999999999a"), "1.1");
+  ASSERT_EQ(Reencode("f4"), "false");
+  ASSERT_EQ(Reencode("f5"), "true");
+  ASSERT_EQ(Reencode("f6"), "null");
+  ASSERT_EQ(Reencode("f7"), "null");
+  ASSERT_EQ(Reencode("6449455446"), R"("IETF")");
+  ASSERT_EQ(Reencode("a26161016162820203"), R"({"a":1,"b":[2,3]})");
+
+  // Indefinite lengths.
+  ASSERT_EQ(Reencode("9fff"), "[]");
+  ASSERT_EQ(Reencode("9f018202039f0405ffff"), "[1,[2,3],[4,5]]");
+  ASSERT_EQ(Reencode("bf61610161629f0203ffff"), R"({"a":1,"b":[2,3]})");
+  ASSERT_EQ(Reencode("7f657374726561646d696e67ff"), R"("streaming")");
+
+  // Tags are ignored.
+  ASSERT_EQ(Reencode("c074323031332d30332d32315432303a30343a30305a"), R"("2013-03-21T20:04:00Z")");
+  ASSERT_EQ(Reencode("c11a514b67b0"), "1363896240");
+
+  // The last of duplicate keys wins.
+  ASSERT_EQ(Reencode("a2616101616102"), R"({"a":2})");
+}
+
+TEST(JsonCbor, TestRoundTrip) {
+  for (auto storage : { kv::JsonMapStorage::Hashed, kv::JsonMapStorage::Flat }) {
+    auto json = kv::ParseJson(Document, kv::ObjectAllocator<kv::JsonObject> { }, storage);
+    auto encoded = kv::EncodeCbor(json);
+    auto decoded = kv::DecodeCbor(encoded, kv::ObjectAllocator<kv::JsonObject> { }, storage);
+    ASSERT_EQ(decoded, json);
+    ASSERT_EQ(decoded.GetMapStorage(), storage);
+    decoded.WithMap([](const auto& map) {
+      ASSERT_TRUE(std::signbit(map.at("values")->GetArray()[8]->GetNumber()));
+    });
+  }
+
+  // Numbers keep their exact values.
+  for (auto value : { 0.1, -2.5, 5e-324, 1.7976931348623157e308, 9007199254740993.0, -18446744073709551616.0 }) {
+    ASSERT_EQ(kv::DecodeCbor(kv::EncodeCbor(kv::JsonObject { value })).GetNumber(), value);
+  }
+
+  // Large negative integers are decoded with a single rounding.
+  for (auto value : { -10856290258340266.0, -9007199254740994.0, -9223372036854775808.0, -18446744073709549568.0 }) {
+    ASSERT_EQ(kv::DecodeCbor(kv::EncodeCbor(kv::JsonObject { value })).GetNumber(), value);
+  }
+  ASSERT_EQ(kv::DecodeCbor(Unhex("3bffffffffffffffff")).GetNumber(), -18446744073709551616.0);
+  ASSERT_EQ(kv::DecodeCbor(Unhex("3b002691bd0c6d49a9")).GetNumber(), -10856290258340266.0);
+
+  // Tapes encode exactly like flat maps, which keep the document order.
+  auto tape = kv::ParseJsonTape(Document);
+  auto flat = kv::ParseJson(Document, kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Flat);
+  ASSERT_EQ(kv::EncodeCbor(tape.GetRoot()), kv::EncodeCbor(flat));
+}
+
+TEST(JsonCbor, TestSkip) {
+  auto json = kv::ParseJson(Document);
+  std::string data;
+  kv::EncodeCbor(json, data);
+  auto first = data.size();
+  kv::EncodeCbor(kv::JsonObject { "second" }, data);
+  data.append(Unhex("9f7f6161ffbf6161f7ffff"));
+  auto third = data.size();
+  kv::EncodeCbor(kv::JsonObject { 42 }, data);
+
+  kv::JsonCborDecoder decoder { data };
+  decoder.Skip();
+  ASSERT_EQ(decoder.GetOffset(), first);
+  ASSERT_EQ(decoder.Decode().GetString(), "second");
+  decoder.Skip();
+  ASSERT_EQ(decoder.GetOffset(), third);
+  ASSERT_FALSE(decoder.IsAtEnd());
+  ASSERT_EQ(decoder.Decode().GetNumber(), 42);
+  ASSERT_TRUE(decoder.IsAtEnd());
+}
+
+TEST(JsonCbor, TestErrors) {
+  auto expectError = [](std::string_view hex, size_t offset) {
+    auto data = Unhex(hex);
+    try {
+      (void)kv::DecodeCbor(data);
+      FAIL() << hex << " decoded";
+    } catch (const kv::JsonParseException& ex) {
+      ASSERT_EQ(ex.GetOffset(), offset) << hex << ": " << ex.what();
+    }
+
+    // Skipping detects the same errors, except for trailing data.
+    kv::JsonCborDecoder decoder { data };
+    try {
+      decoder.Skip();
+      ASSERT_FALSE(decoder.IsAtEnd()) << hex << " skipped";
+    } catch (const kv::JsonParseException& ex) {
+      ASSERT_EQ(ex.GetOffset(), offset) << hex << ": " << ex.what();
+    }
+  };
+
+  expectError("", 0);
+  expectError("19", 1);
+  expectError("1903", 1);
+  expectError("1c", 0);
+  expectError("1f", 0);
+  expectError("62", 0);
+  expectError("6261", 0);
+  expectError("4161", 0);
+  expectError("83", 1);
+  expectError("8301", 2);
+  expectError("9f01", 2);
+  expectError("a1016161", 1);
+  expectError("7f4161ff", 1);
+  expectError("ff", 0);
+  expectError("f8ff", 0);
+  expectError("f0", 0);
+  expectError("0000", 1);
+
+  // Nesting depth is limited.
+  std::string deep(kv::JsonCborDecoder::MaxDepth + 1, '\x81');
+  deep.push_back('\x00');
+  ASSERT_THROW((void)kv::DecodeCbor(deep), kv::JsonParseException);
+  kv::JsonCborDecoder decoder { deep };
+  ASSERT_THROW(decoder.Skip(), kv::JsonParseException);
+}
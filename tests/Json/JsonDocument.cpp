@@ -0,0 +1,121 @@
+#include "kv/Json/JsonDocument.h"
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include "kv/Json/JsonParser.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr std::string_view Document =
+    R"({"name": "plain", "escaped": "a\"bé", "n": -12.5, "ok": true, "no": false, "nothing": null,)"
+    R"( "list": [1, [2, 3], {}, []], "nested": {"k": "v", "k": "w"}})";
+
+size_t GetErrorOffset(std::string_view text) {
+  try {
+    kv::JsonDocument document { text };
+  } catch (const kv::JsonParseException& ex) {
+    return ex.GetOffset();
+  }
+  ADD_FAILURE() << "no exception thrown for " << text;
+  return 0;
+}
+
+} // namespace <anonymous>
+
+TEST(JsonDocument, TestScalars) {
+  kv::JsonDocument document { Document };
+  auto root = document.GetRoot().GetMap();
+
+  auto name = root.At("name").GetString();
+  ASSERT_EQ(name, "plain");
+  // Strings without escapes point into the source text.
+  ASSERT_GE(name.data(), Document.data());
+  ASSERT_LT(name.data(), Document.data() + Document.size());
+
+  ASSERT_EQ(root.At("escaped").GetString(), "a\"b\xC3\xA9");
+  // Strings with escapes are decoded once.
+  ASSERT_EQ(root.At("escaped").GetString().data(), root.At("escaped").GetString().data());
+  ASSERT_EQ(root.At("n").GetNumber(), -12.5);
+  ASSERT_EQ(root.At("n").GetNumber<int>(), -12);
+  ASSERT_TRUE(root.At("ok").GetBoolean());
+  ASSERT_FALSE(root.At("no").GetBoolean());
+  ASSERT_TRUE(root.At("nothing").IsNull());
+  ASSERT_FALSE(root.Find("missing").has_value());
+  ASSERT_THROW((void)root.At("missing"), kv::JsonException);
+  ASSERT_THROW((void)root.At("name").GetNumber(), kv::JsonException);
+}
+
+TEST(JsonDocument, TestContainers) {
+  kv::JsonDocument document { Document };
+  auto root = document.GetRoot().GetMap();
+  ASSERT_EQ(root.GetSize(), 8);
+
+  std::vector<std::string_view> keys;
+  for (auto [key, value] : root) {
+    keys.push_back(key);
+  }
+  ASSERT_EQ(keys, (std::vector<std::string_view> {
+      "name", "escaped", "n", "ok", "no", "nothing", "list", "nested" }));
+
+  auto list = root.At("list").GetArray();
+  ASSERT_EQ(list.GetSize(), 4);
+  ASSERT_EQ(list.At(0).GetNumber<int>(), 1);
+  ASSERT_EQ(list.At(1).GetArray().At(1).GetNumber<int>(), 3);
+  ASSERT_TRUE(list.At(2).GetMap().IsEmpty());
+  ASSERT_TRUE(list.At(3).GetArray().IsEmpty());
+  ASSERT_THROW((void)list.At(4), kv::JsonException);
+
+  // The last occurrence of a duplicate key wins, as in JsonParser.
+  ASSERT_EQ(root.At("nested").GetMap().At("k").GetString(), "w");
+}
+
+TEST(JsonDocument, TestToJsonObject) {
+  kv::JsonDocument document { Document };
+  ASSERT_EQ(document.GetRoot().ToJsonObject(), kv::ParseJson(Document));
+  ASSERT_EQ(document.GetRoot().GetMap().At("list").ToJsonObject(), kv::ParseJson("[1, [2, 3], {}, []]"));
+}
+
+TEST(JsonDocument, TestStructuralErrors) {
+  ASSERT_EQ(GetErrorOffset(""), 0);
+  ASSERT_EQ(GetErrorOffset("[1, 2"), 5);
+  ASSERT_EQ(GetErrorOffset("[1 2]"), 3);
+  ASSERT_EQ(GetErrorOffset("{\"a\" 1}"), 5);
+  ASSERT_EQ(GetErrorOffset("{1: 2}"), 1);
+  ASSERT_EQ(GetErrorOffset("[1,]"), 3);
+  ASSERT_EQ(GetErrorOffset("null x"), 5);
+  ASSERT_EQ(GetErrorOffset("{\"a\": 1"), 7);
+}
+
+TEST(JsonDocument, TestLazyScalarErrors) {
+  kv::JsonDocument document { R"([tru, 01, "a\x"])" };
+  auto list = document.GetRoot().GetArray();
+
+  try {
+    (void)list.At(0).GetBoolean();
+    FAIL() << "no exception thrown";
+  } catch (const kv::JsonParseException& ex) {
+    ASSERT_EQ(ex.GetOffset(), 1);
+  }
+  ASSERT_THROW((void)list.At(1).GetNumber(), kv::JsonParseException);
+  ASSERT_THROW((void)list.At(2).GetString(), kv::JsonParseException);
+}
+
+TEST(JsonDocument, TestMappedFile) {
+  char path[] = "/tmp/kv-json-document-XXXXXX";
+  auto fd = ::mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(::write(fd, Document.data(), Document.size()), static_cast<ssize_t>(Document.size()));
+  ::close(fd);
+
+  kv::JsonDocument document { kv::MappedFile { path } };
+  std::remove(path);
+  ASSERT_EQ(document.GetText(), Document);
+  ASSERT_EQ(document.GetRoot().GetMap().At("name").GetString(), "plain");
+}
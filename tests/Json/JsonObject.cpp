@@ -1,5 +1,8 @@
 #include "kv/Json/JsonObject.h"
 
+#include <type_traits>
+#include <utility>
+
 #include "gtest/gtest.h"
 
 namespace {
@@ -162,3 +165,199 @@ TEST(JsonObject, TestVisitMap) {
   ASSERT_EQ(visitor.ArrayCount, 0);
   ASSERT_EQ(visitor.MapCount, 1);
 }
+
+TEST(JsonObject, TestEqualityComparesChildren) {
+  auto lhs = kv::JsonObject::CreateArray();
+  lhs.GetArray().push_back(kv::MakeJsonObject(1));
+  auto rhs = kv::JsonObject::CreateArray();
+  rhs.GetArray().push_back(kv::MakeJsonObject(1));
+  ASSERT_EQ(lhs, rhs);
+
+  rhs.GetArray()[0] = kv::MakeJsonObject(2);
+  ASSERT_NE(lhs, rhs);
+
+  auto lhsMap = kv::JsonObject::CreateMap();
+  lhsMap.GetMap().emplace("a", kv::MakeJsonObject(true));
+  auto rhsMap = kv::JsonObject::CreateMap();
+  rhsMap.GetMap().emplace("a", kv::MakeJsonObject(true));
+  ASSERT_EQ(lhsMap, rhsMap);
+  ASSERT_NE(lhsMap, lhs);
+
+  rhsMap.GetMap().emplace("b", kv::MakeJsonObject(nullptr));
+  ASSERT_NE(lhsMap, rhsMap);
+}
+
+TEST(JsonObject, TestFlatMap) {
+  auto flat = kv::JsonObject::CreateMap(kv::JsonMapStorage::Flat);
+  ASSERT_TRUE(flat.IsMap());
+  ASSERT_TRUE(flat.IsFlatMap());
+  ASSERT_EQ(flat.GetType(), kv::JsonObjectType::Map);
+  ASSERT_EQ(flat.GetMapStorage(), kv::JsonMapStorage::Flat);
+  ASSERT_THROW((void)flat.GetMap(), kv::JsonException);
+
+  flat.GetFlatMap().emplace("a", kv::MakeJsonObject(true));
+  flat.GetFlatMap().emplace("b", kv::MakeJsonObject(1));
+
+  auto hashed = kv::JsonObject::CreateMap();
+  ASSERT_FALSE(hashed.IsFlatMap());
+  ASSERT_EQ(hashed.GetMapStorage(), kv::JsonMapStorage::Hashed);
+  ASSERT_THROW((void)hashed.GetFlatMap(), kv::JsonException);
+  hashed.GetMap().emplace("b", kv::MakeJsonObject(1));
+  hashed.GetMap().emplace("a", kv::MakeJsonObject(true));
+
+  // Equality does not depend on the storage mode.
+  ASSERT_EQ(flat, hashed);
+  ASSERT_EQ(hashed, flat);
+  hashed.GetMap().at("b") = kv::MakeJsonObject(2);
+  ASSERT_NE(flat, hashed);
+
+  Visitor visitor;
+  flat.Visit(visitor);
+  ASSERT_EQ(visitor.MapCount, 1);
+  ASSERT_EQ(flat.WithMap([](const auto& map) { return map.size(); }), 2);
+}
+
+namespace {
+
+class CountingResource final : public kv::MemoryResource {
+public:
+  size_t Live = 0;
+
+  void* Allocate(size_t size, size_t) override {
+    ++Live;
+    return ::operator new(size);
+  }
+
+  void Release(void* ptr) noexcept override {
+    if (ptr) {
+      --Live;
+      ::operator delete(ptr);
+    }
+  }
+}; // class CountingResource
+
+} // namespace <anonymous>
+
+TEST(JsonObject, TestDeepTeardown) {
+  constexpr const size_t Depth = 300000;
+
+  CountingResource resource;
+  {
+    kv::ObjectAllocator<kv::JsonObject> allocator { resource };
+    auto root = kv::JsonObject::CreateArray();
+    auto tail = &root;
+    for (size_t i = 0; i < Depth; ++i) {
+      // Alternate between arrays, hashed maps and flat maps, each with a scalar sibling of the nested child.
+      kv::JsonObjectPtr child;
+      switch (i % 3) {
+        case 0:
+          child = kv::MakeObject<kv::JsonObject>(allocator, kv::JsonObject::CreateArray());
+          break;
+        case 1:
+          child = kv::MakeObject<kv::JsonObject>(allocator, kv::JsonObject::CreateMap());
+          break;
+        default:
+          child = kv::MakeObject<kv::JsonObject>(allocator, kv::JsonObject::CreateMap(kv::JsonMapStorage::Flat));
+          break;
+      }
+      auto next = child.get();
+      if (tail->IsArray()) {
+        tail->GetArray().push_back(kv::MakeObject<kv::JsonObject>(allocator, 1));
+        tail->GetArray().push_back(std::move(child));
+      } else if (tail->IsFlatMap()) {
+        tail->GetFlatMap().emplace("leaf", kv::MakeObject<kv::JsonObject>(allocator, "leaf"));
+        tail->GetFlatMap().emplace("next", std::move(child));
+      } else {
+        tail->GetMap().emplace("leaf", kv::MakeObject<kv::JsonObject>(allocator, nullptr));
+        tail->GetMap().emplace("next", std::move(child));
+      }
+      tail = next;
+    }
+    ASSERT_EQ(resource.Live, 2 * Depth);
+  }
+  ASSERT_EQ(resource.Live, 0);
+}
+
+static_assert(!std::is_polymorphic_v<kv::JsonObject>, "JsonObject should not have a vtable");
+static_assert(std::is_nothrow_move_constructible_v<kv::JsonObject>, "JsonObject should be moved without throwing");
+
+TEST(JsonObject, TestTryGet) {
+  kv::JsonObject number { 2.5 };
+  ASSERT_EQ(number.TryGetNumber(), 2.5);
+  ASSERT_EQ(number.TryGetNumber<int>(), 2);
+  ASSERT_FALSE(number.TryGetBoolean());
+  ASSERT_EQ(number.TryGetString(), nullptr);
+  ASSERT_EQ(number.TryGetArray(), nullptr);
+  ASSERT_THROW((void)number.GetString(), kv::JsonException);
+
+  kv::JsonObject boolean { false };
+  ASSERT_EQ(boolean.TryGetBoolean(), false);
+  ASSERT_FALSE(boolean.TryGetNumber());
+
+  kv::JsonObject string { "text" };
+  ASSERT_NE(string.TryGetString(), nullptr);
+  ASSERT_EQ(*string.TryGetString(), "text");
+
+  auto array = kv::JsonObject::CreateArray();
+  ASSERT_NE(array.TryGetArray(), nullptr);
+  array.TryGetArray()->push_back(kv::MakeJsonObject(nullptr));
+  ASSERT_EQ(array.GetArray().size(), 1);
+  ASSERT_EQ(array.TryGetMap(), nullptr);
+
+  auto hashed = kv::JsonObject::CreateMap();
+  ASSERT_NE(hashed.TryGetMap(), nullptr);
+  ASSERT_EQ(hashed.TryGetFlatMap(), nullptr);
+
+  const auto flat = kv::JsonObject::CreateMap(kv::JsonMapStorage::Flat);
+  ASSERT_NE(flat.TryGetFlatMap(), nullptr);
+  ASSERT_EQ(flat.TryGetMap(), nullptr);
+}
+
+TEST(JsonObject, TestCopy) {
+  CountingResource resource;
+  kv::ObjectAllocator<kv::JsonObject> allocator { resource };
+
+  auto root = kv::JsonObject::CreateMap(kv::JsonMapStorage::Flat);
+  auto& entries = root.GetFlatMap();
+  entries.emplace("number", kv::MakeObject<kv::JsonObject>(allocator, 1));
+  entries.emplace("array", kv::MakeObject<kv::JsonObject>(allocator, kv::JsonObject::CreateArray()));
+  entries.at("array")->GetArray().push_back(kv::MakeJsonObject("global"));
+  entries.emplace("map", kv::MakeJsonObject(kv::JsonObject::CreateMap()));
+  entries.at("map")->GetMap().emplace("nested", kv::MakeObject<kv::JsonObject>(allocator, true));
+  ASSERT_EQ(resource.Live, 3);
+
+  // Copies allocate every node from the resource of the node they copy.
+  kv::JsonObject copy { root };
+  ASSERT_EQ(copy, root);
+  ASSERT_TRUE(copy.IsFlatMap());
+  ASSERT_EQ(resource.Live, 6);
+  ASSERT_NE(copy.GetFlatMap().at("array").get(), root.GetFlatMap().at("array").get());
+
+  copy.GetFlatMap().at("number") = kv::MakeJsonObject(2);
+  ASSERT_NE(copy, root);
+  ASSERT_EQ(root.GetFlatMap().at("number")->GetNumber(), 1);
+
+  copy = root;
+  ASSERT_EQ(copy, root);
+  ASSERT_EQ(resource.Live, 6);
+
+  auto scalar = kv::JsonObject { "text" };
+  copy = scalar;
+  ASSERT_EQ(copy.GetString(), "text");
+  ASSERT_EQ(resource.Live, 3);
+}
+
+TEST(JsonObject, TestClone) {
+  auto root = kv::JsonObject::CreateArray();
+  root.GetArray().push_back(kv::MakeJsonObject(kv::JsonObject::CreateMap()));
+  root.GetArray().back()->GetMap().emplace("a", kv::MakeJsonObject("b"));
+  root.GetArray().push_back(kv::MakeJsonObject(kv::JsonObject::CreateArray()));
+
+  CountingResource resource;
+  {
+    auto clone = root.Clone(kv::ObjectAllocator<kv::JsonObject> { resource });
+    ASSERT_EQ(*clone, root);
+    ASSERT_EQ(resource.Live, 4);
+  }
+  ASSERT_EQ(resource.Live, 0);
+}
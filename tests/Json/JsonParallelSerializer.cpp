@@ -0,0 +1,85 @@
+#include "kv/Json/JsonParallelSerializer.h"
+
+#include <cstdio>
+#include <string>
+
+#include <unistd.h>
+
+#include "kv/Json/JsonParser.h"
+#include "kv/Json/JsonSerializer.h"
+#include "kv/Json/JsonTape.h"
+#include "kv/Support/MappedFile.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string MakeDocument() {
+  std::string records = "[";
+  std::string map = "{";
+  for (auto i = 0; i < 1000; ++i) {
+    records += R"({"id": )" + std::to_string(i) + R"(, "name": "item \")" + std::to_string(i) + R"(\"", "tags": [1, 2.5, null]},)";
+    map += "\"k" + std::to_string(i) + "\": [" + std::to_string(i) + "],";
+  }
+  records += "[]]";
+  map += "\"last\": {}}";
+  return R"({"meta": {"version": 3, "empty": []}, "records": )" + records + R"(, "index": )" + map + R"(, "tail": true})";
+}
+
+template <typename Node>
+std::string SerializeParallel(const Node& node, size_t threadCount, size_t threshold) {
+  kv::JsonParallelSerializer serializer { threadCount, threshold };
+  std::string output;
+  serializer.Serialize(node, output);
+  return output;
+}
+
+} // namespace <anonymous>
+
+TEST(JsonParallelSerializer, TestScalarsAndSmallDocuments) {
+  for (const auto* text : { "null", "1.5", R"("s")", "[]", "{}", R"([1, {"a": [true]}])" }) {
+    auto json = kv::ParseJson(text);
+    ASSERT_EQ(SerializeParallel(json, 4, 1), kv::SerializeJson(json)) << text;
+  }
+}
+
+TEST(JsonParallelSerializer, TestMatchesSequential) {
+  auto text = MakeDocument();
+  auto hashed = kv::ParseJson(text);
+  auto flat = kv::ParseJson(text, kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Flat);
+  auto tape = kv::ParseJsonTape(text);
+
+  for (auto threshold : { static_cast<size_t>(1), static_cast<size_t>(3), static_cast<size_t>(100),
+                          static_cast<size_t>(1000), kv::JsonParallelSerializer::DefaultParallelThreshold }) {
+    for (auto threadCount : { 1, 2, 5 }) {
+      ASSERT_EQ(SerializeParallel(hashed, threadCount, threshold), kv::SerializeJson(hashed));
+      ASSERT_EQ(SerializeParallel(flat, threadCount, threshold), kv::SerializeJson(flat));
+      ASSERT_EQ(SerializeParallel(tape.GetRoot(), threadCount, threshold), kv::SerializeJson(tape.GetRoot()));
+    }
+  }
+}
+
+TEST(JsonParallelSerializer, TestWriteToFile) {
+  auto json = kv::ParseJson(MakeDocument());
+  auto expected = kv::SerializeJson(json);
+
+  for (auto threadCount : { 1, 4 }) {
+    char path[] = "/tmp/kv-json-parallel-XXXXXX";
+    auto fd = ::mkstemp(path);
+    ASSERT_GE(fd, 0);
+
+    kv::JsonParallelSerializer serializer { static_cast<size_t>(threadCount), 10 };
+    serializer.Serialize(json, fd);
+    ::close(fd);
+
+    kv::MappedFile file { path };
+    std::remove(path);
+    ASSERT_EQ(file.GetView(), expected);
+  }
+}
+
+TEST(JsonParallelSerializer, TestDefaultThreadCount) {
+  kv::JsonParallelSerializer serializer;
+  ASSERT_GE(serializer.GetThreadCount(), 1);
+  ASSERT_EQ(serializer.GetThreshold(), kv::JsonParallelSerializer::DefaultParallelThreshold);
+}
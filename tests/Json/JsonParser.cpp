@@ -0,0 +1,135 @@
+#include "kv/Json/JsonParser.h"
+
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "kv/Json/JsonSerializer.h"
+#include "kv/Support/MonotonicArena.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+size_t GetErrorOffset(const char* text) {
+  try {
+    auto json = kv::ParseJson(text);
+  } catch (const kv::JsonParseException& ex) {
+    return ex.GetOffset();
+  }
+  ADD_FAILURE() << "no exception thrown for " << text;
+  return 0;
+}
+
+} // namespace <anonymous>
+
+TEST(JsonParser, TestParseScalars) {
+  ASSERT_TRUE(kv::ParseJson("null").IsNull());
+  ASSERT_TRUE(kv::ParseJson(" true ").GetBoolean());
+  ASSERT_FALSE(kv::ParseJson("false").GetBoolean());
+  ASSERT_EQ(kv::ParseJson("42").GetNumber<int>(), 42);
+  ASSERT_EQ(kv::ParseJson("-0.5e2").GetNumber(), -50.0);
+  // Subnormal and underflowing numbers are accepted.
+  ASSERT_EQ(kv::ParseJson("5e-324").GetNumber(), 5e-324);
+  ASSERT_EQ(kv::ParseJson("-1e-400").GetNumber(), 0);
+  ASSERT_EQ(kv::ParseJson("\"hello\"").GetString(), "hello");
+}
+
+TEST(JsonParser, TestParseEscapes) {
+  ASSERT_EQ(kv::ParseJson(R"("a\"b\\c\/d\n\t\r\b\f")").GetString(), "a\"b\\c/d\n\t\r\b\f");
+  ASSERT_EQ(kv::ParseJson(R"("\u0041\u00e9\u4e2d")").GetString(), "A\xC3\xA9\xE4\xB8\xAD");
+  ASSERT_EQ(kv::ParseJson(R"("\ud83d\ude00")").GetString(), "\xF0\x9F\x98\x80");
+}
+
+TEST(JsonParser, TestParseContainers) {
+  auto json = kv::ParseJson(R"({"a": [1, 2, {"b": null}], "c": {}, "d": []})");
+  ASSERT_TRUE(json.IsMap());
+
+  const auto& map = json.GetMap();
+  ASSERT_EQ(map.size(), 3);
+
+  const auto& arr = map.at("a")->GetArray();
+  ASSERT_EQ(arr.size(), 3);
+  ASSERT_EQ(arr[0]->GetNumber<int>(), 1);
+  ASSERT_EQ(arr[1]->GetNumber<int>(), 2);
+  ASSERT_TRUE(arr[2]->GetMap().at("b")->IsNull());
+
+  ASSERT_TRUE(map.at("c")->GetMap().empty());
+  ASSERT_TRUE(map.at("d")->GetArray().empty());
+}
+
+TEST(JsonParser, TestDuplicateKeys) {
+  auto json = kv::ParseJson(R"({"a": 1, "a": 2})");
+  ASSERT_EQ(json.GetMap().size(), 1);
+  ASSERT_EQ(json.GetMap().at("a")->GetNumber<int>(), 2);
+}
+
+TEST(JsonParser, TestDeepNesting) {
+  std::string text(1000, '[');
+  text.append(1000, ']');
+
+  auto json = kv::ParseJson(text);
+  auto depth = 0;
+  for (auto node = &json; !node->GetArray().empty(); node = node->GetArray()[0].get()) {
+    ++depth;
+  }
+  ASSERT_EQ(depth, 999);
+
+  std::string tooDeep(kv::JsonParser<const char *>::MaxDepth + 1, '[');
+  ASSERT_THROW(kv::ParseJson(tooDeep), kv::JsonParseException);
+}
+
+TEST(JsonParser, TestParseStream) {
+  std::istringstream input { R"([true, "x", 3.25])" };
+  auto json = kv::ParseJson(input);
+  ASSERT_EQ(json.GetArray().size(), 3);
+  ASSERT_EQ(json.GetArray()[2]->GetNumber(), 3.25);
+}
+
+TEST(JsonParser, TestArenaAllocator) {
+  kv::MonotonicArena arena;
+  auto json = kv::ParseJson(R"({"a": [1, 2, 3]})", kv::ObjectAllocator<kv::JsonObject> { arena });
+
+  const auto& child = json.GetMap().at("a");
+  ASSERT_EQ(child.get_deleter().GetAllocator().GetResource(), &arena);
+  ASSERT_EQ(child->GetArray()[0].get_deleter().GetAllocator().GetResource(), &arena);
+}
+
+TEST(JsonParser, TestErrorOffsets) {
+  ASSERT_EQ(GetErrorOffset(""), 0);
+  ASSERT_EQ(GetErrorOffset("[1, 2"), 5);
+  ASSERT_EQ(GetErrorOffset("[1 2]"), 3);
+  ASSERT_EQ(GetErrorOffset("{\"a\" 1}"), 5);
+  ASSERT_EQ(GetErrorOffset("{1: 2}"), 1);
+  ASSERT_EQ(GetErrorOffset("tru"), 0);
+  ASSERT_EQ(GetErrorOffset("01"), 1);
+  ASSERT_EQ(GetErrorOffset("1."), 0);
+  ASSERT_EQ(GetErrorOffset("\"abc"), 0);
+  ASSERT_EQ(GetErrorOffset("\"a\nb\""), 2);
+  ASSERT_EQ(GetErrorOffset("\"\\x\""), 1);
+  ASSERT_EQ(GetErrorOffset("\"\\ud800\""), 1);
+  ASSERT_EQ(GetErrorOffset("null x"), 5);
+  ASSERT_EQ(GetErrorOffset("1e999"), 0);
+}
+
+TEST(JsonParser, TestParseFlatMaps) {
+  constexpr const char* text = R"({"z": 1, "a": {"y": [], "b": null}, "m": "x", "z": 2})";
+  auto json = kv::ParseJson(text, kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Flat);
+  ASSERT_TRUE(json.IsFlatMap());
+  ASSERT_EQ(json, kv::ParseJson(text));
+
+  // Keys keep document order; a duplicate key keeps its first position and its last value.
+  const auto& map = json.GetFlatMap();
+  ASSERT_EQ(map.size(), 3);
+  auto it = map.begin();
+  ASSERT_EQ(it->first, "z");
+  ASSERT_EQ(it->second->GetNumber<int>(), 2);
+  ASSERT_EQ((++it)->first, "a");
+  ASSERT_TRUE(it->second->IsFlatMap());
+  ASSERT_EQ((++it)->first, "m");
+
+  std::string output;
+  kv::JsonSerializer<std::back_insert_iterator<std::string>> serializer { std::back_inserter(output) };
+  serializer.Serialize(json);
+  ASSERT_EQ(output, R"({"z":2,"a":{"y":[],"b":null},"m":"x"})");
+}
@@ -0,0 +1,130 @@
+#include "kv/Json/JsonPath.h"
+
+#include <string>
+#include <vector>
+
+#include "kv/Json/JsonParser.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr const char* Document = R"({
+  "spans": [
+    {"name": "a", "attrs": {"latency": 1, "a/b": 2, "m~n": 3, "*": 4}},
+    {"name": "b", "attrs": {"size": 5}},
+    {"name": "c", "attrs": {"latency": 6}}
+  ],
+  "": {"": 7},
+  "10": [8, 9]
+})";
+
+template <typename Node>
+std::vector<double> CollectNumbers(const kv::JsonPath& path, const Node& root) {
+  std::vector<double> numbers;
+  path.ForEach(root, [&numbers](const Node& node) {
+    numbers.push_back(node.GetNumber());
+  });
+  return numbers;
+}
+
+/**
+ * @brief Check that the specified paths give the same results on all representations of the document.
+ */
+void CheckAllRepresentations(const char* pointer, const std::vector<double>& expected) {
+  kv::JsonPath path { pointer };
+
+  for (auto storage : { kv::JsonMapStorage::Flat, kv::JsonMapStorage::Hashed }) {
+    auto json = kv::ParseJson(Document, kv::ObjectAllocator<kv::JsonObject> { }, storage);
+    ASSERT_EQ(CollectNumbers(path, json), expected) << pointer;
+    auto found = path.Find(json);
+    ASSERT_EQ(found != nullptr, !expected.empty()) << pointer;
+    if (found) {
+      ASSERT_EQ(found->GetNumber(), expected.front()) << pointer;
+    }
+  }
+
+  auto tape = kv::ParseJsonTape(Document);
+  ASSERT_EQ(CollectNumbers(path, tape.GetRoot()), expected) << pointer;
+  auto tapeFound = path.Find(tape.GetRoot());
+  ASSERT_EQ(tapeFound != nullptr, !expected.empty()) << pointer;
+
+  kv::JsonDocument document { Document };
+  ASSERT_EQ(CollectNumbers(path, document.GetRoot()), expected) << pointer;
+  auto documentFound = path.Find(document.GetRoot());
+  ASSERT_EQ(documentFound.has_value(), !expected.empty()) << pointer;
+  if (documentFound) {
+    ASSERT_EQ(documentFound->GetNumber(), expected.front()) << pointer;
+  }
+}
+
+} // namespace <anonymous>
+
+TEST(JsonPath, TestCompile) {
+  kv::JsonPath root { "" };
+  ASSERT_EQ(root.GetTokenCount(), 0);
+  ASSERT_FALSE(root.HasWildcards());
+  ASSERT_EQ(root.ToString(), "");
+
+  kv::JsonPath path { "/spans/*/attrs/a~1b/m~0n/~2/" };
+  ASSERT_EQ(path.GetTokenCount(), 7);
+  ASSERT_TRUE(path.HasWildcards());
+  ASSERT_EQ(path.ToString(), "/spans/*/attrs/a~1b/m~0n/~2/");
+
+  ASSERT_THROW(kv::JsonPath { "spans" }, kv::JsonParseException);
+  ASSERT_THROW(kv::JsonPath { "/a~" }, kv::JsonParseException);
+  ASSERT_THROW(kv::JsonPath { "/a~3" }, kv::JsonParseException);
+  try {
+    kv::JsonPath { "/ab/c~x" };
+    FAIL();
+  } catch (const kv::JsonParseException& ex) {
+    ASSERT_EQ(ex.GetOffset(), 5);
+  }
+}
+
+TEST(JsonPath, TestKeys) {
+  CheckAllRepresentations("/spans/0/attrs/latency", { 1 });
+  CheckAllRepresentations("/spans/0/attrs/a~1b", { 2 });
+  CheckAllRepresentations("/spans/0/attrs/m~0n", { 3 });
+  CheckAllRepresentations("/spans/0/attrs/~2", { 4 });
+  CheckAllRepresentations("//", { 7 });
+  CheckAllRepresentations("/spans/0/attrs/missing", { });
+  CheckAllRepresentations("/spans/0/name/latency", { });
+}
+
+TEST(JsonPath, TestIndices) {
+  CheckAllRepresentations("/10/1", { 9 });
+  CheckAllRepresentations("/spans/2/attrs/latency", { 6 });
+  CheckAllRepresentations("/spans/3/attrs/latency", { });
+  CheckAllRepresentations("/10/01", { });
+  CheckAllRepresentations("/10/-", { });
+  CheckAllRepresentations("/10/99999999999999999999999", { });
+}
+
+TEST(JsonPath, TestWildcards) {
+  CheckAllRepresentations("/spans/*/attrs/latency", { 1, 6 });
+  CheckAllRepresentations("/10/*", { 8, 9 });
+  CheckAllRepresentations("/*/", { 7 });
+  CheckAllRepresentations("/spans/*/attrs/*/x", { });
+
+  auto json = kv::ParseJson(Document, kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Flat);
+  kv::JsonPath attrs { "/spans/*/attrs/*" };
+  ASSERT_EQ(CollectNumbers(attrs, json), (std::vector<double> { 1, 2, 3, 4, 5, 6 }));
+}
+
+TEST(JsonPath, TestFindEach) {
+  auto first = kv::ParseJson(R"({"a": {"b": 1}})");
+  auto second = kv::ParseJson(R"({"a": []})");
+  auto third = kv::ParseJson(R"({"a": {"b": 3}})");
+
+  kv::JsonPath path { "/a/b" };
+  auto matches = path.FindEach<kv::JsonObject>({ &first, &second, nullptr, &third });
+  ASSERT_EQ(matches.size(), 4);
+  ASSERT_EQ(matches[0], &first.GetMap().at("a")->GetMap().at("b").operator*());
+  ASSERT_EQ(matches[1], nullptr);
+  ASSERT_EQ(matches[2], nullptr);
+  ASSERT_EQ(matches[3]->GetNumber(), 3);
+
+  kv::JsonPath root;
+  ASSERT_EQ(root.Find(first), &first);
+}
@@ -0,0 +1,185 @@
+#include "kv/Json/JsonReader.h"
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// Records every event as text, and returns the action configured for container starts and keys.
+class Recorder {
+public:
+  explicit Recorder() noexcept
+    : Log(),
+      SkipKey(),
+      SkipContainerAt(-1),
+      StopAt(-1),
+      _events(0)
+  { }
+
+  std::string Log;
+  std::string SkipKey;
+  int SkipContainerAt;
+  int StopAt;
+
+  kv::JsonReadAction VisitNull() {
+    return Record("n");
+  }
+
+  kv::JsonReadAction VisitBoolean(bool value) {
+    return Record(value ? "t" : "f");
+  }
+
+  kv::JsonReadAction VisitNumber(double value) {
+    return Record(std::to_string(static_cast<int>(value)));
+  }
+
+  kv::JsonReadAction VisitString(std::string_view value) {
+    return Record("'" + std::string { value } + "'");
+  }
+
+  kv::JsonReadAction VisitArray() {
+    return RecordContainer("[");
+  }
+
+  kv::JsonReadAction VisitArrayEnd() {
+    return Record("]");
+  }
+
+  kv::JsonReadAction VisitMap() {
+    return RecordContainer("{");
+  }
+
+  kv::JsonReadAction VisitKey(std::string_view key) {
+    auto action = Record(std::string { key } + ":");
+    return action == kv::JsonReadAction::Continue && key == SkipKey ? kv::JsonReadAction::Skip : action;
+  }
+
+  kv::JsonReadAction VisitMapEnd() {
+    return Record("}");
+  }
+
+private:
+  int _events;
+
+  kv::JsonReadAction Record(const std::string& event) {
+    Log += event;
+    Log += ' ';
+    return _events++ == StopAt ? kv::JsonReadAction::Stop : kv::JsonReadAction::Continue;
+  }
+
+  kv::JsonReadAction RecordContainer(const std::string& event) {
+    auto index = _events;
+    auto action = Record(event);
+    return action == kv::JsonReadAction::Continue && index == SkipContainerAt ? kv::JsonReadAction::Skip : action;
+  }
+}; // class Recorder
+
+// Handler whose methods return void and take ownership of strings.
+class Collector {
+public:
+  std::string Strings;
+  int Values = 0;
+
+  void VisitNull() { ++Values; }
+  void VisitBoolean(bool) { ++Values; }
+  void VisitNumber(double) { ++Values; }
+  void VisitString(std::string&& value) { ++Values; Strings += std::move(value); }
+  void VisitArray() { }
+  void VisitArrayEnd() { }
+  void VisitMap() { }
+  void VisitKey(std::string&& key) { Strings += std::move(key); }
+  void VisitMapEnd() { }
+}; // class Collector
+
+constexpr const char* Document = R"({"a": [1, {"b": null}], "c": "x", "d": {"e": [true, false]}, "f": 2})";
+
+} // namespace <anonymous>
+
+TEST(JsonReader, TestEvents) {
+  Recorder recorder;
+  ASSERT_TRUE(kv::ReadJson(Document, recorder));
+  ASSERT_EQ(recorder.Log, "{ a: [ 1 { b: n } ] c: 'x' d: { e: [ t f ] } f: 2 } ");
+}
+
+TEST(JsonReader, TestEmptyContainers) {
+  Recorder recorder;
+  ASSERT_TRUE(kv::ReadJson("[[], {}]", recorder));
+  ASSERT_EQ(recorder.Log, "[ [ ] { } ] ");
+}
+
+TEST(JsonReader, TestSkipContainer) {
+  Recorder recorder;
+  recorder.SkipContainerAt = 4;
+  ASSERT_TRUE(kv::ReadJson(Document, recorder));
+  ASSERT_EQ(recorder.Log, "{ a: [ 1 { ] c: 'x' d: { e: [ t f ] } f: 2 } ");
+
+  Recorder empty;
+  empty.SkipContainerAt = 1;
+  ASSERT_TRUE(kv::ReadJson("[{}, 1]", empty));
+  ASSERT_EQ(empty.Log, "[ { 1 ] ");
+
+  Recorder root;
+  root.SkipContainerAt = 0;
+  ASSERT_TRUE(kv::ReadJson(Document, root));
+  ASSERT_EQ(root.Log, "{ ");
+}
+
+TEST(JsonReader, TestSkipKey) {
+  Recorder container;
+  container.SkipKey = "d";
+  ASSERT_TRUE(kv::ReadJson(Document, container));
+  ASSERT_EQ(container.Log, "{ a: [ 1 { b: n } ] c: 'x' d: f: 2 } ");
+
+  Recorder scalar;
+  scalar.SkipKey = "c";
+  ASSERT_TRUE(kv::ReadJson(Document, scalar));
+  ASSERT_EQ(scalar.Log, "{ a: [ 1 { b: n } ] c: d: { e: [ t f ] } f: 2 } ");
+}
+
+TEST(JsonReader, TestStop) {
+  Recorder recorder;
+  recorder.StopAt = 5;
+  ASSERT_FALSE(kv::ReadJson(std::string { Document } + " trailing garbage", recorder));
+  ASSERT_EQ(recorder.Log, "{ a: [ 1 { b: ");
+
+  kv::JsonReader<const char *> reader { Document, Document + std::char_traits<char>::length(Document) };
+  Recorder stopAtStart;
+  stopAtStart.StopAt = 0;
+  ASSERT_FALSE(reader.Read(stopAtStart));
+  ASSERT_EQ(reader.GetOffset(), 1);
+}
+
+TEST(JsonReader, TestSkippedValuesAreValidated) {
+  Recorder recorder;
+  recorder.SkipKey = "a";
+  ASSERT_THROW(kv::ReadJson(R"({"a": [1, "\x"], "b": 2})", recorder), kv::JsonParseException);
+  ASSERT_THROW(kv::ReadJson(R"({"a": [1, 2}, "b": 2})", recorder), kv::JsonParseException);
+}
+
+TEST(JsonReader, TestVoidHandler) {
+  Collector collector;
+  std::istringstream input { Document };
+  ASSERT_TRUE(kv::ReadJson(input, collector));
+  ASSERT_EQ(collector.Values, 6);
+  ASSERT_EQ(collector.Strings, "abcxdef");
+}
+
+TEST(JsonReader, TestIndexedRead) {
+  std::string text = "[\n";
+  for (auto i = 0; i < 1000; ++i) {
+    text += "  { \"id\" : " + std::to_string(i) + " , \"tags\" : [ \"x\" , \"y\" ] } ,\n";
+  }
+  text += "  null\n]\n";
+  ASSERT_GE(text.size(), kv::MinIndexedJsonSize);
+
+  Collector indexed;
+  ASSERT_TRUE(kv::ReadJson(text, indexed));
+  Collector plain;
+  kv::JsonReader<const char *> reader { text.data(), text.data() + text.size() };
+  ASSERT_TRUE(reader.Read(plain));
+  ASSERT_EQ(indexed.Values, plain.Values);
+  ASSERT_EQ(indexed.Strings, plain.Strings);
+}
@@ -0,0 +1,165 @@
+#include "kv/Json/JsonScanner.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "kv/Json/JsonParser.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr kv::JsonScannerIsa AllIsas[] = {
+    kv::JsonScannerIsa::Scalar,
+    kv::JsonScannerIsa::Sse42,
+    kv::JsonScannerIsa::Avx2,
+    kv::JsonScannerIsa::Avx512,
+    kv::JsonScannerIsa::Neon,
+};
+
+// Byte-by-byte model of the structural index.
+std::vector<uint32_t> ScanReference(const std::string& text) {
+  std::vector<uint32_t> positions;
+  auto inString = false;
+  auto escapeNext = false;
+  auto inScalar = false;
+
+  for (size_t i = 0; i < text.size(); ++i) {
+    auto ch = text[i];
+    auto escaped = escapeNext;
+    escapeNext = ch == '\\' && !escaped;
+    auto quote = ch == '"' && !escaped;
+
+    if (inString) {
+      inString = !quote;
+      inScalar = false;
+    } else if (quote) {
+      positions.push_back(static_cast<uint32_t>(i));
+      inString = true;
+      inScalar = false;
+    } else if (ch == '{' || ch == '}' || ch == '[' || ch == ']' || ch == ':' || ch == ',') {
+      positions.push_back(static_cast<uint32_t>(i));
+      inScalar = false;
+    } else if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r') {
+      inScalar = false;
+    } else {
+      if (!inScalar) {
+        positions.push_back(static_cast<uint32_t>(i));
+      }
+      inScalar = true;
+    }
+  }
+  return positions;
+}
+
+void ExpectSameAsReference(const std::string& text) {
+  auto expected = ScanReference(text);
+  for (auto isa : AllIsas) {
+    if (!kv::IsJsonScannerIsaSupported(isa)) {
+      continue;
+    }
+    std::vector<uint32_t> positions;
+    kv::ScanJsonStructurals(text, positions, isa);
+    ASSERT_EQ(positions, expected) << kv::GetJsonScannerIsaName(isa) << " on " << text;
+  }
+}
+
+size_t GetErrorOffset(const std::string& text, bool indexed) {
+  std::vector<uint32_t> positions;
+  kv::JsonParser<const char *> parser { text.data(), text.data() + text.size() };
+  if (indexed) {
+    kv::ScanJsonStructurals(text, positions);
+    parser.SetStructuralIndex(positions.data(), positions.data() + positions.size());
+  }
+
+  try {
+    auto json = parser.Parse();
+  } catch (const kv::JsonParseException& ex) {
+    return ex.GetOffset();
+  }
+  ADD_FAILURE() << "no exception thrown for " << text;
+  return 0;
+}
+
+} // namespace <anonymous>
+
+TEST(JsonScanner, TestIsaSelection) {
+  ASSERT_TRUE(kv::IsJsonScannerIsaSupported(kv::JsonScannerIsa::Scalar));
+  ASSERT_TRUE(kv::IsJsonScannerIsaSupported(kv::GetJsonScannerIsa()));
+  ASSERT_STREQ(kv::GetJsonScannerIsaName(kv::JsonScannerIsa::Avx2), "avx2");
+}
+
+TEST(JsonScanner, TestScanDocument) {
+  std::vector<uint32_t> positions;
+  kv::ScanJsonStructurals(R"( {"a\"b": [12, true]} )", positions);
+  ASSERT_EQ(positions, (std::vector<uint32_t> { 1, 2, 8, 10, 11, 13, 15, 19, 20 }));
+
+  kv::ScanJsonStructurals("", positions);
+  ASSERT_TRUE(positions.empty());
+}
+
+TEST(JsonScanner, TestBlockBoundaries) {
+  for (size_t pad = 0; pad < 130; ++pad) {
+    // Backslash runs of both parities ending right before or across a block boundary.
+    for (size_t run = 1; run <= 4; ++run) {
+      ExpectSameAsReference(std::string(pad, ' ') + "\"" + std::string(run, '\\') + "\" , 1]");
+    }
+    // Strings and scalars spanning blocks.
+    ExpectSameAsReference(std::string(pad, ' ') + "[\"" + std::string(100, 'x') + "\", 123456789]");
+    ExpectSameAsReference(std::string(pad, '1') + ",2");
+  }
+}
+
+TEST(JsonScanner, TestRandomInput) {
+  const char alphabet[] = "{}[]:,\"\\ \t\na1";
+  std::mt19937 rng { 42 };
+  std::uniform_int_distribution<size_t> charDist { 0, sizeof(alphabet) - 2 };
+  std::uniform_int_distribution<size_t> sizeDist { 0, 300 };
+
+  for (auto i = 0; i < 2000; ++i) {
+    std::string text(sizeDist(rng), ' ');
+    for (auto& ch : text) {
+      ch = alphabet[charDist(rng)];
+    }
+    ExpectSameAsReference(text);
+  }
+}
+
+TEST(JsonScanner, TestIndexedParse) {
+  std::string text = "{\n";
+  for (auto i = 0; i < 500; ++i) {
+    text += "    \"key" + std::to_string(i) + "\" : [ " + std::to_string(i) + " , \"v\\\"" + std::to_string(i) +
+        "\" , null ] ,\n";
+  }
+  text += "    \"last\" : { }\n}\n";
+  ASSERT_GE(text.size(), kv::MinIndexedJsonSize);
+
+  auto indexed = kv::ParseJson(text);
+  kv::JsonParser<const char *> parser { text.data(), text.data() + text.size() };
+  ASSERT_EQ(indexed, parser.Parse());
+  ASSERT_EQ(indexed.GetMap().size(), 501);
+  ASSERT_EQ(indexed.GetMap().at("key7")->GetArray()[1]->GetString(), "v\"7");
+}
+
+TEST(JsonScanner, TestIndexedErrorOffsets) {
+  const char* cases[] = {
+      "",
+      "   ",
+      "[1,   2",
+      "[1   2]",
+      "{\"a\"   1}",
+      "{   1: 2}",
+      "   tru",
+      "[ \"abc   ",
+      "\"a\\\"   ",
+      "null   x",
+      "[1,   ]",
+      "  \\\"x\" ",
+      "[\"a\"   \"b\"]",
+  };
+  for (auto text : cases) {
+    ASSERT_EQ(GetErrorOffset(text, true), GetErrorOffset(text, false)) << text;
+  }
+}
@@ -0,0 +1,174 @@
+#include "kv/Json/JsonSerializer.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "kv/Json/JsonParser.h"
+#include "kv/Json/JsonSink.h"
+#include "kv/Support/MappedFile.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr const char* Document =
+    R"({"list": [1, true, false, null, "plain", "with \"quotes\"\n\tand escapes"], "nested": {"a": []}})";
+
+} // namespace <anonymous>
+
+TEST(JsonSerializer, TestSinksAgree) {
+  auto json = kv::ParseJson(Document, kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Flat);
+  auto expected = kv::SerializeJson(json);
+  ASSERT_EQ(expected, R"({"list":[1,true,false,null,"plain","with \"quotes\"\n\tand escapes"],"nested":{"a":[]}})");
+
+  std::string iterOutput;
+  kv::JsonSerializer<std::back_insert_iterator<std::string>> iterSerializer { std::back_inserter(iterOutput) };
+  iterSerializer.Serialize(json);
+  ASSERT_EQ(iterOutput, expected);
+
+  std::ostringstream stream;
+  kv::JsonSerializer<std::ostreambuf_iterator<char>> streamSerializer { std::ostreambuf_iterator<char> { stream } };
+  streamSerializer.Serialize(json);
+  ASSERT_EQ(stream.str(), expected);
+
+  // SerializeJson appends, so a reused string keeps its earlier content.
+  std::string appended = "x";
+  kv::SerializeJson(json, appended);
+  ASSERT_EQ(appended, "x" + expected);
+}
+
+TEST(JsonSerializer, TestEscapeRuns) {
+  ASSERT_EQ(kv::SerializeJson(kv::JsonObject { "" }), R"("")");
+  ASSERT_EQ(kv::SerializeJson(kv::JsonObject { "\"" }), R"("\"")");
+  ASSERT_EQ(kv::SerializeJson(kv::JsonObject { "ab\n\ncd\"" }), R"("ab\n\ncd\"")");
+  ASSERT_EQ(kv::SerializeJson(kv::JsonObject { "\tabc" }), R"("\tabc")");
+}
+
+TEST(JsonSerializer, TestEscapeAll) {
+  ASSERT_EQ(kv::SerializeJson(kv::JsonObject { "a\\b\b\f\r/" }), R"("a\\b\b\f\r/")");
+  ASSERT_EQ(kv::SerializeJson(kv::JsonObject { std::string { "\0\x01\x1f\x7f", 4 } }), "\"\\u0000\\u0001\\u001f\x7f\"");
+  // UTF-8 is copied verbatim.
+  ASSERT_EQ(kv::SerializeJson(kv::JsonObject { "\xC3\xA9\xE4\xB8\xAD" }), "\"\xC3\xA9\xE4\xB8\xAD\"");
+  // Keys are escaped as well.
+  auto map = kv::JsonObject::CreateMap();
+  map.GetMap().emplace("a\"b", kv::MakeJsonObject(nullptr));
+  ASSERT_EQ(kv::SerializeJson(map), R"({"a\"b":null})");
+
+  // Every byte value at every position around the 16-byte blocks survives a round trip.
+  for (auto ch = 0; ch < 256; ++ch) {
+    for (size_t position = 0; position < 40; position += 3) {
+      std::string s(40, 'x');
+      s[position] = static_cast<char>(ch);
+      auto serialized = kv::SerializeJson(kv::JsonObject { s });
+      ASSERT_EQ(kv::ParseJson(serialized).GetString(), s) << ch << " at " << position;
+    }
+  }
+}
+
+TEST(JsonSerializer, TestNumbers) {
+  constexpr auto Format = [](double value) {
+    return kv::SerializeJson(kv::JsonObject { value });
+  };
+
+  ASSERT_EQ(Format(0), "0");
+  ASSERT_EQ(Format(-0.0), "-0");
+  ASSERT_EQ(Format(42), "42");
+  ASSERT_EQ(Format(-7), "-7");
+  ASSERT_EQ(Format(0.1), "0.1");
+  ASSERT_EQ(Format(-2.5), "-2.5");
+  ASSERT_EQ(Format(9007199254740991.0), "9007199254740991");
+  ASSERT_EQ(Format(9007199254740992.0), "9007199254740992");
+  ASSERT_EQ(Format(1e21), "1e+21");
+  ASSERT_EQ(Format(5e-324), "5e-324");
+  ASSERT_EQ(Format(std::numeric_limits<double>::infinity()), "null");
+  ASSERT_EQ(Format(std::numeric_limits<double>::quiet_NaN()), "null");
+
+  // The shortest representation parses back to the same value.
+  std::mt19937_64 random { 42 };
+  for (auto i = 0; i < 10000; ++i) {
+    auto bits = random();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (!std::isfinite(value)) {
+      continue;
+    }
+    auto serialized = Format(value);
+    ASSERT_EQ(kv::ParseJson(serialized).GetNumber(), value) << serialized;
+  }
+}
+
+TEST(JsonSerializer, TestFileSink) {
+  char path[] = "/tmp/kv-json-serializer-XXXXXX";
+  auto fd = ::mkstemp(path);
+  ASSERT_GE(fd, 0);
+
+  auto json = kv::ParseJson(Document, kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Flat);
+  auto expected = kv::SerializeJson(json);
+  {
+    // A tiny buffer exercises both flushing and writing appends past the buffer.
+    kv::JsonFileSink sink { fd, 7 };
+    kv::JsonSerializer<kv::JsonFileSink> serializer { sink };
+    serializer.Serialize(json);
+    serializer.Serialize(json);
+    ASSERT_GT(sink.GetBytesWritten(), 0);
+    sink.Flush();
+    ASSERT_EQ(sink.GetBytesWritten(), expected.size() * 2);
+  }
+  ::close(fd);
+
+  kv::MappedFile file { path };
+  std::remove(path);
+  ASSERT_EQ(file.GetView(), expected + expected);
+}
+
+TEST(JsonSerializer, TestFileSinkError) {
+  // Writing to a descriptor opened for reading fails with EBADF.
+  auto fd = ::open("/dev/null", O_RDONLY);
+  ASSERT_GE(fd, 0);
+
+  kv::JsonFileSink sink { fd };
+  sink.Append("[]", 2);
+  ASSERT_THROW(sink.Flush(), std::system_error);
+  ::close(fd);
+}
+
+TEST(JsonSerializer, TestIterativeAgrees) {
+  for (auto storage : { kv::JsonMapStorage::Flat, kv::JsonMapStorage::Hashed }) {
+    auto json = kv::ParseJson(R"([{"a": [], "b": {}, "c": [{"d": [1, [2, {}]]}], "e": "f"}, [], [[]], null])",
+        kv::ObjectAllocator<kv::JsonObject> { }, storage);
+
+    std::string output;
+    kv::JsonStringSink sink { output };
+    kv::JsonSerializer<kv::JsonStringSink> serializer { sink };
+    serializer.SerializeIterative(json);
+    ASSERT_EQ(output, kv::SerializeJson(json));
+  }
+}
+
+TEST(JsonSerializer, TestDeepNesting) {
+  constexpr const size_t Depth = 300000;
+
+  auto root = kv::JsonObject::CreateArray();
+  auto tail = &root;
+  for (size_t i = 1; i < Depth; ++i) {
+    auto& array = tail->GetArray();
+    array.push_back(kv::MakeJsonObject(kv::JsonObject::CreateArray()));
+    tail = array.back().get();
+  }
+  tail->GetArray().push_back(kv::MakeJsonObject(0));
+
+  std::string output;
+  kv::JsonSerializer<std::back_insert_iterator<std::string>> serializer { std::back_inserter(output) };
+  serializer.SerializeIterative(root);
+  ASSERT_EQ(output, std::string(Depth, '[') + "0" + std::string(Depth, ']'));
+}
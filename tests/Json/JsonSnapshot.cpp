@@ -0,0 +1,320 @@
+#include "kv/Json/JsonSnapshot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include "kv/Json/JsonParser.h"
+#include "kv/Json/JsonSerializer.h"
+#include "kv/Json/JsonSink.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr std::string_view Document =
+    R"({"short": "twelve bytes", "long": "thirteen bytes", "n": 1.5, "flags": [true, false, null],)"
+    R"( "nested": {"list": [[], {}, ["a very long string spanning multiple tape nodes"]]}, "k": 1})";
+
+/**
+ * @brief A copy of a snapshot at an address aligned to 16 bytes, as a mapped file would be.
+ */
+class AlignedImage {
+public:
+  explicit AlignedImage(std::string_view bytes)
+    : _words(std::max<size_t>((bytes.size() + sizeof(Word) - 1) / sizeof(Word), 1)),
+      _size(bytes.size())
+  {
+    // An empty image still gets one word, so that even its view has an aligned, non-null address.
+    if (!bytes.empty()) {
+      std::memcpy(_words.data(), bytes.data(), bytes.size());
+    }
+  }
+
+  [[nodiscard]]
+  std::string_view GetView() const noexcept {
+    return std::string_view { reinterpret_cast<const char *>(_words.data()), _size };
+  }
+
+  [[nodiscard]]
+  char* GetData() noexcept {
+    return reinterpret_cast<char *>(_words.data());
+  }
+
+private:
+  struct alignas(16) Word {
+    char bytes[16];
+  };
+
+  std::vector<Word> _words;
+  size_t _size;
+}; // class AlignedImage
+
+template <typename Node>
+std::string Serialize(const Node& node) {
+  std::string output;
+  kv::JsonSerializer<std::back_insert_iterator<std::string>> serializer { std::back_inserter(output) };
+  serializer.Serialize(node);
+  return output;
+}
+
+std::string MakeIndexSnapshot(size_t count) {
+  std::string image;
+  kv::JsonStringSink sink { image };
+  kv::JsonSnapshotWriter<kv::JsonStringSink> writer { sink };
+  writer.BeginIndex("users");
+  for (size_t i = 0; i < count; ++i) {
+    auto record = kv::JsonObject::CreateMap();
+    record.GetMap().emplace("id", kv::MakeObject<kv::JsonObject>(kv::ObjectAllocator<kv::JsonObject> { }, i));
+    record.GetMap().emplace("name", kv::MakeObject<kv::JsonObject>(kv::ObjectAllocator<kv::JsonObject> { },
+                                                                   "a name longer than twelve bytes " +
+                                                                   std::to_string(i)));
+    writer.AddEntry("user-" + std::to_string(i), record);
+  }
+  writer.EndIndex();
+  writer.BeginIndex("empty");
+  writer.EndIndex();
+  writer.Finish();
+  EXPECT_EQ(writer.GetBytesWritten(), image.size());
+  return image;
+}
+
+} // namespace <anonymous>
+
+TEST(JsonSnapshot, TestDocuments) {
+  auto json = kv::ParseJson(Document);
+  auto tape = kv::ParseJsonTape(Document);
+
+  std::string image;
+  kv::JsonStringSink sink { image };
+  kv::JsonSnapshotWriter<kv::JsonStringSink> writer { sink };
+  writer.WriteDocument("tree", json);
+  writer.WriteDocument("tape", tape.GetRoot());
+  writer.WriteDocument("scalar", kv::JsonObject { "a string longer than twelve bytes" });
+  writer.Finish();
+  ASSERT_EQ(image.size() % 16, 0);
+
+  AlignedImage aligned { image };
+  kv::JsonSnapshot snapshot { aligned.GetView() };
+  ASSERT_EQ(snapshot.GetSectionCount(), 3);
+  ASSERT_TRUE(snapshot.Verify());
+
+  auto section = snapshot.GetSection(1);
+  ASSERT_EQ(section.name, "tape");
+  ASSERT_EQ(section.kind, kv::JsonSnapshotSectionKind::Document);
+  ASSERT_EQ(section.size, tape.GetByteSize());
+  ASSERT_EQ(snapshot.FindSection("scalar"), 2);
+  ASSERT_FALSE(snapshot.FindSection("missing").has_value());
+
+  // A tree encodes to the same nodes as the tape parsed from the same text, up to the order of map entries.
+  auto tree = snapshot.FindDocument("tree");
+  ASSERT_NE(tree, nullptr);
+  ASSERT_EQ(tree->GetSpan(), tape.GetNodeCount());
+  ASSERT_EQ(kv::ParseJson(Serialize(*tree)), json);
+  ASSERT_EQ(kv::ToJsonObject(*tree), json);
+  ASSERT_EQ(std::memcmp(snapshot.FindDocument("tape"), &tape.GetRoot(), tape.GetByteSize()), 0);
+  ASSERT_EQ(snapshot.FindDocument("scalar")->GetString(), "a string longer than twelve bytes");
+
+  ASSERT_EQ(snapshot.FindDocument("missing"), nullptr);
+  ASSERT_FALSE(snapshot.FindIndex("tree").has_value());
+}
+
+TEST(JsonSnapshot, TestIndex) {
+  constexpr size_t Count = 1000;
+  AlignedImage aligned { MakeIndexSnapshot(Count) };
+  kv::JsonSnapshot snapshot { aligned.GetView() };
+  ASSERT_TRUE(snapshot.Verify());
+
+  auto index = snapshot.FindIndex("users");
+  ASSERT_TRUE(index.has_value());
+  ASSERT_EQ(index->size(), Count);
+  for (size_t i = 0; i < Count; ++i) {
+    auto value = index->Find("user-" + std::to_string(i));
+    ASSERT_NE(value, nullptr) << i;
+    ASSERT_EQ(value->GetMap().At("id").GetNumber<size_t>(), i);
+  }
+  ASSERT_EQ(index->Find("user-1000"), nullptr);
+  ASSERT_EQ(index->Find(""), nullptr);
+
+  size_t visited = 0;
+  index->ForEach([&visited](std::string_view key, const kv::JsonTapeNode& value) {
+    ASSERT_EQ(key, "user-" + std::to_string(visited));
+    ASSERT_EQ(value.GetMap().At("id").GetNumber<size_t>(), visited);
+    ++visited;
+  });
+  ASSERT_EQ(visited, Count);
+
+  auto empty = snapshot.FindIndex("empty");
+  ASSERT_TRUE(empty.has_value());
+  ASSERT_TRUE(empty->empty());
+  ASSERT_EQ(empty->Find("user-1"), nullptr);
+}
+
+TEST(JsonSnapshot, TestDuplicateKeys) {
+  std::string image;
+  kv::JsonStringSink sink { image };
+  kv::JsonSnapshotWriter<kv::JsonStringSink> writer { sink };
+  writer.BeginIndex("index");
+  writer.AddEntry("key", kv::JsonObject { 1 });
+  writer.AddEntry("key", kv::ParseJsonTape("2").GetRoot());
+  writer.EndIndex();
+  writer.Finish();
+
+  AlignedImage aligned { image };
+  kv::JsonSnapshot snapshot { aligned.GetView() };
+  auto index = snapshot.FindIndex("index");
+  ASSERT_EQ(index->size(), 2);
+  ASSERT_EQ(index->Find("key")->GetNumber(), 1);
+}
+
+TEST(JsonSnapshot, TestDeepTree) {
+  // Deeper than the parser accepts, so the tree is built directly.
+  constexpr size_t Depth = 100000;
+  auto json = kv::JsonObject::CreateArray();
+  auto tail = &json;
+  for (size_t i = 1; i < Depth; ++i) {
+    auto child = kv::MakeJsonObject(kv::JsonObject::CreateArray());
+    auto next = child.get();
+    tail->GetArray().push_back(std::move(child));
+    tail = next;
+  }
+
+  std::string image;
+  kv::JsonStringSink sink { image };
+  kv::JsonSnapshotWriter<kv::JsonStringSink> writer { sink };
+  writer.WriteDocument("deep", json);
+  writer.Finish();
+
+  AlignedImage aligned { image };
+  kv::JsonSnapshot snapshot { aligned.GetView() };
+  auto root = snapshot.FindDocument("deep");
+  for (size_t i = 0; i < Depth; ++i) {
+    ASSERT_EQ(root[i].GetSpan(), Depth - i) << i;
+    ASSERT_EQ(root[i].GetArray().size(), i + 1 < Depth ? 1 : 0) << i;
+  }
+
+  // Decoding and encoding again gives the same nodes.
+  auto decoded = kv::ToJsonObject(*root);
+  std::string copy;
+  kv::JsonStringSink copySink { copy };
+  kv::JsonSnapshotWriter<kv::JsonStringSink> copyWriter { copySink };
+  copyWriter.WriteDocument("deep", decoded);
+  copyWriter.Finish();
+  ASSERT_EQ(copy, image);
+}
+
+TEST(JsonSnapshot, TestOutputIterator) {
+  auto json = kv::ParseJson(Document);
+  std::string expected;
+  {
+    kv::JsonStringSink sink { expected };
+    kv::JsonSnapshotWriter<kv::JsonStringSink> writer { sink };
+    writer.WriteDocument("doc", json);
+    writer.Finish();
+  }
+
+  std::string image;
+  kv::JsonSnapshotWriter<std::back_insert_iterator<std::string>> writer { std::back_inserter(image) };
+  writer.WriteDocument("doc", json);
+  writer.Finish();
+  ASSERT_EQ(image, expected);
+}
+
+TEST(JsonSnapshot, TestFile) {
+  char path[] = "/tmp/kv-json-snapshot-XXXXXX";
+  auto fd = ::mkstemp(path);
+  ASSERT_GE(fd, 0);
+
+  auto json = kv::ParseJson(Document);
+  uint64_t size;
+  {
+    // A tiny buffer makes the writer stream the sections through many flushes.
+    kv::JsonFileSink sink { fd, 7 };
+    kv::JsonSnapshotWriter<kv::JsonFileSink> writer { sink };
+    writer.WriteDocument("doc", json);
+    writer.BeginIndex("index");
+    writer.AddEntry("doc", json);
+    writer.EndIndex();
+    writer.Finish();
+    sink.Flush();
+    size = writer.GetBytesWritten();
+  }
+  ::close(fd);
+
+  kv::JsonSnapshot snapshot { path };
+  std::remove(path);
+  ASSERT_EQ(snapshot.GetSectionCount(), 2);
+  ASSERT_EQ(snapshot.GetSection(1).offset + snapshot.GetSection(1).size + 2 * 64 + 32, size);
+  ASSERT_TRUE(snapshot.Verify());
+  ASSERT_EQ(kv::ToJsonObject(*snapshot.FindDocument("doc")), json);
+  ASSERT_EQ(kv::ToJsonObject(*snapshot.FindIndex("index")->Find("doc")), json);
+
+  // The values stay valid when the snapshot is moved.
+  auto moved = std::move(snapshot);
+  ASSERT_EQ(kv::ToJsonObject(*moved.FindDocument("doc")), json);
+}
+
+TEST(JsonSnapshot, TestCorruption) {
+  auto image = MakeIndexSnapshot(10);
+
+  {
+    // Corrupting a value is detected by the checksum of its section only.
+    AlignedImage aligned { image };
+    aligned.GetData()[32 + 20] ^= 1;
+    kv::JsonSnapshot snapshot { aligned.GetView() };
+    ASSERT_FALSE(snapshot.VerifySection(0));
+    ASSERT_TRUE(snapshot.VerifySection(1));
+    ASSERT_FALSE(snapshot.Verify());
+  }
+
+  {
+    AlignedImage aligned { image };
+    aligned.GetData()[0] = 'X';
+    ASSERT_THROW(kv::JsonSnapshot { aligned.GetView() }, kv::JsonParseException);
+  }
+
+  {
+    // The section table is checked when the snapshot is opened.
+    AlignedImage aligned { image };
+    aligned.GetData()[image.size() - 32 - 64 + 8] ^= 1;
+    ASSERT_THROW(kv::JsonSnapshot { aligned.GetView() }, kv::JsonParseException);
+  }
+
+  for (auto size : { static_cast<size_t>(0), static_cast<size_t>(16), image.size() / 2, image.size() - 16 }) {
+    AlignedImage aligned { std::string_view { image }.substr(0, size) };
+    ASSERT_THROW(kv::JsonSnapshot { aligned.GetView() }, kv::JsonParseException) << size;
+  }
+
+  AlignedImage aligned { image + " " };
+  ASSERT_THROW(kv::JsonSnapshot { aligned.GetView().substr(1) }, std::invalid_argument);
+}
+
+TEST(JsonSnapshot, TestWriterMisuse) {
+  std::string image;
+  kv::JsonStringSink sink { image };
+  kv::JsonSnapshotWriter<kv::JsonStringSink> writer { sink };
+  ASSERT_THROW(writer.AddEntry("key", kv::JsonObject { 1 }), std::logic_error);
+  ASSERT_THROW(writer.EndIndex(), std::logic_error);
+  ASSERT_THROW(writer.WriteDocument(std::string(33, 'n'), kv::JsonObject { 1 }), std::invalid_argument);
+
+  writer.BeginIndex(std::string(32, 'n'));
+  ASSERT_THROW(writer.WriteDocument("doc", kv::JsonObject { 1 }), std::logic_error);
+  ASSERT_THROW(writer.BeginIndex("index"), std::logic_error);
+  ASSERT_THROW(writer.Finish(), std::logic_error);
+  writer.EndIndex();
+
+  writer.Finish();
+  ASSERT_THROW(writer.WriteDocument("doc", kv::JsonObject { 1 }), std::logic_error);
+  ASSERT_THROW(writer.Finish(), std::logic_error);
+
+  AlignedImage aligned { image };
+  kv::JsonSnapshot snapshot { aligned.GetView() };
+  ASSERT_EQ(snapshot.GetSection(0).name, std::string(32, 'n'));
+}
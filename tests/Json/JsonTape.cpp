@@ -0,0 +1,124 @@
+#include "kv/Json/JsonTape.h"
+
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "kv/Json/JsonParser.h"
+#include "kv/Json/JsonSerializer.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr std::string_view Document =
+    R"({"short": "twelve bytes", "long": "thirteen bytes", "n": 1.5, "flags": [true, false, null],)"
+    R"( "nested": {"list": [[], {}, ["a very long string spanning multiple tape nodes"]]}, "k": 1, "k": 2})";
+
+template <typename Node>
+std::string Serialize(const Node& node) {
+  std::string output;
+  kv::JsonSerializer<std::back_insert_iterator<std::string>> serializer { std::back_inserter(output) };
+  serializer.Serialize(node);
+  return output;
+}
+
+} // namespace <anonymous>
+
+TEST(JsonTape, TestScalars) {
+  auto tape = kv::ParseJsonTape(Document);
+  const auto& root = tape.GetRoot();
+  ASSERT_TRUE(root.IsMap());
+
+  auto map = root.GetMap();
+  ASSERT_EQ(map.At("short").GetString(), "twelve bytes");
+  ASSERT_EQ(map.At("long").GetString(), "thirteen bytes");
+  ASSERT_EQ(map.At("n").GetNumber(), 1.5);
+  ASSERT_EQ(map.At("n").GetNumber<int>(), 1);
+
+  auto flags = map.At("flags").GetArray();
+  ASSERT_EQ(flags.size(), 3);
+  auto it = flags.begin();
+  ASSERT_TRUE((*it++)->GetBoolean());
+  ASSERT_FALSE((*it++)->GetBoolean());
+  ASSERT_TRUE((*it++)->IsNull());
+  ASSERT_EQ(it, flags.end());
+
+  ASSERT_EQ(map.Find("missing"), nullptr);
+  ASSERT_THROW((void)map.At("missing"), kv::JsonException);
+  ASSERT_THROW((void)map.At("n").GetString(), kv::JsonException);
+}
+
+TEST(JsonTape, TestNesting) {
+  auto tape = kv::ParseJsonTape(Document);
+  auto list = tape.GetRoot().GetMap().At("nested").GetMap().At("list").GetArray();
+  ASSERT_EQ(list.size(), 3);
+
+  std::vector<const kv::JsonTapeNode *> elements(list.begin(), list.end());
+  ASSERT_TRUE(elements[0]->GetArray().empty());
+  ASSERT_TRUE(elements[1]->GetMap().empty());
+  ASSERT_EQ((*elements[2]->GetArray().begin())->GetString(), "a very long string spanning multiple tape nodes");
+}
+
+TEST(JsonTape, TestStringBoundaries) {
+  for (size_t size = 0; size < 70; ++size) {
+    std::string s(size, 'x');
+    auto tape = kv::ParseJsonTape("[\"" + s + "\", 7]");
+    auto arr = tape.GetRoot().GetArray();
+    auto it = arr.begin();
+    ASSERT_EQ((*it++)->GetString(), s);
+    ASSERT_EQ((*it++)->GetNumber<int>(), 7);
+    ASSERT_EQ(it, arr.end());
+  }
+}
+
+TEST(JsonTape, TestDuplicateKeys) {
+  auto tape = kv::ParseJsonTape(Document);
+  auto map = tape.GetRoot().GetMap();
+  ASSERT_EQ(map.size(), 7);
+  ASSERT_EQ(map.At("k").GetNumber<int>(), 2);
+}
+
+TEST(JsonTape, TestSerialize) {
+  auto tape = kv::ParseJsonTape(Document);
+  auto json = kv::ParseJson(Document);
+  ASSERT_EQ(kv::ParseJson(Serialize(tape.GetRoot())), json);
+  ASSERT_EQ(Serialize(kv::ParseJsonTape("[1,\"a\",[true,null],{}]").GetRoot()), Serialize(kv::ParseJson("[1,\"a\",[true,null],{}]")));
+}
+
+TEST(JsonTape, TestCompactSize) {
+  std::string text = "[";
+  for (auto i = 0; i < 1000; ++i) {
+    text += "{\"id\":" + std::to_string(i) + ",\"ok\":true},";
+  }
+  text += "null]";
+
+  auto tape = kv::ParseJsonTape(text);
+  // One array, and a map, two keys and two values per element.
+  ASSERT_EQ(tape.GetNodeCount(), 1 + 1000 * 5 + 1);
+  ASSERT_EQ(tape.GetByteSize(), tape.GetNodeCount() * sizeof(kv::JsonTapeNode));
+}
+
+TEST(JsonTape, TestParseStream) {
+  std::istringstream input { R"([1, 2, "three"])" };
+  auto tape = kv::ParseJsonTape(input);
+  ASSERT_EQ(tape.GetRoot().GetArray().size(), 3);
+  ASSERT_THROW((void)kv::ParseJsonTape("[1, 2"), kv::JsonParseException);
+}
+
+TEST(JsonTape, TestToJsonObject) {
+  auto tape = kv::ParseJsonTape(Document);
+  auto json = kv::ParseJson(Document);
+  ASSERT_EQ(kv::ToJsonObject(tape.GetRoot()), json);
+
+  auto flat = kv::ToJsonObject(tape.GetRoot(), kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Flat);
+  ASSERT_TRUE(flat.IsFlatMap());
+  ASSERT_EQ(flat.GetFlatMap().at("k")->GetNumber(), 2);
+  ASSERT_EQ(flat.GetFlatMap().at("nested")->GetFlatMap().at("list")->GetArray().size(), 3);
+
+  auto scalar = kv::ParseJsonTape("\"a string longer than twelve bytes\"");
+  ASSERT_EQ(kv::ToJsonObject(scalar.GetRoot()).GetString(), "a string longer than twelve bytes");
+  ASSERT_TRUE(kv::ToJsonObject(kv::ParseJsonTape("[]").GetRoot()).GetArray().empty());
+}
@@ -0,0 +1,137 @@
+#include "kv/Json/JsonTraversal.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "kv/Json/JsonParser.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+constexpr const char* Document = R"({"a": [1, "x", {"b": null}], "c": {}, "d": true})";
+
+/**
+ * @brief Describe a node by its key or scalar value, such as `a` or `1`.
+ */
+std::string Describe(const kv::JsonObject& node, const std::string* key) {
+  std::string description = key ? *key + "=" : "";
+  switch (node.GetType()) {
+    case kv::JsonObjectType::Null:
+      return description + "null";
+    case kv::JsonObjectType::Boolean:
+      return description + (node.GetBoolean() ? "true" : "false");
+    case kv::JsonObjectType::Number:
+      return description + std::to_string(node.GetNumber<int>());
+    case kv::JsonObjectType::String:
+      return description + node.GetString();
+    case kv::JsonObjectType::Array:
+      return description + "[]";
+    default:
+      return description + "{}";
+  }
+}
+
+template <typename Range>
+std::vector<std::string> Collect(Range range) {
+  std::vector<std::string> nodes;
+  for (auto it = range.begin(); it != range.end(); ++it) {
+    nodes.push_back(Describe(*it, it.GetKey()) + "@" + std::to_string(it.GetDepth()));
+  }
+  return nodes;
+}
+
+} // namespace <anonymous>
+
+TEST(JsonTraversal, TestWalker) {
+  auto json = kv::ParseJson(R"([1, {"a": []}])", kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Flat);
+
+  std::vector<std::pair<kv::JsonWalkEvent, size_t>> events;
+  for (kv::JsonTreeWalker walker { json }; !walker.IsDone(); walker.Next()) {
+    events.emplace_back(walker.GetEvent(), walker.GetIndex());
+  }
+
+  std::vector<std::pair<kv::JsonWalkEvent, size_t>> expected = {
+    { kv::JsonWalkEvent::Enter, 0 },
+    { kv::JsonWalkEvent::Value, 0 },
+    { kv::JsonWalkEvent::Enter, 1 },
+    { kv::JsonWalkEvent::Enter, 0 },
+    { kv::JsonWalkEvent::Leave, 0 },
+    { kv::JsonWalkEvent::Leave, 1 },
+    { kv::JsonWalkEvent::Leave, 0 },
+  };
+  ASSERT_EQ(events, expected);
+
+  kv::JsonTreeWalker done;
+  ASSERT_TRUE(done.IsDone());
+
+  kv::JsonObject scalar { 1 };
+  kv::JsonTreeWalker walker { scalar };
+  ASSERT_EQ(walker.GetEvent(), kv::JsonWalkEvent::Value);
+  ASSERT_EQ(&walker.GetNode(), &scalar);
+  ASSERT_EQ(walker.GetKey(), nullptr);
+  walker.Next();
+  ASSERT_TRUE(walker.IsDone());
+}
+
+TEST(JsonTraversal, TestPreOrder) {
+  auto json = kv::ParseJson(Document, kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Flat);
+  std::vector<std::string> expected = {
+    "{}@0", "a=[]@1", "1@2", "x@2", "{}@2", "b=null@3", "c={}@1", "d=true@1",
+  };
+  ASSERT_EQ(Collect(kv::TraversePreOrder(json)), expected);
+}
+
+TEST(JsonTraversal, TestPostOrder) {
+  auto json = kv::ParseJson(Document, kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Flat);
+  std::vector<std::string> expected = {
+    "1@2", "x@2", "b=null@3", "{}@2", "a=[]@1", "c={}@1", "d=true@1", "{}@0",
+  };
+  ASSERT_EQ(Collect(kv::TraversePostOrder(json)), expected);
+}
+
+TEST(JsonTraversal, TestHashedMap) {
+  auto json = kv::ParseJson(Document, kv::ObjectAllocator<kv::JsonObject> { }, kv::JsonMapStorage::Hashed);
+
+  // Entries of hashed maps come in unspecified order, so only the set of nodes and their depths is checked.
+  auto preOrder = Collect(kv::TraversePreOrder(json));
+  auto postOrder = Collect(kv::TraversePostOrder(json));
+  ASSERT_EQ(preOrder.size(), 8);
+  ASSERT_EQ(preOrder.front(), "{}@0");
+  ASSERT_EQ(postOrder.back(), "{}@0");
+  std::sort(preOrder.begin(), preOrder.end());
+  std::sort(postOrder.begin(), postOrder.end());
+  ASSERT_EQ(preOrder, postOrder);
+
+  size_t count = 0;
+  for (const auto& node : kv::TraversePreOrder(json)) {
+    static_cast<void>(node);
+    ++count;
+  }
+  ASSERT_EQ(count, 8);
+}
+
+TEST(JsonTraversal, TestDeepNesting) {
+  constexpr const size_t Depth = 300000;
+
+  auto root = kv::JsonObject::CreateMap(kv::JsonMapStorage::Flat);
+  auto tail = &root;
+  for (size_t i = 1; i < Depth; ++i) {
+    auto child = kv::MakeJsonObject(kv::JsonObject::CreateMap(kv::JsonMapStorage::Flat));
+    auto next = child.get();
+    tail->GetFlatMap().emplace("k", std::move(child));
+    tail = next;
+  }
+
+  size_t count = 0;
+  size_t maxDepth = 0;
+  auto range = kv::TraversePostOrder(root);
+  for (auto it = range.begin(); it != range.end(); ++it) {
+    maxDepth = std::max(maxDepth, it.GetDepth());
+    ++count;
+  }
+  ASSERT_EQ(count, Depth);
+  ASSERT_EQ(maxDepth, Depth - 1);
+}
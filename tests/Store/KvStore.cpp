@@ -0,0 +1,258 @@
+#include "kv/Store/KvStore.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "kv/Json/JsonParser.h"
+#include "kv/Json/JsonSink.h"
+
+#include "gtest/gtest.h"
+
+TEST(KvStore, TestPutGetDelete) {
+  kv::KvStore store;
+  ASSERT_EQ(store.GetSize(), 0);
+  ASSERT_FALSE(store.Contains("answer"));
+  ASSERT_FALSE(store.Get("answer").has_value());
+
+  ASSERT_TRUE(store.Put("answer", kv::JsonObject { 42 }));
+  ASSERT_EQ(store.GetSize(), 1);
+  ASSERT_TRUE(store.Contains("answer"));
+  auto value = store.Get("answer");
+  ASSERT_TRUE(value.has_value());
+  ASSERT_EQ(value->GetNumber(), 42);
+
+  ASSERT_FALSE(store.Put("answer", kv::JsonObject { "forty-two" }));
+  ASSERT_EQ(store.GetSize(), 1);
+  ASSERT_TRUE(store.Get("answer", [](const kv::JsonObject& value) {
+    ASSERT_EQ(value.GetString(), "forty-two");
+  }));
+
+  ASSERT_FALSE(store.Delete("question"));
+  ASSERT_TRUE(store.Delete("answer"));
+  ASSERT_FALSE(store.Delete("answer"));
+  ASSERT_EQ(store.GetSize(), 0);
+  ASSERT_FALSE(store.Contains("answer"));
+}
+
+TEST(KvStore, TestShardCount) {
+  kv::KvStoreOptions options;
+  options.shards = 5;
+  kv::KvStore store { options };
+  ASSERT_EQ(store.GetShardCount(), 8);
+
+  options.shards = 0;
+  kv::KvStore single { options };
+  ASSERT_EQ(single.GetShardCount(), 1);
+}
+
+TEST(KvStore, TestManyKeys) {
+  kv::KvStoreOptions options;
+  options.shards = 4;
+  options.initialCapacity = 4;
+  kv::KvStore store { options };
+
+  constexpr size_t Count = 10000;
+  for (size_t i = 0; i < Count; ++i) {
+    ASSERT_TRUE(store.Put("key-" + std::to_string(i), kv::JsonObject { i }));
+  }
+  ASSERT_EQ(store.GetSize(), Count);
+
+  // Deleting every other key shifts the probe sequences of the remaining keys back.
+  for (size_t i = 0; i < Count; i += 2) {
+    ASSERT_TRUE(store.Delete("key-" + std::to_string(i)));
+  }
+  ASSERT_EQ(store.GetSize(), Count / 2);
+
+  for (size_t i = 0; i < Count; ++i) {
+    auto value = store.Get("key-" + std::to_string(i));
+    if (i % 2 == 0) {
+      ASSERT_FALSE(value.has_value()) << i;
+    } else {
+      ASSERT_TRUE(value.has_value()) << i;
+      ASSERT_EQ(value->GetNumber(), static_cast<double>(i));
+    }
+  }
+
+  store.Clear();
+  ASSERT_EQ(store.GetSize(), 0);
+  ASSERT_FALSE(store.Contains("key-1"));
+  ASSERT_TRUE(store.Put("key-1", kv::JsonObject { true }));
+  ASSERT_TRUE(store.Get("key-1")->GetBoolean());
+}
+
+TEST(KvStore, TestLongKeys) {
+  kv::KvStore store;
+  std::string key1(1000, 'a');
+  std::string key2(1000, 'a');
+  key2.back() = 'b';
+
+  ASSERT_TRUE(store.Put(key1, kv::JsonObject { 1 }));
+  ASSERT_TRUE(store.Put(key2, kv::JsonObject { 2 }));
+  ASSERT_TRUE(store.Put("", kv::JsonObject { 3 }));
+  ASSERT_EQ(store.Get(key1)->GetNumber(), 1);
+  ASSERT_EQ(store.Get(key2)->GetNumber(), 2);
+  ASSERT_EQ(store.Get("")->GetNumber(), 3);
+
+  ASSERT_TRUE(store.Delete(key1));
+  ASSERT_FALSE(store.Contains(key1));
+  ASSERT_TRUE(store.Contains(key2));
+}
+
+TEST(KvStore, TestNestedValues) {
+  kv::KvStore store;
+  auto allocator = store.GetNodeAllocator();
+  auto value = kv::JsonObject::CreateMap();
+  auto tags = kv::MakeObject<kv::JsonObject>(allocator, kv::JsonObject::CreateArray());
+  tags->GetArray().push_back(kv::MakeObject<kv::JsonObject>(allocator, "red"));
+  value.GetMap().emplace("tags", std::move(tags));
+  ASSERT_TRUE(store.Put("record", std::move(value)));
+
+  // Get returns a deep copy, which outlives the entry.
+  auto copy = store.Get("record");
+  ASSERT_TRUE(store.Delete("record"));
+  ASSERT_TRUE(copy.has_value());
+  ASSERT_EQ(copy->GetMap().at("tags")->GetArray().at(0)->GetString(), "red");
+}
+
+TEST(KvStore, TestMultiGet) {
+  kv::KvStoreOptions options;
+  options.shards = 4;
+  kv::KvStore store { options };
+  for (size_t i = 0; i < 100; ++i) {
+    ASSERT_TRUE(store.Put("key-" + std::to_string(i), kv::JsonObject { i }));
+  }
+
+  std::vector<std::string> names;
+  for (size_t i = 0; i < 200; i += 3) {
+    names.push_back("key-" + std::to_string(i));
+  }
+  std::vector<std::string_view> keys(names.begin(), names.end());
+
+  std::vector<double> values(keys.size(), -1);
+  auto found = store.MultiGet(keys, [&values](size_t position, const kv::JsonObject& value) {
+    values[position] = value.GetNumber();
+  });
+  ASSERT_EQ(found, 34);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto expected = i * 3 < 100 ? static_cast<double>(i * 3) : -1.0;
+    ASSERT_EQ(values[i], expected) << keys[i];
+  }
+
+  ASSERT_EQ(store.MultiGet({ }, [](size_t, const kv::JsonObject &) { }), 0);
+}
+
+TEST(KvStore, TestConcurrentReadersAndWriters) {
+  kv::KvStoreOptions options;
+  options.shards = 8;
+  options.initialCapacity = 16;
+  kv::KvStore store { options };
+
+  constexpr size_t Keys = 512;
+  constexpr size_t Rounds = 20;
+  for (size_t i = 0; i < Keys; ++i) {
+    store.Put("key-" + std::to_string(i), kv::JsonObject { 0 });
+  }
+
+  std::atomic<bool> done { false };
+  std::atomic<size_t> mismatches { 0 };
+  std::vector<std::thread> readers;
+  for (size_t t = 0; t < 3; ++t) {
+    readers.emplace_back([&store, &done, &mismatches, t]() {
+      std::vector<std::string> names;
+      for (size_t i = t; i < Keys; i += 7) {
+        names.push_back("key-" + std::to_string(i));
+      }
+      std::vector<std::string_view> keys(names.begin(), names.end());
+      while (!done.load(std::memory_order_relaxed)) {
+        store.MultiGet(keys, [&mismatches](size_t, const kv::JsonObject& value) {
+          // Writers only ever store numbers.
+          if (!value.IsNumber()) {
+            mismatches.fetch_add(1, std::memory_order_relaxed);
+          }
+        });
+        store.Get(names.front(), [&mismatches](const kv::JsonObject& value) {
+          if (!value.IsNumber()) {
+            mismatches.fetch_add(1, std::memory_order_relaxed);
+          }
+        });
+      }
+    });
+  }
+
+  std::vector<std::thread> writers;
+  for (size_t t = 0; t < 2; ++t) {
+    writers.emplace_back([&store, t]() {
+      for (size_t round = 1; round <= Rounds; ++round) {
+        for (size_t i = t; i < Keys; i += 2) {
+          auto key = "key-" + std::to_string(i);
+          if (round % 4 == 1 && i % 8 == t) {
+            store.Delete(key);
+          } else {
+            store.Put(key, kv::JsonObject { round });
+          }
+        }
+      }
+    });
+  }
+
+  for (auto& writer : writers) {
+    writer.join();
+  }
+  done.store(true, std::memory_order_relaxed);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  ASSERT_EQ(mismatches.load(), 0);
+  ASSERT_EQ(store.GetSize(), Keys);
+  for (size_t i = 0; i < Keys; ++i) {
+    auto value = store.Get("key-" + std::to_string(i));
+    ASSERT_TRUE(value.has_value()) << i;
+    ASSERT_EQ(value->GetNumber(), static_cast<double>(Rounds));
+  }
+}
+
+TEST(KvStore, TestSnapshot) {
+  kv::KvStoreOptions options;
+  options.shards = 4;
+  kv::KvStore store { options };
+  constexpr size_t Count = 500;
+  for (size_t i = 0; i < Count; ++i) {
+    auto text = R"({"id": )" + std::to_string(i) + R"(, "tags": ["a tag longer than twelve bytes", null]})";
+    ASSERT_TRUE(store.Put("key-" + std::to_string(i), kv::ParseJson(text, store.GetNodeAllocator())));
+  }
+
+  char path[] = "/tmp/kv-store-snapshot-XXXXXX";
+  auto fd = ::mkstemp(path);
+  ASSERT_GE(fd, 0);
+  {
+    kv::JsonFileSink sink { fd };
+    kv::JsonSnapshotWriter<kv::JsonFileSink> writer { sink };
+    store.WriteSnapshot(writer, "store");
+    writer.Finish();
+    sink.Flush();
+  }
+  ::close(fd);
+
+  kv::JsonSnapshot snapshot { path };
+  std::remove(path);
+  ASSERT_TRUE(snapshot.Verify());
+  auto index = snapshot.FindIndex("store");
+  ASSERT_TRUE(index.has_value());
+  ASSERT_EQ(index->size(), Count);
+  ASSERT_EQ(index->Find("key-7")->GetMap().At("id").GetNumber(), 7);
+
+  kv::KvStore loaded;
+  ASSERT_TRUE(loaded.Put("key-0", kv::JsonObject { "stale" }));
+  ASSERT_EQ(loaded.LoadSnapshot(*index), Count);
+  ASSERT_EQ(loaded.GetSize(), Count);
+  for (size_t i = 0; i < Count; ++i) {
+    auto key = "key-" + std::to_string(i);
+    ASSERT_EQ(loaded.Get(key), store.Get(key)) << key;
+  }
+}
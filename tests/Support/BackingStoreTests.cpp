@@ -0,0 +1,87 @@
+#include "kv/Support/BackingStore.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "kv/Support/Memory.h"
+#include "gtest/gtest.h"
+
+TEST(BackingStore, TestMallocStore) {
+  auto store = kv::GetMallocBackingStore();
+
+  auto ptr = store->Map(4096);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) & 15, 0);
+  std::memset(ptr, 0xFF, 4096);
+  store->Purge(ptr, 4096);
+  store->Unmap(ptr, 4096);
+}
+
+TEST(BackingStore, TestMmapStorePurge) {
+  kv::MmapBackingStore store;
+  auto size = store.GetGranularity() * 4;
+
+  auto ptr = reinterpret_cast<uint8_t *>(store.Map(size));
+  std::memset(ptr, 0xFF, size);
+  store.Purge(ptr, size);
+  for (size_t i = 0; i < size; i += 512) {
+    ASSERT_EQ(ptr[i], 0);
+  }
+  store.Unmap(ptr, size);
+}
+
+TEST(BackingStore, TestTransparentHugePages) {
+  kv::MmapBackingStore store { kv::HugePagePolicy::Transparent };
+  ASSERT_EQ(store.GetGranularity(), 1 << 21);
+
+  auto ptr = store.Map(store.GetGranularity());
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) & (store.GetGranularity() - 1), 0);
+  std::memset(ptr, 0, store.GetGranularity());
+  store.Unmap(ptr, store.GetGranularity());
+}
+
+TEST(BackingStore, TestExplicitHugePages) {
+  kv::MmapBackingStore store { kv::HugePagePolicy::Explicit2M };
+
+  // Without a hugetlbfs pool the store falls back to transparent huge pages, which are aligned as well.
+  auto ptr = store.Map(store.GetGranularity());
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) & ((1 << 21) - 1), 0);
+  std::memset(ptr, 0, store.GetGranularity());
+  store.Unmap(ptr, store.GetGranularity());
+}
+
+TEST(BackingStore, TestAllocatorOverMmapStore) {
+  kv::MmapBackingStore store;
+  kv::RawAllocatorOptions options;
+  options.backingStore = &store;
+  options.blockSize = 1 << 16;
+  options.blockGrowthFactor = 2;
+  options.maxBlockSize = 1 << 20;
+  kv::RawAllocator allocator { options };
+
+  for (size_t i = 0; i < 64; ++i) {
+    auto ptr = allocator.Allocate(30000, 64);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) & 63, 0);
+    std::memset(ptr, 0xAB, 30000);
+  }
+}
+
+TEST(BackingStore, TestPurgeIdleBlocks) {
+  kv::MmapBackingStore store;
+  kv::RawAllocatorOptions options;
+  options.backingStore = &store;
+  options.blockSize = 1 << 16;
+  options.purgeIdleBlocks = true;
+  kv::RawAllocator allocator { options };
+
+  auto size = static_cast<size_t>(1) << 15;
+  auto ptr = reinterpret_cast<uint8_t *>(allocator.Allocate(size));
+  std::memset(ptr, 0xFF, size);
+  allocator.Release(ptr);
+
+  // The pages past the first page of the block have been discarded.
+  auto again = reinterpret_cast<uint8_t *>(allocator.Allocate(size));
+  ASSERT_EQ(again, ptr);
+  ASSERT_EQ(again[size - 1], 0);
+  allocator.Release(again);
+  allocator.Trim();
+}
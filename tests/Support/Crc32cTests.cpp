@@ -0,0 +1,39 @@
+#include "kv/Support/Crc32c.h"
+
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+TEST(Crc32c, TestKnownValues) {
+  ASSERT_EQ(kv::ComputeCrc32c(nullptr, 0), 0);
+
+  std::string_view check { "123456789" };
+  ASSERT_EQ(kv::ComputeCrc32c(check.data(), check.size()), 0xE3069283);
+
+  // The test vectors of RFC 3720, section B.4.
+  std::string zeros(32, '\0');
+  ASSERT_EQ(kv::ComputeCrc32c(zeros.data(), zeros.size()), 0x8A9136AA);
+  std::string ones(32, '\xFF');
+  ASSERT_EQ(kv::ComputeCrc32c(ones.data(), ones.size()), 0x62A8AB43);
+  std::string ascending;
+  for (int i = 0; i < 32; ++i) {
+    ascending.push_back(static_cast<char>(i));
+  }
+  ASSERT_EQ(kv::ComputeCrc32c(ascending.data(), ascending.size()), 0x46DD794E);
+}
+
+TEST(Crc32c, TestIncremental) {
+  std::string data;
+  for (int i = 0; i < 1000; ++i) {
+    data.push_back(static_cast<char>(i * 31 + 7));
+  }
+  auto whole = kv::ComputeCrc32c(data.data(), data.size());
+  for (size_t split : { 0, 1, 7, 8, 9, 500, 999, 1000 }) {
+    auto prefix = kv::ComputeCrc32c(data.data(), split);
+    ASSERT_EQ(kv::ComputeCrc32c(data.data() + split, data.size() - split, prefix), whole) << split;
+  }
+
+  // Unaligned starts take the same path as aligned ones.
+  ASSERT_EQ(kv::ComputeCrc32c(data.data() + 3, 100), kv::ComputeCrc32c(std::string { data, 3, 100 }.data(), 100));
+}
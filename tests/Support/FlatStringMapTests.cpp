@@ -0,0 +1,118 @@
+#include "kv/Support/FlatStringMap.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(FlatStringMap, TestInsertionOrder) {
+  kv::FlatStringMap<int> map;
+  ASSERT_TRUE(map.empty());
+
+  ASSERT_TRUE(map.emplace("b", 1).second);
+  ASSERT_TRUE(map.try_emplace("a", 2).second);
+  ASSERT_TRUE(map.insert_or_assign("c", 3).second);
+  ASSERT_FALSE(map.emplace("b", 4).second);
+  ASSERT_FALSE(map.insert_or_assign("a", 5).second);
+
+  std::vector<std::string> keys;
+  std::vector<int> values;
+  for (const auto& [key, value] : map) {
+    keys.push_back(key);
+    values.push_back(value);
+  }
+  ASSERT_EQ(keys, (std::vector<std::string> { "b", "a", "c" }));
+  ASSERT_EQ(values, (std::vector<int> { 1, 5, 3 }));
+}
+
+TEST(FlatStringMap, TestLookup) {
+  kv::FlatStringMap<int> map;
+  map["x"] = 7;
+  ASSERT_EQ(map.size(), 1);
+  ASSERT_EQ(map.at("x"), 7);
+  ASSERT_EQ(map.count("x"), 1);
+  ASSERT_EQ(map.count("y"), 0);
+  ASSERT_EQ(map.find("y"), map.end());
+  ASSERT_THROW((void)map.at("y"), std::out_of_range);
+  ASSERT_EQ(map["y"], 0);
+  ASSERT_EQ(map.size(), 2);
+}
+
+TEST(FlatStringMap, TestLargeMap) {
+  constexpr int Count = 5000;
+
+  kv::FlatStringMap<int> map;
+  std::unordered_map<std::string, int> reference;
+  for (auto i = 0; i < Count; ++i) {
+    auto key = "key" + std::to_string(i * 7919 % Count);
+    map.insert_or_assign(key, i);
+    reference.insert_or_assign(key, i);
+    ASSERT_EQ(map.size(), reference.size());
+  }
+
+  for (const auto& [key, value] : reference) {
+    auto it = map.find(key);
+    ASSERT_NE(it, map.end());
+    ASSERT_EQ(it->first, key);
+    ASSERT_EQ(it->second, value);
+  }
+  ASSERT_EQ(map.find("key"), map.end());
+  ASSERT_EQ(map.find("key" + std::to_string(Count)), map.end());
+
+  // Lookups with precomputed hashes agree with plain lookups, both with and without an index.
+  kv::FlatStringMap<int> small;
+  small.emplace("key1", 1);
+  for (const auto* m : { &map, &small }) {
+    for (const auto* key : { "key1", "key4999", "key" }) {
+      ASSERT_EQ(m->find(key, kv::FlatStringMap<int>::HashKey(key)), m->find(key));
+    }
+  }
+
+  // Iteration follows insertion order also when the map is indexed.
+  auto expected = 0;
+  for (const auto& entry : map) {
+    ASSERT_EQ(entry.second, expected++);
+  }
+}
+
+TEST(FlatStringMap, TestErase) {
+  kv::FlatStringMap<int> map;
+  for (auto i = 0; i < 40; ++i) {
+    map.emplace(std::to_string(i), i);
+  }
+
+  for (auto i = 0; i < 40; i += 2) {
+    ASSERT_EQ(map.erase(std::to_string(i)), 1);
+  }
+  ASSERT_EQ(map.erase("0"), 0);
+  ASSERT_EQ(map.size(), 20);
+
+  auto expected = 1;
+  for (const auto& [key, value] : map) {
+    ASSERT_EQ(value, expected);
+    ASSERT_EQ(map.at(key), expected);
+    expected += 2;
+  }
+  for (auto i = 0; i < 40; i += 2) {
+    ASSERT_EQ(map.count(std::to_string(i)), 0);
+  }
+
+  map.clear();
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(map.find("1"), map.end());
+}
+
+TEST(FlatStringMap, TestReserveAndMove) {
+  kv::FlatStringMap<std::unique_ptr<int>> map;
+  map.reserve(100);
+  for (auto i = 0; i < 100; ++i) {
+    map.emplace(std::to_string(i), std::make_unique<int>(i));
+  }
+
+  auto moved = std::move(map);
+  ASSERT_EQ(moved.size(), 100);
+  ASSERT_EQ(*moved.at("42"), 42);
+}
@@ -0,0 +1,49 @@
+#include "kv/Support/MappedFile.h"
+
+#include <cstdio>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::string WriteTempFile(const std::string& content) {
+  char path[] = "/tmp/kv-mapped-file-XXXXXX";
+  auto fd = ::mkstemp(path);
+  EXPECT_GE(fd, 0);
+  EXPECT_EQ(::write(fd, content.data(), content.size()), static_cast<ssize_t>(content.size()));
+  ::close(fd);
+  return path;
+}
+
+} // namespace <anonymous>
+
+TEST(MappedFile, TestMapFile) {
+  auto path = WriteTempFile("hello, mapped world");
+  kv::MappedFile file { path.c_str() };
+  ASSERT_EQ(file.GetView(), "hello, mapped world");
+  ASSERT_EQ(file.GetSize(), 19);
+
+  kv::MappedFile moved { std::move(file) };
+  ASSERT_EQ(moved.GetView(), "hello, mapped world");
+  ASSERT_EQ(file.GetData(), nullptr);
+  ASSERT_EQ(file.GetSize(), 0);
+
+  std::remove(path.c_str());
+}
+
+TEST(MappedFile, TestEmptyFile) {
+  auto path = WriteTempFile("");
+  kv::MappedFile file { path.c_str() };
+  ASSERT_EQ(file.GetData(), nullptr);
+  ASSERT_TRUE(file.GetView().empty());
+  std::remove(path.c_str());
+}
+
+TEST(MappedFile, TestMissingFile) {
+  ASSERT_THROW(kv::MappedFile { "/nonexistent/kv-mapped-file" }, std::system_error);
+}
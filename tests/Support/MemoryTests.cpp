@@ -1,6 +1,11 @@
 #include "kv/Support/Memory.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <limits>
+#include <new>
+#include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -41,3 +46,196 @@ TEST(RawAllocator, TestChunkMergeForward) {
   auto ptr3 = allocator.Allocate(16, 8);
   ASSERT_EQ(ptr1, ptr3);
 }
+
+TEST(RawAllocator, TestChunkMergeBackward) {
+  kv::RawAllocator allocator;
+
+  auto ptr1 = allocator.Allocate(8, 8);
+  auto ptr2 = allocator.Allocate(8, 8);
+  allocator.Release(ptr1);
+  allocator.Release(ptr2);
+
+  auto ptr3 = allocator.Allocate(16, 8);
+  ASSERT_EQ(ptr1, ptr3);
+}
+
+TEST(RawAllocator, TestReuseFromSizeClass) {
+  kv::RawAllocator allocator;
+
+  auto small = allocator.Allocate(8, 8);
+  auto large = allocator.Allocate(1024, 8);
+  auto guard = allocator.Allocate(8, 8);
+  allocator.Release(large);
+
+  auto reused = allocator.Allocate(512, 8);
+  ASSERT_EQ(reused, large);
+
+  allocator.Release(small);
+  allocator.Release(reused);
+  allocator.Release(guard);
+}
+
+TEST(RawAllocator, TestManyAllocations) {
+  kv::RawAllocator allocator;
+
+  std::vector<std::pair<uint8_t *, size_t>> ptrs;
+  for (size_t i = 0; i < 2000; ++i) {
+    auto size = 1 + (i * 37) % 700;
+    auto alignment = static_cast<size_t>(1) << (i % 7);
+    auto ptr = reinterpret_cast<uint8_t *>(allocator.Allocate(size, alignment));
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) & (alignment - 1), 0);
+    std::fill(ptr, ptr + size, static_cast<uint8_t>(i));
+    ptrs.emplace_back(ptr, size);
+
+    if (i % 3 == 0) {
+      auto victim = ptrs[(i * 7) % ptrs.size()];
+      ptrs.erase(ptrs.begin() + static_cast<ptrdiff_t>((i * 7) % ptrs.size()));
+      allocator.Release(victim.first);
+    }
+  }
+
+  for (size_t i = 0; i < ptrs.size(); ++i) {
+    auto [ptr, size] = ptrs[i];
+    auto expected = ptr[0];
+    for (size_t j = 0; j < size; ++j) {
+      ASSERT_EQ(ptr[j], expected);
+    }
+    allocator.Release(ptr);
+  }
+}
+
+TEST(RawAllocator, TestLargeAlignment) {
+  kv::RawAllocator allocator;
+
+  for (size_t alignment = 32; alignment <= 8192; alignment <<= 1) {
+    auto ptr = allocator.Allocate(24, alignment);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) & (alignment - 1), 0);
+    ASSERT_GE(kv::RawAllocator::GetUsableSize(ptr), 24);
+  }
+}
+
+TEST(RawAllocator, TestUsableSize) {
+  kv::RawAllocator allocator;
+
+  auto ptr = allocator.Allocate(100, 8);
+  ASSERT_GE(kv::RawAllocator::GetUsableSize(ptr), 100);
+  allocator.Release(ptr);
+}
+
+TEST(RawAllocator, TestReleaseNull) {
+  kv::RawAllocator allocator;
+
+  allocator.Release(nullptr);
+}
+
+TEST(RawAllocator, TestOwner) {
+  kv::RawAllocator allocator1;
+  kv::RawAllocator allocator2;
+
+  auto ptr1 = allocator1.Allocate(8, 8);
+  auto ptr2 = allocator2.Allocate(8, 64);
+  ASSERT_EQ(kv::RawAllocator::GetOwner(ptr1), &allocator1);
+  ASSERT_EQ(kv::RawAllocator::GetOwner(ptr2), &allocator2);
+}
+
+TEST(RawAllocator, TestStatsLayout) {
+  kv::RawAllocator allocator;
+
+  auto empty = allocator.GetStats();
+  ASSERT_EQ(empty.blockCount, 0);
+  ASSERT_EQ(empty.GetInUseBytes(), 0);
+
+  auto ptr1 = allocator.Allocate(100);
+  auto ptr2 = allocator.Allocate(100);
+  auto stats = allocator.GetStats();
+  ASSERT_EQ(stats.blockCount, 1);
+  ASSERT_EQ(stats.chunkCount, 3);
+  ASSERT_EQ(stats.freeChunkCount, 1);
+  ASSERT_EQ(stats.freeBytes, stats.largestFreeChunkSize);
+  ASSERT_EQ(stats.GetFragmentation(), 0.0);
+  ASSERT_GE(stats.GetInUseBytes(), 200);
+
+  allocator.Release(ptr1);
+  stats = allocator.GetStats();
+  ASSERT_EQ(stats.freeChunkCount, 2);
+  ASSERT_GT(stats.GetFragmentation(), 0.0);
+
+  allocator.Release(ptr2);
+  stats = allocator.GetStats();
+  ASSERT_EQ(stats.chunkCount, 1);
+  ASSERT_EQ(stats.freeChunkCount, 1);
+}
+
+TEST(RawAllocator, TestStatsCounters) {
+  if (!kv::AllocatorStatsEnabled) {
+    GTEST_SKIP() << "allocator statistics are disabled in this build";
+  }
+
+  kv::RawAllocator allocator;
+  auto ptr = allocator.Allocate(24);
+  auto sizeClass = kv::SizeToFloorClass(kv::RawAllocator::GetUsableSize(ptr));
+  allocator.Release(ptr);
+
+  auto stats = allocator.GetStats();
+  ASSERT_EQ(stats.allocations[sizeClass], 1);
+  ASSERT_EQ(stats.releases[sizeClass], 1);
+  ASSERT_EQ(stats.splits, 1);
+  ASSERT_EQ(stats.merges, 1);
+  ASSERT_EQ(stats.lockAcquisitions, 3);
+}
+
+TEST(RawAllocator, TestGlobalStats) {
+  auto ptr = kv::GetGlobalAllocator()->Allocate(100);
+  auto stats = kv::GetGlobalAllocatorStats();
+  ASSERT_GE(stats.blockCount, 1);
+  ASSERT_GE(stats.GetInUseBytes(), 100);
+  kv::GetGlobalAllocator()->Release(ptr);
+}
+
+TEST(GlobalAllocator, TestArrayNew) {
+  auto arr = new int[100];
+  ASSERT_NE(kv::RawAllocator::GetOwner(arr), nullptr);
+  delete[] arr;
+}
+
+TEST(GlobalAllocator, TestNothrowNew) {
+  auto ptr = new (std::nothrow) int { 42 };
+  ASSERT_NE(ptr, nullptr);
+  ASSERT_NE(kv::RawAllocator::GetOwner(ptr), nullptr);
+  delete ptr;
+
+  auto huge = ::operator new(std::numeric_limits<size_t>::max() / 2, std::nothrow);
+  ASSERT_EQ(huge, nullptr);
+}
+
+TEST(GlobalAllocator, TestAlignedNew) {
+  struct alignas(128) Aligned {
+    char data[200];
+  };
+
+  auto obj = new Aligned;
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(obj) % 128, 0);
+  delete obj;
+
+  auto arr = new Aligned[3];
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(arr) % 128, 0);
+  delete[] arr;
+}
+
+TEST(GlobalAllocator, TestSizedDelete) {
+  for (size_t size = 1; size <= 4096; size += 37) {
+    auto ptr = ::operator new(size);
+    ASSERT_GE(kv::RawAllocator::GetUsableSize(ptr), size);
+    ::operator delete(ptr, size);
+  }
+}
+
+TEST(GlobalAllocator, TestRegisteredWithoutConstruction) {
+  auto allocator = kv::GetGlobalAllocator();
+  ASSERT_EQ(allocator, kv::GetGlobalAllocator());
+
+  auto ptr = allocator->Allocate(64);
+  ASSERT_EQ(kv::RawAllocator::GetOwner(ptr), allocator);
+  ASSERT_EQ(kv::RawAllocator::GetOwnerTag(ptr), allocator->GetTag());
+  allocator->Release(ptr);
+}
@@ -0,0 +1,198 @@
+#include "kv/Support/MonotonicArena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class CountingResource : public kv::MemoryResource {
+public:
+  void* Allocate(size_t size, size_t alignment) override {
+    ++allocations;
+    return _raw.Allocate(size, alignment);
+  }
+
+  void Release(void* ptr) noexcept override {
+    ++releases;
+    _raw.Release(ptr);
+  }
+
+  size_t allocations = 0;
+  size_t releases = 0;
+
+private:
+  kv::RawAllocator _raw;
+}; // class CountingResource
+
+class DestructorCounter {
+public:
+  explicit DestructorCounter(int& counter) noexcept
+    : _counter(counter)
+  { }
+
+  ~DestructorCounter() noexcept {
+    ++_counter;
+  }
+
+private:
+  int& _counter;
+}; // class DestructorCounter
+
+} // namespace <anonymous>
+
+TEST(MonotonicArena, TestBumpAllocation) {
+  kv::MonotonicArena arena;
+
+  auto ptr1 = static_cast<char *>(arena.Allocate(24));
+  auto ptr2 = static_cast<char *>(arena.Allocate(24));
+  ASSERT_EQ(ptr1 + 24, ptr2);
+}
+
+TEST(MonotonicArena, TestAlignment) {
+  kv::MonotonicArena arena;
+
+  for (size_t alignment = 1; alignment <= 4096; alignment *= 2) {
+    arena.Allocate(1, 1);
+    auto ptr = arena.Allocate(8, alignment);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignment, 0);
+  }
+}
+
+TEST(MonotonicArena, TestBlockGrowth) {
+  CountingResource upstream;
+  kv::MonotonicArena arena { upstream, 1024 };
+
+  for (int i = 0; i < 1000; ++i) {
+    std::memset(arena.Allocate(100), 0xAB, 100);
+  }
+
+  // Doubling block sizes need far fewer blocks than fixed ones.
+  ASSERT_LT(upstream.allocations, 10);
+  ASSERT_GE(arena.GetReservedSize(), 100 * 1000);
+}
+
+TEST(MonotonicArena, TestLargeAllocation) {
+  CountingResource upstream;
+  kv::MonotonicArena arena { upstream, 1024 };
+
+  auto small = static_cast<char *>(arena.Allocate(16));
+  auto large = arena.Allocate(1 << 20);
+  std::memset(large, 0xAB, 1 << 20);
+
+  // The large request does not retire the current block.
+  ASSERT_EQ(small + 16, arena.Allocate(16));
+  ASSERT_EQ(upstream.allocations, 2);
+}
+
+TEST(MonotonicArena, TestAllocationLargerThanMaxBlockSize) {
+  kv::RawAllocator upstream;
+  kv::MonotonicArena arena { upstream };
+
+  constexpr size_t size = kv::MonotonicArena::MaxBlockSize * 2 + 4096;
+  auto large = static_cast<char *>(arena.Allocate(size, 4096));
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(large) % 4096, 0);
+  large[0] = 1;
+  large[size - 1] = 2;
+  ASSERT_GE(arena.GetReservedSize(), size);
+
+  // Later small requests are still served from the current block.
+  auto small = static_cast<char *>(arena.Allocate(16));
+  ASSERT_EQ(small + 16, arena.Allocate(16));
+}
+
+TEST(MonotonicArena, TestAllocationOverflow) {
+  kv::MonotonicArena arena;
+
+  ASSERT_THROW(arena.Allocate(std::numeric_limits<size_t>::max() - 8), std::bad_alloc);
+}
+
+TEST(MonotonicArena, TestReset) {
+  CountingResource upstream;
+  kv::MonotonicArena arena { upstream, 1024 };
+
+  for (int i = 0; i < 100; ++i) {
+    arena.Allocate(100);
+  }
+  arena.Allocate(1 << 20);
+
+  arena.Reset();
+  ASSERT_EQ(upstream.releases, upstream.allocations - 1);
+
+  // The retained block is reused after the reset.
+  auto retained = upstream.allocations;
+  auto ptr1 = arena.Allocate(100);
+  arena.Reset();
+  auto ptr2 = arena.Allocate(100);
+  ASSERT_EQ(ptr1, ptr2);
+  ASSERT_EQ(upstream.allocations, retained);
+}
+
+TEST(MonotonicArena, TestDestructorReleasesBlocks) {
+  CountingResource upstream;
+  {
+    kv::MonotonicArena arena { upstream, 1024 };
+    for (int i = 0; i < 100; ++i) {
+      arena.Allocate(100);
+    }
+    arena.Allocate(1 << 20);
+  }
+
+  ASSERT_EQ(upstream.allocations, upstream.releases);
+}
+
+TEST(MonotonicArena, TestContainers) {
+  kv::MonotonicArena arena;
+
+  std::vector<int, kv::ObjectAllocator<int>> vector { kv::ObjectAllocator<int> { arena } };
+  for (int i = 0; i < 1000; ++i) {
+    vector.push_back(i);
+  }
+  ASSERT_EQ(vector.size(), 1000);
+  ASSERT_EQ(vector.get_allocator().GetResource(), &arena);
+
+  std::list<int, kv::ObjectAllocator<int>> list { kv::ObjectAllocator<int> { arena } };
+  for (int i = 0; i < 100; ++i) {
+    list.push_back(i);
+  }
+  ASSERT_EQ(list.size(), 100);
+
+  using String = std::basic_string<char, std::char_traits<char>, kv::ObjectAllocator<char>>;
+  using Map = std::map<String, int, std::less<>, kv::ObjectAllocator<std::pair<const String, int>>>;
+  Map map { kv::ObjectAllocator<std::pair<const String, int>> { arena } };
+  for (int i = 0; i < 100; ++i) {
+    auto key = std::to_string(i) + " is a key that does not fit into the small string buffer";
+    map.emplace(String { key.c_str(), kv::ObjectAllocator<char> { arena } }, i);
+  }
+  ASSERT_EQ(map.size(), 100);
+  ASSERT_EQ(map.begin()->second, 0);
+}
+
+TEST(MonotonicArena, TestObjectDeleter) {
+  kv::MonotonicArena arena;
+  int destroyed = 0;
+
+  {
+    auto obj = kv::MakeObject<DestructorCounter>(kv::ObjectAllocator<DestructorCounter> { arena }, destroyed);
+    ASSERT_EQ(obj.get_deleter().GetAllocator().GetResource(), &arena);
+  }
+
+  ASSERT_EQ(destroyed, 1);
+}
+
+TEST(ObjectDeleter, TestDestroysObject) {
+  int destroyed = 0;
+
+  {
+    auto obj = kv::MakeObject<DestructorCounter>(kv::ObjectAllocator<DestructorCounter> { }, destroyed);
+    ASSERT_EQ(kv::RawAllocator::GetOwner(obj.get()) != nullptr, true);
+  }
+
+  ASSERT_EQ(destroyed, 1);
+}
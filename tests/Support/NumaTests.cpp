@@ -0,0 +1,81 @@
+#include "kv/Support/Numa.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+#include "kv/Support/Memory.h"
+#include "gtest/gtest.h"
+
+TEST(NumaTopology, TestBasicTopology) {
+  const auto& topology = kv::NumaTopology::Get();
+  ASSERT_GE(topology.GetNodeCount(), 1);
+  ASSERT_GE(topology.GetCpuCount(), 1);
+
+  size_t cpus = 0;
+  for (size_t node = 0; node < topology.GetNodeCount(); ++node) {
+    if (topology.IsNodeOnline(node)) {
+      cpus += topology.GetCpusOfNode(node).count();
+      ASSERT_EQ(topology.GetDistance(node, node), 10);
+    }
+  }
+  ASSERT_GE(cpus, 1);
+}
+
+TEST(NumaTopology, TestCurrentNode) {
+  const auto& topology = kv::NumaTopology::Get();
+  ASSERT_TRUE(topology.IsNodeOnline(kv::NumaTopology::GetCurrentNode()));
+}
+
+TEST(NumaTopology, TestPinToNode) {
+  std::thread thread([]() {
+    auto node = kv::NumaTopology::GetCurrentNode();
+    ASSERT_TRUE(kv::PinCurrentThreadToNumaNode(node));
+    ASSERT_EQ(kv::NumaTopology::GetCurrentNode(), node);
+  });
+  thread.join();
+}
+
+TEST(NodeAllocator, TestAllocateFromNode) {
+  auto allocator = kv::GetNodeAllocator(0);
+  ASSERT_NE(allocator, nullptr);
+  ASSERT_EQ(allocator->GetOptions().numaNode, 0);
+
+  auto ptr = allocator->Allocate(4096, 64);
+  std::memset(ptr, 0, 4096);
+  ASSERT_EQ(kv::RawAllocator::GetOwner(ptr), allocator);
+  allocator->Release(ptr);
+}
+
+TEST(NodeAllocator, TestOfflineNodeFallsBackToGlobal) {
+  ASSERT_EQ(kv::GetNodeAllocator(kv::NumaTopology::MaxNodes), kv::GetGlobalAllocator());
+}
+
+TEST(NodeAllocator, TestGlobalDeleteReturnsToOwner) {
+  auto allocator = kv::GetNodeAllocator(0);
+  auto ptr = allocator->Allocate(32);
+  ::operator delete(ptr);
+
+  auto large = allocator->Allocate(1 << 16);
+  ::operator delete(large);
+}
+
+TEST(NodeAllocator, TestPerNodeMode) {
+  auto previous = kv::GetGlobalAllocatorMode();
+  kv::SetGlobalAllocatorMode(kv::GlobalAllocatorMode::PerNode);
+
+  std::thread thread([]() {
+    auto local = kv::GetLocalAllocator();
+    ASSERT_EQ(local, kv::GetNodeAllocator(kv::NumaTopology::GetCurrentNode()));
+
+    auto value = new uint64_t(42);
+    ASSERT_EQ(kv::RawAllocator::GetOwner(value), local);
+    delete value;
+  });
+  thread.join();
+
+  kv::SetGlobalAllocatorMode(previous);
+  ASSERT_EQ(kv::GetLocalAllocator(), previous == kv::GlobalAllocatorMode::Shared
+      ? kv::GetGlobalAllocator()
+      : kv::GetNodeAllocator(kv::NumaTopology::GetCurrentNode()));
+}
@@ -0,0 +1,33 @@
+#include "kv/Support/SizeClass.h"
+
+#include "gtest/gtest.h"
+
+TEST(SizeClass, TestLinearClasses) {
+  ASSERT_EQ(kv::SizeToClass(1), 0);
+  ASSERT_EQ(kv::SizeToClass(16), 0);
+  ASSERT_EQ(kv::SizeToClass(17), 1);
+  ASSERT_EQ(kv::SizeToClass(128), 7);
+  ASSERT_EQ(kv::ClassToSize(0), 16);
+  ASSERT_EQ(kv::ClassToSize(7), 128);
+}
+
+TEST(SizeClass, TestGeometricClasses) {
+  ASSERT_EQ(kv::SizeToClass(129), 8);
+  ASSERT_EQ(kv::ClassToSize(8), 160);
+  ASSERT_EQ(kv::SizeToClass(161), 9);
+  ASSERT_EQ(kv::ClassToSize(11), 256);
+  ASSERT_EQ(kv::ClassToSize(12), 320);
+}
+
+TEST(SizeClass, TestRoundTrip) {
+  for (size_t sizeClass = 0; sizeClass < kv::SizeClassCount; ++sizeClass) {
+    auto size = kv::ClassToSize(sizeClass);
+    ASSERT_EQ(kv::SizeToClass(size), sizeClass);
+    ASSERT_EQ(kv::SizeToFloorClass(size), sizeClass);
+    if (sizeClass > 0) {
+      ASSERT_GT(size, kv::ClassToSize(sizeClass - 1));
+      ASSERT_EQ(kv::SizeToClass(kv::ClassToSize(sizeClass - 1) + 1), sizeClass);
+      ASSERT_EQ(kv::SizeToFloorClass(size - 1), sizeClass - 1);
+    }
+  }
+}
@@ -0,0 +1,123 @@
+#include "kv/Support/SlabPool.h"
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <map>
+#include <unordered_set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(SlabPool, TestSlotSize) {
+  kv::SlabPool pool { 1 };
+  ASSERT_EQ(pool.GetSlotSize(), kv::SlabPool::SlotAlignment);
+
+  kv::SlabPool pool2 { 40 };
+  ASSERT_EQ(pool2.GetSlotSize(), 48);
+}
+
+TEST(SlabPool, TestContiguousSlots) {
+  kv::SlabPool pool { 32 };
+
+  auto ptr1 = static_cast<char *>(pool.Allocate());
+  auto ptr2 = static_cast<char *>(pool.Allocate());
+  ASSERT_EQ(ptr1 + 32, ptr2);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr1) % kv::SlabPool::SlotAlignment, 0);
+}
+
+TEST(SlabPool, TestReuseAfterRelease) {
+  kv::SlabPool pool { 32 };
+
+  auto ptr1 = pool.Allocate();
+  pool.Allocate();
+  pool.Release(ptr1);
+  ASSERT_EQ(pool.Allocate(), ptr1);
+}
+
+TEST(SlabPool, TestManySlabs) {
+  kv::SlabPool pool { 64, 1024 };
+
+  std::vector<void *> slots;
+  for (int i = 0; i < 1000; ++i) {
+    auto ptr = pool.Allocate();
+    std::memset(ptr, 0xAB, 64);
+    slots.push_back(ptr);
+  }
+  ASSERT_GT(pool.GetSlabCount(), 1);
+
+  auto slabCount = pool.GetSlabCount();
+  for (auto ptr : slots) {
+    pool.Release(ptr);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    pool.Allocate();
+  }
+  ASSERT_EQ(pool.GetSlabCount(), slabCount);
+}
+
+TEST(SlabPoolSet, TestPoolSelection) {
+  kv::SlabPoolSet pools;
+
+  ASSERT_EQ(pools.GetPool(1, 8), pools.GetPool(16, 8));
+  ASSERT_NE(pools.GetPool(16, 8), pools.GetPool(17, 8));
+  ASSERT_EQ(pools.GetPool(17, 8)->GetSlotSize(), 32);
+  ASSERT_EQ(pools.GetPool(kv::SlabPoolSet::MaxPooledSize + 1, 8), nullptr);
+  ASSERT_EQ(pools.GetPool(16, 64), nullptr);
+}
+
+TEST(PoolAllocator, TestContainers) {
+  kv::SlabPoolSet pools;
+
+  std::list<int, kv::PoolAllocator<int>> list { kv::PoolAllocator<int> { pools } };
+  for (int i = 0; i < 1000; ++i) {
+    list.push_back(i);
+  }
+  ASSERT_EQ(list.size(), 1000);
+  ASSERT_EQ(list.back(), 999);
+
+  using MapAllocator = kv::PoolAllocator<std::pair<const int, int>>;
+  std::map<int, int, std::less<>, MapAllocator> map { MapAllocator { pools } };
+  for (int i = 0; i < 1000; ++i) {
+    map.emplace(i, i * 2);
+  }
+  ASSERT_EQ(map.size(), 1000);
+  ASSERT_EQ(map.at(500), 1000);
+  map.clear();
+
+  using Set = std::unordered_set<int, std::hash<int>, std::equal_to<>, kv::PoolAllocator<int>>;
+  Set set { 0, std::hash<int> { }, std::equal_to<> { }, kv::PoolAllocator<int> { pools } };
+  for (int i = 0; i < 1000; ++i) {
+    set.insert(i);
+  }
+  ASSERT_EQ(set.size(), 1000);
+
+  std::vector<int, kv::PoolAllocator<int>> vector { kv::PoolAllocator<int> { pools } };
+  for (int i = 0; i < 1000; ++i) {
+    vector.push_back(i);
+  }
+  ASSERT_EQ(vector.size(), 1000);
+}
+
+TEST(PoolAllocator, TestRebind) {
+  kv::SlabPoolSet pools;
+  kv::PoolAllocator<int> alloc1 { pools };
+  kv::PoolAllocator<double> alloc2 { alloc1 };
+  ASSERT_EQ(alloc1, alloc2);
+
+  kv::SlabPoolSet otherPools;
+  ASSERT_NE(alloc1, kv::PoolAllocator<int> { otherPools });
+}
+
+TEST(PoolAllocator, TestLargeObjects) {
+  struct Large {
+    char data[kv::SlabPoolSet::MaxPooledSize * 2];
+  };
+
+  kv::SlabPoolSet pools;
+  kv::PoolAllocator<Large> alloc { pools };
+  auto ptr = alloc.allocate(1);
+  std::memset(ptr, 0xAB, sizeof(Large));
+  ASSERT_EQ(kv::RawAllocator::GetOwner(ptr), kv::GetGlobalAllocator());
+  alloc.deallocate(ptr, 1);
+}
@@ -0,0 +1,136 @@
+#include "kv/Support/ThreadCache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(ThreadCache, TestReuseAfterRelease) {
+  kv::RawAllocator shared;
+  kv::ThreadCache cache { shared };
+
+  auto ptr1 = cache.Allocate(24);
+  cache.Release(ptr1);
+
+  auto ptr2 = cache.Allocate(24);
+  ASSERT_EQ(ptr1, ptr2);
+  cache.Release(ptr2);
+}
+
+TEST(ThreadCache, TestChunksServeTheirSizeClass) {
+  kv::RawAllocator shared;
+  kv::ThreadCache cache { shared };
+
+  for (size_t size = 1; size <= kv::ThreadCache::MaxCachedSize; size += 7) {
+    auto ptr = cache.Allocate(size);
+    ASSERT_GE(kv::RawAllocator::GetUsableSize(ptr), size);
+    std::memset(ptr, 0xAB, size);
+    cache.Release(ptr);
+  }
+}
+
+TEST(ThreadCache, TestLargeAllocation) {
+  kv::RawAllocator shared;
+  kv::ThreadCache cache { shared };
+
+  auto ptr = cache.Allocate(kv::ThreadCache::MaxCachedSize * 4);
+  ASSERT_GE(kv::RawAllocator::GetUsableSize(ptr), kv::ThreadCache::MaxCachedSize * 4);
+  cache.Release(ptr);
+}
+
+TEST(ThreadCache, TestDrainAndFlush) {
+  kv::RawAllocator shared;
+  kv::ThreadCache cache { shared };
+
+  std::vector<void *> ptrs;
+  for (size_t i = 0; i < 1000; ++i) {
+    ptrs.push_back(cache.Allocate(16));
+  }
+  for (auto ptr : ptrs) {
+    cache.Release(ptr);
+  }
+  cache.Flush();
+
+  // After flushing, all chunks have been merged back, so a large allocation fits into the first memory block again.
+  auto large = shared.Allocate(512, 8);
+  ASSERT_NE(large, nullptr);
+  shared.Release(large);
+}
+
+TEST(ThreadCache, TestCrossThreadRelease) {
+  kv::RawAllocator shared;
+
+  std::vector<void *> ptrs;
+  std::thread producer([&shared, &ptrs]() {
+    kv::ThreadCache cache { shared };
+    for (size_t i = 0; i < 500; ++i) {
+      auto ptr = cache.Allocate(8 + i % 200);
+      *reinterpret_cast<uint64_t *>(ptr) = i;
+      ptrs.push_back(ptr);
+    }
+  });
+  producer.join();
+
+  std::thread consumer([&shared, &ptrs]() {
+    kv::ThreadCache cache { shared };
+    for (size_t i = 0; i < ptrs.size(); ++i) {
+      ASSERT_EQ(*reinterpret_cast<uint64_t *>(ptrs[i]), i);
+      cache.Release(ptrs[i]);
+    }
+  });
+  consumer.join();
+}
+
+TEST(ThreadCache, TestGlobalConcurrentChurn) {
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([t]() {
+      std::vector<std::vector<uint8_t>> buffers;
+      for (size_t i = 0; i < 5000; ++i) {
+        buffers.emplace_back(1 + (i * 13 + t) % 300, static_cast<uint8_t>(i));
+        if (buffers.size() > 64) {
+          buffers.erase(buffers.begin());
+        }
+      }
+      for (const auto& buffer : buffers) {
+        for (auto byte : buffer) {
+          ASSERT_EQ(byte, buffer.front());
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_NE(kv::ThreadCache::GetCurrent(), nullptr);
+}
+
+TEST(ThreadCache, TestSizedRelease) {
+  kv::RawAllocator shared;
+  kv::ThreadCache cache { shared };
+
+  auto ptr1 = cache.Allocate(100);
+  cache.Release(ptr1, 100);
+
+  // Any size of the same size class reuses the chunk.
+  auto ptr2 = cache.Allocate(kv::ClassToSize(kv::SizeToClass(100)));
+  ASSERT_EQ(ptr1, ptr2);
+  cache.Release(ptr2, kv::ClassToSize(kv::SizeToClass(100)));
+}
+
+TEST(ThreadCache, TestSizedReleaseOfForeignChunk) {
+  kv::RawAllocator shared;
+  kv::RawAllocator other;
+  kv::ThreadCache cache { shared };
+
+  auto ptr = other.Allocate(100);
+  cache.Release(ptr, 100);
+
+  // The chunk went back to its owner instead of the magazine.
+  ASSERT_NE(cache.Allocate(100), ptr);
+  ASSERT_EQ(other.Allocate(100), ptr);
+}